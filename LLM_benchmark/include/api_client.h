@@ -1,8 +1,11 @@
 #ifndef API_CLIENT_H
 #define API_CLIENT_H
 
+#include "inference_backend.h"
 #include <string>
 #include <vector>
+#include <chrono>
+#include <functional>
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 
@@ -11,13 +14,61 @@ using json = nlohmann::json;
 /**
  * @brief Class to handle Ollama API interactions
  */
-class OllamaAPI {
+class OllamaAPI : public InferenceBackend {
 private:
     std::string base_url;
     bool use_mmap;  // Use memory-mapped model loading
+    int num_ctx;    // Context length sent as options.num_ctx (0 for the server default)
+    
+    /**
+     * @brief Partial state of a streamed (NDJSON) response
+     */
+    struct StreamState {
+        std::string pending;        // Bytes after the last complete line
+        std::string text;           // Concatenated "response" fields
+        json final_chunk;           // The chunk with "done": true, which carries the metrics
+        std::chrono::steady_clock::time_point start;
+        std::vector<double>* token_times; // Arrival of each non-empty chunk (may be null)
+        bool echo;                  // Print pieces as they arrive
+        const std::function<void(const std::string&)>* on_piece = nullptr; // Called with each piece (may be null)
+    };
     
     // Callback function for cURL to write response data
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* response);
+    
+    /**
+     * @brief Parse one NDJSON chunk of a streamed response
+     * @param line The chunk, without its newline
+     * @param state Stream being assembled
+     * @param arrival When the bytes arrived
+     */
+    static void handle_stream_line(const std::string& line, StreamState* state,
+                                   std::chrono::steady_clock::time_point arrival);
+    
+    // Callback function for cURL that parses streamed chunks as they arrive
+    static size_t StreamCallback(void* contents, size_t size, size_t nmemb, StreamState* state);
+    
+    /**
+     * @brief POST a JSON body to an endpoint of the server
+     * @param path Endpoint path (e.g. "/api/chat")
+     * @param body Request body
+     * @param response Receives the response body (for streams, the final chunk with the full text)
+     * @param stream_state Parse the response as NDJSON chunks (nullptr to buffer it)
+     * @param http_code Optional output for the HTTP status
+     * @return cURL result
+     */
+    CURLcode post_json(const std::string& path, const json& body, std::string& response,
+                       StreamState* stream_state = nullptr, long* http_code = nullptr);
+    
+    /**
+     * @brief Default request options (GPU, temperature, mmap, num_ctx) with overrides merged in
+     */
+    json request_options(const json* options) const;
+    
+    /**
+     * @brief Timing fields of a final response, converted to seconds
+     */
+    static GenerationMetrics parse_metrics(const json& j, double wall_time);
 
 public:
     /**
@@ -38,26 +89,147 @@ public:
      */
     static void cleanup();
     
+    /**
+     * @brief Backend name for reports
+     * @return "ollama"
+     */
+    std::string name() const override;
+    
     /**
      * @brief Get list of available models
      * @return Vector of model names
      */
-    std::vector<std::string> list_models();
+    std::vector<std::string> list_models() override;
+    
+    /**
+     * @brief Get size and quantization of every available model
+     * @return Model descriptions
+     */
+    std::vector<ModelInfo> list_model_info() override;
+    
+    /**
+     * @brief Request a context length instead of the server default
+     * @param context Tokens (0 to leave options.num_ctx unset)
+     */
+    void set_num_ctx(int context);
+    
+    /**
+     * @brief Server defaults (F16 KV cache, 512-token batches) and num_ctx
+     * @return Runtime configuration of the llama.cpp runner
+     */
+    RuntimeConfig runtime_config() const override;
     
     /**
      * @brief Generate text from a model
      * @param model The model name
      * @param prompt The input prompt
-     * @param stream Whether to stream the output
+     * @param stream Receive the response chunk by chunk and record when each token arrives
+     *        (printed as it arrives in verbose mode)
      * @param verbose Whether to print verbose information
+     * @param metrics Optional output for server-reported timing metrics
+     * @param options Optional keys merged into the request's "options" object
      * @return The model's response
      */
     std::string generate(
         const std::string& model, 
         const std::string& prompt, 
         bool stream = false, 
-        bool verbose = false
+        bool verbose = false,
+        GenerationMetrics* metrics = nullptr,
+        const json* options = nullptr
+    ) override;
+    
+    /**
+     * @brief Continue a generation from the token context a previous one returned
+     * @param model The model name
+     * @param prompt The new input
+     * @param system System prompt (empty for the model's default)
+     * @param context Context from the previous response (empty to start); replaced by the new one
+     * @param metrics Optional output for server-reported timing metrics
+     * @param options Optional keys merged into the request's "options" object
+     * @return The model's response, or a message starting with "Error:"
+     */
+    std::string generate_with_context(
+        const std::string& model,
+        const std::string& prompt,
+        const std::string& system,
+        std::vector<int>& context,
+        GenerationMetrics* metrics = nullptr,
+        const json* options = nullptr
+    );
+    
+    /**
+     * @brief Stream a generation whose output is constrained by the request's "format"
+     * @param model The model name
+     * @param prompt The input prompt
+     * @param format "json", a JSON schema object, or null for unconstrained output
+     * @param metrics Optional output for server-reported timings and token arrival times
+     * @param options Optional keys merged into the request's "options" object
+     * @param on_piece Called with each piece of the response as it arrives
+     * @return The model's response, or a message starting with "Error:"
+     */
+    std::string generate_structured(
+        const std::string& model,
+        const std::string& prompt,
+        const json& format,
+        GenerationMetrics* metrics = nullptr,
+        const json* options = nullptr,
+        const std::function<void(const std::string&)>& on_piece = nullptr
+    );
+    
+    /**
+     * @brief Stream a generation with images attached (vision-language models)
+     * @param model The model name
+     * @param prompt The input prompt
+     * @param images Base64-encoded image files (PNG or JPEG), sent as the request's "images"
+     * @param metrics Optional output for server-reported timings and token arrival times
+     * @param options Optional keys merged into the request's "options" object
+     * @return The model's response, or a message starting with "Error:"
+     */
+    std::string generate_with_images(
+        const std::string& model,
+        const std::string& prompt,
+        const std::vector<std::string>& images,
+        GenerationMetrics* metrics = nullptr,
+        const json* options = nullptr
     );
+    
+    /**
+     * @brief Send a conversation to /api/chat
+     * @param model The model name
+     * @param messages Array of {"role", "content"} objects, oldest first
+     * @param metrics Optional output for server-reported timing metrics
+     * @param options Optional keys merged into the request's "options" object
+     * @return The assistant's reply, or a message starting with "Error:"
+     */
+    std::string chat(
+        const std::string& model,
+        const json& messages,
+        GenerationMetrics* metrics = nullptr,
+        const json* options = nullptr
+    );
+    
+    /**
+     * @brief Embed a batch of documents with /api/embed
+     * @param model The model name
+     * @param inputs Documents, one embedding each
+     * @param embeddings Receives one vector per input, in order
+     * @param metrics Optional output for the input token count and server/client timings
+     * @return Empty on success, or a message starting with "Error:"
+     */
+    std::string embed(
+        const std::string& model,
+        const std::vector<std::string>& inputs,
+        std::vector<std::vector<float>>& embeddings,
+        GenerationMetrics* metrics = nullptr
+    );
+    
+    /**
+     * @brief Unload a model from server memory (keep_alive = 0)
+     * @param model The model name
+     * @return true if the server acknowledged the request
+     */
+    bool unload_model(const std::string& model) override;
 };
 
 #endif // API_CLIENT_H
\ No newline at end of file
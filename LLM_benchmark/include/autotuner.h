@@ -0,0 +1,123 @@
+#ifndef AUTOTUNER_H
+#define AUTOTUNER_H
+
+#include "inference_backend.h"
+#include "tokenizer.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief One short request with one candidate set of options
+ */
+struct TuneProbe {
+    json options;               // Candidate, as sent in the request
+    int round;                  // 0-based halving round
+    int budget;                 // Output tokens (decode) or prompt tokens (ttft) of the probe
+    bool ok;
+    std::string error;          // Backend message if the request failed
+    double decode_tps;          // eval_count / eval_duration
+    double ttft_seconds;        // Prefill plus one decode step, without the load
+    double load_seconds;        // Non-zero when the options made the model reload
+};
+
+/**
+ * @brief Outcome of tuning one model
+ */
+struct TuneResult {
+    std::string model_name;
+    std::string objective;
+    bool ok;                    // Whether any candidate completed a probe
+    json options;               // Winning candidate
+    double decode_tps;          // Measurements of the winner's last probe
+    double ttft_seconds;
+    std::vector<TuneProbe> probes;
+};
+
+/**
+ * @brief Searches num_thread, num_batch and num_ctx for the fastest settings of a model
+ *
+ * Successive halving: every candidate combination gets a short probe,
+ * the better half survives, and each round doubles the probe so the last
+ * few candidates are compared on longer, less noisy requests. Candidates
+ * whose probe fails (for example because the context does not fit in
+ * memory) are dropped at once. The objective is either decode rate
+ * (longer outputs of a short prompt) or time to first token (longer
+ * prompts, one output token); both come from the backend's own timings,
+ * so a reload caused by changing options is not counted.
+ *
+ * num_batch is not searched on backends that ignore it (gguf decodes one
+ * token per step), and num_ctx is only searched when values are given,
+ * since a smaller context is nearly always faster but holds less.
+ */
+class Autotuner {
+private:
+    std::string objective;
+    std::vector<int> threads;
+    std::vector<int> batches;
+    std::vector<int> contexts;
+
+    /**
+     * @brief Send one probe and measure it
+     */
+    TuneProbe probe(InferenceBackend& backend, const std::string& model, const json& candidate,
+                    int round, const Tokenizer* tokenizer, unsigned seed) const;
+
+    /**
+     * @brief Score of a probe, higher is better
+     */
+    double score(const TuneProbe& probe) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param goal "decode" to maximize tokens/s or "ttft" to minimize time to first token
+     * @param thread_values num_thread candidates (empty for powers of two up to the CPU count)
+     * @param batch_values num_batch candidates (empty for 32 to 512)
+     * @param context_values num_ctx candidates (empty to leave the context alone)
+     */
+    Autotuner(const std::string& goal = "decode",
+              const std::vector<int>& thread_values = {},
+              const std::vector<int>& batch_values = {},
+              const std::vector<int>& context_values = {});
+
+    /**
+     * @brief Powers of two below the online CPU count, then the count itself
+     */
+    static std::vector<int> default_threads();
+
+    /**
+     * @brief Parse a comma-separated list of positive integers
+     * @return false if an entry is not a positive integer
+     */
+    static bool parse_list(const std::string& text, std::vector<int>& values);
+
+    /**
+     * @brief Every combination to search on a backend
+     */
+    std::vector<json> candidates(const InferenceBackend& backend) const;
+
+    /**
+     * @brief Tune one model
+     * @param backend Backend to probe
+     * @param model Model name
+     * @param tokenizer The model's tokenizer, to size ttft prompts (may be nullptr)
+     */
+    TuneResult run(InferenceBackend& backend, const std::string& model, const Tokenizer* tokenizer);
+
+    /**
+     * @brief Print each round's probes and the winner
+     */
+    static void print(const TuneResult& result);
+
+    /**
+     * @brief Result and its probes as JSON
+     */
+    static json to_json(const TuneResult& result);
+
+    const std::string& get_objective() const;
+};
+
+#endif // AUTOTUNER_H
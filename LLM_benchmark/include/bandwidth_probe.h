@@ -0,0 +1,76 @@
+#ifndef BANDWIDTH_PROBE_H
+#define BANDWIDTH_PROBE_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Sustained bandwidth of one STREAM kernel
+ */
+struct BandwidthResult {
+    std::string kernel;   // "copy", "scale" or "triad"
+    int threads;
+    double gb_per_s;      // Best iteration, 10^9 bytes per second
+};
+
+/**
+ * @brief STREAM-style memory bandwidth probe
+ *
+ * Runs copy (c = a), scale (b = s*c) and triad (a = b + s*c) over three
+ * arrays of doubles, once with a single thread and once with one thread
+ * per allowed CPU. Threads are pinned so that every physical core gets a
+ * thread before any SMT sibling does, spread round-robin across NUMA nodes.
+ * Each thread first-touches its own slice of the arrays, which places
+ * those pages on the thread's local node. The best of several iterations
+ * is reported, skipping the first, as STREAM does.
+ */
+class BandwidthProbe {
+private:
+    size_t array_elements;
+    int max_threads;
+    int iterations;
+    std::vector<int> cpu_order; // CPUs in pinning order
+    int numa_nodes;
+
+    /**
+     * @brief Order the allowed CPUs by physical core, then SMT sibling, across NUMA nodes
+     */
+    void discover_topology();
+
+    /**
+     * @brief Run all kernels with a given thread count
+     * @param threads Number of worker threads
+     * @return One result per kernel
+     */
+    std::vector<BandwidthResult> run_kernels(int threads);
+
+public:
+    /**
+     * @brief Constructor
+     * @param array_mb Size of each of the three arrays in MB (should be well above the last-level cache)
+     * @param threads Thread count for the multithreaded pass (0 for every allowed CPU)
+     * @param repeat Iterations per kernel
+     */
+    explicit BandwidthProbe(size_t array_mb = 128, int threads = 0, int repeat = 5);
+
+    /**
+     * @brief Run the single-threaded and multithreaded passes
+     * @return Results for every kernel and thread count
+     */
+    std::vector<BandwidthResult> run();
+
+    /**
+     * @brief Number of NUMA nodes the threads were spread over
+     */
+    int get_numa_nodes() const;
+
+    /**
+     * @brief Highest bandwidth measured for a kernel
+     * @param results Results from run()
+     * @param kernel Kernel name
+     * @return Bandwidth in GB/s (0 if not measured)
+     */
+    static double best(const std::vector<BandwidthResult>& results, const std::string& kernel);
+};
+
+#endif // BANDWIDTH_PROBE_H
@@ -0,0 +1,102 @@
+#ifndef CHAT_BENCHMARK_H
+#define CHAT_BENCHMARK_H
+
+#include "api_client.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief One scripted conversation: a system prompt and the user's turns
+ */
+struct ChatScript {
+    std::string name;
+    std::string system;
+    std::vector<std::string> turns;
+};
+
+/**
+ * @brief Prefill of one turn in one reuse mode
+ */
+struct ChatTurnResult {
+    std::string model_name;
+    std::string conversation;
+    int turn;                  // 1-based
+    std::string mode;          // "cold", "chat" or "context"
+    int prompt_tokens;         // Tokens the server evaluated for this turn
+    double prefill_seconds;    // prompt_eval_duration
+    double wall_seconds;       // Client-side time of the whole turn
+    int output_tokens;
+};
+
+/**
+ * @brief Measures how much KV-cache reuse saves on multi-turn conversations
+ *
+ * Every conversation is played three times against the same loaded model:
+ *
+ * - chat: /api/chat with the whole history each turn. The server keeps
+ *   the KV cache of the previous turn and only evaluates what is new.
+ * - context: /api/generate with only the new turn and the context array
+ *   the previous response returned.
+ * - cold: /api/chat with the history of the chat run, but the system
+ *   prompt starts with a different session tag every turn, so nothing
+ *   can be reused and the whole history is evaluated again.
+ *
+ * Each run starts with its own session tag so the runs cannot share a
+ * cached prefix. Replies use a fixed seed, temperature 0 and a fixed
+ * length.
+ */
+class ChatBenchmark {
+private:
+    int reply_tokens;
+    unsigned session;          // Tag that makes a run's prompts unique
+
+    std::string tagged(const std::string& system);
+
+public:
+    /**
+     * @brief Constructor
+     * @param reply_length Tokens generated per turn
+     */
+    explicit ChatBenchmark(int reply_length = 64);
+
+    /**
+     * @brief Built-in assistant conversation used without a script file
+     */
+    static std::vector<ChatScript> default_scripts();
+
+    /**
+     * @brief Read conversations from a JSON file
+     *
+     * The file holds one object or an array of objects with "name",
+     * "system" and "turns" (an array of user messages).
+     *
+     * @param path Script file
+     * @param scripts Receives the conversations
+     * @return false if the file cannot be read or has no turns
+     */
+    static bool load_scripts(const std::string& path, std::vector<ChatScript>& scripts);
+
+    /**
+     * @brief Play every conversation in every mode against one model
+     * @param api Ollama client
+     * @param model Model name
+     * @param scripts Conversations
+     * @return One result per turn and mode
+     */
+    std::vector<ChatTurnResult> run(OllamaAPI& api, const std::string& model, const std::vector<ChatScript>& scripts);
+
+    /**
+     * @brief Print prefill per turn side by side for the three modes
+     */
+    static void print(const std::vector<ChatTurnResult>& results);
+
+    /**
+     * @brief Results as a JSON array
+     */
+    static json to_json(const std::vector<ChatTurnResult>& results);
+};
+
+#endif // CHAT_BENCHMARK_H
@@ -0,0 +1,94 @@
+#ifndef DECODE_SWEEP_H
+#define DECODE_SWEEP_H
+
+#include "inference_backend.h"
+#include "tokenizer.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Streamed decode of one output length
+ */
+struct DecodePoint {
+    std::string model_name;
+    int num_predict;                    // Requested output length
+    int tokens;                         // Tokens generated (fewer if the model stopped early)
+    double decode_seconds;              // eval_duration
+    double ttft_seconds;                // Arrival of the first token
+    std::vector<double> latencies_ms;   // Gap before each token from the second one on
+    unsigned long peak_memory_kb;       // Peak RSS of the process running the model
+
+    /**
+     * @brief Decode throughput in tokens per second
+     */
+    double decode_rate() const;
+
+    /**
+     * @brief Mean gap between tokens at 1-based positions first..last
+     * @return Milliseconds per token, or 0 if no token in the range arrived
+     */
+    double mean_latency_ms(int first, int last) const;
+};
+
+/**
+ * @brief Measures how decode slows down as the KV cache grows
+ *
+ * The same prompt is run with num_predict growing geometrically, a fixed
+ * seed and no stop sequences. Responses are streamed so the arrival time
+ * of every token is known. Each token attends to all the positions before
+ * it, so the gap between tokens widens with position. Memory of the
+ * process running the model is sampled during each request to show how
+ * much the cache and sampler add as the answer grows.
+ */
+class DecodeSweep {
+private:
+    int min_tokens;
+    int max_tokens;
+    double factor;
+
+public:
+    /**
+     * @brief Constructor
+     * @param min_length Shortest output in tokens
+     * @param max_length Longest output in tokens (capped by the context)
+     * @param growth Ratio between consecutive lengths
+     */
+    DecodeSweep(int min_length = 16, int max_length = 2048, double growth = 2.0);
+
+    /**
+     * @brief Output lengths the sweep will use
+     * @param room Tokens of context left after the prompt
+     */
+    std::vector<int> lengths(int room) const;
+
+    /**
+     * @brief Run every length against one model
+     * @param backend Backend to stream from
+     * @param model Model name
+     * @param tokenizer The model's tokenizer, to size the prompt (may be nullptr)
+     * @param context_length Context every request runs with
+     * @return One point per length, in increasing order
+     */
+    std::vector<DecodePoint> run(InferenceBackend& backend, const std::string& model,
+                                 const Tokenizer* tokenizer, int context_length);
+
+    /**
+     * @brief Prompt used for every request; asks for an answer longer than any length
+     */
+    static const std::string& prompt();
+
+    /**
+     * @brief Print the per-length table and the latency by position of each model's longest run
+     */
+    static void print(const std::vector<DecodePoint>& points);
+
+    /**
+     * @brief Points as a JSON array, with per-token latencies
+     */
+    static json to_json(const std::vector<DecodePoint>& points);
+};
+
+#endif // DECODE_SWEEP_H
@@ -0,0 +1,97 @@
+#ifndef DEVICE_PROFILE_H
+#define DEVICE_PROFILE_H
+
+#include <nlohmann/json.hpp>
+#include <map>
+#include <string>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Request options found best for one model on one backend
+ */
+struct TunedSettings {
+    std::string objective;      // "decode" or "ttft"
+    json options;               // num_thread, num_batch and num_ctx as sent in the request
+    double decode_tps = 0.0;    // Decode rate of the winning probe
+    double ttft_seconds = 0.0;  // Prefill plus first token of the winning probe
+    std::string tuned_at;       // Local time of the tuning run
+};
+
+/**
+ * @brief Tuned runtime settings of this device, kept in a JSON file
+ *
+ * The file records which machine it was tuned on (hostname, CPU model,
+ * CPU count and RAM) and, for each model and backend, the options the
+ * autotuner picked. By default it lives in
+ * $XDG_CONFIG_HOME/edge_ai_benchmark/<hostname>.json (~/.config when
+ * XDG_CONFIG_HOME is unset), so every device keeps its own profile.
+ */
+class DeviceProfile {
+private:
+    std::string path;
+    json device;                // Identity of the machine the file was tuned on
+    std::map<std::string, std::map<std::string, TunedSettings>> models; // Model -> backend -> settings
+
+public:
+    /**
+     * @brief Constructor
+     * @param file Profile path (empty for the default path of this device)
+     */
+    explicit DeviceProfile(const std::string& file = "");
+
+    /**
+     * @brief Default profile path of this device
+     */
+    static std::string default_path();
+
+    /**
+     * @brief Hostname, CPU model, online CPUs and total RAM of this machine
+     */
+    static json identify();
+
+    /**
+     * @brief Read the profile file
+     * @return false if the file does not exist or is not a profile
+     */
+    bool load();
+
+    /**
+     * @brief Write the profile, creating its directory if needed
+     * @return false if the file cannot be written
+     */
+    bool save();
+
+    /**
+     * @brief Whether the profile was tuned on this machine
+     */
+    bool matches_device() const;
+
+    /**
+     * @brief Settings of a model on a backend
+     * @return nullptr if the model was not tuned on that backend
+     */
+    const TunedSettings* get(const std::string& model, const std::string& backend) const;
+
+    /**
+     * @brief Record the settings of a model on a backend, replacing earlier ones
+     */
+    void set(const std::string& model, const std::string& backend, const TunedSettings& settings);
+
+    /**
+     * @brief Number of tuned model and backend pairs
+     */
+    size_t size() const;
+
+    /**
+     * @brief Path of the profile file
+     */
+    const std::string& get_path() const;
+
+    /**
+     * @brief Identity of the machine the profile was tuned on
+     */
+    const json& get_device() const;
+};
+
+#endif // DEVICE_PROFILE_H
@@ -0,0 +1,131 @@
+#ifndef EMBED_BENCHMARK_H
+#define EMBED_BENCHMARK_H
+
+#include "api_client.h"
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Embedding throughput of one model at one batch size and concurrency
+ */
+struct EmbedRun {
+    std::string model_name;
+    int batch_size;             // Documents per request
+    int concurrency;            // Requests in flight
+    int documents;              // Documents embedded successfully
+    int requests;
+    int failed;                 // Requests that returned an error
+    long long tokens;           // Input tokens the server reported
+    int dimensions;             // Length of one embedding
+    double wall_seconds;        // First request sent to last response received
+    std::vector<double> latencies; // Client-side request latency in seconds, sorted
+    unsigned long peak_memory;  // Peak server RSS in KB
+    unsigned long peak_pss;     // Peak server PSS in KB
+    std::string error;          // First error message
+
+    double docs_per_second() const;
+    double tokens_per_second() const;
+
+    /**
+     * @brief Request latency at a percentile
+     * @param pct Percentile (0-100)
+     * @return Latency in seconds (nearest rank), or 0 without requests
+     */
+    double latency_percentile(double pct) const;
+};
+
+/**
+ * @brief Measures /api/embed throughput over a corpus with client-side batching
+ *
+ * The corpus file is memory-mapped and every non-empty line is one
+ * document, so large corpora are not copied into the process up front.
+ * For every model, batch size and concurrency, the documents are split
+ * into batches that worker threads send as single embed requests, each
+ * worker taking the next batch when its previous one returns. The server
+ * is sampled by MemoryMonitor meanwhile. One warm-up request loads the
+ * model first so the load time is not counted against the first setting.
+ */
+class EmbedBenchmark {
+private:
+    OllamaAPI api;
+    std::string corpus_file;
+    std::string output_file;
+    std::vector<std::string> models;
+    std::vector<int> batch_sizes;
+    std::vector<int> concurrencies;
+    size_t max_documents;       // 0 for the whole corpus
+    void* mapping;
+    size_t mapping_size;
+    std::vector<std::string_view> documents; // Lines of the mapped corpus
+
+    /**
+     * @brief Map the corpus and index its lines
+     * @return false if the file cannot be mapped or has no documents
+     */
+    bool map_corpus();
+
+    void unmap_corpus();
+
+    /**
+     * @brief Embed the corpus once at one batch size and concurrency
+     */
+    EmbedRun measure(const std::string& model, int batch_size, int concurrency);
+
+public:
+    /**
+     * @brief Constructor
+     * @param corpus_path Corpus file, one document per line
+     * @param output_path Path for JSON results (empty for none)
+     * @param use_memory_mapping Whether the server should load models with mmap
+     */
+    EmbedBenchmark(const std::string& corpus_path, const std::string& output_path,
+                   bool use_memory_mapping = false);
+
+    ~EmbedBenchmark();
+
+    /**
+     * @brief Add an embedding model to benchmark
+     * @param model_name Name of the model
+     */
+    void add_model(const std::string& model_name);
+
+    /**
+     * @brief Set the batch sizes to try
+     * @param sizes Documents per request (default 16)
+     */
+    void set_batch_sizes(const std::vector<int>& sizes);
+
+    /**
+     * @brief Set the numbers of concurrent requests to try
+     * @param levels Requests in flight (default 1)
+     */
+    void set_concurrency(const std::vector<int>& levels);
+
+    /**
+     * @brief Embed only the first documents of the corpus
+     * @param count Documents to use (0 for all)
+     */
+    void set_max_documents(size_t count);
+
+    /**
+     * @brief Run every model at every batch size and concurrency and report
+     */
+    void run();
+
+    /**
+     * @brief Print documents/s, tokens/s, latency percentiles and memory per setting
+     */
+    static void print(const std::vector<EmbedRun>& runs);
+
+    /**
+     * @brief Runs as a JSON array
+     */
+    static json to_json(const std::vector<EmbedRun>& runs);
+};
+
+#endif // EMBED_BENCHMARK_H
@@ -0,0 +1,109 @@
+#ifndef GGUF_BACKEND_H
+#define GGUF_BACKEND_H
+
+#include "inference_backend.h"
+#include "gguf_file.h"
+#include "tokenizer.h"
+#include "llama_model.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <random>
+
+/**
+ * @brief In-process CPU inference on GGUF files, without the Ollama server
+ *
+ * Models are named as Ollama names them ("tinyllama:latest"), resolved to
+ * weight blobs through the manifests in the models directory, or given as
+ * a path to a .gguf file. The prompt is tokenized and run as-is (no chat
+ * template), decode uses the same temperature as the HTTP path unless the
+ * request options say otherwise, and the
+ * timing fields match what Ollama reports. One model is kept loaded;
+ * requests are serialized.
+ */
+class GgufBackend : public InferenceBackend {
+private:
+    std::string models_dir;
+    int threads;
+    int context_length;
+    int max_tokens;
+
+    std::mutex mtx;
+    std::string loaded_model;
+    int loaded_threads;        // Threads and context the loaded model was built with
+    int loaded_context;
+    std::unique_ptr<GgufFile> file;
+    std::unique_ptr<Tokenizer> tokenizer;
+    std::unique_ptr<LlamaModel> model;
+    std::mt19937 rng;
+
+    /**
+     * @brief Map a model name or path to a GGUF file
+     * @return Path, empty if the model is not found
+     */
+    std::string resolve(const std::string& name) const;
+
+    /**
+     * @brief Load a model unless it is already loaded with the same threads and context
+     * @param name Model name or path
+     * @param load_seconds Receives the time spent loading (0 if it was loaded)
+     * @param worker_threads Decode threads (0 for all CPUs)
+     * @param context KV cache length in tokens
+     */
+    bool ensure_loaded(const std::string& name, double& load_seconds, int worker_threads, int context);
+
+    /**
+     * @brief Pick the next token (greedy when temperature is 0)
+     */
+    int sample(const float* logits, int vocab, float temperature, int top_k);
+
+public:
+    /**
+     * @brief Constructor
+     * @param dir Ollama models directory (empty for $OLLAMA_MODELS or ~/.ollama/models)
+     * @param worker_threads Decode threads (0 for all CPUs)
+     * @param context KV cache length in tokens
+     * @param max_new_tokens Generation limit per request
+     */
+    explicit GgufBackend(const std::string& dir = "", int worker_threads = 0,
+                         int context = 2048, int max_new_tokens = 256);
+
+    std::string name() const override;
+
+    /**
+     * @brief Models with a manifest in the models directory
+     */
+    std::vector<std::string> list_models() override;
+
+    /**
+     * @brief Size, architecture and file type read from each model's GGUF header
+     */
+    std::vector<ModelInfo> list_model_info() override;
+
+    /**
+     * @brief Requested context, one token per step, F32 KV cache
+     */
+    RuntimeConfig runtime_config() const override;
+
+    /**
+     * @brief Run a prompt in this process
+     *
+     * Honours num_predict (-1 for up to the context), temperature, top_k,
+     * seed and ignore_eos (keep generating past end-of-generation tokens,
+     * as in llama.cpp) from options. num_thread and num_ctx override the constructor's
+     * values and reload the model when they change, as they do in Ollama.
+     */
+    std::string generate(
+        const std::string& model,
+        const std::string& prompt,
+        bool stream = false,
+        bool verbose = false,
+        GenerationMetrics* metrics = nullptr,
+        const json* options = nullptr
+    ) override;
+
+    bool unload_model(const std::string& model) override;
+};
+
+#endif // GGUF_BACKEND_H
@@ -0,0 +1,150 @@
+#ifndef GGUF_FILE_H
+#define GGUF_FILE_H
+
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+/**
+ * @brief ggml tensor types as numbered in the GGUF format
+ */
+enum class GgmlType : uint32_t {
+    F32 = 0, F16 = 1, Q4_0 = 2, Q4_1 = 3, Q5_0 = 6, Q5_1 = 7, Q8_0 = 8, Q8_1 = 9,
+    Q2_K = 10, Q3_K = 11, Q4_K = 12, Q5_K = 13, Q6_K = 14, Q8_K = 15,
+    IQ2_XXS = 16, IQ2_XS = 17, IQ3_XXS = 18, IQ1_S = 19, IQ4_NL = 20, IQ3_S = 21, IQ2_S = 22, IQ4_XS = 23,
+    I8 = 24, I16 = 25, I32 = 26, I64 = 27, F64 = 28, IQ1_M = 29, BF16 = 30
+};
+
+/**
+ * @brief One tensor of a GGUF file, pointing into the mapping
+ */
+struct GgufTensor {
+    std::string name;
+    GgmlType type;
+    std::vector<uint64_t> dims;  // dims[0] is the contiguous (row) dimension
+    uint64_t offset;             // Relative to the start of the data section
+    const uint8_t* data;         // Start of the tensor in the mapping
+    size_t bytes;
+
+    /**
+     * @brief Number of elements
+     */
+    uint64_t elements() const;
+};
+
+/**
+ * @brief Read-only view of a GGUF model file
+ *
+ * The file is mapped with mmap, so tensors are used in place and pages
+ * are only read when touched. Metadata values are converted to JSON
+ * (arrays included), which keeps lookups simple for the few keys a
+ * backend needs.
+ */
+class GgufFile {
+private:
+    std::string path;
+    int fd;
+    uint8_t* base;
+    size_t file_size;
+    uint32_t version;
+    size_t alignment;
+    size_t data_offset;
+    bool skip_arrays;
+    json metadata;
+    std::vector<GgufTensor> tensors;
+    std::unordered_map<std::string, size_t> tensor_index;
+
+    bool parse();
+
+public:
+    GgufFile();
+    ~GgufFile();
+
+    GgufFile(const GgufFile&) = delete;
+    GgufFile& operator=(const GgufFile&) = delete;
+
+    /**
+     * @brief Map and parse a file
+     * @param file_path Path to a .gguf file (or an Ollama model blob)
+     * @param metadata_only Step over array values (vocabulary, merges) and
+     *        leave them null; scalar keys and the tensor index are still read
+     * @return false if the file is missing, truncated or not GGUF
+     */
+    bool open(const std::string& file_path, bool metadata_only = false);
+
+    /**
+     * @brief Fault in every page of the tensor data
+     *
+     * Without this the first tokens pay for page faults and the load time
+     * only covers parsing.
+     * @return Bytes touched
+     */
+    size_t prefetch() const;
+
+    /**
+     * @brief Unmap the file
+     */
+    void close();
+
+    /**
+     * @brief Whether a file is mapped
+     */
+    bool is_open() const;
+
+    const std::string& get_path() const;
+    size_t get_file_size() const;
+    uint32_t get_version() const;
+
+    /**
+     * @brief All metadata key/value pairs
+     */
+    const json& get_metadata() const;
+
+    /**
+     * @brief Metadata lookups with a fallback for missing or mistyped keys
+     */
+    std::string get_string(const std::string& key, const std::string& fallback = "") const;
+    long long get_int(const std::string& key, long long fallback = 0) const;
+    double get_float(const std::string& key, double fallback = 0.0) const;
+
+    /**
+     * @brief Metadata key of the model architecture (e.g. "llama.block_count")
+     * @param suffix Key without the architecture prefix
+     */
+    std::string arch_key(const std::string& suffix) const;
+
+    /**
+     * @brief All tensors in file order
+     */
+    const std::vector<GgufTensor>& get_tensors() const;
+
+    /**
+     * @brief Look up a tensor by name
+     * @return Tensor, or nullptr if the file has no such tensor
+     */
+    const GgufTensor* find_tensor(const std::string& name) const;
+
+    /**
+     * @brief Name of a tensor type ("Q4_0", "Q6_K", ...)
+     */
+    static std::string type_name(GgmlType type);
+
+    /**
+     * @brief Name of a general.file_type value (e.g. 15 -> "Q4_K_M")
+     * @return Empty for unknown values
+     */
+    static std::string file_type_name(long long file_type);
+
+    /**
+     * @brief Elements per block and bytes per block of a tensor type
+     * @return false for unknown types
+     */
+    static bool type_layout(GgmlType type, size_t& block_elements, size_t& block_bytes);
+};
+
+#endif // GGUF_FILE_H
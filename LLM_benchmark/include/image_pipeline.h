@@ -0,0 +1,174 @@
+#ifndef IMAGE_PIPELINE_H
+#define IMAGE_PIPELINE_H
+
+#include "image_utils.h"
+#include <nlohmann/json.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Turns an encoded image file into pixels so the pipeline can resize it
+ */
+class ImageDecoder {
+public:
+    virtual ~ImageDecoder() = default;
+
+    /**
+     * @brief Short name for reports
+     */
+    virtual std::string name() const = 0;
+
+    /**
+     * @brief Whether the file looks like this decoder's format
+     * @param header First bytes of the file (at least 16 when the file is that long)
+     */
+    virtual bool accepts(const std::string& header) const = 0;
+
+    /**
+     * @brief Decode a whole file
+     * @return false if the data is not a supported image
+     */
+    virtual bool decode(const std::string& data, RgbImage& image) const = 0;
+};
+
+/**
+ * @brief Binary 8-bit PPM (P6)
+ */
+class PpmDecoder : public ImageDecoder {
+public:
+    std::string name() const override;
+    bool accepts(const std::string& header) const override;
+    bool decode(const std::string& data, RgbImage& image) const override;
+};
+
+/**
+ * @brief One payload to prepare
+ */
+struct ImageJob {
+    std::string name;           // Label for reports
+    std::string path;           // Source file (empty for the generated pattern)
+    int size;                   // Longest side to scale to, 0 to send the file as it is
+};
+
+/**
+ * @brief A base64 image ready to go into a request
+ */
+struct ImagePayload {
+    std::string name;
+    bool native;                // The file as it is (false: scaled)
+    int width;
+    int height;
+    size_t encoded_bytes;       // Image file size before base64
+    std::string base64;
+    bool cached;                // Read from the payload cache
+    bool ok;
+    std::string error;
+};
+
+/**
+ * @brief Where the preprocessing time went
+ *
+ * Stage times are summed over the workers (CPU time); the wall time is
+ * the whole prepare() call.
+ */
+struct PreprocessStats {
+    int jobs = 0;
+    int cache_hits = 0;
+    int threads = 0;
+    std::string isa;            // Instruction set of the base64 encoder
+    double wall_seconds = 0.0;
+    double read_seconds = 0.0;
+    double decode_seconds = 0.0;
+    double resize_seconds = 0.0;
+    double png_seconds = 0.0;
+    double base64_seconds = 0.0;
+    double hash_seconds = 0.0;
+    double cache_seconds = 0.0; // Cache reads and writes
+    size_t base64_bytes = 0;    // Payload produced, cached or not
+    double base64_scalar_mbps = 0.0; // Encoder microbenchmark, input MB/s
+    double base64_simd_mbps = 0.0;
+};
+
+/**
+ * @brief Prepares image payloads before any request is timed
+ *
+ * Jobs are spread over a pool of worker threads, each taking the next job
+ * when it finishes one. A native job is the file as it is (base64 only,
+ * after conversion to PNG if the server cannot take the format); a scaled
+ * job is decoded by the first decoder that accepts the file, resized so
+ * its longest side has the requested size, and written as PNG. A job
+ * without a path uses a generated test pattern of the requested size.
+ *
+ * Payloads are cached on disk under the SHA-256 of the source bytes and
+ * the job's target, so later runs skip the image work entirely; changing
+ * an image changes its key. The stage is timed per step so its own cost
+ * can be reported.
+ */
+class ImagePipeline {
+private:
+    int threads;
+    std::string cache_dir;      // Empty disables the cache
+    std::vector<std::unique_ptr<ImageDecoder>> decoders;
+    PreprocessStats last_stats;
+
+    /**
+     * @brief Decoder that accepts a file, or nullptr
+     */
+    const ImageDecoder* find_decoder(const std::string& data) const;
+
+    /**
+     * @brief Prepare one job, adding its stage times to stats
+     */
+    ImagePayload prepare_one(const ImageJob& job, PreprocessStats& stats) const;
+
+    bool read_cache(const std::string& key, ImagePayload& payload) const;
+    void write_cache(const std::string& key, const ImagePayload& payload) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param worker_threads Workers (0 for every allowed CPU)
+     * @param cache_path Payload cache directory ("" for the default, "-" to disable)
+     */
+    explicit ImagePipeline(int worker_threads = 0, const std::string& cache_path = "");
+
+    /**
+     * @brief $XDG_CACHE_HOME/edge_ai_benchmark/images (or ~/.cache/...)
+     */
+    static std::string default_cache_dir();
+
+    /**
+     * @brief Add a decoder for the resolution sweep (tried after the built-in PPM decoder)
+     */
+    void add_decoder(std::unique_ptr<ImageDecoder> decoder);
+
+    /**
+     * @brief Whether a file can be decoded, so it can be scaled
+     */
+    bool can_decode(const std::string& path) const;
+
+    /**
+     * @brief Prepare every job on the worker pool
+     * @return One payload per job, in job order
+     */
+    std::vector<ImagePayload> prepare(const std::vector<ImageJob>& jobs);
+
+    /**
+     * @brief Stage times of the last prepare() call, with the base64 encoder benchmark
+     */
+    const PreprocessStats& stats() const;
+
+    const std::string& get_cache_dir() const;
+
+    /**
+     * @brief Print the stage breakdown
+     */
+    static void print(const PreprocessStats& stats);
+
+    static json to_json(const PreprocessStats& stats);
+};
+
+#endif // IMAGE_PIPELINE_H
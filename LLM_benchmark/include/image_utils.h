@@ -0,0 +1,89 @@
+#ifndef IMAGE_UTILS_H
+#define IMAGE_UTILS_H
+
+#include "quant_kernels.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief 8-bit RGB image, rows top to bottom, three bytes per pixel
+ */
+struct RgbImage {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+/**
+ * @brief Read a whole file into memory
+ * @param path File path
+ * @param data Receives the file contents
+ * @return false if the file cannot be read
+ */
+bool read_binary_file(const std::string& path, std::string& data);
+
+/**
+ * @brief Width and height from the header of a PNG, JPEG or PPM file
+ * @param data Encoded file contents
+ * @param width Receives the width in pixels
+ * @param height Receives the height in pixels
+ * @return false if the format is not recognised
+ */
+bool image_dimensions(const std::string& data, int& width, int& height);
+
+/**
+ * @brief Decode a binary PPM (P6) image
+ * @param data File contents
+ * @param image Receives the pixels (scaled to 8 bits if maxval is not 255)
+ * @return false if the data is not an 8-bit P6 image
+ */
+bool decode_ppm(const std::string& data, RgbImage& image);
+
+/**
+ * @brief Bilinear resize
+ * @param image Source image
+ * @param width Target width
+ * @param height Target height
+ * @return Resized image
+ */
+RgbImage resize_image(const RgbImage& image, int width, int height);
+
+/**
+ * @brief Synthetic image with gradients, edges and a checkerboard
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param seed Shifts the pattern so repeated images differ
+ * @return Generated image
+ */
+RgbImage test_pattern(int width, int height, unsigned seed = 0);
+
+/**
+ * @brief Encode as PNG with uncompressed (stored) deflate blocks
+ *
+ * No zlib needed; the file is larger than a compressed PNG but decodes
+ * the same, and the vision encoder only sees the pixels.
+ *
+ * @param image Image to encode
+ * @return PNG file contents
+ */
+std::string encode_png(const RgbImage& image);
+
+/**
+ * @brief Standard base64 with padding, as the Ollama "images" field expects
+ *
+ * SSSE3 and NEON versions encode 12 and 48 input bytes per step with a
+ * shuffle and a table lookup instead of one table read per output byte;
+ * the tail is encoded by the scalar code.
+ *
+ * @param data Bytes to encode
+ * @param isa Instruction set to use (AVX2 uses the SSSE3 code; unsupported sets fall back to scalar)
+ * @return Encoded text
+ */
+std::string base64_encode(const std::string& data, KernelIsa isa);
+
+/**
+ * @brief base64_encode with the best instruction set this CPU supports
+ */
+std::string base64_encode(const std::string& data);
+
+#endif // IMAGE_UTILS_H
@@ -0,0 +1,119 @@
+#ifndef INFERENCE_BACKEND_H
+#define INFERENCE_BACKEND_H
+
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Timing and token counts reported by the backend for one request
+ *
+ * Durations are converted from the nanoseconds Ollama reports to seconds.
+ */
+struct GenerationMetrics {
+    int prompt_eval_count = 0;          // Prompt tokens evaluated (prefill)
+    int eval_count = 0;                 // Generated tokens (decode)
+    double total_duration = 0.0;        // Server-side total time in seconds
+    double load_duration = 0.0;         // Model load time in seconds
+    double prompt_eval_duration = 0.0;  // Prefill time in seconds
+    double eval_duration = 0.0;         // Decode time in seconds
+    double wall_time = 0.0;             // Client-side request time in seconds
+    std::vector<double> token_times;    // Streamed requests: arrival of each token, seconds from the request start
+
+    /**
+     * @brief Decode throughput
+     * @return Generated tokens per second, or 0 if not reported
+     */
+    double decode_rate() const;
+
+    /**
+     * @brief Prefill throughput
+     * @return Prompt tokens per second, or 0 if not reported
+     */
+    double prefill_rate() const;
+};
+
+/**
+ * @brief Model description from /api/tags (or from the GGUF file)
+ */
+struct ModelInfo {
+    std::string name;
+    unsigned long long size = 0;     // Bytes on disk (weights plus metadata layers)
+    std::string family;
+    std::string parameter_size;      // e.g. "7B"
+    std::string quantization_level;  // e.g. "Q4_0"
+};
+
+/**
+ * @brief How a backend sizes its per-model buffers
+ */
+struct RuntimeConfig {
+    int context_length = 2048;  // KV cache length requested (capped by the model's trained context)
+    int batch_size = 512;       // Tokens per prefill step
+    int kv_element_bytes = 2;   // Bytes per cached K or V element (2 for F16, 4 for F32)
+};
+
+/**
+ * @brief Something that can run a prompt through a model
+ *
+ * OllamaAPI sends requests to the server; GgufBackend runs the model in
+ * this process. Both fill the same GenerationMetrics so results compare
+ * directly and the difference is server and HTTP overhead.
+ */
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+
+    /**
+     * @brief Short name for reports ("ollama", "gguf")
+     */
+    virtual std::string name() const = 0;
+
+    /**
+     * @brief Get list of available models
+     * @return Vector of model names
+     */
+    virtual std::vector<std::string> list_models() = 0;
+
+    /**
+     * @brief Get size and quantization of every available model
+     * @return Model descriptions
+     */
+    virtual std::vector<ModelInfo> list_model_info() = 0;
+
+    /**
+     * @brief Context, batch and KV cache precision a loaded model will use
+     */
+    virtual RuntimeConfig runtime_config() const = 0;
+
+    /**
+     * @brief Generate text from a model
+     * @param model The model name
+     * @param prompt The input prompt
+     * @param stream Receive tokens one at a time and fill GenerationMetrics::token_times
+     * @param verbose Whether to print verbose information
+     * @param metrics Optional output for timing metrics
+     * @param options Optional request options in Ollama's naming (num_predict,
+     *        num_ctx, temperature, top_k, seed, ...) that override the defaults
+     * @return The model's response, or a message starting with "Error:"
+     */
+    virtual std::string generate(
+        const std::string& model,
+        const std::string& prompt,
+        bool stream = false,
+        bool verbose = false,
+        GenerationMetrics* metrics = nullptr,
+        const json* options = nullptr
+    ) = 0;
+
+    /**
+     * @brief Release a model's memory
+     * @param model The model name
+     * @return true if the model was unloaded
+     */
+    virtual bool unload_model(const std::string& model) = 0;
+};
+
+#endif // INFERENCE_BACKEND_H
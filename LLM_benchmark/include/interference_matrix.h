@@ -0,0 +1,104 @@
+#ifndef INTERFERENCE_MATRIX_H
+#define INTERFERENCE_MATRIX_H
+
+#include "api_client.h"
+#include "system_utils.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief One model measured alone or while another model generates
+ */
+struct InterferenceCell {
+    std::string victim;         // Model being measured
+    std::string load;           // Model generating in the background (empty when alone)
+    bool ok;
+    double decode_rate;         // Median decode tokens/s of the victim
+    double ttft_seconds;        // Median time to the first streamed token
+    double decode_slowdown;     // Alone rate / rate under load (1.0 alone, higher is slower)
+    double ttft_slowdown;       // TTFT under load / TTFT alone
+    int load_requests;          // Background requests completed meanwhile
+    double load_decode_rate;    // Decode tokens/s of those background requests
+    bool reloaded;              // A victim request had to load its model again
+    unsigned long peak_memory;  // Peak server RSS in KB
+    SwapActivity swap;          // Swap activity over the whole measurement
+    std::string error;
+};
+
+/**
+ * @brief Measures how much each model slows down while another one runs
+ *
+ * Every model is first measured alone. Then, for every ordered pair, the
+ * second model generates back to back in a background thread while the
+ * first one streams its requests, so the pair (A, B) is A under load from
+ * B. Each victim request is repeated and the medians are kept. The server
+ * memory and swap counters are sampled over each measurement. Both models
+ * have to stay loaded at once (OLLAMA_MAX_LOADED_MODELS) and the server
+ * has to accept parallel requests; a victim request that reports a model
+ * load is flagged, since the server evicted a model to fit the other.
+ */
+class InterferenceMatrix {
+private:
+    OllamaAPI api;
+    std::string prompt_file;
+    std::string output_file;
+    std::vector<std::string> models;
+    int num_predict;
+    int repeats;
+    unsigned session;           // Tag that makes every victim prompt unique
+
+    /**
+     * @brief Measure a victim, with another model generating in the background unless load is empty
+     */
+    InterferenceCell measure(const std::string& victim, const std::string& load, const std::string& prompt);
+
+public:
+    /**
+     * @brief Constructor
+     * @param prompt_path Path to the prompt file
+     * @param output_path Path for JSON results (empty for none)
+     * @param use_memory_mapping Whether the server should load models with mmap
+     */
+    InterferenceMatrix(const std::string& prompt_path, const std::string& output_path,
+                       bool use_memory_mapping = false);
+
+    ~InterferenceMatrix();
+
+    /**
+     * @brief Add a model to the matrix
+     * @param model_name Name of the model
+     */
+    void add_model(const std::string& model_name);
+
+    /**
+     * @brief Set the output token limit of every request
+     * @param tokens num_predict (default 128)
+     */
+    void set_num_predict(int tokens);
+
+    /**
+     * @brief Set how many victim requests each cell takes the median of
+     * @param count Requests per cell (default 3)
+     */
+    void set_repeats(int count);
+
+    /**
+     * @brief Measure every model alone and under every other model, and report
+     */
+    void run();
+
+    /**
+     * @brief Print the decode and TTFT slowdown matrices and the per-pair memory and swap table
+     */
+    static void print(const std::vector<std::string>& models, const std::vector<InterferenceCell>& cells);
+
+    /**
+     * @brief Cells as a JSON array
+     */
+    static json to_json(const std::vector<InterferenceCell>& cells);
+};
+
+#endif // INTERFERENCE_MATRIX_H
@@ -0,0 +1,129 @@
+#ifndef JSON_STREAM_VALIDATOR_H
+#define JSON_STREAM_VALIDATOR_H
+
+#include <nlohmann/json.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Incremental JSON syntax checker fed one chunk at a time
+ *
+ * A generation is checked while it streams: every piece is pushed as it
+ * arrives, and the first byte that cannot continue a JSON document is
+ * reported with its offset, without waiting for (or buffering) the whole
+ * response. Exactly one top-level value is accepted, surrounded by
+ * optional whitespace. Strings are checked for escapes and control
+ * characters, for well-formed UTF-8 (no overlong forms, encoded
+ * surrogates or code points past U+10FFFF) and for \u escapes that pair
+ * every high surrogate with a low one, as a conforming parser requires.
+ */
+class JsonStreamValidator {
+public:
+    enum class Status {
+        Incomplete,     // Valid so far, the document is not finished
+        Complete,       // One whole value, nothing but whitespace after it
+        Invalid         // A byte that cannot continue the document
+    };
+
+private:
+    // What the next structural token may be
+    enum class Expect { Value, FirstValueOrEnd, FirstKeyOrEnd, Key, Colon, CommaOrEnd, Done };
+    // Lexical state inside a scalar
+    enum class Lex { None, String, Escape, Unicode, Number, Literal };
+    // Position inside a number: after the sign, a leading zero, integer digits, '.', fraction, 'e', exponent sign, exponent
+    enum class Num { Sign, Zero, Int, Point, Frac, Exp, ExpSign, ExpDigits };
+
+    Status state;
+    Expect expect;
+    Lex lex;
+    Num num;
+    std::vector<char> stack;    // '{' or '[' for every open container
+    bool string_is_key;
+    int unicode_left;           // Hex digits still expected after \u
+    unsigned unicode_value;     // Code unit of the \u escape being read
+    bool low_surrogate_next;    // A high surrogate was read; "\u" and a low one must follow
+    int utf8_left;              // Continuation bytes still expected in a multi-byte sequence
+    unsigned char utf8_low;     // Allowed range of the next continuation byte
+    unsigned char utf8_high;
+    std::string literal;        // Rest of true/false/null still expected
+    size_t offset;              // Bytes consumed
+    size_t max_depth;
+    std::string message;
+
+    /**
+     * @brief Consume one byte
+     */
+    void push(char c);
+
+    /**
+     * @brief A scalar or container closed: move to what may follow it
+     */
+    void value_done();
+
+    /**
+     * @brief Check a string byte that is not ASCII
+     */
+    void push_utf8(unsigned char byte);
+
+    /**
+     * @brief A \u escape is complete: check its surrogate pairing
+     */
+    void unicode_done();
+
+    void fail(const std::string& reason);
+
+public:
+    JsonStreamValidator();
+
+    /**
+     * @brief Forget everything and expect a new document
+     */
+    void reset();
+
+    /**
+     * @brief Check the next piece of the document
+     * @return Status after the piece
+     */
+    Status feed(const std::string& chunk);
+
+    /**
+     * @brief Mark the end of input (a trailing top-level number ends here)
+     * @return Complete, or Invalid if the document was cut short
+     */
+    Status finish();
+
+    Status status() const;
+
+    /**
+     * @brief Offset of the first bad byte (or of the end of input if cut short)
+     */
+    size_t error_offset() const;
+
+    /**
+     * @brief Why the document is invalid (empty while it is valid)
+     */
+    const std::string& error() const;
+
+    /**
+     * @brief Deepest nesting of objects and arrays seen
+     */
+    size_t depth() const;
+
+    /**
+     * @brief Check a parsed value against the common subset of JSON Schema
+     *
+     * Covers type, required, properties, items, enum and additionalProperties
+     * set to false, which is what structured-output schemas use.
+     *
+     * @param value Parsed document
+     * @param schema Schema object
+     * @param problem Receives the first mismatch, as a path and reason
+     * @return Whether the value matches
+     */
+    static bool matches_schema(const json& value, const json& schema, std::string& problem);
+};
+
+#endif // JSON_STREAM_VALIDATOR_H
@@ -0,0 +1,151 @@
+#ifndef LLAMA_MODEL_H
+#define LLAMA_MODEL_H
+
+#include "gguf_file.h"
+#include "quant_kernels.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Fixed set of threads that split row ranges of one job
+ *
+ * Threads stay parked between jobs, so the hundreds of matvecs per token
+ * do not each pay for thread creation. The calling thread takes the
+ * first chunk itself.
+ */
+class WorkerPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    const std::function<void(int, int)>* job;
+    int job_items;
+    unsigned long generation;
+    int pending;
+    bool stopping;
+
+    void worker_loop(int index);
+
+public:
+    /**
+     * @brief Constructor
+     * @param threads Total threads including the caller (at least 1)
+     */
+    explicit WorkerPool(int threads);
+    ~WorkerPool();
+
+    /**
+     * @brief Run fn(begin, end) over [0, items) split into one contiguous chunk per thread
+     */
+    void run(int items, const std::function<void(int, int)>& fn);
+
+    /**
+     * @brief Threads including the caller
+     */
+    int size() const;
+};
+
+/**
+ * @brief Weight matrix used in place from the GGUF mapping
+ */
+struct LlamaWeight {
+    const uint8_t* data = nullptr;
+    bool is_f32 = false;          // F32 has no dot kernel and is handled directly
+    QuantFormat format = QuantFormat::F16;
+    DotKernel kernel = nullptr;
+    int rows = 0;                 // Output features
+    int cols = 0;                 // Input features
+    size_t stride = 0;            // Bytes per row
+};
+
+/**
+ * @brief CPU decoder for llama-architecture GGUF models
+ *
+ * Runs one token at a time: RMSNorm, rotary embeddings, grouped-query
+ * attention over a KV cache allocated once for the full context, and a
+ * SwiGLU feed-forward block. Matrix-vector products use the SIMD kernels
+ * from quant_kernels, split across a worker pool. Supported weight types
+ * are Q4_0, Q8_0, Q4_K, Q6_K, F16 and F32.
+ */
+class LlamaModel {
+private:
+    struct Layer {
+        const float* attn_norm;
+        LlamaWeight wq, wk, wv, wo;
+        const float* ffn_norm;
+        LlamaWeight gate, up, down;
+    };
+
+    int n_embd;
+    int n_layer;
+    int n_head;
+    int n_head_kv;
+    int head_dim;
+    int kv_dim;
+    int n_ff;
+    int n_vocab;
+    int n_ctx;
+    int requested_ctx;
+    float rms_eps;
+    std::vector<float> rope_freqs;  // Inverse frequency of each rotated pair
+
+    LlamaWeight token_embd;
+    LlamaWeight output;
+    const float* output_norm;
+    std::vector<Layer> layers;
+
+    std::vector<float> key_cache;    // [layer][position][kv_dim]
+    std::vector<float> value_cache;
+
+    // Scratch buffers for one token
+    std::vector<float> x, xb, xb2, q, hb, hb2, att, logits;
+    std::vector<uint8_t> activations;
+
+    std::unique_ptr<WorkerPool> pool;
+
+    bool bind_weight(const GgufFile& file, const std::string& name, int rows, int cols, LlamaWeight& weight);
+    bool bind_norm(const GgufFile& file, const std::string& name, int n, const float*& norm);
+    void matmul(const LlamaWeight& weight, const float* in, float* out);
+    void rms_norm(float* out, const float* in, const float* weight);
+    void rope(float* vec, int heads, int pos);
+
+public:
+    /**
+     * @brief Constructor
+     * @param threads Worker threads (0 for all online CPUs)
+     * @param context_length Context to allocate the KV cache for (capped by the model's own)
+     */
+    explicit LlamaModel(int threads = 0, int context_length = 2048);
+
+    /**
+     * @brief Bind the tensors of a file and allocate the KV cache
+     * @param file Open GGUF file; must outlive the model
+     * @return false if the architecture, a tensor shape or a weight type is unsupported
+     */
+    bool load(const GgufFile& file);
+
+    /**
+     * @brief Run one token through the network
+     * @param token Token id
+     * @param pos Position in the sequence (its keys and values land in the cache there)
+     * @return Logits over the vocabulary, valid until the next call
+     */
+    const float* forward(int token, int pos);
+
+    int get_context_length() const;
+    int get_vocab_size() const;
+    int get_threads() const;
+
+    /**
+     * @brief Bytes allocated for the KV cache
+     */
+    size_t get_kv_cache_bytes() const;
+};
+
+#endif // LLAMA_MODEL_H
@@ -3,17 +3,83 @@
 
 #include "api_client.h"
 #include "memory_monitor.h"
+#include "thermal_monitor.h"
+#include "power_source.h"
+#include "storage_probe.h"
+#include "bandwidth_probe.h"
+#include "quant_bench.h"
+#include "model_footprint.h"
+#include "memory_predictor.h"
+#include "tokenizer.h"
+#include "prefill_sweep.h"
+#include "decode_sweep.h"
+#include "chat_benchmark.h"
+#include "prefix_cache_bench.h"
+#include "structured_output_bench.h"
+#include "vision_bench.h"
+#include "option_sweep.h"
+#include "device_profile.h"
+#include "autotuner.h"
 #include <string>
 #include <vector>
 #include <chrono>
 #include <mutex>
 #include <map>
 #include <future>
+#include <memory>
 
 /**
  * @brief Class to benchmark LLM models
  */
 class LLMBenchmark {
+public:
+    /**
+     * @brief Per-section measurements
+     */
+    struct SectionMetrics {
+        std::chrono::milliseconds duration;
+        unsigned long memory;
+        double tokens_per_second;
+        int output_tokens;
+        double energy_joules;  // Negative when no power source is configured
+        SwapActivity swap;
+        ThermalSummary thermal;
+    };
+    
+    /**
+     * @brief Result structure with memory metrics
+     */
+    struct Result {
+        std::string model_name;
+        std::string response;
+        std::chrono::milliseconds duration;
+        double tokens_per_second;
+        unsigned long peak_memory;
+        unsigned long baseline_memory;
+        unsigned long peak_pss;         // Peak proportional set size of the full prompt (KB, 0 if unreadable)
+        int output_tokens;              // Generated tokens for the full prompt
+        int prompt_tokens;              // Tokens in the prompt text (no template), 0 if unknown
+        std::string token_source;       // Where output_tokens came from: "server", "tokenizer" or "estimate"
+        double energy_joules;           // Energy for the full prompt (negative if unavailable)
+        int token_budget;               // num_predict forced by fixed-length mode (0 in normal mode)
+        double normalized_tps;          // Decode rate over the full token budget (0 if the model stopped short)
+        GenerationMetrics generation;   // Server-reported timings for the full prompt
+        SwapActivity swap;              // Swap activity during the full prompt
+        ThermalSummary thermal;         // Temperature and CPU frequency during the full prompt
+        ModelFootprint footprint;       // Parameters, weight bytes and shape from the GGUF header
+        MemoryPrediction predicted_memory; // Weights + KV cache + compute buffers expected for this run
+        std::map<std::string, std::string> section_responses; // For verbose output
+        std::map<std::string, SectionMetrics> section_metrics; // Duration, memory and swap by section
+        std::vector<std::string> swap_alerts; // Throughput drops that coincided with swap-in
+
+        /**
+         * @brief Peak RSS above the baseline, 0 when models resident at the start were evicted
+         */
+        unsigned long memory_increase() const {
+            return peak_memory > baseline_memory ? peak_memory - baseline_memory : 0;
+        }
+    };
+    
 private:
     std::vector<std::string> models;
     std::string prompt_file;
@@ -24,22 +90,57 @@ private:
     bool use_mmap;          // Use memory-mapped model loading
     unsigned long swap_size; // Swap size in MB
     int swappiness;         // VM swappiness setting
-    OllamaAPI api;
+    std::unique_ptr<InferenceBackend> backend; // Ollama over HTTP unless replaced with set_backend()
     std::mutex output_mutex;
+    std::vector<Result> last_results; // Results of the most recent run, sorted by duration
+    std::unique_ptr<ThermalMonitor> thermal_monitor; // Null unless thermal tracking is enabled
+    bool discard_throttled;  // Drop throughput measured at reduced CPU frequency
+    std::unique_ptr<PowerSource> power_source; // Null unless energy accounting is enabled
+    std::unique_ptr<StorageProbe> storage_probe; // Null unless the storage probe is enabled
+    std::vector<StorageMeasurement> storage_results; // Read throughput of the model filesystem
+    std::unique_ptr<BandwidthProbe> bandwidth_probe; // Null unless the bandwidth probe is enabled
+    std::vector<BandwidthResult> bandwidth_results;  // STREAM bandwidth of this machine
+    std::unique_ptr<QuantKernelBench> quant_bench;   // Null unless the kernel microbenchmark is enabled
+    std::vector<QuantKernelResult> quant_results;    // Dot/matvec kernel throughput of this CPU
+    std::unique_ptr<ModelFootprintReader> footprint_reader; // Reads model blobs' GGUF headers
+    bool admission;          // In parallel mode, start a model only when its predicted memory fits
+    std::mutex tokenizer_mutex;
+    std::map<std::string, std::unique_ptr<Tokenizer>> tokenizers; // By model; null if the model has no GGUF vocabulary
+    size_t tokenizer_bench_mb; // Text encoded per model by the tokenizer benchmark (0 disables it)
     
     /**
-     * @brief Result structure with memory metrics
+     * @brief Tokenizer throughput on one model's vocabulary
      */
-    struct Result {
+    struct TokenizerBenchResult {
         std::string model_name;
-        std::string response;
-        std::chrono::milliseconds duration;
-        double tokens_per_second;
-        unsigned long peak_memory;
-        unsigned long baseline_memory;
-        std::map<std::string, std::string> section_responses; // For verbose output
-        std::map<std::string, std::pair<std::chrono::milliseconds, unsigned long>> section_metrics; // Duration and memory by section
+        std::string kind;       // "spm" or "bpe"
+        int vocab_size;
+        size_t bytes;
+        size_t tokens;
+        double seconds;
     };
+    std::vector<TokenizerBenchResult> tokenizer_results;
+    std::unique_ptr<PrefillSweep> prefill_sweep;   // Null unless the prefill sweep is enabled
+    std::vector<PrefillPoint> prefill_points;      // Prefill throughput by prompt length
+    std::unique_ptr<DecodeSweep> decode_sweep;     // Null unless the decode sweep is enabled
+    std::vector<DecodePoint> decode_points;        // Streamed decode latency by output length
+    std::unique_ptr<ChatBenchmark> chat_bench;     // Null unless the multi-turn chat benchmark is enabled
+    std::vector<ChatScript> chat_scripts;          // Conversations the chat benchmark plays
+    std::vector<ChatTurnResult> chat_results;      // Prefill per turn with and without KV reuse
+    std::unique_ptr<PrefixCacheBench> prefix_cache_bench; // Null unless the shared-prefix benchmark is enabled
+    std::vector<PrefixCachePoint> prefix_cache_points;    // Section prefill behind a warm and a cold prefix
+    std::unique_ptr<StructuredOutputBench> structured_bench; // Null unless the structured-output benchmark is enabled
+    std::vector<StructuredRun> structured_runs;    // Sections generated free, with format "json" and with a schema
+    std::unique_ptr<VisionBench> vision_bench;     // Null unless the vision-language workload is enabled
+    std::vector<VisionPoint> vision_points;        // Image requests, native and resized
+    std::unique_ptr<OptionSweep> option_sweep;     // Null unless the options grid sweep is enabled
+    std::string option_sweep_csv;                  // CSV file for the grid rows (empty for none)
+    std::vector<OptionSweepRow> option_rows;       // One row per model and option combination
+    std::string profile_path;                      // Device profile file (empty for this device's default)
+    bool use_profile;                              // Apply the profile's tuned options to the model runs
+    std::map<std::string, json> tuned_options;     // By model; options from the device profile
+    int fixed_length;                              // Tokens every model generates (0 for normal mode)
+    int fixed_seed;                                // Sampling seed in fixed-length mode
     
     /**
      * @brief Read prompt from file
@@ -61,11 +162,45 @@ private:
     std::string get_timestamp();
     
     /**
-     * @brief Estimate token count (approximate)
+     * @brief Tokenizer of a model, loaded from its GGUF vocabulary on first use
+     * @param model Model name
+     * @return Tokenizer, or nullptr if the model's blob or vocabulary is not available
+     */
+    const Tokenizer* tokenizer_for(const std::string& model);
+    
+    /**
+     * @brief Count the tokens of a text with the model's own tokenizer
+     * @param model Model name
      * @param text Input text
-     * @return Estimated token count
+     * @param exact Set to whether the count came from the tokenizer (false: ~4 characters per token)
+     * @return Token count
+     */
+    int count_tokens(const std::string& model, const std::string& text, bool* exact = nullptr);
+    
+    /**
+     * @brief Encode a few MB of the prompt with each model's tokenizer and time it
+     * @param prompt Text to repeat
      */
-    int estimate_tokens(const std::string& text);
+    void run_tokenizer_bench(const std::string& prompt);
+    
+    /**
+     * @brief Load the device profile and keep the tuned options of the models to run
+     * @return Line describing the profile for the run header
+     */
+    std::string load_profile();
+    
+    /**
+     * @brief Options sent with a model's benchmark requests: tuned options, then the fixed-length settings
+     * @param model Model name
+     * @return JSON object (empty when the requests use the backend defaults)
+     */
+    json request_options(const std::string& model) const;
+    
+    /**
+     * @brief Print decode rates over the fixed token budget, flagging models that stopped short
+     * @param results Results of the run
+     */
+    void report_fixed_length(const std::vector<Result>& results);
     
     /**
      * @brief Parse prompt sections for better output
@@ -74,6 +209,103 @@ private:
      */
     std::vector<std::pair<std::string, std::string>> parse_prompt_sections(const std::string& prompt);
     
+    /**
+     * @brief Run the full prompt and (in verbose mode) each section against one model
+     * @param model Model name
+     * @param prompt Full prompt text
+     * @param prompt_sections Parsed prompt sections
+     * @param baseline_memory Ollama memory before the benchmark started (KB)
+     * @return Populated result for the model
+     */
+    Result benchmark_model(
+        const std::string& model, 
+        const std::string& prompt, 
+        const std::vector<std::pair<std::string, std::string>>& prompt_sections, 
+        unsigned long baseline_memory
+    );
+    
+    /**
+     * @brief Flag requests whose decode throughput dropped while pages were swapped in
+     * 
+     * The reference rate is the fastest request of the same model that saw no
+     * swap-in. Requests that fall more than 20% below it with swap-in active
+     * are recorded in result.swap_alerts.
+     * 
+     * @param result Result to inspect and annotate
+     */
+    void detect_swap_slowdowns(Result& result);
+    
+    /**
+     * @brief Print how throttling lined up with each request's decode rate
+     * @param results Results of the run
+     */
+    void report_thermal(const std::vector<Result>& results);
+    
+    /**
+     * @brief Print joules per token and tokens per joule for each model
+     * @param results Results of the run
+     */
+    void report_energy(const std::vector<Result>& results);
+    
+    /**
+     * @brief Compare each model's load_duration with its size divided by storage bandwidth
+     * @param results Results of the run
+     */
+    void report_load_io(const std::vector<Result>& results);
+    
+    /**
+     * @brief Sequential read bandwidth matching how the server loads weights
+     * @return Bandwidth in MB/s (0 if not measured)
+     */
+    double load_bandwidth() const;
+    
+    /**
+     * @brief Decode rate of one model against the memory-bandwidth ceiling
+     */
+    struct RooflineRow {
+        std::string model_name;
+        ModelInfo info;
+        double ceiling_tps;      // Bandwidth divided by weight bytes
+        double tokens_per_second;
+        double efficiency_pct;   // Decode rate as a percentage of the ceiling
+    };
+    
+    /**
+     * @brief Compute each model's decode ceiling from its weight bytes
+     * @param results Results of the run
+     * @return One row per model whose size is known
+     */
+    std::vector<RooflineRow> compute_roofline(const std::vector<Result>& results);
+    
+    /**
+     * @brief Print decode rate as a share of the bandwidth / weight-bytes ceiling
+     * @param rows Rows from compute_roofline()
+     */
+    void report_roofline(const std::vector<RooflineRow>& rows);
+    
+    /**
+     * @brief Print each model's shape and its decode rate normalized by size
+     * @param results Results of the run
+     */
+    void report_footprint(const std::vector<Result>& results);
+    
+    /**
+     * @brief Whether several models ran at once, so the server's RSS is not one model's
+     */
+    bool concurrent_runs() const;
+    
+    /**
+     * @brief Print predicted memory next to the measured RSS increase and PSS
+     * @param results Results of the run
+     */
+    void report_memory_prediction(const std::vector<Result>& results);
+    
+    /**
+     * @brief Print the matvec-limited decode ceiling of each model's weight format
+     * @param results Results of the run
+     */
+    void report_kernel_ceiling(const std::vector<Result>& results);
+    
 public:
     /**
      * @brief Constructor
@@ -113,10 +345,166 @@ public:
      */
     void add_all_models();
     
+    /**
+     * @brief Sample CPU temperature and frequency alongside memory
+     * @param sysfs_root Root under which /sys is resolved (fixture tree for testing)
+     * @param interval_ms Sampling interval in milliseconds
+     * @param discard Exclude throughput measured while throttled from the results
+     */
+    void enable_thermal_tracking(const std::string& sysfs_root = "/", int interval_ms = 1000, bool discard = false);
+    
+    /**
+     * @brief Measure the energy of every request
+     * @param source Power source to read (powercap counters or an external meter log)
+     */
+    void enable_energy_tracking(std::unique_ptr<PowerSource> source);
+    
+    /**
+     * @brief Measure memory bandwidth before the models run and report decode efficiency
+     * @param array_mb Size of each STREAM array in MB
+     * @param threads Threads for the multithreaded pass (0 for every allowed CPU)
+     */
+    void enable_bandwidth_probe(size_t array_mb = 128, int threads = 0);
+    
+    /**
+     * @brief Benchmark the quantized dot/matvec kernels before the models run
+     * @param shapes Layer shapes as rows x cols
+     */
+    void enable_quant_bench(const std::vector<std::pair<int, int>>& shapes = QuantKernelBench::default_shapes());
+    
+    /**
+     * @brief Run models through a different backend (e.g. in-process GGUF decode)
+     * @param inference Backend to use instead of the Ollama server
+     */
+    void set_backend(std::unique_ptr<InferenceBackend> inference);
+    
+    /**
+     * @brief Directory where model names are resolved to GGUF blobs for footprint annotation
+     * @param models_dir Ollama models directory (empty for the default)
+     */
+    void set_models_dir(const std::string& models_dir);
+    
+    /**
+     * @brief Time each model's tokenizer before the models run
+     * @param text_mb Text encoded per model in MB
+     */
+    void enable_tokenizer_bench(size_t text_mb = 8);
+    
+    /**
+     * @brief After the models run, time prefill at geometrically growing prompt lengths
+     * @param min_tokens Shortest prompt in tokens
+     * @param max_tokens Longest prompt in tokens (0 for the context length)
+     * @param factor Ratio between consecutive lengths
+     */
+    void enable_prefill_sweep(int min_tokens = 16, int max_tokens = 0, double factor = 2.0);
+    
+    /**
+     * @brief After the models run, stream a fixed prompt at doubling output lengths
+     * @param min_tokens Shortest output in tokens
+     * @param max_tokens Longest output in tokens (capped by the context)
+     */
+    void enable_decode_sweep(int min_tokens = 16, int max_tokens = 2048);
+    
+    /**
+     * @brief After the models run, play multi-turn conversations with and without KV-cache reuse
+     * @param scripts Conversations to play
+     * @param reply_tokens Tokens generated per turn
+     */
+    void enable_chat_bench(const std::vector<ChatScript>& scripts = ChatBenchmark::default_scripts(), int reply_tokens = 64);
+    
+    /**
+     * @brief After the models run, send the prompt sections behind a shared prefix, warm and cold
+     * @param prefix Preamble prepended to every section (empty for the built-in one)
+     */
+    void enable_prefix_cache_bench(const std::string& prefix = "");
+    
+    /**
+     * @brief After the models run, generate each section free and with JSON / JSON-schema constraints
+     * @param schema Schema the answers are asked for and constrained to
+     * @param num_predict Output token limit per request
+     */
+    void enable_structured_bench(const json& schema = StructuredOutputBench::default_schema(), int num_predict = 256);
+    
+    /**
+     * @brief After the models run, send images to them and sweep the image resolution
+     * @param image_dir Directory of PNG, JPEG and PPM images (empty for the generated pattern only)
+     * @param sizes Longest image side in pixels for the sweep
+     * @param num_predict Output token limit per request
+     * @param threads Image preprocessing threads (0 for every allowed CPU)
+     * @param cache_dir Image payload cache ("" for the default, "-" to disable)
+     */
+    void enable_vision_bench(const std::string& image_dir = "", const std::vector<int>& sizes = VisionBench::default_sizes(),
+                             int num_predict = 64, int threads = 0, const std::string& cache_dir = "");
+    
+    /**
+     * @brief After the models run, run the prompt across every combination of request options
+     * @param grid Option names and the values to try
+     * @param repeats Runs per combination
+     * @param csv_path Also write the rows to this CSV file (empty for JSON only)
+     */
+    void enable_option_sweep(const OptionGrid& grid, int repeats = 1, const std::string& csv_path = "");
+    
+    /**
+     * @brief Make every model generate the same number of tokens with the same seed
+     *
+     * Stop sequences and end-of-generation tokens are disabled, so response
+     * time and throughput compare the same amount of work. The responses
+     * are not meant for quality evaluation.
+     *
+     * @param num_predict Tokens to generate per request
+     * @param seed Sampling seed
+     */
+    void enable_fixed_length(int num_predict = 256, int seed = 42);
+    
+    /**
+     * @brief Hold back parallel models until their predicted memory fits in available RAM
+     * @param enabled Whether admission control is on (default on)
+     */
+    void set_admission(bool enabled);
+    
+    /**
+     * @brief Print each model's predicted memory and whether it fits a device, without running it
+     * @param device_ram_mb RAM of the target device in MB (0 for this machine)
+     */
+    void predict_memory(unsigned long device_ram_mb = 0);
+    
+    /**
+     * @brief Device profile to read tuned options from and autotune() to write to
+     * @param path Profile file (empty for this device's default path)
+     * @param apply Whether run() sends each model's tuned options with its requests
+     */
+    void set_profile(const std::string& path = "", bool apply = true);
+    
+    /**
+     * @brief Search each model's num_thread, num_batch and num_ctx and save the winners to the device profile
+     * @param tuner Search space and objective
+     */
+    void autotune(Autotuner& tuner);
+    
+    /**
+     * @brief Measure storage read throughput before the models run
+     * @param models_dir Ollama models directory (empty for the default)
+     * @param block_kb Read block size in KB
+     * @param size_mb Bytes to read per sequential pass in MB
+     */
+    void enable_storage_probe(const std::string& models_dir = "", size_t block_kb = 1024, unsigned long long size_mb = 512);
+    
     /**
      * @brief Run the benchmark
      */
     void run();
+    
+    /**
+     * @brief Get the results of the most recent run
+     * @return Results sorted by duration (empty before run())
+     */
+    const std::vector<Result>& get_results() const;
+    
+    /**
+     * @brief Get the storage probe measurements of the most recent run
+     * @return Measurements (empty unless the probe was enabled)
+     */
+    const std::vector<StorageMeasurement>& get_storage_results() const;
 };
 
 #endif // LLM_BENCHMARK_H
\ No newline at end of file
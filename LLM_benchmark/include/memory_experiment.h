@@ -0,0 +1,196 @@
+#ifndef MEMORY_EXPERIMENT_H
+#define MEMORY_EXPERIMENT_H
+
+#include "api_client.h"
+#include <string>
+#include <vector>
+#include <utility>
+
+/**
+ * @brief One combination of memory settings in the experiment matrix
+ */
+struct MemoryConfig {
+    int swappiness;          // VM swappiness, -1 to leave the current value
+    unsigned long swap_mb;   // Size of the extra swap file in MB, 0 for none
+    bool use_mmap;           // Memory-mapped model loading
+    std::string thp_mode;    // Transparent hugepage mode, empty to leave the current mode
+
+    /**
+     * @brief Short human-readable description
+     * @return Label such as "swappiness=10 swap=2048MB mmap=on thp=never"
+     */
+    std::string label() const;
+};
+
+/**
+ * @brief Applies memory settings and restores the original values
+ *
+ * Settings are written directly to procfs/sysfs under a configurable root
+ * ("/" on a real system, a fixture directory for testing). The original
+ * value of every file is recorded before its first change and written back
+ * by restore(), by the destructor, or by the SIGINT/SIGTERM/SIGHUP handler
+ * installed while a guard is alive. Only one guard may be active at a time.
+ */
+class SystemStateGuard {
+private:
+    std::string root;
+    bool dry_run;
+    std::string swap_file;
+    bool swap_active;
+    std::string thp_options;   // Transparent hugepage modes offered by the kernel
+    std::vector<std::pair<std::string, std::string>> originals; // Resolved path and original value
+
+    /**
+     * @brief Prefix a system path with the configured root
+     * @param path Absolute system path (e.g. /proc/sys/vm/swappiness)
+     * @return Path under the root
+     */
+    std::string resolve(const std::string& path) const;
+
+    /**
+     * @brief Whether swapon/swapoff may be called (real root, not a dry run)
+     */
+    bool can_touch_swap() const;
+
+    /**
+     * @brief Record the original value of a file, then write a new one
+     * @param path Absolute system path
+     * @param value Value to write
+     * @return true if successful (always true in dry-run mode)
+     */
+    bool set_value(const std::string& path, const std::string& value);
+
+    /**
+     * @brief Disable and remove the extra swap file if it is active
+     */
+    void release_swap();
+
+public:
+    /**
+     * @brief Constructor
+     * @param root_dir Root under which /proc and /sys are resolved
+     * @param dry_run_only Log the changes without writing anything
+     * @param swap_path Path of the extra swap file (relative to the root)
+     */
+    explicit SystemStateGuard(
+        const std::string& root_dir = "/",
+        bool dry_run_only = false,
+        const std::string& swap_path = "/var/tmp/edge_ai_benchmark.swap"
+    );
+
+    /**
+     * @brief Destructor, restores the original settings
+     */
+    ~SystemStateGuard();
+
+    SystemStateGuard(const SystemStateGuard&) = delete;
+    SystemStateGuard& operator=(const SystemStateGuard&) = delete;
+
+    /**
+     * @brief Apply every setting of a configuration
+     * @param config Configuration to apply
+     * @return true if all settings were applied
+     */
+    bool apply(const MemoryConfig& config);
+
+    /**
+     * @brief Set vm.swappiness
+     * @param value Swappiness (0-100)
+     * @return true if successful
+     */
+    bool set_swappiness(int value);
+
+    /**
+     * @brief Set the transparent hugepage mode
+     * @param mode One of the modes listed in the sysfs file (e.g. always, madvise, never)
+     * @return true if successful
+     */
+    bool set_thp_mode(const std::string& mode);
+
+    /**
+     * @brief Replace the extra swap file with one of the given size
+     * @param size_mb Size in MB, 0 to remove the extra swap file
+     * @return true if successful
+     */
+    bool set_swap_size(unsigned long size_mb);
+
+    /**
+     * @brief Restore every recorded original value and remove the swap file
+     */
+    void restore();
+};
+
+/**
+ * @brief Runs the benchmark across a matrix of memory configurations
+ *
+ * Every combination of swappiness, extra swap size, mmap on/off and
+ * transparent hugepage mode is applied in turn, the benchmark is run,
+ * and a comparison table shows the fastest configuration for each model.
+ */
+class MemoryExperiment {
+private:
+    OllamaAPI api;              // Evicts the models between configurations
+    std::string prompt_file;
+    std::string output_file;
+    std::string root;
+    bool dry_run;
+    std::vector<std::string> models;
+    std::vector<int> swappiness_values;
+    std::vector<unsigned long> swap_sizes;
+    std::vector<bool> mmap_modes;
+    std::vector<std::string> thp_modes;
+
+    /**
+     * @brief Expand the configured value lists into their cartesian product
+     * @return All configurations to run
+     */
+    std::vector<MemoryConfig> build_matrix() const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param prompt_path Path to the prompt file
+     * @param output_path Path for the JSON comparison (empty for none)
+     * @param root_dir Root under which /proc and /sys are resolved
+     * @param dry_run_only Log system changes without writing anything
+     */
+    MemoryExperiment(
+        const std::string& prompt_path,
+        const std::string& output_path = "",
+        const std::string& root_dir = "/",
+        bool dry_run_only = false
+    );
+
+    /**
+     * @brief Add a model to the experiment
+     * @param model_name Name of the model
+     */
+    void add_model(const std::string& model_name);
+
+    /**
+     * @brief Set the swappiness values to try (default: leave unchanged)
+     */
+    void set_swappiness_values(const std::vector<int>& values);
+
+    /**
+     * @brief Set the extra swap sizes in MB to try (default: none)
+     */
+    void set_swap_sizes(const std::vector<unsigned long>& sizes_mb);
+
+    /**
+     * @brief Set the mmap modes to try (default: off and on)
+     */
+    void set_mmap_modes(const std::vector<bool>& modes);
+
+    /**
+     * @brief Set the transparent hugepage modes to try (default: leave unchanged)
+     */
+    void set_thp_modes(const std::vector<std::string>& modes);
+
+    /**
+     * @brief Run every configuration and print the comparison table
+     */
+    void run();
+};
+
+#endif // MEMORY_EXPERIMENT_H
@@ -5,6 +5,7 @@
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include "system_utils.h"
 
 /**
  * @brief Class to monitor process memory usage
@@ -15,14 +16,19 @@ private:
     std::atomic<bool> should_run;
     std::thread monitor_thread;
     unsigned long peak_memory;
+    unsigned long peak_pss;         // Proportional set size: shared pages split between their users
     std::string process_name;
     int sample_interval_ms;
+    SwapStats swap_start;           // Swap counters when monitoring started
+    SwapStats swap_end;             // Swap counters when monitoring stopped
+    unsigned long min_swap_free;    // Lowest SwapFree seen while sampling
     
     /**
      * @brief Get current RSS memory usage in KB
+     * @param pss Receives the current PSS in KB (0 if unreadable)
      * @return Current memory usage in KB
      */
-    unsigned long get_memory_usage();
+    unsigned long get_memory_usage(unsigned long& pss);
     
     /**
      * @brief Monitor thread function
@@ -57,6 +63,18 @@ public:
      * @return Peak memory usage in KB
      */
     unsigned long get_peak_memory();
+    
+    /**
+     * @brief Get peak PSS in KB
+     * @return Peak proportional set size in KB (0 if unreadable)
+     */
+    unsigned long get_peak_pss();
+    
+    /**
+     * @brief Get swap activity observed between start() and stop()
+     * @return Swap-in/out page deltas and SwapFree changes
+     */
+    SwapActivity get_swap_activity();
 };
 
 #endif // MEMORY_MONITOR_H
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef MEMORY_PREDICTOR_H
+#define MEMORY_PREDICTOR_H
+
+#include "model_footprint.h"
+#include "inference_backend.h"
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Expected resident memory of one loaded model, by component (KB)
+ */
+struct MemoryPrediction {
+    unsigned long weights_kb = 0;    // Tensor data
+    unsigned long kv_cache_kb = 0;   // K and V for every layer and context position
+    unsigned long compute_kb = 0;    // Activations, attention scores and logits of one batch
+    int context_length = 0;          // Context the KV cache was sized for
+
+    /**
+     * @brief Whether the model's footprint was known
+     */
+    bool valid() const;
+
+    /**
+     * @brief Sum of the components
+     */
+    unsigned long total_kb() const;
+
+    /**
+     * @brief Signed error of a measurement against the prediction
+     * @param measured_kb Measured memory in KB
+     * @return (predicted - measured) / measured in percent, 0 without a measurement
+     */
+    double error_pct(unsigned long measured_kb) const;
+
+    /**
+     * @brief Components and total, for the JSON report
+     */
+    json to_json() const;
+};
+
+/**
+ * @brief Predicts peak memory from model shape instead of running the model
+ *
+ * Follows how llama.cpp sizes its buffers: every weight is resident, the
+ * KV cache holds n_ctx positions of n_kv_heads * head_dim values for K
+ * and V in every layer, and the compute buffer holds one batch of
+ * activations (residual, QKV, FFN hidden), the attention scores against
+ * the full context, and one row of logits. Runtime code and allocator
+ * slack are not modelled; the error column of the report shows them.
+ */
+class MemoryPredictor {
+public:
+    /**
+     * @brief Predict the memory of one model
+     * @param footprint Shape and weight bytes from the GGUF header
+     * @param config Context, batch and KV precision of the backend
+     * @return Prediction; valid() is false if the footprint is unknown
+     */
+    static MemoryPrediction predict(const ModelFootprint& footprint, const RuntimeConfig& config);
+};
+
+#endif // MEMORY_PREDICTOR_H
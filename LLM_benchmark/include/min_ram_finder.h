@@ -0,0 +1,180 @@
+#ifndef MIN_RAM_FINDER_H
+#define MIN_RAM_FINDER_H
+
+#include "api_client.h"
+#include "system_utils.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Restricts the memory available to the inference server
+ */
+class MemoryLimiter {
+public:
+    virtual ~MemoryLimiter() = default;
+
+    /**
+     * @brief Apply a memory budget
+     * @param limit_mb Budget in MB, 0 to remove the limit
+     * @return true if the limit is in effect
+     */
+    virtual bool apply(unsigned long limit_mb) = 0;
+
+    /**
+     * @brief Remove the limit and undo any setup
+     */
+    virtual void release() = 0;
+
+    /**
+     * @brief Short description for reports
+     */
+    virtual std::string description() const = 0;
+};
+
+/**
+ * @brief Limits the server with a cgroup v2 memory.max
+ *
+ * The server processes are moved into a dedicated child cgroup; the model
+ * runner they spawn afterwards inherits it. release() moves every process
+ * back to its original cgroup and removes the child group.
+ */
+class CgroupLimiter : public MemoryLimiter {
+private:
+    std::string cgroup_root;
+    std::string cgroup_dir;
+    std::string process_name;
+    std::vector<std::pair<int, std::string>> moved; // PID and its original cgroup directory
+    bool prepared;
+
+    /**
+     * @brief Create the child cgroup and move the server processes into it
+     * @return true if successful
+     */
+    bool prepare();
+
+public:
+    /**
+     * @brief Constructor
+     * @param root Mount point of the cgroup v2 hierarchy
+     * @param process Name of the server process to limit
+     */
+    explicit CgroupLimiter(const std::string& root = "/sys/fs/cgroup", const std::string& process = "ollama");
+    ~CgroupLimiter() override;
+
+    bool apply(unsigned long limit_mb) override;
+    void release() override;
+    std::string description() const override;
+};
+
+/**
+ * @brief Limits available RAM by pinning a balloon of locked memory
+ *
+ * The balloon is sized so that MemAvailable drops to the requested budget.
+ * mlock needs CAP_IPC_LOCK or a large RLIMIT_MEMLOCK; without it the pages
+ * are still touched but may be swapped out, which weakens the limit.
+ */
+class BalloonLimiter : public MemoryLimiter {
+private:
+    void* balloon;
+    size_t balloon_bytes;
+    bool locked;
+
+public:
+    BalloonLimiter();
+    ~BalloonLimiter() override;
+
+    bool apply(unsigned long limit_mb) override;
+    void release() override;
+    std::string description() const override;
+};
+
+/**
+ * @brief One measurement at a memory budget
+ */
+struct RamProbe {
+    unsigned long limit_mb;     // Budget in MB, 0 for unlimited
+    bool ok;                    // Request completed and produced tokens
+    double tokens_per_second;   // Decode throughput
+    unsigned long peak_memory;  // Peak server memory in KB
+    SwapActivity swap;          // Swap activity during the request
+};
+
+/**
+ * @brief Binary-searches the smallest memory budget that keeps a model above a throughput floor
+ */
+class MinimumRamFinder {
+private:
+    OllamaAPI api;
+    std::string prompt_file;
+    std::string output_file;
+    std::vector<std::string> models;
+    std::unique_ptr<MemoryLimiter> limiter;
+    double floor_tps;           // Absolute floor in tokens/sec, 0 to derive from the unlimited run
+    double floor_fraction;      // Fraction of the unlimited rate used when floor_tps is 0
+    unsigned long min_mb;
+    unsigned long max_mb;
+    unsigned long resolution_mb;
+
+    /**
+     * @brief Run one request against a model under a memory budget
+     * @param model Model name
+     * @param prompt Prompt text
+     * @param limit_mb Budget in MB, 0 for unlimited
+     * @return Measurement at that budget
+     */
+    RamProbe probe(const std::string& model, const std::string& prompt, unsigned long limit_mb);
+
+public:
+    /**
+     * @brief Constructor
+     * @param prompt_path Path to the prompt file
+     * @param output_path Path for JSON results (empty for none)
+     * @param memory_limiter Limiter used to constrain the server
+     * @param use_memory_mapping Whether to use memory-mapped model loading
+     */
+    MinimumRamFinder(
+        const std::string& prompt_path,
+        const std::string& output_path,
+        std::unique_ptr<MemoryLimiter> memory_limiter,
+        bool use_memory_mapping = false
+    );
+
+    /**
+     * @brief Destructor
+     */
+    ~MinimumRamFinder();
+
+    /**
+     * @brief Add a model to search
+     * @param model_name Name of the model
+     */
+    void add_model(const std::string& model_name);
+
+    /**
+     * @brief Set an absolute throughput floor
+     * @param tokens_per_second Floor, 0 to use 80% of the unlimited rate
+     */
+    void set_floor(double tokens_per_second);
+
+    /**
+     * @brief Set the search range
+     * @param lower_mb Smallest budget to try
+     * @param upper_mb Largest budget to try (0 for total system memory)
+     */
+    void set_range(unsigned long lower_mb, unsigned long upper_mb);
+
+    /**
+     * @brief Set the search resolution
+     * @param step_mb Stop when the bracket is narrower than this
+     */
+    void set_resolution(unsigned long step_mb);
+
+    /**
+     * @brief Search every model and print the throughput curve and cliff point
+     */
+    void run();
+};
+
+#endif // MIN_RAM_FINDER_H
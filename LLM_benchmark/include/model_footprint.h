@@ -0,0 +1,121 @@
+#ifndef MODEL_FOOTPRINT_H
+#define MODEL_FOOTPRINT_H
+
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Tensors of one quantization type within a model
+ */
+struct TensorTypeStats {
+    std::string type;        // e.g. "Q4_K"
+    int tensors = 0;
+    uint64_t parameters = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * @brief Size and shape of a model, read from its GGUF header
+ */
+struct ModelFootprint {
+    std::string path;                   // Weights blob (empty if not found)
+    std::string architecture;           // general.architecture
+    std::string file_type;              // general.file_type name, e.g. "Q4_K_M"
+    uint64_t parameter_count = 0;       // Sum of tensor elements
+    uint64_t weight_bytes = 0;          // Sum of tensor data sizes
+    long long context_length = 0;       // Trained context in tokens
+    long long block_count = 0;          // Transformer layers
+    long long head_count = 0;
+    long long head_count_kv = 0;
+    long long embedding_length = 0;
+    long long feed_forward_length = 0;
+    long long vocab_size = 0;
+    std::vector<TensorTypeStats> tensor_types; // Largest share of the weights first
+
+    /**
+     * @brief Whether the header was read
+     */
+    bool valid() const;
+
+    /**
+     * @brief Average stored bits per parameter
+     */
+    double bits_per_weight() const;
+
+    /**
+     * @brief Type holding most of the weight bytes ("" if not read)
+     */
+    std::string dominant_type() const;
+
+    /**
+     * @brief Parameters touched per second at a given decode rate, in billions
+     */
+    double gparams_per_second(double tokens_per_second) const;
+
+    /**
+     * @brief Weight bytes streamed per second at a given decode rate, in GB/s
+     */
+    double weight_gb_per_second(double tokens_per_second) const;
+
+    /**
+     * @brief Every field, for the JSON report
+     */
+    json to_json() const;
+};
+
+/**
+ * @brief Reads model footprints from GGUF headers without touching the weights
+ *
+ * Only the header and tensor index are parsed (array values such as the
+ * vocabulary are stepped over), so reading a multi-gigabyte blob costs a
+ * few pages of I/O. Results are cached per model name.
+ */
+class ModelFootprintReader {
+private:
+    std::string models_dir;
+    std::mutex mtx;
+    std::map<std::string, ModelFootprint> cache;
+
+public:
+    /**
+     * @brief Constructor
+     * @param dir Ollama models directory (empty for $OLLAMA_MODELS or ~/.ollama/models)
+     */
+    explicit ModelFootprintReader(const std::string& dir = "");
+
+    /**
+     * @brief Footprint of a model
+     * @param model Ollama model name or path to a .gguf file
+     * @return Footprint; valid() is false if the blob is missing or not GGUF
+     */
+    ModelFootprint read(const std::string& model);
+
+    /**
+     * @brief Directory model names are resolved in
+     */
+    const std::string& get_models_dir() const;
+
+    /**
+     * @brief Map a model name or path to its GGUF file
+     * @param models_dir Ollama models directory
+     * @param model Ollama model name or path to a .gguf file
+     * @return Path, empty if the model is not found
+     */
+    static std::string locate(const std::string& models_dir, const std::string& model);
+
+    /**
+     * @brief Footprint of a GGUF file
+     * @param path File to read
+     * @param footprint Receives the footprint
+     * @return false if the file could not be parsed
+     */
+    static bool read_file(const std::string& path, ModelFootprint& footprint);
+};
+
+#endif // MODEL_FOOTPRINT_H
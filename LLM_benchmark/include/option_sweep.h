@@ -0,0 +1,110 @@
+#ifndef OPTION_SWEEP_H
+#define OPTION_SWEEP_H
+
+#include "inference_backend.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Grid of request options: each option name with the values to try
+ */
+using OptionGrid = std::vector<std::pair<std::string, std::vector<json>>>;
+
+/**
+ * @brief One model run with one combination of options
+ */
+struct OptionSweepRow {
+    std::string model_name;
+    json options;               // The combination, as sent in the request
+    int repeat;                 // 1-based repetition of the combination
+    bool ok;
+    std::string error;          // Backend message if the request failed
+    double wall_seconds;
+    double load_seconds;
+    double ttft_seconds;        // Arrival of the first streamed token
+    int prompt_tokens;
+    double prefill_seconds;
+    int output_tokens;
+    double decode_seconds;
+    unsigned long peak_memory_kb;
+
+    double prefill_rate() const;
+    double decode_rate() const;
+};
+
+/**
+ * @brief Runs the benchmark prompt across every combination of a grid of options
+ *
+ * Options are sent in Ollama's naming (num_thread, num_batch, num_ctx,
+ * num_predict, temperature, top_k, use_mlock, ...) and override the client
+ * defaults. Options that make the server reload the model (num_ctx,
+ * num_batch, num_thread, num_gpu, use_mlock, use_mmap) vary slowest, so
+ * consecutive combinations reload as rarely as possible; the load time is
+ * recorded in every row. Each run is streamed so time to first token is
+ * known, and memory of the process running the model is sampled.
+ */
+class OptionSweep {
+private:
+    OptionGrid grid;
+    int repeats;
+    unsigned session;           // Tag that makes every prompt unique
+
+public:
+    /**
+     * @brief Constructor
+     * @param option_grid Options and their values
+     * @param repeat_count Runs per combination
+     */
+    OptionSweep(const OptionGrid& option_grid, int repeat_count = 1);
+
+    /**
+     * @brief Parse a grid written as "name=v1,v2;name=v1,..."
+     *
+     * Values are numbers, true/false, or strings.
+     *
+     * @return false if an entry has no name or no values
+     */
+    static bool parse(const std::string& spec, OptionGrid& grid);
+
+    /**
+     * @brief Read a grid from a JSON object of name -> value or array of values
+     * @return false if the file cannot be read or is not an object
+     */
+    static bool load(const std::string& path, OptionGrid& grid);
+
+    /**
+     * @brief Every combination of the grid, reload-causing options varying slowest
+     */
+    std::vector<json> combinations() const;
+
+    /**
+     * @brief Run every combination on one model
+     * @param backend Backend to send the prompt to
+     * @param model Model name
+     * @param prompt Benchmark prompt
+     * @return One row per combination and repetition
+     */
+    std::vector<OptionSweepRow> run(InferenceBackend& backend, const std::string& model, const std::string& prompt);
+
+    /**
+     * @brief Print one line per row, marking each model's fastest decode
+     */
+    static void print(const std::vector<OptionSweepRow>& rows);
+
+    /**
+     * @brief Rows as a JSON array, one flat object per row
+     */
+    static json to_json(const std::vector<OptionSweepRow>& rows);
+
+    /**
+     * @brief Write the rows as CSV with one column per option
+     * @return false if the file cannot be written
+     */
+    static bool write_csv(const std::string& path, const std::vector<OptionSweepRow>& rows);
+};
+
+#endif // OPTION_SWEEP_H
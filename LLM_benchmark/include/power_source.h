@@ -0,0 +1,128 @@
+#ifndef POWER_SOURCE_H
+#define POWER_SOURCE_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Snapshot taken at a request boundary
+ */
+struct EnergyMark {
+    std::chrono::system_clock::time_point time;
+    std::vector<unsigned long long> counters; // Raw energy counters (source-specific, may be empty)
+};
+
+/**
+ * @brief Source of energy measurements
+ *
+ * Implementations either read cumulative counters at each mark
+ * (powercap) or integrate an external power log over the interval
+ * between two marks (CSV meter logs).
+ */
+class PowerSource {
+public:
+    virtual ~PowerSource() = default;
+
+    /**
+     * @brief Whether the source can produce measurements
+     */
+    virtual bool available() const = 0;
+
+    /**
+     * @brief Short description for reports
+     */
+    virtual std::string description() const = 0;
+
+    /**
+     * @brief Record a snapshot at the current time
+     * @return Snapshot to pass to energy_between()
+     */
+    virtual EnergyMark mark() = 0;
+
+    /**
+     * @brief Energy consumed between two snapshots
+     * @param start Snapshot at the start of the interval
+     * @param end Snapshot at the end of the interval
+     * @return Energy in joules (negative if unavailable)
+     */
+    virtual double energy_between(const EnergyMark& start, const EnergyMark& end) = 0;
+};
+
+/**
+ * @brief Reads cumulative energy counters from the Linux powercap framework
+ *
+ * Sums energy_uj over the top-level zones under the powercap directory
+ * (e.g. intel-rapl:0, intel-rapl:1); subzones are skipped so that core
+ * and uncore energy is not counted twice. Counter wraparound is handled
+ * with max_energy_range_uj.
+ */
+class PowercapSource : public PowerSource {
+private:
+    std::string powercap_dir;
+    std::vector<std::pair<std::string, unsigned long long>> zones; // energy_uj path and wrap range
+
+public:
+    /**
+     * @brief Constructor
+     * @param dir Powercap directory (default /sys/class/powercap)
+     */
+    explicit PowercapSource(const std::string& dir = "/sys/class/powercap");
+
+    bool available() const override;
+    std::string description() const override;
+    EnergyMark mark() override;
+    double energy_between(const EnergyMark& start, const EnergyMark& end) override;
+};
+
+/**
+ * @brief Integrates an external power meter log
+ *
+ * The log is a CSV of "timestamp,watts" lines with Unix timestamps in
+ * seconds; a header line and comment lines starting with '#' are
+ * ignored. The file is re-read when it grows, so a meter can keep
+ * appending during the run. Power is integrated with the trapezoidal
+ * rule, interpolating at the interval boundaries.
+ */
+class CsvPowerLog : public PowerSource {
+private:
+    std::string log_path;
+    std::vector<std::pair<double, double>> samples; // Unix time (s) and watts
+    long long loaded_size;
+    std::mutex mtx;
+
+    /**
+     * @brief Reload the log if it changed since the last read
+     */
+    void refresh();
+
+    /**
+     * @brief Interpolated power at a point in time
+     */
+    double watts_at(double t) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param path Path to the CSV log
+     */
+    explicit CsvPowerLog(const std::string& path);
+
+    bool available() const override;
+    std::string description() const override;
+    EnergyMark mark() override;
+    double energy_between(const EnergyMark& start, const EnergyMark& end) override;
+};
+
+/**
+ * @brief Create a power source from a command-line spec
+ * @param spec "powercap", "powercap:DIR" or "csv:FILE"
+ * @param sysfs_root Root prepended to the default powercap directory
+ * @return Power source, or nullptr if the spec is not recognized
+ */
+std::unique_ptr<PowerSource> create_power_source(const std::string& spec, const std::string& sysfs_root = "/");
+
+#endif // POWER_SOURCE_H
@@ -0,0 +1,90 @@
+#ifndef PREFILL_SWEEP_H
+#define PREFILL_SWEEP_H
+
+#include "inference_backend.h"
+#include "tokenizer.h"
+#include <nlohmann/json.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Prefill timing of one prompt length
+ */
+struct PrefillPoint {
+    std::string model_name;
+    int target_tokens;        // Length the filler text was sized for
+    int prompt_tokens;        // Tokens the backend evaluated (prompt_eval_count)
+    double prefill_seconds;   // prompt_eval_duration
+    double ttft_seconds;      // Client-side time to the single output token
+    double load_seconds;      // Non-zero if the model had to be (re)loaded
+
+    /**
+     * @brief Prefill throughput in tokens per second
+     */
+    double prefill_rate() const;
+};
+
+/**
+ * @brief Measures prefill throughput and time to first token against prompt length
+ *
+ * Prompt lengths grow geometrically from a few tokens up to the context
+ * size. Each prompt is deterministic filler text that starts differently
+ * from every other, so the server cannot reuse a cached prefix, and the
+ * output is limited to one token so the request time is prefill plus a
+ * single decode step. With the model's tokenizer the filler is trimmed to
+ * the exact length; without it, about four characters make a token.
+ */
+class PrefillSweep {
+private:
+    int min_tokens;
+    int max_tokens;     // 0 for the backend's context length
+    double factor;
+
+public:
+    /**
+     * @brief Constructor
+     * @param min_length Shortest prompt in tokens
+     * @param max_length Longest prompt in tokens (0 for the context length)
+     * @param growth Ratio between consecutive lengths
+     */
+    PrefillSweep(int min_length = 16, int max_length = 0, double growth = 2.0);
+
+    /**
+     * @brief Prompt lengths the sweep will use
+     * @param context_length Context the requests run with
+     */
+    std::vector<int> lengths(int context_length) const;
+
+    /**
+     * @brief Run every length against one model
+     * @param backend Backend to send the prompts to
+     * @param model Model name
+     * @param tokenizer The model's tokenizer (nullptr to estimate lengths)
+     * @param context_length Context every request runs with
+     * @return One point per length, in increasing order
+     */
+    std::vector<PrefillPoint> run(InferenceBackend& backend, const std::string& model, const Tokenizer* tokenizer, int context_length);
+
+    /**
+     * @brief Deterministic filler text of about the given number of tokens
+     * @param tokens Target length
+     * @param seed Selects the word sequence; different seeds differ from the first word
+     * @param tokenizer Used to trim the text to the exact length (may be nullptr)
+     */
+    static std::string filler_text(int tokens, unsigned seed, const Tokenizer* tokenizer);
+
+    /**
+     * @brief Print a table of the points
+     */
+    static void print(const std::vector<PrefillPoint>& points);
+
+    /**
+     * @brief Points as a JSON array
+     */
+    static json to_json(const std::vector<PrefillPoint>& points);
+};
+
+#endif // PREFILL_SWEEP_H
@@ -0,0 +1,88 @@
+#ifndef PREFIX_CACHE_BENCH_H
+#define PREFIX_CACHE_BENCH_H
+
+#include "inference_backend.h"
+#include "tokenizer.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Prefill of one prompt section behind a warm and a cold shared prefix
+ */
+struct PrefixCachePoint {
+    std::string model_name;
+    std::string section;
+    int prefix_tokens;          // Length of the shared prefix
+    int warm_tokens;            // Tokens evaluated when the prefix was cached
+    double warm_prefill_seconds;
+    int cold_tokens;            // Tokens evaluated when nothing could be reused
+    double cold_prefill_seconds;
+
+    /**
+     * @brief Share of the cold prefill time the warm prefix saved, in percent
+     */
+    double saved_pct() const;
+};
+
+/**
+ * @brief Measures the server's prompt-cache benefit for a shared preamble
+ *
+ * Production prompts usually start with the same long system preamble. The
+ * preamble is prepended to every prompt section, and the sections are sent
+ * back to back to the same loaded model after one request that primes the
+ * cache with the preamble alone. The server can then reuse the preamble's
+ * KV cache and only evaluate the section. A second pass sends the same
+ * prompts with a unique tag in front of the preamble, so nothing can be
+ * reused, which gives the cold prefill time of the same text. Only the
+ * first output token is generated.
+ */
+class PrefixCacheBench {
+private:
+    std::string prefix;
+    unsigned session;          // Tag that makes a cold prompt unique
+
+public:
+    /**
+     * @brief Constructor
+     * @param shared_prefix Preamble prepended to every section (empty for the built-in one)
+     */
+    explicit PrefixCacheBench(const std::string& shared_prefix = "");
+
+    /**
+     * @brief Built-in system preamble of a few hundred tokens
+     */
+    static const std::string& default_prefix();
+
+    /**
+     * @brief Preamble in use
+     */
+    const std::string& get_prefix() const;
+
+    /**
+     * @brief Send every section behind the warm and then the cold prefix
+     * @param backend Backend to send the prompts to
+     * @param model Model name
+     * @param sections Prompt sections as (title, text)
+     * @param tokenizer The model's tokenizer, to count the prefix (may be nullptr)
+     * @return One point per section
+     */
+    std::vector<PrefixCachePoint> run(InferenceBackend& backend, const std::string& model,
+                                      const std::vector<std::pair<std::string, std::string>>& sections,
+                                      const Tokenizer* tokenizer);
+
+    /**
+     * @brief Print warm and cold prefill side by side
+     */
+    static void print(const std::vector<PrefixCachePoint>& points);
+
+    /**
+     * @brief Points as a JSON array
+     */
+    static json to_json(const std::vector<PrefixCachePoint>& points);
+};
+
+#endif // PREFIX_CACHE_BENCH_H
@@ -0,0 +1,100 @@
+#ifndef QUANT_BENCH_H
+#define QUANT_BENCH_H
+
+#include "quant_kernels.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+#include <utility>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Timing of one kernel on one layer shape
+ */
+struct QuantKernelResult {
+    std::string format;     // "Q4_0", "Q8_0", "Q4_K", "Q6_K" or "F16"
+    std::string isa;        // "scalar", "sse", "avx2" or "neon"
+    std::string op;         // "dot" (one cache-resident row) or "matvec" (whole layer)
+    int rows;
+    int cols;
+    double seconds;         // Time per call
+    double gflops;          // 2 * rows * cols per call
+    double gb_per_s;        // Weight and activation bytes per call
+    double max_rel_error;   // Largest deviation from the scalar kernel, relative to its largest output
+};
+
+/**
+ * @brief Microbenchmark of the quantized dot and matvec kernels
+ *
+ * Every format is run on every instruction set the CPU supports, for a
+ * set of layer shapes (rows x cols of typical attention and FFN
+ * projections). The dot test repeats a single row that stays in L1 and
+ * shows the compute peak. The matvec test streams the whole layer and
+ * shows what decode can reach. Kernels run single-threaded.
+ */
+class QuantKernelBench {
+private:
+    std::vector<std::pair<int, int>> shapes;
+    double min_seconds;
+
+    /**
+     * @brief Call a function repeatedly for at least min_seconds
+     * @return Seconds per call
+     */
+    template <typename Function>
+    double time_calls(Function&& function) const;
+
+public:
+    /**
+     * @brief Constructor
+     * @param layer_shapes Rows x cols of each layer (cols must be a multiple of 256)
+     * @param min_time_s Minimum timing window per kernel in seconds
+     */
+    explicit QuantKernelBench(const std::vector<std::pair<int, int>>& layer_shapes = default_shapes(),
+                              double min_time_s = 0.1);
+
+    /**
+     * @brief Projection shapes of 1B-7B llama-style models
+     */
+    static std::vector<std::pair<int, int>> default_shapes();
+
+    /**
+     * @brief Parse a shape list such as "4096x4096,11008x4096"
+     * @param spec Comma-separated ROWSxCOLS list
+     * @param out Parsed shapes
+     * @return false if a shape is malformed or cols is not a multiple of 256
+     */
+    static bool parse_shapes(const std::string& spec, std::vector<std::pair<int, int>>& out);
+
+    /**
+     * @brief Run every format, instruction set and shape
+     * @return Results in run order
+     */
+    std::vector<QuantKernelResult> run();
+
+    /**
+     * @brief Print results as a table
+     */
+    static void print(const std::vector<QuantKernelResult>& results);
+
+    /**
+     * @brief Convert results for the JSON report
+     */
+    static json to_json(const std::vector<QuantKernelResult>& results);
+
+    /**
+     * @brief Best matvec bandwidth for a format across instruction sets and shapes
+     * @return GB/s (0 if the format was not measured)
+     */
+    static double best_matvec_bandwidth(const std::vector<QuantKernelResult>& results, const std::string& format);
+
+    /**
+     * @brief Map an Ollama quantization level to the kernel format that runs it
+     * @param quantization_level e.g. "Q4_K_M", "Q4_0", "F16"
+     * @return Format name, empty if no kernel here covers it
+     */
+    static std::string kernel_format_for(const std::string& quantization_level);
+};
+
+#endif // QUANT_BENCH_H
@@ -0,0 +1,171 @@
+#ifndef QUANT_KERNELS_H
+#define QUANT_KERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief GGUF weight formats with dot-product kernels
+ */
+enum class QuantFormat { Q4_0, Q8_0, Q4_K, Q6_K, F16 };
+
+/**
+ * @brief Instruction sets a kernel can be built for
+ */
+enum class KernelIsa { SCALAR, SSE, AVX2, NEON };
+
+// Block layouts match ggml so that GGUF tensors can be used in place
+constexpr int QK4_0 = 32;
+constexpr int QK8_0 = 32;
+constexpr int QK_K = 256;
+constexpr int K_SCALE_SIZE = 12;
+
+/**
+ * @brief 32 weights as 4-bit values with one fp16 scale: w = (q - 8) * d
+ */
+struct BlockQ4_0 {
+    uint16_t d;
+    uint8_t qs[QK4_0 / 2]; // Low nibbles hold weights 0-15, high nibbles 16-31
+};
+
+/**
+ * @brief 32 weights as 8-bit values with one fp16 scale: w = q * d
+ */
+struct BlockQ8_0 {
+    uint16_t d;
+    int8_t qs[QK8_0];
+};
+
+/**
+ * @brief 256 weights in 8 sub-blocks of 32 with 6-bit scales and mins
+ *
+ * w = d * scale[j] * q - dmin * min[j] for sub-block j.
+ */
+struct BlockQ4_K {
+    uint16_t d;
+    uint16_t dmin;
+    uint8_t scales[K_SCALE_SIZE];
+    uint8_t qs[QK_K / 2];
+};
+
+/**
+ * @brief 256 weights in 16 sub-blocks of 16 with signed 8-bit scales
+ *
+ * w = d * scales[j] * (q - 32) for sub-block j, where q is 6 bits split
+ * into a low nibble (ql) and two high bits (qh).
+ */
+struct BlockQ6_K {
+    uint8_t ql[QK_K / 2];
+    uint8_t qh[QK_K / 4];
+    int8_t scales[QK_K / 16];
+    uint16_t d;
+};
+
+/**
+ * @brief 256 activations as 8-bit values with a float scale (partner of the K formats)
+ */
+struct BlockQ8_K {
+    float d;
+    int8_t qs[QK_K];
+    int16_t bsums[QK_K / 16]; // Sums of each group of 16 quants
+};
+
+static_assert(sizeof(BlockQ4_0) == 18, "BlockQ4_0 must match the GGUF layout");
+static_assert(sizeof(BlockQ8_0) == 34, "BlockQ8_0 must match the GGUF layout");
+static_assert(sizeof(BlockQ4_K) == 144, "BlockQ4_K must match the GGUF layout");
+static_assert(sizeof(BlockQ6_K) == 210, "BlockQ6_K must match the GGUF layout");
+
+/**
+ * @brief Dot product of one weight row with quantized activations
+ *
+ * w points to a row in the weight format; x points to the activations
+ * quantized with quantize_activations() for the same format.
+ */
+using DotKernel = float (*)(int n, const void* w, const void* x);
+
+/**
+ * @brief Convert an IEEE half to float
+ */
+float fp16_to_fp32(uint16_t h);
+
+/**
+ * @brief Convert a float to IEEE half (round to nearest even)
+ */
+uint16_t fp32_to_fp16(float f);
+
+/**
+ * @brief Name of a format ("Q4_0", "Q8_0", "Q4_K", "Q6_K", "F16")
+ */
+std::string format_name(QuantFormat format);
+
+/**
+ * @brief Name of an instruction set ("scalar", "sse", "avx2", "neon")
+ */
+std::string isa_name(KernelIsa isa);
+
+/**
+ * @brief Bytes used by a row of n weights (n must be a multiple of the block size)
+ */
+size_t row_size(QuantFormat format, int n);
+
+/**
+ * @brief Weights per block of a format
+ */
+int block_elements(QuantFormat format);
+
+/**
+ * @brief Quantize a row of weights
+ * @param format Target format
+ * @param x Input weights
+ * @param out Output row of row_size(format, n) bytes
+ * @param n Number of weights
+ */
+void quantize_row(QuantFormat format, const float* x, void* out, int n);
+
+/**
+ * @brief Expand a quantized row back to floats
+ */
+void dequantize_row(QuantFormat format, const void* in, float* y, int n);
+
+/**
+ * @brief Quantize activations into the partner format of a weight format
+ *
+ * Q8_0 for Q4_0 and Q8_0 weights, Q8_K for Q4_K and Q6_K weights, and plain floats
+ * for F16 weights.
+ */
+void quantize_activations(QuantFormat format, const float* x, int n, std::vector<uint8_t>& out);
+
+/**
+ * @brief Whether the CPU running the program supports an instruction set
+ *
+ * SSE kernels need SSSE3 and AVX2 kernels need AVX2, FMA and F16C. NEON
+ * kernels are only built for AArch64.
+ */
+bool isa_supported(KernelIsa isa);
+
+/**
+ * @brief Fastest instruction set supported at runtime
+ */
+KernelIsa best_isa();
+
+/**
+ * @brief Look up a dot kernel
+ * @return Kernel, or nullptr if it was not built for this architecture
+ */
+DotKernel get_dot_kernel(QuantFormat format, KernelIsa isa);
+
+/**
+ * @brief Matrix-vector product y = W x
+ * @param kernel Dot kernel for the weight format
+ * @param format Weight format
+ * @param rows Output rows
+ * @param cols Input columns
+ * @param w Row-major weights in the given format
+ * @param x Activations from quantize_activations()
+ * @param y Output of rows floats
+ */
+void matvec(DotKernel kernel, QuantFormat format, int rows, int cols, const void* w, const void* x, float* y);
+
+#endif // QUANT_KERNELS_H
@@ -0,0 +1,113 @@
+#ifndef SERVER_BATCHING_H
+#define SERVER_BATCHING_H
+
+#include "api_client.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief K simultaneous requests to one model
+ */
+struct BatchingRound {
+    std::string model_name;
+    int concurrency;            // K, requests sent at once
+    int completed;              // Requests that produced all num_predict tokens
+    int failed;
+    int short_requests;         // Stopped before num_predict (EOS), left out of the rates
+    long long tokens;           // Output tokens over all requests
+    double wall_seconds;        // First request sent to last response received
+    double decode_window;       // Earliest first token to latest last token
+    double mean_rate;           // Mean per-request decode tokens/s (server-reported)
+    double min_rate;            // Slowest request's decode tokens/s
+    double mean_ttft;           // Mean time to the first streamed token
+    double max_ttft;            // Longest TTFT (grows with K when the server queues requests)
+    unsigned long peak_memory;  // Peak server RSS in KB
+    long memory_growth;         // Peak RSS minus the K=1 peak in KB (extra KV caches)
+    std::string error;          // First error message
+
+    /**
+     * @brief Output tokens per second over all requests while they were decoding
+     */
+    double aggregate_rate() const;
+};
+
+/**
+ * @brief Measures how well the server batches concurrent requests to one model
+ *
+ * For every K, K threads wait at a common start and then send the same
+ * prompt with the same num_predict. Ollama still ends a request at EOS,
+ * so only requests that produced exactly num_predict tokens are counted
+ * and the rest are reported as short, which keeps the work per counted
+ * request identical. Per-request decode rates come from the server; the
+ * aggregate rate is all output tokens over the window from the first
+ * token of any request to the last token of any request. K=1 is always
+ * measured and is the baseline for the speedup and for the memory growth,
+ * which shows the extra KV caches the parallel slots touch. Whether
+ * requests actually overlap depends on the server's OLLAMA_NUM_PARALLEL;
+ * if it queues them, max TTFT grows with K and the speedup stays near 1.
+ */
+class ServerBatchingBench {
+private:
+    OllamaAPI api;
+    std::string prompt_file;
+    std::string output_file;
+    std::vector<std::string> models;
+    std::vector<int> levels;
+    int num_predict;
+    unsigned session;           // Tag that makes every prompt unique
+
+    /**
+     * @brief Send K requests at once and collect their metrics
+     */
+    BatchingRound measure(const std::string& model, const std::string& prompt, int concurrency);
+
+public:
+    /**
+     * @brief Constructor
+     * @param prompt_path Path to the prompt file
+     * @param output_path Path for JSON results (empty for none)
+     * @param use_memory_mapping Whether the server should load models with mmap
+     */
+    ServerBatchingBench(const std::string& prompt_path, const std::string& output_path,
+                        bool use_memory_mapping = false);
+
+    ~ServerBatchingBench();
+
+    /**
+     * @brief Add a model to test
+     * @param model_name Name of the model
+     */
+    void add_model(const std::string& model_name);
+
+    /**
+     * @brief Set the numbers of simultaneous requests to try
+     * @param concurrency K values (default 1,2,4,8; 1 is always added)
+     */
+    void set_levels(const std::vector<int>& concurrency);
+
+    /**
+     * @brief Set the output length of every request
+     * @param tokens num_predict (default 128)
+     */
+    void set_num_predict(int tokens);
+
+    /**
+     * @brief Run every K against every model and report
+     */
+    void run();
+
+    /**
+     * @brief Print per-request and aggregate rates, speedup, TTFT and memory per K
+     */
+    static void print(const std::vector<BatchingRound>& rounds);
+
+    /**
+     * @brief Rounds as a JSON array
+     */
+    static json to_json(const std::vector<BatchingRound>& rounds);
+};
+
+#endif // SERVER_BATCHING_H
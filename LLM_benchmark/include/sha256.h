@@ -0,0 +1,46 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Incremental SHA-256 (FIPS 180-4), used to address cached payloads by content
+ */
+class Sha256 {
+private:
+    std::array<uint32_t, 8> state;
+    std::array<unsigned char, 64> block;
+    size_t block_used;          // Bytes waiting in block
+    uint64_t total_bytes;
+
+    /**
+     * @brief Compress one 64-byte block into the state
+     */
+    void transform(const unsigned char* data);
+
+public:
+    Sha256();
+
+    /**
+     * @brief Hash more bytes
+     */
+    void update(const void* data, size_t size);
+    void update(const std::string& data);
+
+    /**
+     * @brief Finish the hash (the object must not be updated afterwards)
+     * @return 64 lower-case hex digits
+     */
+    std::string hex_digest();
+
+    /**
+     * @brief Hash a string in one call
+     * @return 64 lower-case hex digits
+     */
+    static std::string hash(const std::string& data);
+};
+
+#endif // SHA256_H
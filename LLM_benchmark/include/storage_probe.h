@@ -0,0 +1,100 @@
+#ifndef STORAGE_PROBE_H
+#define STORAGE_PROBE_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Throughput of one read method and access pattern
+ */
+struct StorageMeasurement {
+    std::string method;       // "buffered", "direct" or "mmap"
+    std::string pattern;      // "sequential" or "random"
+    size_t block_size;        // Bytes per read (or per touched block for mmap)
+    unsigned long long bytes; // Bytes read
+    double seconds;
+
+    /**
+     * @brief Throughput in MB/s
+     */
+    double mb_per_s() const { return seconds > 0 ? bytes / 1048576.0 / seconds : 0.0; }
+};
+
+/**
+ * @brief Measures read throughput of the filesystem holding the Ollama model blobs
+ *
+ * Reads the largest model blob (or a scratch file when the directory holds
+ * no blobs) with buffered read(2), O_DIRECT and mmap plus page touching,
+ * both sequentially and at random block-aligned offsets. The page cache is
+ * dropped for the file with POSIX_FADV_DONTNEED before every pass; pages
+ * that a running server still has mapped cannot be dropped, so the probe
+ * is most accurate with no model loaded.
+ */
+class StorageProbe {
+private:
+    std::string models_dir;
+    size_t block_size;
+    unsigned long long max_bytes; // Read budget for sequential passes (random passes read a quarter)
+    std::string target_file;
+    unsigned long long target_size;
+    bool scratch_file;            // target_file was created by the probe and is removed afterwards
+
+    /**
+     * @brief Pick the file to read, creating a scratch file if needed
+     * @return true if a readable target exists
+     */
+    bool prepare();
+
+    /**
+     * @brief Block-aligned offsets in random order
+     * @param bytes Total bytes to cover
+     * @return Offsets into the target file
+     */
+    std::vector<unsigned long long> random_offsets(unsigned long long bytes) const;
+
+    bool measure_buffered(bool sequential, StorageMeasurement& out);
+    bool measure_direct(bool sequential, StorageMeasurement& out);
+    bool measure_mmap(bool sequential, StorageMeasurement& out);
+
+public:
+    /**
+     * @brief Constructor
+     * @param dir Models directory (empty for $OLLAMA_MODELS or ~/.ollama/models)
+     * @param block_kb Read block size in KB
+     * @param size_mb Bytes to read per sequential pass in MB
+     */
+    explicit StorageProbe(const std::string& dir = "", size_t block_kb = 1024, unsigned long long size_mb = 512);
+
+    /**
+     * @brief Destructor (removes the scratch file, if any)
+     */
+    ~StorageProbe();
+
+    /**
+     * @brief Run every method and pattern
+     * @return Measurements (empty if no target file could be read)
+     */
+    std::vector<StorageMeasurement> run();
+
+    /**
+     * @brief Directory being probed
+     */
+    const std::string& get_models_dir() const;
+
+    /**
+     * @brief Locate Ollama's models directory
+     * @return $OLLAMA_MODELS, else ~/.ollama/models, else the Linux service default
+     */
+    static std::string default_models_dir();
+
+    /**
+     * @brief Find the weights blob of a model through its manifest
+     * @param models_dir Models directory
+     * @param model Model name (e.g. "tinyllama:latest" or "user/model:tag")
+     * @param size Receives the blob size in bytes
+     * @return Path to the blob, empty if not found
+     */
+    static std::string find_model_blob(const std::string& models_dir, const std::string& model, unsigned long long& size);
+};
+
+#endif // STORAGE_PROBE_H
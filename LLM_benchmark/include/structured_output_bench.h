@@ -0,0 +1,109 @@
+#ifndef STRUCTURED_OUTPUT_BENCH_H
+#define STRUCTURED_OUTPUT_BENCH_H
+
+#include "api_client.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief One prompt section generated in one output mode
+ */
+struct StructuredRun {
+    std::string model_name;
+    std::string section;
+    std::string mode;           // "free", "json" (format: "json") or "schema" (format: the schema)
+    bool ok;                    // Whether the request succeeded
+    int prompt_tokens;
+    double prefill_seconds;
+    double ttft_seconds;        // Arrival of the first streamed piece
+    int output_tokens;
+    double decode_seconds;
+    bool valid_json;            // The streaming validator accepted the whole output
+    int invalid_at_piece;       // 1-based piece where the output stopped being JSON (0 if valid)
+    bool schema_ok;             // The output parsed and matched the schema
+    std::string error;          // Backend message, or why the output is not valid
+
+    /**
+     * @brief Server-side decode time per output token in milliseconds
+     */
+    double ms_per_token() const;
+};
+
+/**
+ * @brief Measures what constrained (JSON / JSON-schema) decoding costs
+ *
+ * Each prompt section is sent three times with the same instruction to
+ * answer as JSON matching a schema: unconstrained, with format "json",
+ * and with the schema itself as the format. The server then restricts
+ * sampling to tokens that keep the output valid, which costs time per
+ * token and sets up a grammar before the first token. Every request
+ * starts with its own tag so no mode reuses another's cached prompt.
+ * Output is streamed into a JsonStreamValidator as it arrives, so
+ * invalid output is caught at the piece where it goes wrong; complete
+ * documents are then checked against the schema.
+ */
+class StructuredOutputBench {
+private:
+    json schema;
+    int max_tokens;
+    unsigned session;           // Tag that makes every prompt unique
+
+public:
+    /**
+     * @brief Constructor
+     * @param output_schema Schema of the requested answer
+     * @param num_predict Output token limit per request
+     */
+    explicit StructuredOutputBench(const json& output_schema = default_schema(), int num_predict = 256);
+
+    /**
+     * @brief Answer object with a summary, key points and a confidence level
+     */
+    static json default_schema();
+
+    /**
+     * @brief Read a JSON schema from a file
+     * @return false if the file cannot be read or is not a JSON object
+     */
+    static bool load_schema(const std::string& path, json& schema);
+
+    /**
+     * @brief Parse an output the streaming validator accepted and check it against the schema
+     *
+     * The validator checks syntax only, so a lone surrogate escape, an
+     * out-of-range number or bad UTF-8 can still be rejected here.
+     *
+     * @param text Complete output
+     * @param schema Schema to match
+     * @param parsed Set to false if the text does not parse
+     * @param problem Receives why the output does not parse or match
+     * @return true if the output parsed and matched the schema
+     */
+    static bool check_output(const std::string& text, const json& schema, bool& parsed, std::string& problem);
+
+    /**
+     * @brief Run every section in every mode on one model
+     * @param api Ollama client (format is a server feature)
+     * @param model Model name
+     * @param sections Prompt sections as (title, text)
+     * @return Three runs per section
+     */
+    std::vector<StructuredRun> run(OllamaAPI& api, const std::string& model,
+                                   const std::vector<std::pair<std::string, std::string>>& sections);
+
+    /**
+     * @brief Print decode overhead and TTFT change of each constrained mode against free output
+     */
+    static void print(const std::vector<StructuredRun>& runs);
+
+    /**
+     * @brief Runs as a JSON array
+     */
+    static json to_json(const std::vector<StructuredRun>& runs);
+};
+
+#endif // STRUCTURED_OUTPUT_BENCH_H
@@ -3,6 +3,32 @@
 
 #include <string>
 #include <utility>
+#include <vector>
+
+/**
+ * @brief Snapshot of the kernel swap counters
+ */
+struct SwapStats {
+    unsigned long pages_swapped_in = 0;   // pswpin from /proc/vmstat
+    unsigned long pages_swapped_out = 0;  // pswpout from /proc/vmstat
+    unsigned long swap_total_kb = 0;      // SwapTotal from /proc/meminfo
+    unsigned long swap_free_kb = 0;       // SwapFree from /proc/meminfo
+};
+
+/**
+ * @brief Swap activity observed over an interval
+ */
+struct SwapActivity {
+    unsigned long pages_in = 0;           // Pages swapped in during the interval
+    unsigned long pages_out = 0;          // Pages swapped out during the interval
+    long swap_used_delta_kb = 0;          // Change in used swap (end - start)
+    unsigned long peak_swap_growth_kb = 0; // Largest drop in SwapFree below the start value
+    
+    /**
+     * @brief Whether any pages were swapped in during the interval
+     */
+    bool swap_in_active() const { return pages_in > 0; }
+};
 
 /**
  * @brief Configure swap file for better performance with large models
@@ -13,6 +39,48 @@
  */
 bool configure_swap(unsigned long swap_size_mb, int swappiness);
 
+/**
+ * @brief Read a procfs/sysfs value
+ * 
+ * @param path File to read (e.g. /proc/sys/vm/swappiness)
+ * @return File contents without trailing whitespace, empty if unreadable
+ */
+std::string read_system_value(const std::string& path);
+
+/**
+ * @brief Write a procfs/sysfs value directly (no shell-out)
+ * 
+ * @param path File to write (e.g. /proc/sys/vm/swappiness)
+ * @param value Value to write; a trailing newline is appended
+ * @return true if the full value was written, false otherwise
+ */
+bool write_system_value(const std::string& path, const std::string& value);
+
+/**
+ * @brief Allocate a swap file and write its swap header (like mkswap)
+ * 
+ * @param path Swap file path (created with mode 0600)
+ * @param size_mb Size of the swap file in MB
+ * @return true if successful, false otherwise
+ */
+bool create_swap_file(const std::string& path, unsigned long size_mb);
+
+/**
+ * @brief Enable a prepared swap file with swapon(2)
+ * 
+ * @param path Swap file path
+ * @return true if successful, false otherwise
+ */
+bool enable_swap_file(const std::string& path);
+
+/**
+ * @brief Disable a swap file with swapoff(2)
+ * 
+ * @param path Swap file path
+ * @return true if the file was in use and is now disabled
+ */
+bool disable_swap_file(const std::string& path);
+
 /**
  * @brief Get the total and available system memory
  * 
@@ -20,6 +88,30 @@ bool configure_swap(unsigned long swap_size_mb, int swappiness);
  */
 std::pair<unsigned long, unsigned long> get_system_memory();
 
+/**
+ * @brief Read the current swap counters from /proc/vmstat and /proc/meminfo
+ * 
+ * @return Swap counter snapshot (zeros if unavailable)
+ */
+SwapStats get_swap_stats();
+
+/**
+ * @brief Compute the swap activity between two snapshots
+ * 
+ * @param before Snapshot taken at the start of the interval
+ * @param after Snapshot taken at the end of the interval
+ * @return Swap activity over the interval
+ */
+SwapActivity swap_activity_between(const SwapStats& before, const SwapStats& after);
+
+/**
+ * @brief Convert a page count to KB using the system page size
+ * 
+ * @param pages Number of pages
+ * @return Size in KB
+ */
+unsigned long pages_to_kb(unsigned long pages);
+
 /**
  * @brief Get Ollama process memory usage
  * 
@@ -27,6 +119,21 @@ std::pair<unsigned long, unsigned long> get_system_memory();
  */
 unsigned long get_ollama_memory_usage();
 
+/**
+ * @brief Find processes by executable name
+ * 
+ * @param name Process name as shown in /proc/PID/comm (e.g. "ollama")
+ * @return PIDs of matching processes
+ */
+std::vector<int> find_process_ids(const std::string& name);
+
+/**
+ * @brief Create a directory and any missing parents (mkdir -p)
+ * @param dir Directory path
+ * @return false if a component could not be created
+ */
+bool make_directories(const std::string& dir);
+
 /**
  * @brief Format memory size for human-readable display
  * 
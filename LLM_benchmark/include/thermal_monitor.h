@@ -0,0 +1,139 @@
+#ifndef THERMAL_MONITOR_H
+#define THERMAL_MONITOR_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+/**
+ * @brief One point on the thermal/frequency timeline
+ */
+struct ThermalSample {
+    double time_s;          // Seconds since monitoring started
+    double max_temp_c;      // Hottest thermal zone in degrees Celsius
+    double mean_freq_mhz;   // Mean current frequency across CPUs
+    double freq_ratio;      // Highest current/scaling_max_freq ratio across CPUs
+    bool throttled;         // Throttle counters rose, or no CPU reached the throttle ratio mid-request
+    bool boundary;          // Taken at a request boundary, when the CPUs may be idle
+};
+
+/**
+ * @brief Thermal state over a time window
+ */
+struct ThermalSummary {
+    int samples = 0;
+    int throttled_samples = 0;
+    double max_temp_c = 0.0;
+    double mean_freq_mhz = 0.0;     // Over samples taken while the request ran
+    double min_freq_ratio = 1.0;
+
+    /**
+     * @brief Whether any sample in the window ran at reduced frequency
+     */
+    bool throttled() const { return throttled_samples > 0; }
+};
+
+/**
+ * @brief Class to sample CPU temperature and frequency from sysfs
+ *
+ * Reads /sys/class/thermal/thermal_zone<N>/temp and
+ * /sys/devices/system/cpu/cpu<N>/cpufreq/scaling_cur_freq under a
+ * configurable root so it can run against a fixture tree. A sample is
+ * marked throttled when the thermal_throttle event counters went up since
+ * the previous sample, or, for samples taken while a request runs, when no
+ * CPU runs at or above throttle_ratio of the scaling_max_freq found at
+ * startup. Boundary samples from sample_now() only mark the window: the CPUs
+ * are often still idling then, so their frequency is not judged.
+ */
+class ThermalMonitor {
+private:
+    std::mutex mtx;
+    std::atomic<bool> should_run;
+    std::thread monitor_thread;
+    std::string sysfs_root;
+    int sample_interval_ms;
+    double throttle_ratio;
+    std::chrono::steady_clock::time_point start_time;
+    std::vector<std::string> zone_paths;                          // thermal_zone<N>/temp paths
+    std::vector<std::pair<std::string, unsigned long>> cpu_paths; // scaling_cur_freq and scaling_max_freq (kHz)
+    std::vector<std::string> throttle_paths;                      // thermal_throttle/*_throttle_count paths
+    unsigned long long throttle_events;                           // Counter total at the previous sample
+    std::vector<ThermalSample> samples;
+
+    /**
+     * @brief Locate thermal zones and cpufreq directories under the root
+     */
+    void discover();
+
+    /**
+     * @brief Sum the thermal_throttle event counters of all CPUs
+     */
+    unsigned long long read_throttle_count() const;
+
+    /**
+     * @brief Read all zones and CPUs once
+     * @param boundary Whether the sample marks a request boundary rather than a running request
+     * @return Current sample
+     */
+    ThermalSample take_sample(bool boundary);
+
+    /**
+     * @brief Monitor thread function
+     */
+    void monitor_thermal();
+
+public:
+    /**
+     * @brief Constructor
+     * @param root Root under which /sys is resolved
+     * @param interval_ms Sampling interval in milliseconds
+     * @param ratio Frequency ratio below which a sample counts as throttled
+     */
+    explicit ThermalMonitor(const std::string& root = "/", int interval_ms = 1000, double ratio = 0.9);
+
+    /**
+     * @brief Destructor
+     */
+    ~ThermalMonitor();
+
+    /**
+     * @brief Whether any thermal zone or cpufreq entry was found
+     */
+    bool available() const;
+
+    /**
+     * @brief Start monitoring (clears previous samples)
+     */
+    void start();
+
+    /**
+     * @brief Stop monitoring
+     */
+    void stop();
+
+    /**
+     * @brief Record a boundary sample immediately, at the start or end of a request
+     * @return Seconds since monitoring started
+     */
+    double sample_now();
+
+    /**
+     * @brief Summarize the samples within a time window
+     * @param from_s Window start in seconds since monitoring started
+     * @param to_s Window end in seconds since monitoring started
+     * @return Summary of the window
+     */
+    ThermalSummary summarize(double from_s, double to_s);
+
+    /**
+     * @brief Get the full timeline
+     * @return Samples in time order
+     */
+    std::vector<ThermalSample> get_samples();
+};
+
+#endif // THERMAL_MONITOR_H
@@ -0,0 +1,112 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include "gguf_file.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * @brief Tokenizer built from a GGUF vocabulary
+ *
+ * Two tokenizer models are supported, as named by tokenizer.ggml.model:
+ *
+ * - "llama" (SentencePiece): follows llama.cpp's SPM tokenizer. Spaces
+ *   become U+2581, the text is split into UTF-8 characters, and adjacent
+ *   pieces are merged while the merged piece is in the vocabulary, highest
+ *   score first. Characters with no piece fall back to <0xXX> byte tokens.
+ * - "gpt2" (byte-level BPE, used by Llama 3, Qwen, Mistral Nemo, ...):
+ *   the text is pre-split into words with the GPT-2 or Llama 3 pattern,
+ *   each byte maps to one base token, and pairs are merged lowest rank
+ *   first using tokenizer.ggml.merges. Merges are looked up by token id
+ *   pair in a hash table and each distinct word is merged once per call.
+ *
+ * Unicode letter/number classes of the pre-split patterns are approximated
+ * (ASCII exactly, other code points by block), and special tokens written
+ * in the text are tokenized as plain text.
+ */
+class Tokenizer {
+private:
+    enum class Model { SPM, BPE };
+
+    Model model;
+    std::vector<std::string> pieces;
+    std::vector<float> scores;
+    std::vector<int> types;  // tokenizer.ggml.token_type (1 normal, 3 control, 6 byte)
+    std::unordered_map<std::string_view, int> piece_ids; // Views into pieces
+    int byte_tokens[256];    // SPM <0xXX> tokens, BPE base tokens
+    int bos_id;
+    int eos_id;
+    int eot_id;
+    int unk_id;
+    bool add_bos;
+    bool add_space_prefix;
+    bool llama3_split;       // Llama 3 pre-split pattern instead of GPT-2's
+
+    // BPE: (left id << 32 | right id) -> (rank, merged id)
+    std::unordered_map<uint64_t, std::pair<int, int>> merges;
+    std::unordered_map<uint32_t, unsigned char> char_bytes; // Byte-level code point -> byte
+
+    bool load_merges(const json& metadata);
+    void encode_spm(const std::string& input, std::vector<int>& ids) const;
+    void encode_bpe(const std::string& input, std::vector<int>& ids) const;
+
+    /**
+     * @brief Split text into the words BPE merges within
+     * @return Byte ranges of the words, in order
+     */
+    std::vector<std::pair<size_t, size_t>> split_words(const std::string& text) const;
+
+    /**
+     * @brief Merge the base tokens of one word
+     */
+    void merge_word(const std::string& text, size_t start, size_t length, std::vector<int>& out) const;
+
+public:
+    Tokenizer();
+
+    Tokenizer(const Tokenizer&) = delete;
+    Tokenizer& operator=(const Tokenizer&) = delete;
+
+    /**
+     * @brief Load the vocabulary of a model
+     * @param file Open GGUF file
+     * @return false if the file has no vocabulary or uses another tokenizer model
+     */
+    bool load(const GgufFile& file);
+
+    /**
+     * @brief Split text into token ids
+     * @param text UTF-8 text
+     * @param with_bos Prepend the BOS token if the model asks for it
+     */
+    std::vector<int> encode(const std::string& text, bool with_bos = true) const;
+
+    /**
+     * @brief Number of tokens in a text, without BOS
+     */
+    size_t count(const std::string& text) const;
+
+    /**
+     * @brief Text of one token (empty for control tokens)
+     */
+    std::string decode(int token) const;
+
+    /**
+     * @brief Whether a token ends generation (EOS or end-of-turn)
+     */
+    bool is_end(int token) const;
+
+    /**
+     * @brief Tokenizer model name ("spm" or "bpe")
+     */
+    std::string kind() const;
+
+    int vocab_size() const;
+    int bos() const;
+    int eos() const;
+};
+
+#endif // TOKENIZER_H
@@ -0,0 +1,126 @@
+#ifndef VISION_BENCH_H
+#define VISION_BENCH_H
+
+#include "api_client.h"
+#include "image_pipeline.h"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+/**
+ * @brief One image request to a vision-language model
+ */
+struct VisionPoint {
+    std::string model_name;
+    std::string image;          // File name, or "pattern" for the generated image
+    bool native;                // Sent as the original file (false: resized for the sweep)
+    int width;
+    int height;
+    size_t payload_bytes;       // Encoded image size before base64
+    bool ok;
+    int prompt_tokens;          // Prompt tokens including the image
+    int image_tokens;           // Prompt tokens beyond the text-only request
+    double prefill_seconds;     // Prompt eval with the image
+    double vision_seconds;      // Prompt eval beyond the text-only request (image encoding)
+    double ttft_seconds;        // Arrival of the first streamed piece
+    int output_tokens;
+    double decode_seconds;
+    unsigned long peak_memory;  // Peak server RSS in KB
+    std::string error;
+
+    long pixels() const;
+
+    /**
+     * @brief Text decode throughput
+     * @return Output tokens per second, or 0 if not reported
+     */
+    double decode_rate() const;
+};
+
+/**
+ * @brief Vision-language workload: images through the "images" field
+ *
+ * Every image in a directory is sent as it is (PNG and JPEG; PPM is
+ * converted to PNG), then the resolution sweep scales the images a
+ * decoder can read, or a generated test pattern if there are none, so
+ * that the longest side has each requested size. All payloads are
+ * prepared by an ImagePipeline before the first request, so timed
+ * requests do no image work. Prompt eval covers both the vision encoder
+ * and the text prompt, so each model also answers the same prompt
+ * without an image; the difference is reported as the vision time and
+ * the image's token count. Text decode is timed separately from the
+ * generated tokens, and the server's memory is sampled per request.
+ * Every prompt starts with its own tag so no request reuses another's
+ * cached prompt.
+ */
+class VisionBench {
+private:
+    std::string image_dir;
+    std::vector<int> sizes;     // Longest side in pixels for the sweep
+    int max_tokens;
+    unsigned session;           // Tag that makes every prompt unique
+    ImagePipeline pipeline;
+    std::vector<ImagePayload> payloads; // Native images first, then the sweep
+    bool prepared;
+
+    /**
+     * @brief List the directory and prepare every native and scaled payload
+     */
+    void prepare_payloads();
+
+    /**
+     * @brief Send one payload and measure it against the text-only request
+     */
+    VisionPoint measure(OllamaAPI& api, const std::string& model, const ImagePayload& payload,
+                        int text_tokens, double text_prefill);
+
+public:
+    /**
+     * @brief Constructor
+     * @param directory Image directory (empty to use only the test pattern)
+     * @param sweep_sizes Longest side in pixels for the resolution sweep
+     * @param num_predict Output token limit per request
+     * @param threads Preprocessing threads (0 for every allowed CPU)
+     * @param cache_dir Payload cache directory ("" for the default, "-" to disable)
+     */
+    explicit VisionBench(const std::string& directory = "",
+                         const std::vector<int>& sweep_sizes = default_sizes(), int num_predict = 64,
+                         int threads = 0, const std::string& cache_dir = "");
+
+    /**
+     * @brief 224, 448, 672 and 896 pixels (common vision-encoder tile sizes)
+     */
+    static std::vector<int> default_sizes();
+
+    /**
+     * @brief Instruction sent with every image
+     */
+    static const std::string& prompt();
+
+    /**
+     * @brief Send every image, then every sweep size, to one model
+     * @param api Ollama client (images are a server feature)
+     * @param model Model name
+     * @return One point per request, native images first
+     */
+    std::vector<VisionPoint> run(OllamaAPI& api, const std::string& model);
+
+    /**
+     * @brief Cost of preparing the payloads (empty until the first run)
+     */
+    const PreprocessStats& preprocess_stats() const;
+
+    /**
+     * @brief Print vision time, image tokens, decode rate and memory by image and resolution
+     */
+    static void print(const std::vector<VisionPoint>& points);
+
+    /**
+     * @brief Points as a JSON array
+     */
+    static json to_json(const std::vector<VisionPoint>& points);
+};
+
+#endif // VISION_BENCH_H
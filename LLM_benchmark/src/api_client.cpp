@@ -9,8 +9,73 @@ size_t OllamaAPI::WriteCallback(void* contents, size_t size, size_t nmemb, std::
     return total_size;
 }
 
+void OllamaAPI::handle_stream_line(const std::string& line, StreamState* state,
+                                   std::chrono::steady_clock::time_point arrival) {
+    if (line.empty()) {
+        return;
+    }
+    try {
+        json chunk = json::parse(line);
+        std::string piece = chunk.value("response", "");
+        if (!piece.empty()) {
+            state->text += piece;
+            if (state->token_times) {
+                state->token_times->push_back(std::chrono::duration<double>(arrival - state->start).count());
+            }
+            if (state->echo) {
+                std::cout << piece << std::flush;
+            }
+            if (state->on_piece && *state->on_piece) {
+                (*state->on_piece)(piece);
+            }
+        }
+        if (chunk.value("done", false) || chunk.contains("error")) {
+            state->final_chunk = chunk;
+        }
+    } catch (json::parse_error& e) {
+        std::cerr << "JSON parse error in stream: " << e.what() << std::endl;
+    }
+}
+
+size_t OllamaAPI::StreamCallback(void* contents, size_t size, size_t nmemb, StreamState* state) {
+    size_t total_size = size * nmemb;
+    auto now = std::chrono::steady_clock::now();
+    state->pending.append(static_cast<char*>(contents), total_size);
+    
+    // Each complete line is one JSON chunk
+    size_t line_start = 0;
+    size_t newline;
+    while ((newline = state->pending.find('\n', line_start)) != std::string::npos) {
+        handle_stream_line(state->pending.substr(line_start, newline - line_start), state, now);
+        line_start = newline + 1;
+    }
+    state->pending.erase(0, line_start);
+    return total_size;
+}
+
+double GenerationMetrics::decode_rate() const {
+    return (eval_count > 0 && eval_duration > 0) ? eval_count / eval_duration : 0.0;
+}
+
+double GenerationMetrics::prefill_rate() const {
+    return (prompt_eval_count > 0 && prompt_eval_duration > 0) ? 
+           prompt_eval_count / prompt_eval_duration : 0.0;
+}
+
 OllamaAPI::OllamaAPI(const std::string& url, bool memory_mapping) 
-    : base_url(url), use_mmap(memory_mapping) {}
+    : base_url(url), use_mmap(memory_mapping), num_ctx(0) {}
+
+void OllamaAPI::set_num_ctx(int context) {
+    num_ctx = context;
+}
+
+RuntimeConfig OllamaAPI::runtime_config() const {
+    RuntimeConfig config;
+    if (num_ctx > 0) {
+        config.context_length = num_ctx;
+    }
+    return config;
+}
 
 bool OllamaAPI::initialize() {
     return curl_global_init(CURL_GLOBAL_ALL) == CURLE_OK;
@@ -20,6 +85,10 @@ void OllamaAPI::cleanup() {
     curl_global_cleanup();
 }
 
+std::string OllamaAPI::name() const {
+    return "ollama";
+}
+
 std::vector<std::string> OllamaAPI::list_models() {
     std::vector<std::string> models;
     std::string response;
@@ -55,105 +124,212 @@ std::vector<std::string> OllamaAPI::list_models() {
     return models;
 }
 
-std::string OllamaAPI::generate(
-    const std::string& model, 
-    const std::string& prompt, 
-    bool stream, 
-    bool verbose
-) {
-    std::string response_text;
+std::vector<ModelInfo> OllamaAPI::list_model_info() {
+    std::vector<ModelInfo> models;
+    std::string response;
     
+    CURL* curl = curl_easy_init();
+    if (curl) {
+        std::string url = base_url + "/api/tags";
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+        
+        CURLcode res = curl_easy_perform(curl);
+        if (res == CURLE_OK) {
+            try {
+                json j = json::parse(response);
+                if (j.contains("models") && j["models"].is_array()) {
+                    for (const auto& model : j["models"]) {
+                        ModelInfo info;
+                        info.name = model.value("name", "");
+                        info.size = model.value("size", 0ULL);
+                        if (model.contains("details") && model["details"].is_object()) {
+                            info.family = model["details"].value("family", "");
+                            info.parameter_size = model["details"].value("parameter_size", "");
+                            info.quantization_level = model["details"].value("quantization_level", "");
+                        }
+                        models.push_back(info);
+                    }
+                }
+            } catch (json::exception& e) {
+                std::cerr << "JSON parse error: " << e.what() << std::endl;
+            }
+        } else {
+            std::cerr << "cURL error: " << curl_easy_strerror(res) << std::endl;
+        }
+        
+        curl_easy_cleanup(curl);
+    }
+    
+    return models;
+}
+
+json OllamaAPI::request_options(const json* options) const {
+    json merged = {
+        {"num_gpu", 1},      // Use GPU if available
+        {"temperature", 0.7},
+        {"use_mmap", use_mmap}   // Memory-mapped model loading
+    };
+    if (num_ctx > 0) {
+        merged["num_ctx"] = num_ctx;
+    }
+    if (options && options->is_object()) {
+        merged.update(*options);
+    }
+    return merged;
+}
+
+CURLcode OllamaAPI::post_json(const std::string& path, const json& body, std::string& response,
+                              StreamState* stream_state, long* http_code) {
     CURL* curl = curl_easy_init();
     if (!curl) {
-        return "Error: Failed to initialize cURL";
+        return CURLE_FAILED_INIT;
     }
     
-    std::string url = base_url + "/api/generate";
+    std::string url = base_url + path;
     struct curl_slist* headers = nullptr;
     headers = curl_slist_append(headers, "Content-Type: application/json");
+    std::string request_str = body.dump();
+    
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request_str.c_str());
+    if (stream_state) {
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, StreamCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, stream_state);
+        stream_state->start = std::chrono::steady_clock::now();
+    } else {
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    }
+    
+    CURLcode res = curl_easy_perform(curl);
+    if (http_code) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, http_code);
+    }
+    
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
     
+    if (stream_state) {
+        // Errors raised before streaming starts arrive as one body without a newline
+        if (!stream_state->pending.empty()) {
+            handle_stream_line(stream_state->pending, stream_state, std::chrono::steady_clock::now());
+            stream_state->pending.clear();
+        }
+        // The final chunk has the metrics; the text is the concatenated pieces
+        if (!stream_state->final_chunk.is_null()) {
+            json final_chunk = stream_state->final_chunk;
+            if (!final_chunk.contains("error")) {
+                final_chunk["response"] = stream_state->text;
+            }
+            response = final_chunk.dump();
+        } else {
+            response = stream_state->text;
+        }
+    }
+    return res;
+}
+
+GenerationMetrics OllamaAPI::parse_metrics(const json& j, double wall_time) {
+    // Ollama reports durations in nanoseconds
+    GenerationMetrics parsed;
+    parsed.wall_time = wall_time;
+    parsed.prompt_eval_count = j.value("prompt_eval_count", 0);
+    parsed.eval_count = j.value("eval_count", 0);
+    parsed.total_duration = j.value("total_duration", 0.0) / 1e9;
+    parsed.load_duration = j.value("load_duration", 0.0) / 1e9;
+    parsed.prompt_eval_duration = j.value("prompt_eval_duration", 0.0) / 1e9;
+    parsed.eval_duration = j.value("eval_duration", 0.0) / 1e9;
+    return parsed;
+}
+
+std::string OllamaAPI::generate(
+    const std::string& model, 
+    const std::string& prompt, 
+    bool stream, 
+    bool verbose,
+    GenerationMetrics* metrics,
+    const json* options
+) {
     // Create JSON request body with memory options
     json request_body = {
         {"model", model},
         {"prompt", prompt},
         {"stream", stream},
-        {"options", {
-            {"num_gpu", 1},      // Use GPU if available
-            {"temperature", 0.7},
-            {"mmap", use_mmap}   // Add memory-mapped option
-        }}
+        {"options", request_options(options)}
     };
     
-    std::string request_str = request_body.dump();
-    
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request_str.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_text);
+    std::vector<double> token_times;
+    StreamState stream_state;
+    stream_state.token_times = &token_times;
+    stream_state.echo = verbose;
     
     if (verbose) {
         std::cout << "[DEBUG] Requesting completion from " << model << std::endl;
-        std::cout << "[DEBUG] Request body: " << request_str << std::endl;
+        std::cout << "[DEBUG] Request body: " << request_body.dump() << std::endl;
         std::cout << "[DEBUG] Memory mapping: " << (use_mmap ? "enabled" : "disabled") << std::endl;
     }
     
+    std::string response_text;
     auto start_time = std::chrono::high_resolution_clock::now();
-    CURLcode res = curl_easy_perform(curl);
+    CURLcode res = post_json("/api/generate", request_body, response_text, stream ? &stream_state : nullptr);
     auto end_time = std::chrono::high_resolution_clock::now();
     
     std::chrono::duration<double> elapsed = end_time - start_time;
     
+    if (stream && verbose) {
+        std::cout << std::endl;
+    }
+    
     if (res != CURLE_OK) {
         std::cerr << "cURL error: " << curl_easy_strerror(res) << std::endl;
-        response_text = "Error: Failed to connect to Ollama API";
+        return "Error: Failed to connect to Ollama API";
     } else if (verbose) {
         std::cout << "[DEBUG] Raw response received with length: " << response_text.length() << " bytes" << std::endl;
         std::cout << "[DEBUG] API request took: " << elapsed.count() << "s" << std::endl;
     }
     
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-    
     // Parse the response for metrics
     if (!response_text.empty()) {
         try {
             json j = json::parse(response_text);
+            if (j.contains("error")) {
+                return "Error: " + j["error"].get<std::string>();
+            }
             
-            // Extract and display metrics similar to Ollama CLI
+            GenerationMetrics parsed = parse_metrics(j, elapsed.count());
+            parsed.token_times = std::move(token_times);
+            
+            if (metrics) {
+                *metrics = parsed;
+            }
+            
+            // Display metrics similar to Ollama CLI
             if (verbose && j.contains("eval_count") && j.contains("eval_duration")) {
-                double total_duration = elapsed.count();
-                int eval_count = j["eval_count"];
-                double eval_duration = j["eval_duration"].get<double>() / 1000.0; // Convert ms to s
-                double token_rate = (eval_count > 0 && eval_duration > 0) ? 
-                                    eval_count / eval_duration : 0;
-                
-                // Display metrics in similar format to Ollama CLI
                 std::cout << "\nPERFORMANCE METRICS:" << std::endl;
                 std::cout << std::left << std::setw(25) << "total duration:" 
-                        << total_duration << "s" << std::endl;
+                        << parsed.wall_time << "s" << std::endl;
+                std::cout << std::left << std::setw(25) << "load duration:" 
+                        << parsed.load_duration << "s" << std::endl;
                 
                 if (j.contains("prompt_eval_count")) {
-                    int prompt_tokens = j["prompt_eval_count"];
-                    double prompt_duration = j["prompt_eval_duration"].get<double>() / 1000.0;
-                    double prompt_rate = (prompt_tokens > 0 && prompt_duration > 0) ? 
-                                        prompt_tokens / prompt_duration : 0;
-                    
                     std::cout << std::left << std::setw(25) << "prompt eval count:" 
-                            << prompt_tokens << " token(s)" << std::endl;
+                            << parsed.prompt_eval_count << " token(s)" << std::endl;
                     std::cout << std::left << std::setw(25) << "prompt eval duration:" 
-                            << prompt_duration << "s" << std::endl;
+                            << parsed.prompt_eval_duration << "s" << std::endl;
                     std::cout << std::left << std::setw(25) << "prompt eval rate:" 
-                            << std::fixed << std::setprecision(2) << prompt_rate 
+                            << std::fixed << std::setprecision(2) << parsed.prefill_rate() 
                             << " tokens/s" << std::endl;
                 }
                 
                 std::cout << std::left << std::setw(25) << "eval count:" 
-                        << eval_count << " token(s)" << std::endl;
+                        << parsed.eval_count << " token(s)" << std::endl;
                 std::cout << std::left << std::setw(25) << "eval duration:" 
-                        << eval_duration << "s" << std::endl;
+                        << parsed.eval_duration << "s" << std::endl;
                 std::cout << std::left << std::setw(25) << "eval rate:" 
-                        << std::fixed << std::setprecision(2) << token_rate 
+                        << std::fixed << std::setprecision(2) << parsed.decode_rate() 
                         << " tokens/s" << std::endl;
             }
             
@@ -167,4 +343,241 @@ std::string OllamaAPI::generate(
     }
     
     return response_text;
-}
\ No newline at end of file
+}
+
+std::string OllamaAPI::generate_with_context(
+    const std::string& model,
+    const std::string& prompt,
+    const std::string& system,
+    std::vector<int>& context,
+    GenerationMetrics* metrics,
+    const json* options
+) {
+    json request_body = {
+        {"model", model},
+        {"prompt", prompt},
+        {"stream", false},
+        {"options", request_options(options)}
+    };
+    if (!system.empty()) {
+        request_body["system"] = system;
+    }
+    if (!context.empty()) {
+        request_body["context"] = context;
+    }
+    
+    std::string response_text;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    CURLcode res = post_json("/api/generate", request_body, response_text);
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    if (res != CURLE_OK) {
+        std::cerr << "cURL error: " << curl_easy_strerror(res) << std::endl;
+        return "Error: Failed to connect to Ollama API";
+    }
+    
+    try {
+        json j = json::parse(response_text);
+        if (j.contains("error")) {
+            return "Error: " + j["error"].get<std::string>();
+        }
+        if (metrics) {
+            *metrics = parse_metrics(j, elapsed.count());
+        }
+        if (j.contains("context") && j["context"].is_array()) {
+            context = j["context"].get<std::vector<int>>();
+        }
+        return j.value("response", "");
+    } catch (json::exception& e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        return "Error: Failed to parse response";
+    }
+}
+
+std::string OllamaAPI::generate_structured(
+    const std::string& model,
+    const std::string& prompt,
+    const json& format,
+    GenerationMetrics* metrics,
+    const json* options,
+    const std::function<void(const std::string&)>& on_piece
+) {
+    json request_body = {
+        {"model", model},
+        {"prompt", prompt},
+        {"stream", true},
+        {"options", request_options(options)}
+    };
+    if (!format.is_null()) {
+        request_body["format"] = format;
+    }
+    
+    std::vector<double> token_times;
+    StreamState stream_state;
+    stream_state.token_times = &token_times;
+    stream_state.echo = false;
+    stream_state.on_piece = &on_piece;
+    
+    std::string response_text;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    CURLcode res = post_json("/api/generate", request_body, response_text, &stream_state);
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    if (res != CURLE_OK) {
+        std::cerr << "cURL error: " << curl_easy_strerror(res) << std::endl;
+        return "Error: Failed to connect to Ollama API";
+    }
+    
+    try {
+        json j = json::parse(response_text);
+        if (j.contains("error")) {
+            return "Error: " + j["error"].get<std::string>();
+        }
+        if (metrics) {
+            *metrics = parse_metrics(j, elapsed.count());
+            metrics->token_times = std::move(token_times);
+        }
+        return j.value("response", "");
+    } catch (json::exception& e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        return "Error: Failed to parse response";
+    }
+}
+
+std::string OllamaAPI::generate_with_images(
+    const std::string& model,
+    const std::string& prompt,
+    const std::vector<std::string>& images,
+    GenerationMetrics* metrics,
+    const json* options
+) {
+    json request_body = {
+        {"model", model},
+        {"prompt", prompt},
+        {"stream", true},
+        {"options", request_options(options)}
+    };
+    if (!images.empty()) {
+        request_body["images"] = images;
+    }
+    
+    std::vector<double> token_times;
+    StreamState stream_state;
+    stream_state.token_times = &token_times;
+    stream_state.echo = false;
+    
+    std::string response_text;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    CURLcode res = post_json("/api/generate", request_body, response_text, &stream_state);
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    if (res != CURLE_OK) {
+        std::cerr << "cURL error: " << curl_easy_strerror(res) << std::endl;
+        return "Error: Failed to connect to Ollama API";
+    }
+    
+    try {
+        json j = json::parse(response_text);
+        if (j.contains("error")) {
+            return "Error: " + j["error"].get<std::string>();
+        }
+        if (metrics) {
+            *metrics = parse_metrics(j, elapsed.count());
+            metrics->token_times = std::move(token_times);
+        }
+        return j.value("response", "");
+    } catch (json::exception& e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        return "Error: Failed to parse response";
+    }
+}
+
+std::string OllamaAPI::chat(
+    const std::string& model,
+    const json& messages,
+    GenerationMetrics* metrics,
+    const json* options
+) {
+    json request_body = {
+        {"model", model},
+        {"messages", messages},
+        {"stream", false},
+        {"options", request_options(options)}
+    };
+    
+    std::string response_text;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    CURLcode res = post_json("/api/chat", request_body, response_text);
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    if (res != CURLE_OK) {
+        std::cerr << "cURL error: " << curl_easy_strerror(res) << std::endl;
+        return "Error: Failed to connect to Ollama API";
+    }
+    
+    try {
+        json j = json::parse(response_text);
+        if (j.contains("error")) {
+            return "Error: " + j["error"].get<std::string>();
+        }
+        if (metrics) {
+            *metrics = parse_metrics(j, elapsed.count());
+        }
+        if (j.contains("message") && j["message"].is_object()) {
+            return j["message"].value("content", "");
+        }
+        return "";
+    } catch (json::exception& e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        return "Error: Failed to parse response";
+    }
+}
+
+std::string OllamaAPI::embed(
+    const std::string& model,
+    const std::vector<std::string>& inputs,
+    std::vector<std::vector<float>>& embeddings,
+    GenerationMetrics* metrics
+) {
+    json request_body = {
+        {"model", model},
+        {"input", inputs},
+        {"options", request_options(nullptr)}
+    };
+    
+    embeddings.clear();
+    std::string response_text;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    CURLcode res = post_json("/api/embed", request_body, response_text);
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+    if (res != CURLE_OK) {
+        std::cerr << "cURL error: " << curl_easy_strerror(res) << std::endl;
+        return "Error: Failed to connect to Ollama API";
+    }
+    
+    try {
+        json j = json::parse(response_text);
+        if (j.contains("error")) {
+            return "Error: " + j["error"].get<std::string>();
+        }
+        if (metrics) {
+            *metrics = parse_metrics(j, elapsed.count());
+        }
+        if (j.contains("embeddings") && j["embeddings"].is_array()) {
+            embeddings = j["embeddings"].get<std::vector<std::vector<float>>>();
+        }
+        return "";
+    } catch (json::exception& e) {
+        std::cerr << "JSON parse error: " << e.what() << std::endl;
+        return "Error: Failed to parse response";
+    }
+}
+
+bool OllamaAPI::unload_model(const std::string& model) {
+    // An empty request with keep_alive 0 makes the server evict the model
+    json request_body = {
+        {"model", model},
+        {"keep_alive", 0}
+    };
+    std::string response_text;
+    long http_code = 0;
+    CURLcode res = post_json("/api/generate", request_body, response_text, nullptr, &http_code);
+    
+    return res == CURLE_OK && http_code == 200;
+}
@@ -0,0 +1,264 @@
+#include "autotuner.h"
+#include "decode_sweep.h"
+#include "prefill_sweep.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+// First-round probe sizes; each round doubles them
+const int decode_budget = 16;
+const int ttft_budget = 64;
+const int probe_seed = 42;
+
+std::string options_text(const json& options) {
+    std::string text;
+    for (const auto& [name, value] : options.items()) {
+        text += (text.empty() ? "" : " ") + name + "=" + value.dump();
+    }
+    return text;
+}
+
+// Decode rate (when measured) and time to first token
+std::string measurement_text(double decode_tps, double ttft_seconds) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    if (decode_tps > 0) {
+        ss << decode_tps << " t/s, ";
+    }
+    ss << "TTFT " << std::setprecision(3) << ttft_seconds << " s";
+    return ss.str();
+}
+
+} // namespace
+
+Autotuner::Autotuner(const std::string& goal, const std::vector<int>& thread_values,
+                     const std::vector<int>& batch_values, const std::vector<int>& context_values)
+    : objective(goal),
+      threads(thread_values.empty() ? default_threads() : thread_values),
+      batches(batch_values.empty() ? std::vector<int>{32, 64, 128, 256, 512} : batch_values),
+      contexts(context_values) {
+}
+
+std::vector<int> Autotuner::default_threads() {
+    const int cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<int> values;
+    for (int n = 1; n < cpus; n *= 2) {
+        values.push_back(n);
+    }
+    values.push_back(cpus);
+    return values;
+}
+
+bool Autotuner::parse_list(const std::string& text, std::vector<int>& values) {
+    values.clear();
+    std::stringstream list(text);
+    std::string entry;
+    while (std::getline(list, entry, ',')) {
+        size_t used = 0;
+        int value = 0;
+        try {
+            value = std::stoi(entry, &used);
+        } catch (...) {
+            used = 0;
+        }
+        if (used == 0 || used != entry.size() || value <= 0) {
+            std::cerr << "Error: '" << entry << "' is not a positive integer" << std::endl;
+            return false;
+        }
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+std::vector<json> Autotuner::candidates(const InferenceBackend& backend) const {
+    // gguf prefills one token per step, so num_batch would only repeat probes
+    const std::vector<int> batch_values = backend.name() == "gguf" ? std::vector<int>{} : batches;
+
+    std::vector<json> result;
+    const size_t context_count = std::max<size_t>(1, contexts.size());
+    const size_t batch_count = std::max<size_t>(1, batch_values.size());
+    for (size_t c = 0; c < context_count; c++) {
+        for (size_t b = 0; b < batch_count; b++) {
+            for (int thread_count : threads) {
+                json candidate = {{"num_thread", thread_count}};
+                if (!batch_values.empty()) {
+                    candidate["num_batch"] = batch_values[b];
+                }
+                if (!contexts.empty()) {
+                    candidate["num_ctx"] = contexts[c];
+                }
+                result.push_back(candidate);
+            }
+        }
+    }
+    return result;
+}
+
+TuneProbe Autotuner::probe(InferenceBackend& backend, const std::string& model, const json& candidate,
+                           int round, const Tokenizer* tokenizer, unsigned seed) const {
+    const int context_length = candidate.value("num_ctx", backend.runtime_config().context_length);
+
+    TuneProbe result;
+    result.options = candidate;
+    result.round = round;
+    result.decode_tps = 0.0;
+    result.ttft_seconds = 0.0;
+    result.load_seconds = 0.0;
+
+    json options = candidate;
+    options["temperature"] = 0;
+    options["seed"] = probe_seed;
+    std::string prompt;
+    if (objective == "ttft") {
+        // A fresh prompt every probe, so no candidate is helped by the prompt cache
+        result.budget = std::min(ttft_budget << round, std::max(1, context_length - 32));
+        prompt = PrefillSweep::filler_text(result.budget, seed, tokenizer);
+        options["num_predict"] = 1;
+    } else {
+        result.budget = std::min(decode_budget << round, std::max(1, context_length / 2));
+        prompt = DecodeSweep::prompt();
+        options["num_predict"] = result.budget;
+        options["stop"] = json::array();
+    }
+
+    GenerationMetrics metrics;
+    std::string response = backend.generate(model, prompt, false, false, &metrics, &options);
+    result.ok = response.rfind("Error:", 0) != 0;
+    if (result.ok && (objective == "ttft" ? metrics.prompt_eval_duration <= 0 : metrics.eval_duration <= 0)) {
+        result.ok = false;
+        response = "Error: no timings in the response";
+    }
+    result.error = result.ok ? "" : response;
+    // One output token says nothing about the decode rate
+    result.decode_tps = objective == "ttft" ? 0.0 : metrics.decode_rate();
+    result.ttft_seconds = metrics.prompt_eval_duration +
+                          (metrics.eval_count > 0 ? metrics.eval_duration / metrics.eval_count : 0.0);
+    result.load_seconds = metrics.load_duration;
+    return result;
+}
+
+double Autotuner::score(const TuneProbe& probe) const {
+    return objective == "ttft" ? -probe.ttft_seconds : probe.decode_tps;
+}
+
+TuneResult Autotuner::run(InferenceBackend& backend, const std::string& model, const Tokenizer* tokenizer) {
+    TuneResult result;
+    result.model_name = model;
+    result.objective = objective;
+    result.ok = false;
+    result.decode_tps = 0.0;
+    result.ttft_seconds = 0.0;
+
+    std::vector<json> survivors = candidates(backend);
+    unsigned seed = 0;
+    for (int round = 0; !survivors.empty(); round++) {
+        std::vector<std::pair<double, const TuneProbe*>> ranked;
+        const size_t first = result.probes.size();
+        for (const auto& candidate : survivors) {
+            result.probes.push_back(probe(backend, model, candidate, round, tokenizer, seed++));
+        }
+        for (size_t i = first; i < result.probes.size(); i++) {
+            const TuneProbe& measured = result.probes[i];
+            std::cout << "  round " << round + 1 << " [" << i - first + 1 << "/" << survivors.size() << "] "
+                      << options_text(measured.options) << ": ";
+            if (!measured.ok) {
+                std::cout << measured.error << std::endl;
+                continue;
+            }
+            std::cout << measurement_text(measured.decode_tps, measured.ttft_seconds) << std::endl;
+            ranked.emplace_back(score(measured), &measured);
+        }
+
+        // Failed candidates are out; the better half of the rest goes on
+        std::stable_sort(ranked.begin(), ranked.end(),
+                         [](const std::pair<double, const TuneProbe*>& a, const std::pair<double, const TuneProbe*>& b) {
+                             return a.first > b.first;
+                         });
+        if (ranked.size() <= 1) {
+            if (!ranked.empty()) {
+                result.ok = true;
+                result.options = ranked.front().second->options;
+                result.decode_tps = ranked.front().second->decode_tps;
+                result.ttft_seconds = ranked.front().second->ttft_seconds;
+            }
+            break;
+        }
+        ranked.resize((ranked.size() + 1) / 2);
+        survivors.clear();
+        for (const auto& entry : ranked) {
+            survivors.push_back(entry.second->options);
+        }
+    }
+    return result;
+}
+
+void Autotuner::print(const TuneResult& result) {
+    std::cout << std::left << std::setw(7) << "Round"
+              << std::setw(9) << "Budget"
+              << std::setw(12) << "Decode t/s"
+              << std::setw(10) << "TTFT s"
+              << std::setw(9) << "Load s"
+              << "Options" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    for (const auto& probe : result.probes) {
+        std::cout << std::left << std::setw(7) << probe.round + 1
+                  << std::setw(9) << probe.budget;
+        if (!probe.ok) {
+            std::cout << std::setw(31) << probe.error << options_text(probe.options) << std::endl;
+            continue;
+        }
+        std::stringstream decode;
+        if (probe.decode_tps > 0) {
+            decode << std::fixed << std::setprecision(2) << probe.decode_tps;
+        } else {
+            decode << "-";
+        }
+        std::cout << std::setw(12) << decode.str() << std::fixed
+                  << std::setw(10) << std::setprecision(3) << probe.ttft_seconds
+                  << std::setw(9) << std::setprecision(2) << probe.load_seconds
+                  << options_text(probe.options) << std::defaultfloat << std::endl;
+    }
+
+    if (!result.ok) {
+        std::cout << result.model_name << ": no candidate completed a probe" << std::endl;
+        return;
+    }
+    std::cout << result.model_name << " (" << result.objective << "): " << options_text(result.options)
+              << ", " << measurement_text(result.decode_tps, result.ttft_seconds) << std::endl;
+}
+
+json Autotuner::to_json(const TuneResult& result) {
+    json probes = json::array();
+    for (const auto& probe : result.probes) {
+        json entry = {
+            {"round", probe.round + 1},
+            {"budget", probe.budget},
+            {"ok", probe.ok},
+            {"decode_tokens_per_second", probe.decode_tps},
+            {"ttft_s", probe.ttft_seconds},
+            {"load_s", probe.load_seconds},
+            {"options", probe.options}
+        };
+        if (!probe.ok) {
+            entry["error"] = probe.error;
+        }
+        probes.push_back(entry);
+    }
+    return {
+        {"model", result.model_name},
+        {"objective", result.objective},
+        {"ok", result.ok},
+        {"options", result.ok ? result.options : json::object()},
+        {"decode_tokens_per_second", result.decode_tps},
+        {"ttft_s", result.ttft_seconds},
+        {"probes", probes}
+    };
+}
+
+const std::string& Autotuner::get_objective() const {
+    return objective;
+}
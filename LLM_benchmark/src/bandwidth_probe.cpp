@@ -0,0 +1,244 @@
+#include "bandwidth_probe.h"
+#include "system_utils.h"
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <cstdlib>
+#include <sched.h>
+#include <pthread.h>
+#include <glob.h>
+
+namespace {
+
+enum Command { FIRST_TOUCH, COPY, SCALE, TRIAD, STOP };
+
+const double scalar = 3.0;
+
+/**
+ * @brief Reusable barrier for the main thread and its workers
+ */
+class Barrier {
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    int parties;
+    int waiting = 0;
+    unsigned long generation = 0;
+
+public:
+    explicit Barrier(int count) : parties(count) {}
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mtx);
+        unsigned long arrived_generation = generation;
+        if (++waiting == parties) {
+            waiting = 0;
+            generation++;
+            cv.notify_all();
+        } else {
+            cv.wait(lock, [&] { return generation != arrived_generation; });
+        }
+    }
+};
+
+void pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+} // namespace
+
+BandwidthProbe::BandwidthProbe(size_t array_mb, int threads, int repeat)
+    : array_elements(std::max<size_t>(1, array_mb) * 1024 * 1024 / sizeof(double)),
+      max_threads(threads),
+      iterations(std::max(2, repeat)),
+      numa_nodes(1) {
+    discover_topology();
+    if (max_threads <= 0 || max_threads > static_cast<int>(cpu_order.size())) {
+        max_threads = cpu_order.size();
+    }
+}
+
+void BandwidthProbe::discover_topology() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+
+    // Primary threads of each physical core and their SMT siblings, grouped by NUMA node
+    std::map<int, std::vector<int>> primaries;
+    std::map<int, std::vector<int>> siblings;
+    std::set<std::string> seen_cores;
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+        std::string core = read_system_value(topology + "/topology/physical_package_id") + ":" +
+                           read_system_value(topology + "/topology/core_id");
+
+        int node = 0;
+        glob_t matches;
+        std::string pattern = topology + "/node[0-9]*";
+        if (glob(pattern.c_str(), 0, nullptr, &matches) == 0 && matches.gl_pathc > 0) {
+            std::string path = matches.gl_pathv[0];
+            node = std::atoi(path.substr(path.rfind("node") + 4).c_str());
+        }
+        globfree(&matches);
+
+        if (seen_cores.insert(core).second) {
+            primaries[node].push_back(cpu);
+        } else {
+            siblings[node].push_back(cpu);
+        }
+    }
+
+    // Round-robin across nodes so that partial thread counts use every memory controller
+    for (auto* group : {&primaries, &siblings}) {
+        bool added = true;
+        for (size_t i = 0; added; ++i) {
+            added = false;
+            for (const auto& [node, cpus] : *group) {
+                if (i < cpus.size()) {
+                    cpu_order.push_back(cpus[i]);
+                    added = true;
+                }
+            }
+        }
+    }
+
+    numa_nodes = std::max<int>(1, std::max(primaries.size(), siblings.size()));
+    if (cpu_order.empty()) {
+        cpu_order.push_back(0);
+    }
+}
+
+int BandwidthProbe::get_numa_nodes() const {
+    return numa_nodes;
+}
+
+std::vector<BandwidthResult> BandwidthProbe::run_kernels(int threads) {
+    // Allocation leaves the pages untouched so that each worker faults in its own slice
+    size_t bytes = array_elements * sizeof(double);
+    double* a = static_cast<double*>(std::aligned_alloc(64, bytes));
+    double* b = static_cast<double*>(std::aligned_alloc(64, bytes));
+    double* c = static_cast<double*>(std::aligned_alloc(64, bytes));
+    if (!a || !b || !c) {
+        std::cerr << "Error: Could not allocate bandwidth probe arrays" << std::endl;
+        std::free(a);
+        std::free(b);
+        std::free(c);
+        return {};
+    }
+
+    Barrier barrier(threads + 1);
+    std::atomic<int> command(FIRST_TOUCH);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < threads; ++t) {
+        size_t begin = array_elements * t / threads;
+        size_t end = array_elements * (t + 1) / threads;
+        int cpu = cpu_order[t % cpu_order.size()];
+
+        workers.emplace_back([=, &barrier, &command]() {
+            pin_to_cpu(cpu);
+            while (true) {
+                barrier.wait();
+                int current = command.load();
+                if (current == STOP) {
+                    break;
+                }
+                switch (current) {
+                    case FIRST_TOUCH:
+                        for (size_t i = begin; i < end; ++i) {
+                            a[i] = 1.0;
+                            b[i] = 2.0;
+                            c[i] = 0.0;
+                        }
+                        break;
+                    case COPY:
+                        for (size_t i = begin; i < end; ++i) c[i] = a[i];
+                        break;
+                    case SCALE:
+                        for (size_t i = begin; i < end; ++i) b[i] = scalar * c[i];
+                        break;
+                    case TRIAD:
+                        for (size_t i = begin; i < end; ++i) a[i] = b[i] + scalar * c[i];
+                        break;
+                }
+                barrier.wait();
+            }
+        });
+    }
+
+    auto dispatch = [&](int next) {
+        command = next;
+        auto start = std::chrono::steady_clock::now();
+        barrier.wait(); // Release the workers
+        barrier.wait(); // Wait for every slice to finish
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    dispatch(FIRST_TOUCH);
+
+    const std::vector<std::pair<int, std::string>> kernels = {{COPY, "copy"}, {SCALE, "scale"}, {TRIAD, "triad"}};
+    const std::map<int, int> arrays_touched = {{COPY, 2}, {SCALE, 2}, {TRIAD, 3}};
+    std::map<int, double> best_time;
+
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        for (const auto& [kernel, name] : kernels) {
+            double seconds = dispatch(kernel);
+            // The first iteration warms TLBs and caches and is not counted
+            if (iteration > 0 && (best_time.count(kernel) == 0 || seconds < best_time[kernel])) {
+                best_time[kernel] = seconds;
+            }
+        }
+    }
+
+    command = STOP;
+    barrier.wait();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::vector<BandwidthResult> results;
+    for (const auto& [kernel, name] : kernels) {
+        double moved = static_cast<double>(arrays_touched.at(kernel)) * bytes;
+        results.push_back({name, threads, best_time[kernel] > 0 ? moved / best_time[kernel] / 1e9 : 0.0});
+    }
+
+    std::free(a);
+    std::free(b);
+    std::free(c);
+    return results;
+}
+
+std::vector<BandwidthResult> BandwidthProbe::run() {
+    std::cout << "Bandwidth probe: 3 x " << array_elements * sizeof(double) / 1048576 << " MB arrays, "
+              << max_threads << " thread(s) over " << numa_nodes << " NUMA node(s)" << std::endl;
+
+    std::vector<BandwidthResult> results = run_kernels(1);
+    if (max_threads > 1) {
+        auto parallel = run_kernels(max_threads);
+        results.insert(results.end(), parallel.begin(), parallel.end());
+    }
+    return results;
+}
+
+double BandwidthProbe::best(const std::vector<BandwidthResult>& results, const std::string& kernel) {
+    double best_rate = 0.0;
+    for (const auto& result : results) {
+        if (result.kernel == kernel) {
+            best_rate = std::max(best_rate, result.gb_per_s);
+        }
+    }
+    return best_rate;
+}
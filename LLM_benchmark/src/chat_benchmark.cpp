@@ -0,0 +1,230 @@
+#include "chat_benchmark.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <tuple>
+
+namespace {
+
+// Seed of every reply, so the chat and cold runs see the same history
+const int chat_seed = 42;
+
+ChatTurnResult make_result(const std::string& model, const ChatScript& script, int turn,
+                           const std::string& mode, const GenerationMetrics& metrics) {
+    ChatTurnResult result;
+    result.model_name = model;
+    result.conversation = script.name;
+    result.turn = turn;
+    result.mode = mode;
+    result.prompt_tokens = metrics.prompt_eval_count;
+    result.prefill_seconds = metrics.prompt_eval_duration;
+    result.wall_seconds = metrics.wall_time;
+    result.output_tokens = metrics.eval_count;
+    return result;
+}
+
+} // namespace
+
+ChatBenchmark::ChatBenchmark(int reply_length)
+    : reply_tokens(std::max(1, reply_length)),
+      session(std::random_device{}()) {
+}
+
+std::string ChatBenchmark::tagged(const std::string& system) {
+    return "Session " + std::to_string(session++) + ". " + system;
+}
+
+std::vector<ChatScript> ChatBenchmark::default_scripts() {
+    ChatScript script;
+    script.name = "assistant";
+    script.system = "You are a helpful assistant for a team that deploys language models on small edge devices "
+                    "such as the Raspberry Pi. Answer precisely and keep each answer to a few sentences.";
+    script.turns = {
+        "What limits the speed of generating text with a language model on a single-board computer?",
+        "How does quantizing the weights to four bits change that?",
+        "Which quantization format would you pick for a board with 4 GB of RAM, and why?",
+        "How large can the context be before the KV cache becomes a problem on that board?",
+        "Summarize the advice you gave in this conversation as a short checklist."
+    };
+    return {script};
+}
+
+bool ChatBenchmark::load_scripts(const std::string& path, std::vector<ChatScript>& scripts) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open chat script " << path << std::endl;
+        return false;
+    }
+
+    try {
+        json j = json::parse(file);
+        if (j.is_object()) {
+            j = json::array({j});
+        }
+        scripts.clear();
+        for (const auto& entry : j) {
+            ChatScript script;
+            script.name = entry.value("name", "conversation " + std::to_string(scripts.size() + 1));
+            script.system = entry.value("system", "");
+            script.turns = entry.value("turns", std::vector<std::string>());
+            if (!script.turns.empty()) {
+                scripts.push_back(script);
+            }
+        }
+    } catch (json::exception& e) {
+        std::cerr << "Error: Invalid chat script " << path << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    if (scripts.empty()) {
+        std::cerr << "Error: Chat script " << path << " has no turns" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<ChatTurnResult> ChatBenchmark::run(OllamaAPI& api, const std::string& model,
+                                               const std::vector<ChatScript>& scripts) {
+    std::vector<ChatTurnResult> results;
+    json options = {
+        {"num_predict", reply_tokens},
+        {"seed", chat_seed},
+        {"temperature", 0}
+    };
+
+    // Load the model first so the first turn does not include the load
+    json warmup_options = {{"num_predict", 1}};
+    std::string response = api.chat(model, json::array({{{"role", "user"}, {"content", "Hello"}}}), nullptr, &warmup_options);
+    if (response.rfind("Error:", 0) == 0) {
+        std::cerr << "Error: chat benchmark could not run " << model << ": " << response << std::endl;
+        return results;
+    }
+
+    for (const auto& script : scripts) {
+        // chat: the server reuses the previous turn's KV cache
+        json messages = json::array({{{"role", "system"}, {"content", tagged(script.system)}}});
+        std::vector<std::string> replies;
+        for (size_t turn = 0; turn < script.turns.size(); turn++) {
+            messages.push_back({{"role", "user"}, {"content", script.turns[turn]}});
+            GenerationMetrics metrics;
+            response = api.chat(model, messages, &metrics, &options);
+            if (response.rfind("Error:", 0) == 0) {
+                std::cerr << "Error: " << model << " turn " << turn + 1 << ": " << response << std::endl;
+                return results;
+            }
+            messages.push_back({{"role", "assistant"}, {"content", response}});
+            replies.push_back(response);
+            results.push_back(make_result(model, script, static_cast<int>(turn + 1), "chat", metrics));
+        }
+
+        // cold: the same history, but a new tag every turn defeats the cache
+        for (size_t turn = 0; turn < script.turns.size(); turn++) {
+            json history = json::array({{{"role", "system"}, {"content", tagged(script.system)}}});
+            for (size_t previous = 0; previous < turn; previous++) {
+                history.push_back({{"role", "user"}, {"content", script.turns[previous]}});
+                history.push_back({{"role", "assistant"}, {"content", replies[previous]}});
+            }
+            history.push_back({{"role", "user"}, {"content", script.turns[turn]}});
+            GenerationMetrics metrics;
+            response = api.chat(model, history, &metrics, &options);
+            if (response.rfind("Error:", 0) == 0) {
+                std::cerr << "Error: " << model << " turn " << turn + 1 << ": " << response << std::endl;
+                return results;
+            }
+            results.push_back(make_result(model, script, static_cast<int>(turn + 1), "cold", metrics));
+        }
+
+        // context: only the new turn, with the token context of the previous response
+        std::vector<int> context;
+        std::string system = tagged(script.system);
+        for (size_t turn = 0; turn < script.turns.size(); turn++) {
+            GenerationMetrics metrics;
+            response = api.generate_with_context(model, script.turns[turn], system, context, &metrics, &options);
+            if (response.rfind("Error:", 0) == 0) {
+                std::cerr << "Error: " << model << " turn " << turn + 1 << ": " << response << std::endl;
+                return results;
+            }
+            results.push_back(make_result(model, script, static_cast<int>(turn + 1), "context", metrics));
+        }
+    }
+    return results;
+}
+
+void ChatBenchmark::print(const std::vector<ChatTurnResult>& results) {
+    // Line up the three modes of each turn
+    std::map<std::tuple<std::string, std::string, int>, std::map<std::string, const ChatTurnResult*>> turns;
+    for (const auto& result : results) {
+        turns[std::make_tuple(result.model_name, result.conversation, result.turn)][result.mode] = &result;
+    }
+
+    std::cout << std::left << std::setw(20) << "Model"
+              << std::setw(14) << "Conversation"
+              << std::setw(6) << "Turn"
+              << std::setw(10) << "Cold tok"
+              << std::setw(10) << "Cold ms"
+              << std::setw(10) << "Chat tok"
+              << std::setw(10) << "Chat ms"
+              << std::setw(10) << "Ctx tok"
+              << std::setw(10) << "Ctx ms"
+              << "Saved" << std::endl;
+    std::cout << std::string(106, '-') << std::endl;
+
+    for (const auto& entry : turns) {
+        auto cell = [&entry](const std::string& mode, bool tokens) {
+            auto it = entry.second.find(mode);
+            if (it == entry.second.end()) {
+                return std::string("-");
+            }
+            std::stringstream ss;
+            if (tokens) {
+                ss << it->second->prompt_tokens;
+            } else {
+                ss << std::fixed << std::setprecision(1) << it->second->prefill_seconds * 1000.0;
+            }
+            return ss.str();
+        };
+
+        // Prefill time the chat run saved against evaluating the whole history
+        std::string saved = "-";
+        auto cold = entry.second.find("cold");
+        auto chat = entry.second.find("chat");
+        if (cold != entry.second.end() && chat != entry.second.end() && cold->second->prefill_seconds > 0) {
+            std::stringstream ss;
+            ss << std::fixed << std::setprecision(0)
+               << 100.0 * (1.0 - chat->second->prefill_seconds / cold->second->prefill_seconds) << "%";
+            saved = ss.str();
+        }
+
+        std::cout << std::left << std::setw(20) << std::get<0>(entry.first)
+                  << std::setw(14) << std::get<1>(entry.first)
+                  << std::setw(6) << std::get<2>(entry.first)
+                  << std::setw(10) << cell("cold", true)
+                  << std::setw(10) << cell("cold", false)
+                  << std::setw(10) << cell("chat", true)
+                  << std::setw(10) << cell("chat", false)
+                  << std::setw(10) << cell("context", true)
+                  << std::setw(10) << cell("context", false)
+                  << saved << std::endl;
+    }
+}
+
+json ChatBenchmark::to_json(const std::vector<ChatTurnResult>& results) {
+    json j = json::array();
+    for (const auto& result : results) {
+        j.push_back({
+            {"model", result.model_name},
+            {"conversation", result.conversation},
+            {"turn", result.turn},
+            {"mode", result.mode},
+            {"prompt_tokens", result.prompt_tokens},
+            {"prefill_s", result.prefill_seconds},
+            {"wall_s", result.wall_seconds},
+            {"output_tokens", result.output_tokens}
+        });
+    }
+    return j;
+}
@@ -0,0 +1,203 @@
+#include "decode_sweep.h"
+#include "memory_monitor.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace {
+
+// Context left for the chat template around the prompt
+const int context_margin = 16;
+
+// Seed of every request, so each length decodes the same tokens
+const int decode_seed = 42;
+
+// Positions up to this form the first latency window; later windows double
+const int first_window = 16;
+
+} // namespace
+
+double DecodePoint::decode_rate() const {
+    return decode_seconds > 0 ? tokens / decode_seconds : 0.0;
+}
+
+double DecodePoint::mean_latency_ms(int first, int last) const {
+    // latencies_ms[i] is the gap before the token at position i + 2
+    double sum = 0.0;
+    int count = 0;
+    for (int position = std::max(first, 2); position <= last; position++) {
+        size_t index = static_cast<size_t>(position - 2);
+        if (index >= latencies_ms.size()) {
+            break;
+        }
+        sum += latencies_ms[index];
+        count++;
+    }
+    return count > 0 ? sum / count : 0.0;
+}
+
+DecodeSweep::DecodeSweep(int min_length, int max_length, double growth)
+    : min_tokens(std::max(1, min_length)),
+      max_tokens(std::max(min_tokens, max_length)),
+      factor(growth > 1.0 ? growth : 2.0) {
+}
+
+std::vector<int> DecodeSweep::lengths(int room) const {
+    int limit = std::max(1, std::min(max_tokens, room));
+
+    std::vector<int> result;
+    for (double length = min_tokens; length < limit; length *= factor) {
+        int rounded = static_cast<int>(std::lround(length));
+        if (result.empty() || rounded > result.back()) {
+            result.push_back(rounded);
+        }
+    }
+    result.push_back(limit);
+    return result;
+}
+
+const std::string& DecodeSweep::prompt() {
+    static const std::string text =
+        "Write a very long and detailed history of a fictional city, from its founding to the present day. "
+        "Describe every century in turn: its rulers, wars, trade, inventions, buildings, festivals and the lives "
+        "of ordinary people. Do not summarize and do not stop early; keep writing new chapters.";
+    return text;
+}
+
+std::vector<DecodePoint> DecodeSweep::run(InferenceBackend& backend, const std::string& model,
+                                          const Tokenizer* tokenizer, int context_length) {
+    std::vector<DecodePoint> points;
+
+    const int prompt_tokens = tokenizer ? static_cast<int>(tokenizer->count(prompt()) + 1)
+                                        : static_cast<int>(prompt().size() / 4);
+    const int room = context_length - prompt_tokens - context_margin;
+    if (room < 1) {
+        std::cerr << "Error: decode sweep has no room to generate in a context of " << context_length << std::endl;
+        return points;
+    }
+
+    // Load the model first so the shortest length does not include the load
+    json warmup_options = {{"num_predict", 1}, {"num_ctx", context_length}};
+    std::string response = backend.generate(model, "Hello", false, false, nullptr, &warmup_options);
+    if (response.rfind("Error:", 0) == 0) {
+        std::cerr << "Error: decode sweep could not run " << model << ": " << response << std::endl;
+        return points;
+    }
+
+    // The server process for Ollama, this one for the in-process backend
+    const std::string process = backend.name() == "ollama" ? "ollama" : "";
+
+    for (int length : lengths(room)) {
+        json options = {
+            {"num_predict", length},
+            {"num_ctx", context_length},
+            {"seed", decode_seed},
+            {"stop", json::array()}
+        };
+
+        MemoryMonitor memory_monitor(process, 50);
+        memory_monitor.start();
+        GenerationMetrics metrics;
+        response = backend.generate(model, prompt(), true, false, &metrics, &options);
+        memory_monitor.stop();
+        if (response.rfind("Error:", 0) == 0) {
+            std::cerr << "Error: decode sweep at " << length << " tokens: " << response << std::endl;
+            continue;
+        }
+
+        DecodePoint point;
+        point.model_name = model;
+        point.num_predict = length;
+        point.tokens = metrics.eval_count > 0 ? metrics.eval_count : static_cast<int>(metrics.token_times.size());
+        point.decode_seconds = metrics.eval_duration;
+        point.ttft_seconds = metrics.token_times.empty() ? 0.0 : metrics.token_times.front();
+        for (size_t i = 1; i < metrics.token_times.size(); i++) {
+            point.latencies_ms.push_back(1000.0 * (metrics.token_times[i] - metrics.token_times[i - 1]));
+        }
+        point.peak_memory_kb = memory_monitor.get_peak_memory();
+        points.push_back(point);
+    }
+    return points;
+}
+
+void DecodeSweep::print(const std::vector<DecodePoint>& points) {
+    std::cout << std::left << std::setw(20) << "Model"
+              << std::setw(10) << "Predict"
+              << std::setw(10) << "Tokens"
+              << std::setw(12) << "Decode t/s"
+              << std::setw(10) << "TTFT s"
+              << std::setw(12) << "Last ms/tok"
+              << std::setw(12) << "Peak MB"
+              << "Growth MB" << std::endl;
+    std::cout << std::string(96, '-') << std::endl;
+
+    std::map<std::string, const DecodePoint*> first_by_model;
+    std::map<std::string, const DecodePoint*> longest_by_model;
+    for (const auto& point : points) {
+        if (!first_by_model.count(point.model_name)) {
+            first_by_model[point.model_name] = &point;
+        }
+        auto& longest = longest_by_model[point.model_name];
+        if (!longest || point.tokens > longest->tokens) {
+            longest = &point;
+        }
+
+        // Mean gap over the last eighth of the answer
+        int last_window = std::max(1, point.tokens / 8);
+        long growth_kb = static_cast<long>(point.peak_memory_kb) -
+                         static_cast<long>(first_by_model[point.model_name]->peak_memory_kb);
+        std::cout << std::left << std::setw(20) << point.model_name
+                  << std::setw(10) << point.num_predict
+                  << std::setw(10) << point.tokens
+                  << std::setw(12) << std::fixed << std::setprecision(2) << point.decode_rate()
+                  << std::setw(10) << std::setprecision(3) << point.ttft_seconds
+                  << std::setw(12) << std::setprecision(2) << point.mean_latency_ms(point.tokens - last_window + 1, point.tokens)
+                  << std::setw(12) << std::setprecision(1) << point.peak_memory_kb / 1024.0
+                  << (growth_kb >= 0 ? "+" : "") << growth_kb / 1024.0 << std::defaultfloat << std::endl;
+    }
+
+    std::cout << "\nDecode latency by position (longest run of each model):" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model"
+              << std::setw(16) << "Positions"
+              << std::setw(12) << "ms/token"
+              << std::setw(12) << "Tokens/sec"
+              << "vs first" << std::endl;
+    std::cout << std::string(70, '-') << std::endl;
+    for (const auto& entry : longest_by_model) {
+        const DecodePoint& point = *entry.second;
+        double baseline = 0.0;
+        for (int first = 2, last = first_window; first <= point.tokens; first = last + 1, last *= 2) {
+            double latency = point.mean_latency_ms(first, std::min(last, point.tokens));
+            if (latency <= 0) {
+                break;
+            }
+            if (baseline <= 0) {
+                baseline = latency;
+            }
+            std::cout << std::left << std::setw(20) << point.model_name
+                      << std::setw(16) << (std::to_string(first) + "-" + std::to_string(std::min(last, point.tokens)))
+                      << std::setw(12) << std::fixed << std::setprecision(2) << latency
+                      << std::setw(12) << 1000.0 / latency
+                      << std::setprecision(0) << 100.0 * baseline / latency << "%" << std::defaultfloat << std::endl;
+        }
+    }
+}
+
+json DecodeSweep::to_json(const std::vector<DecodePoint>& points) {
+    json j = json::array();
+    for (const auto& point : points) {
+        j.push_back({
+            {"model", point.model_name},
+            {"num_predict", point.num_predict},
+            {"tokens", point.tokens},
+            {"decode_s", point.decode_seconds},
+            {"decode_tokens_per_second", point.decode_rate()},
+            {"ttft_s", point.ttft_seconds},
+            {"peak_memory_kb", point.peak_memory_kb},
+            {"token_latency_ms", point.latencies_ms}
+        });
+    }
+    return j;
+}
@@ -0,0 +1,163 @@
+#include "device_profile.h"
+#include "system_utils.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+std::string hostname() {
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0 || name[0] == '\0') {
+        return "localhost";
+    }
+    return name;
+}
+
+// Board name on ARM boards, the "model name" line of /proc/cpuinfo elsewhere
+std::string cpu_model() {
+    std::string model = read_system_value("/proc/device-tree/model");
+    model = model.c_str(); // The device-tree string ends with a NUL
+    if (!model.empty()) {
+        return model;
+    }
+
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0 || line.rfind("Hardware", 0) == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                size_t begin = line.find_first_not_of(" \t", colon + 1);
+                return begin == std::string::npos ? "" : line.substr(begin);
+            }
+        }
+    }
+    return "unknown";
+}
+
+} // namespace
+
+DeviceProfile::DeviceProfile(const std::string& file)
+    : path(file.empty() ? default_path() : file), device(identify()) {
+}
+
+std::string DeviceProfile::default_path() {
+    std::string config;
+    const char* xdg = std::getenv("XDG_CONFIG_HOME");
+    if (xdg && *xdg) {
+        config = xdg;
+    } else {
+        const char* home = std::getenv("HOME");
+        config = std::string(home ? home : ".") + "/.config";
+    }
+    return config + "/edge_ai_benchmark/" + hostname() + ".json";
+}
+
+json DeviceProfile::identify() {
+    return {
+        {"hostname", hostname()},
+        {"cpu", cpu_model()},
+        {"cpus", std::max(1u, std::thread::hardware_concurrency())},
+        {"memory_mb", get_system_memory().first}
+    };
+}
+
+bool DeviceProfile::load() {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    json j = json::parse(file, nullptr, false);
+    if (j.is_discarded() || !j.is_object() || !j.contains("device")) {
+        std::cerr << "Error: " << path << " is not a device profile" << std::endl;
+        return false;
+    }
+
+    device = j["device"];
+    models.clear();
+    const json entries = j.value("models", json::object());
+    for (const auto& [model, backends] : entries.items()) {
+        for (const auto& [backend, entry] : backends.items()) {
+            TunedSettings settings;
+            settings.objective = entry.value("objective", "decode");
+            settings.options = entry.value("options", json::object());
+            settings.decode_tps = entry.value("decode_tokens_per_second", 0.0);
+            settings.ttft_seconds = entry.value("ttft_s", 0.0);
+            settings.tuned_at = entry.value("tuned_at", "");
+            models[model][backend] = settings;
+        }
+    }
+    return true;
+}
+
+bool DeviceProfile::save() {
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos && slash > 0 && !make_directories(path.substr(0, slash))) {
+        return false;
+    }
+
+    // Saving records the tuning as belonging to this machine
+    device = identify();
+    json j = {{"device", device}, {"models", json::object()}};
+    for (const auto& [model, backends] : models) {
+        for (const auto& [backend, settings] : backends) {
+            j["models"][model][backend] = {
+                {"objective", settings.objective},
+                {"options", settings.options},
+                {"decode_tokens_per_second", settings.decode_tps},
+                {"ttft_s", settings.ttft_seconds},
+                {"tuned_at", settings.tuned_at}
+            };
+        }
+    }
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not write device profile " << path << std::endl;
+        return false;
+    }
+    file << j.dump(4) << std::endl;
+    return true;
+}
+
+bool DeviceProfile::matches_device() const {
+    json here = identify();
+    // RAM is left out: the reported total moves with firmware and kernel reservations
+    return device.value("hostname", "") == here["hostname"].get<std::string>() &&
+           device.value("cpu", "") == here["cpu"].get<std::string>() &&
+           device.value("cpus", 0u) == here["cpus"].get<unsigned>();
+}
+
+const TunedSettings* DeviceProfile::get(const std::string& model, const std::string& backend) const {
+    auto by_model = models.find(model);
+    if (by_model == models.end()) {
+        return nullptr;
+    }
+    auto by_backend = by_model->second.find(backend);
+    return by_backend == by_model->second.end() ? nullptr : &by_backend->second;
+}
+
+void DeviceProfile::set(const std::string& model, const std::string& backend, const TunedSettings& settings) {
+    models[model][backend] = settings;
+}
+
+size_t DeviceProfile::size() const {
+    size_t count = 0;
+    for (const auto& entry : models) {
+        count += entry.second.size();
+    }
+    return count;
+}
+
+const std::string& DeviceProfile::get_path() const {
+    return path;
+}
+
+const json& DeviceProfile::get_device() const {
+    return device;
+}
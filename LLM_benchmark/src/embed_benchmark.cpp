@@ -0,0 +1,343 @@
+#include "embed_benchmark.h"
+#include "memory_monitor.h"
+#include "system_utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+double EmbedRun::docs_per_second() const {
+    return wall_seconds > 0 ? documents / wall_seconds : 0.0;
+}
+
+double EmbedRun::tokens_per_second() const {
+    return wall_seconds > 0 ? tokens / wall_seconds : 0.0;
+}
+
+double EmbedRun::latency_percentile(double pct) const {
+    if (latencies.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(pct / 100.0 * latencies.size()));
+    return latencies[std::min(latencies.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+EmbedBenchmark::EmbedBenchmark(const std::string& corpus_path, const std::string& output_path,
+                               bool use_memory_mapping)
+    : api("http://localhost:11434", use_memory_mapping),
+      corpus_file(corpus_path),
+      output_file(output_path),
+      batch_sizes({16}),
+      concurrencies({1}),
+      max_documents(0),
+      mapping(nullptr),
+      mapping_size(0) {
+    // curl_global_init is not thread-safe; do it before any worker starts
+    OllamaAPI::initialize();
+}
+
+EmbedBenchmark::~EmbedBenchmark() {
+    unmap_corpus();
+    OllamaAPI::cleanup();
+}
+
+void EmbedBenchmark::add_model(const std::string& model_name) {
+    models.push_back(model_name);
+}
+
+void EmbedBenchmark::set_batch_sizes(const std::vector<int>& sizes) {
+    batch_sizes.clear();
+    for (int size : sizes) {
+        if (size > 0) {
+            batch_sizes.push_back(size);
+        }
+    }
+    if (batch_sizes.empty()) {
+        batch_sizes = {16};
+    }
+}
+
+void EmbedBenchmark::set_concurrency(const std::vector<int>& levels) {
+    concurrencies.clear();
+    for (int level : levels) {
+        if (level > 0) {
+            concurrencies.push_back(level);
+        }
+    }
+    if (concurrencies.empty()) {
+        concurrencies = {1};
+    }
+}
+
+void EmbedBenchmark::set_max_documents(size_t count) {
+    max_documents = count;
+}
+
+bool EmbedBenchmark::map_corpus() {
+    int fd = open(corpus_file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open corpus file " << corpus_file << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        std::cerr << "Error: Corpus file " << corpus_file << " is empty" << std::endl;
+        close(fd);
+        return false;
+    }
+    mapping_size = static_cast<size_t>(st.st_size);
+    mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Error: Could not map corpus file " << corpus_file << std::endl;
+        mapping = nullptr;
+        mapping_size = 0;
+        return false;
+    }
+    madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+
+    const char* data = static_cast<const char*>(mapping);
+    const char* end = data + mapping_size;
+    while (data < end && (max_documents == 0 || documents.size() < max_documents)) {
+        const char* newline = static_cast<const char*>(memchr(data, '\n', end - data));
+        const char* line_end = newline ? newline : end;
+        size_t length = line_end - data;
+        if (length > 0 && data[length - 1] == '\r') {
+            length--;
+        }
+        if (length > 0) {
+            documents.emplace_back(data, length);
+        }
+        data = line_end + 1;
+    }
+    if (documents.empty()) {
+        std::cerr << "Error: Corpus file " << corpus_file << " has no documents" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void EmbedBenchmark::unmap_corpus() {
+    documents.clear();
+    if (mapping) {
+        munmap(mapping, mapping_size);
+        mapping = nullptr;
+        mapping_size = 0;
+    }
+}
+
+EmbedRun EmbedBenchmark::measure(const std::string& model, int batch_size, int concurrency) {
+    EmbedRun result;
+    result.model_name = model;
+    result.batch_size = batch_size;
+    result.concurrency = concurrency;
+    result.documents = 0;
+    result.requests = 0;
+    result.failed = 0;
+    result.tokens = 0;
+    result.dimensions = 0;
+
+    const size_t batches = (documents.size() + batch_size - 1) / batch_size;
+    std::atomic<size_t> next_batch(0);
+    std::mutex result_mutex;
+
+    // Each worker sends its next batch as soon as the previous one returns
+    auto worker = [&]() {
+        std::vector<double> latencies;
+        std::vector<std::vector<float>> embeddings;
+        for (size_t batch = next_batch++; batch < batches; batch = next_batch++) {
+            size_t first = batch * batch_size;
+            size_t last = std::min(documents.size(), first + batch_size);
+            std::vector<std::string> inputs(documents.begin() + first, documents.begin() + last);
+
+            GenerationMetrics metrics;
+            std::string error = api.embed(model, inputs, embeddings, &metrics);
+            latencies.push_back(metrics.wall_time);
+
+            std::lock_guard<std::mutex> lock(result_mutex);
+            result.requests++;
+            if (!error.empty() || embeddings.size() != inputs.size()) {
+                result.failed++;
+                if (result.error.empty()) {
+                    result.error = error.empty() ? "Error: " + std::to_string(embeddings.size()) + " embeddings for "
+                                                   + std::to_string(inputs.size()) + " inputs" : error;
+                }
+                continue;
+            }
+            result.documents += static_cast<int>(inputs.size());
+            result.tokens += metrics.prompt_eval_count;
+            result.dimensions = static_cast<int>(embeddings.front().size());
+        }
+        std::lock_guard<std::mutex> lock(result_mutex);
+        result.latencies.insert(result.latencies.end(), latencies.begin(), latencies.end());
+    };
+
+    MemoryMonitor memory_monitor("ollama", 50);
+    memory_monitor.start();
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < concurrency; i++) {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    memory_monitor.stop();
+
+    result.wall_seconds = elapsed.count();
+    std::sort(result.latencies.begin(), result.latencies.end());
+    result.peak_memory = memory_monitor.get_peak_memory();
+    result.peak_pss = memory_monitor.get_peak_pss();
+    return result;
+}
+
+void EmbedBenchmark::run() {
+    if (models.empty()) {
+        std::cerr << "Error: No models specified for the embedding benchmark" << std::endl;
+        return;
+    }
+    if (!map_corpus()) {
+        return;
+    }
+
+    std::cout << "========== EMBEDDING BENCHMARK ==========" << std::endl;
+    std::cout << "Corpus: " << corpus_file << " (" << documents.size() << " documents, "
+              << format_memory(mapping_size / 1024) << " mapped)" << std::endl;
+    std::cout << "Batch sizes:";
+    for (int size : batch_sizes) {
+        std::cout << " " << size;
+    }
+    std::cout << std::endl << "Concurrency:";
+    for (int level : concurrencies) {
+        std::cout << " " << level;
+    }
+    std::cout << std::endl;
+    std::cout << "=========================================" << std::endl;
+
+    std::vector<EmbedRun> runs;
+    json load_times;
+    for (const auto& model : models) {
+        std::cout << "\nModel: " << model << std::endl;
+
+        // Load the model first so the first setting does not include the load
+        std::vector<std::vector<float>> embeddings;
+        GenerationMetrics metrics;
+        std::string error = api.embed(model, {std::string(documents.front())}, embeddings, &metrics);
+        if (error.empty() && embeddings.empty()) {
+            error = "Error: no embedding returned";
+        }
+        if (!error.empty()) {
+            std::cerr << "Error: embedding benchmark could not run " << model << ": " << error << std::endl;
+            continue;
+        }
+        load_times[model] = metrics.load_duration;
+        std::cout << "  Loaded in " << std::fixed << std::setprecision(2) << metrics.load_duration << "s, "
+                  << embeddings.front().size() << " dimensions" << std::defaultfloat << std::endl;
+
+        for (int batch_size : batch_sizes) {
+            for (int concurrency : concurrencies) {
+                std::cout << "  Batch " << batch_size << ", concurrency " << concurrency << "..." << std::flush;
+                EmbedRun result = measure(model, batch_size, concurrency);
+                std::cout << " " << std::fixed << std::setprecision(1) << result.docs_per_second()
+                          << " docs/s" << std::defaultfloat << std::endl;
+                runs.push_back(result);
+            }
+        }
+        api.unload_model(model);
+    }
+
+    std::cout << "\nEMBEDDING THROUGHPUT:" << std::endl;
+    print(runs);
+
+    if (!output_file.empty()) {
+        std::ofstream out(output_file);
+        if (out.is_open()) {
+            json j;
+            j["metadata"]["corpus"] = corpus_file;
+            j["metadata"]["documents"] = documents.size();
+            j["metadata"]["corpus_bytes"] = mapping_size;
+            j["metadata"]["load_s"] = load_times;
+            j["embed"] = to_json(runs);
+            out << std::setw(4) << j << std::endl;
+            std::cout << "\nJSON results saved to " << output_file << std::endl;
+        } else {
+            std::cerr << "Error: Could not open output file " << output_file << std::endl;
+        }
+    }
+    unmap_corpus();
+}
+
+void EmbedBenchmark::print(const std::vector<EmbedRun>& runs) {
+    std::cout << std::left << std::setw(26) << "Model"
+              << std::setw(7) << "Batch"
+              << std::setw(7) << "Conc"
+              << std::setw(10) << "Docs/s"
+              << std::setw(11) << "Tokens/s"
+              << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p95 ms"
+              << std::setw(10) << "p99 ms"
+              << std::setw(12) << "Peak RSS"
+              << "Failed" << std::endl;
+    std::cout << std::string(109, '-') << std::endl;
+
+    for (const auto& run : runs) {
+        std::cout << std::left << std::setw(26) << run.model_name
+                  << std::setw(7) << run.batch_size
+                  << std::setw(7) << run.concurrency
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(10) << run.docs_per_second()
+                  << std::setw(11) << run.tokens_per_second()
+                  << std::setw(10) << 1000.0 * run.latency_percentile(50)
+                  << std::setw(10) << 1000.0 * run.latency_percentile(95)
+                  << std::setw(10) << 1000.0 * run.latency_percentile(99)
+                  << std::setw(12) << format_memory(run.peak_memory)
+                  << run.failed << "/" << run.requests << std::defaultfloat << std::endl;
+    }
+
+    for (const auto& run : runs) {
+        if (!run.error.empty()) {
+            std::cout << "  " << run.model_name << " (batch " << run.batch_size << ", concurrency "
+                      << run.concurrency << "): " << run.error << std::endl;
+        }
+    }
+}
+
+json EmbedBenchmark::to_json(const std::vector<EmbedRun>& runs) {
+    json j = json::array();
+    for (const auto& run : runs) {
+        json entry = {
+            {"model", run.model_name},
+            {"batch_size", run.batch_size},
+            {"concurrency", run.concurrency},
+            {"documents", run.documents},
+            {"requests", run.requests},
+            {"failed", run.failed},
+            {"tokens", run.tokens},
+            {"dimensions", run.dimensions},
+            {"wall_s", run.wall_seconds},
+            {"documents_per_second", run.docs_per_second()},
+            {"tokens_per_second", run.tokens_per_second()},
+            {"latency_p50_s", run.latency_percentile(50)},
+            {"latency_p95_s", run.latency_percentile(95)},
+            {"latency_p99_s", run.latency_percentile(99)},
+            {"peak_memory_kb", run.peak_memory},
+            {"peak_pss_kb", run.peak_pss}
+        };
+        if (!run.error.empty()) {
+            entry["error"] = run.error;
+        }
+        j.push_back(entry);
+    }
+    return j;
+}
@@ -0,0 +1,323 @@
+#include "gguf_backend.h"
+#include "storage_probe.h"
+#include "model_footprint.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+
+constexpr float TEMPERATURE = 0.7f; // Same as the options OllamaAPI sends
+constexpr int TOP_K = 40;           // Ollama's default
+constexpr unsigned SEED = 42;       // Fixed so repeated runs decode the same tokens
+
+bool is_regular_file(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+// Manifests live at manifests/<host>/<namespace>/<name>/<tag>
+void collect_manifests(const std::string& dir, std::vector<std::string>& parts, std::vector<std::string>& out) {
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) {
+        return;
+    }
+    while (struct dirent* entry = readdir(handle)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::string path = dir + "/" + entry->d_name;
+        parts.push_back(entry->d_name);
+        if (parts.size() == 4) {
+            if (is_regular_file(path)) {
+                std::string name = parts[2] + ":" + parts[3];
+                if (parts[0] != "registry.ollama.ai") {
+                    name = parts[0] + "/" + parts[1] + "/" + name;
+                } else if (parts[1] != "library") {
+                    name = parts[1] + "/" + name;
+                }
+                out.push_back(name);
+            }
+        } else {
+            collect_manifests(path, parts, out);
+        }
+        parts.pop_back();
+    }
+    closedir(handle);
+}
+
+// Byte-fallback tokens can leave partial or invalid sequences; replace them with U+FFFD
+std::string sanitize_utf8(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size();) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+        bool valid = length > 0 && i + length <= text.size();
+        for (size_t k = 1; valid && k < length; ++k) {
+            valid = (static_cast<unsigned char>(text[i + k]) & 0xC0) == 0x80;
+        }
+        if (valid) {
+            out.append(text, i, length);
+            i += length;
+        } else {
+            out += "\xEF\xBF\xBD";
+            i++;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+GgufBackend::GgufBackend(const std::string& dir, int worker_threads, int context, int max_new_tokens)
+    : models_dir(dir.empty() ? StorageProbe::default_models_dir() : dir),
+      threads(worker_threads),
+      context_length(context),
+      max_tokens(max_new_tokens),
+      loaded_threads(0),
+      loaded_context(0),
+      rng(SEED) {
+}
+
+std::string GgufBackend::name() const {
+    return "gguf";
+}
+
+std::string GgufBackend::resolve(const std::string& name) const {
+    return ModelFootprintReader::locate(models_dir, name);
+}
+
+std::vector<std::string> GgufBackend::list_models() {
+    std::vector<std::string> models;
+    std::vector<std::string> parts;
+    collect_manifests(models_dir + "/manifests", parts, models);
+    std::sort(models.begin(), models.end());
+    return models;
+}
+
+std::vector<ModelInfo> GgufBackend::list_model_info() {
+    std::vector<ModelInfo> models;
+    for (const auto& name : list_models()) {
+        GgufFile header;
+        std::string path = resolve(name);
+        if (path.empty() || !header.open(path, true)) {
+            continue;
+        }
+        ModelInfo info;
+        info.name = name;
+        info.size = header.get_file_size();
+        info.family = header.get_string("general.architecture");
+        info.parameter_size = header.get_string("general.size_label");
+        info.quantization_level = GgufFile::file_type_name(header.get_int("general.file_type", -1));
+        models.push_back(info);
+    }
+    return models;
+}
+
+RuntimeConfig GgufBackend::runtime_config() const {
+    RuntimeConfig config;
+    config.context_length = context_length;
+    config.batch_size = 1;
+    config.kv_element_bytes = sizeof(float);
+    return config;
+}
+
+bool GgufBackend::ensure_loaded(const std::string& name, double& load_seconds, int worker_threads, int context) {
+    load_seconds = 0.0;
+    if (model && loaded_model == name && loaded_threads == worker_threads && loaded_context == context) {
+        return true;
+    }
+
+    model.reset();
+    tokenizer.reset();
+    file.reset();
+    loaded_model.clear();
+
+    std::string path = resolve(name);
+    if (path.empty()) {
+        std::cerr << "Error: Model " << name << " not found in " << models_dir << std::endl;
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto new_file = std::make_unique<GgufFile>();
+    auto new_tokenizer = std::make_unique<Tokenizer>();
+    auto new_model = std::make_unique<LlamaModel>(worker_threads, context);
+    if (!new_file->open(path) || !new_tokenizer->load(*new_file) || !new_model->load(*new_file)) {
+        return false;
+    }
+    new_file->prefetch();
+    load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    file = std::move(new_file);
+    tokenizer = std::move(new_tokenizer);
+    model = std::move(new_model);
+    loaded_model = name;
+    loaded_threads = worker_threads;
+    loaded_context = context;
+    return true;
+}
+
+int GgufBackend::sample(const float* logits, int vocab, float temperature, int top_k) {
+    if (temperature <= 0.0f) {
+        return static_cast<int>(std::max_element(logits, logits + vocab) - logits);
+    }
+    const int k = top_k > 0 ? std::min(top_k, vocab) : vocab;
+    std::vector<int> ids(vocab);
+    for (int i = 0; i < vocab; ++i) {
+        ids[i] = i;
+    }
+    std::partial_sort(ids.begin(), ids.begin() + k, ids.end(),
+                      [&](int a, int b) { return logits[a] > logits[b]; });
+
+    std::vector<double> weights(k);
+    for (int i = 0; i < k; ++i) {
+        weights[i] = std::exp((logits[ids[i]] - logits[ids[0]]) / temperature);
+    }
+    std::discrete_distribution<int> pick(weights.begin(), weights.end());
+    return ids[pick(rng)];
+}
+
+std::string GgufBackend::generate(
+    const std::string& model_name,
+    const std::string& prompt,
+    bool stream,
+    bool verbose,
+    GenerationMetrics* metrics,
+    const json* options
+) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto start = std::chrono::steady_clock::now();
+
+    int worker_threads = threads;
+    int context = context_length;
+    if (options && options->is_object()) {
+        worker_threads = options->value("num_thread", worker_threads);
+        context = std::max(1, options->value("num_ctx", context));
+    }
+
+    double load_seconds = 0.0;
+    if (!ensure_loaded(model_name, load_seconds, worker_threads, context)) {
+        return "Error: Failed to load model " + model_name;
+    }
+
+    if (verbose) {
+        std::cout << "[DEBUG] In-process decode of " << model_name << " from " << file->get_path() << std::endl;
+        std::cout << "[DEBUG] Threads: " << model->get_threads() << ", kernels: " << isa_name(best_isa())
+                  << ", KV cache: " << model->get_context_length() << " tokens ("
+                  << model->get_kv_cache_bytes() / (1024 * 1024) << " MB)" << std::endl;
+    }
+
+    int limit = max_tokens;
+    float temperature = TEMPERATURE;
+    int top_k = TOP_K;
+    unsigned seed = SEED;
+    bool ignore_eos = false;
+    if (options && options->is_object()) {
+        limit = options->value("num_predict", limit);
+        ignore_eos = options->value("ignore_eos", false);
+        temperature = options->value("temperature", temperature);
+        top_k = options->value("top_k", top_k);
+        seed = options->value("seed", seed);
+    }
+    if (limit < 0) {
+        limit = model->get_context_length();
+    }
+
+    std::vector<int> tokens = tokenizer->encode(prompt);
+    if (tokens.empty()) {
+        tokens.push_back(tokenizer->bos());
+    }
+
+    // Keep the end of an over-long prompt and leave room to generate
+    const int n_ctx = model->get_context_length();
+    const size_t budget = std::max(1, n_ctx - std::min(limit, n_ctx / 2));
+    if (tokens.size() > budget) {
+        if (verbose) {
+            std::cout << "[DEBUG] Prompt truncated from " << tokens.size() << " to " << budget << " tokens" << std::endl;
+        }
+        tokens.erase(tokens.begin(), tokens.end() - budget);
+    }
+
+    rng.seed(seed);
+
+    auto prefill_start = std::chrono::steady_clock::now();
+    const float* logits = nullptr;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        logits = model->forward(tokens[i], static_cast<int>(i));
+    }
+    auto prefill_end = std::chrono::steady_clock::now();
+
+    std::string response;
+    std::vector<double> token_times;
+    int generated = 0;
+    int pos = static_cast<int>(tokens.size());
+    while (generated < limit && pos < n_ctx) {
+        int next = sample(logits, model->get_vocab_size(), temperature, top_k);
+        if (tokenizer->is_end(next) && !ignore_eos) {
+            break;
+        }
+        std::string piece = tokenizer->decode(next);
+        response += piece;
+        if (stream) {
+            token_times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            if (verbose) {
+                std::cout << piece << std::flush;
+            }
+        }
+        generated++;
+        if (generated < limit) {
+            logits = model->forward(next, pos++);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (stream && verbose) {
+        std::cout << std::endl;
+    }
+
+    GenerationMetrics result;
+    result.prompt_eval_count = static_cast<int>(tokens.size());
+    result.eval_count = generated;
+    result.load_duration = load_seconds;
+    result.prompt_eval_duration = std::chrono::duration<double>(prefill_end - prefill_start).count();
+    result.eval_duration = std::chrono::duration<double>(end - prefill_end).count();
+    result.total_duration = std::chrono::duration<double>(end - start).count();
+    result.wall_time = result.total_duration;
+    result.token_times = std::move(token_times);
+
+    if (metrics) {
+        *metrics = result;
+    }
+
+    if (verbose) {
+        std::cout << "\nPERFORMANCE METRICS:" << std::endl;
+        std::cout << std::left << std::setw(25) << "total duration:" << result.total_duration << "s" << std::endl;
+        std::cout << std::left << std::setw(25) << "load duration:" << result.load_duration << "s" << std::endl;
+        std::cout << std::left << std::setw(25) << "prompt eval count:" << result.prompt_eval_count << " token(s)" << std::endl;
+        std::cout << std::left << std::setw(25) << "prompt eval duration:" << result.prompt_eval_duration << "s" << std::endl;
+        std::cout << std::left << std::setw(25) << "prompt eval rate:"
+                  << std::fixed << std::setprecision(2) << result.prefill_rate() << " tokens/s" << std::endl;
+        std::cout << std::left << std::setw(25) << "eval count:" << result.eval_count << " token(s)" << std::endl;
+        std::cout << std::left << std::setw(25) << "eval duration:" << result.eval_duration << "s" << std::endl;
+        std::cout << std::left << std::setw(25) << "eval rate:"
+                  << std::fixed << std::setprecision(2) << result.decode_rate() << " tokens/s" << std::endl;
+    }
+
+    return sanitize_utf8(response);
+}
+
+bool GgufBackend::unload_model(const std::string& model_name) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (loaded_model == model_name) {
+        model.reset();
+        tokenizer.reset();
+        file.reset();
+        loaded_model.clear();
+    }
+    return true;
+}
@@ -0,0 +1,410 @@
+#include "gguf_file.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+// Metadata value types
+enum GgufValueType : uint32_t {
+    GGUF_UINT8 = 0, GGUF_INT8 = 1, GGUF_UINT16 = 2, GGUF_INT16 = 3, GGUF_UINT32 = 4, GGUF_INT32 = 5,
+    GGUF_FLOAT32 = 6, GGUF_BOOL = 7, GGUF_STRING = 8, GGUF_ARRAY = 9, GGUF_UINT64 = 10, GGUF_INT64 = 11,
+    GGUF_FLOAT64 = 12
+};
+
+/**
+ * Bounds-checked little-endian reader over the mapping. After the first
+ * overrun every read returns zero and ok stays false.
+ */
+struct Cursor {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+    bool ok;
+    bool skip_arrays;  // Step over array values instead of converting them
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (!ok || size - pos < sizeof(T)) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    std::string read_string() {
+        uint64_t length = read<uint64_t>();
+        if (!ok || size - pos < length) {
+            ok = false;
+            return "";
+        }
+        std::string value(reinterpret_cast<const char*>(data + pos), length);
+        pos += length;
+        return value;
+    }
+
+    void skip(uint64_t bytes) {
+        if (!ok || size - pos < bytes) {
+            ok = false;
+            return;
+        }
+        pos += bytes;
+    }
+
+    json read_value(uint32_t type) {
+        switch (type) {
+            case GGUF_UINT8: return read<uint8_t>();
+            case GGUF_INT8: return read<int8_t>();
+            case GGUF_UINT16: return read<uint16_t>();
+            case GGUF_INT16: return read<int16_t>();
+            case GGUF_UINT32: return read<uint32_t>();
+            case GGUF_INT32: return read<int32_t>();
+            case GGUF_FLOAT32: return read<float>();
+            case GGUF_BOOL: return read<uint8_t>() != 0;
+            case GGUF_STRING: return read_string();
+            case GGUF_UINT64: return read<uint64_t>();
+            case GGUF_INT64: return read<int64_t>();
+            case GGUF_FLOAT64: return read<double>();
+            case GGUF_ARRAY: {
+                uint32_t item_type = read<uint32_t>();
+                uint64_t count = read<uint64_t>();
+                json items = json::array();
+                // Every item takes at least one byte, which bounds count on corrupt files
+                if (item_type == GGUF_ARRAY || count > size - pos) {
+                    ok = false;
+                    return items;
+                }
+                if (skip_arrays) {
+                    // Only the size of the array is needed to find the next key
+                    for (uint64_t i = 0; i < count && ok; ++i) {
+                        skip(item_type == GGUF_STRING ? read<uint64_t>() : value_size(item_type));
+                    }
+                    return nullptr;
+                }
+                items.get_ref<json::array_t&>().reserve(count);
+                for (uint64_t i = 0; i < count && ok; ++i) {
+                    items.push_back(read_value(item_type));
+                }
+                return items;
+            }
+            default:
+                ok = false;
+                return nullptr;
+        }
+    }
+
+    // Bytes of a fixed-size value (0 for strings, arrays and unknown types)
+    uint64_t value_size(uint32_t type) {
+        switch (type) {
+            case GGUF_UINT8: case GGUF_INT8: case GGUF_BOOL: return 1;
+            case GGUF_UINT16: case GGUF_INT16: return 2;
+            case GGUF_UINT32: case GGUF_INT32: case GGUF_FLOAT32: return 4;
+            case GGUF_UINT64: case GGUF_INT64: case GGUF_FLOAT64: return 8;
+            default:
+                ok = false;
+                return 0;
+        }
+    }
+};
+
+} // namespace
+
+uint64_t GgufTensor::elements() const {
+    uint64_t count = 1;
+    for (uint64_t dim : dims) {
+        count *= dim;
+    }
+    return count;
+}
+
+GgufFile::GgufFile()
+    : fd(-1), base(nullptr), file_size(0), version(0), alignment(32), data_offset(0), skip_arrays(false) {
+}
+
+GgufFile::~GgufFile() {
+    close();
+}
+
+bool GgufFile::open(const std::string& file_path, bool metadata_only) {
+    close();
+    skip_arrays = metadata_only;
+    path = file_path;
+
+    fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open GGUF file " << file_path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < 24) {
+        std::cerr << "Error: " << file_path << " is too small to be a GGUF file" << std::endl;
+        close();
+        return false;
+    }
+    file_size = info.st_size;
+
+    void* mapping = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Error: Could not map " << file_path << ": " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    base = static_cast<uint8_t*>(mapping);
+
+    if (!parse()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool GgufFile::parse() {
+    Cursor cursor{base, file_size, 0, true, skip_arrays};
+
+    if (std::memcmp(base, "GGUF", 4) != 0) {
+        std::cerr << "Error: " << path << " is not a GGUF file" << std::endl;
+        return false;
+    }
+    cursor.pos = 4;
+    version = cursor.read<uint32_t>();
+    if (version < 2 || version > 3) {
+        std::cerr << "Error: Unsupported GGUF version " << version << " in " << path << std::endl;
+        return false;
+    }
+
+    uint64_t tensor_count = cursor.read<uint64_t>();
+    uint64_t kv_count = cursor.read<uint64_t>();
+
+    metadata = json::object();
+    for (uint64_t i = 0; i < kv_count && cursor.ok; ++i) {
+        std::string key = cursor.read_string();
+        uint32_t type = cursor.read<uint32_t>();
+        metadata[key] = cursor.read_value(type);
+    }
+
+    alignment = static_cast<size_t>(get_int("general.alignment", 32));
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        std::cerr << "Error: Invalid alignment " << alignment << " in " << path << std::endl;
+        return false;
+    }
+
+    tensors.clear();
+    tensor_index.clear();
+    for (uint64_t i = 0; i < tensor_count && cursor.ok; ++i) {
+        GgufTensor tensor;
+        tensor.name = cursor.read_string();
+        uint32_t n_dims = cursor.read<uint32_t>();
+        if (n_dims > 4) {
+            cursor.ok = false;
+            break;
+        }
+        for (uint32_t d = 0; d < n_dims; ++d) {
+            tensor.dims.push_back(cursor.read<uint64_t>());
+        }
+        tensor.type = static_cast<GgmlType>(cursor.read<uint32_t>());
+        tensor.offset = cursor.read<uint64_t>();
+        tensor.data = nullptr;
+        tensor.bytes = 0;
+        tensors.push_back(tensor);
+    }
+
+    if (!cursor.ok) {
+        std::cerr << "Error: " << path << " is truncated or corrupt" << std::endl;
+        return false;
+    }
+
+    data_offset = (cursor.pos + alignment - 1) / alignment * alignment;
+
+    for (size_t i = 0; i < tensors.size(); ++i) {
+        GgufTensor& tensor = tensors[i];
+        size_t block_elements, block_bytes;
+        if (!type_layout(tensor.type, block_elements, block_bytes)) {
+            std::cerr << "Error: Tensor " << tensor.name << " has unknown type "
+                      << static_cast<uint32_t>(tensor.type) << std::endl;
+            return false;
+        }
+        tensor.bytes = tensor.elements() / block_elements * block_bytes;
+        // Checked in steps: offsets come from the file and the plain sum can wrap
+        if (data_offset > file_size || tensor.offset > file_size - data_offset
+            || tensor.bytes > file_size - data_offset - tensor.offset) {
+            std::cerr << "Error: Tensor " << tensor.name << " extends past the end of " << path << std::endl;
+            return false;
+        }
+        tensor.data = base + data_offset + tensor.offset;
+        tensor_index[tensor.name] = i;
+    }
+
+    return true;
+}
+
+size_t GgufFile::prefetch() const {
+    if (!base || data_offset >= file_size) {
+        return 0;
+    }
+
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    madvise(base + data_offset / page * page, file_size - data_offset / page * page, MADV_WILLNEED);
+
+    volatile uint8_t sink = 0;
+    for (size_t offset = data_offset; offset < file_size; offset += page) {
+        sink = sink + base[offset];
+    }
+    return file_size - data_offset;
+}
+
+void GgufFile::close() {
+    if (base) {
+        munmap(base, file_size);
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    file_size = 0;
+    tensors.clear();
+    tensor_index.clear();
+    metadata = json::object();
+}
+
+bool GgufFile::is_open() const {
+    return base != nullptr;
+}
+
+const std::string& GgufFile::get_path() const {
+    return path;
+}
+
+size_t GgufFile::get_file_size() const {
+    return file_size;
+}
+
+uint32_t GgufFile::get_version() const {
+    return version;
+}
+
+const json& GgufFile::get_metadata() const {
+    return metadata;
+}
+
+std::string GgufFile::get_string(const std::string& key, const std::string& fallback) const {
+    auto it = metadata.find(key);
+    return it != metadata.end() && it->is_string() ? it->get<std::string>() : fallback;
+}
+
+long long GgufFile::get_int(const std::string& key, long long fallback) const {
+    auto it = metadata.find(key);
+    return it != metadata.end() && it->is_number() ? it->get<long long>() : fallback;
+}
+
+double GgufFile::get_float(const std::string& key, double fallback) const {
+    auto it = metadata.find(key);
+    return it != metadata.end() && it->is_number() ? it->get<double>() : fallback;
+}
+
+std::string GgufFile::arch_key(const std::string& suffix) const {
+    return get_string("general.architecture", "llama") + "." + suffix;
+}
+
+const std::vector<GgufTensor>& GgufFile::get_tensors() const {
+    return tensors;
+}
+
+const GgufTensor* GgufFile::find_tensor(const std::string& name) const {
+    auto it = tensor_index.find(name);
+    return it != tensor_index.end() ? &tensors[it->second] : nullptr;
+}
+
+std::string GgufFile::type_name(GgmlType type) {
+    switch (type) {
+        case GgmlType::F32: return "F32";
+        case GgmlType::F16: return "F16";
+        case GgmlType::Q4_0: return "Q4_0";
+        case GgmlType::Q4_1: return "Q4_1";
+        case GgmlType::Q5_0: return "Q5_0";
+        case GgmlType::Q5_1: return "Q5_1";
+        case GgmlType::Q8_0: return "Q8_0";
+        case GgmlType::Q8_1: return "Q8_1";
+        case GgmlType::Q2_K: return "Q2_K";
+        case GgmlType::Q3_K: return "Q3_K";
+        case GgmlType::Q4_K: return "Q4_K";
+        case GgmlType::Q5_K: return "Q5_K";
+        case GgmlType::Q6_K: return "Q6_K";
+        case GgmlType::Q8_K: return "Q8_K";
+        case GgmlType::IQ2_XXS: return "IQ2_XXS";
+        case GgmlType::IQ2_XS: return "IQ2_XS";
+        case GgmlType::IQ3_XXS: return "IQ3_XXS";
+        case GgmlType::IQ1_S: return "IQ1_S";
+        case GgmlType::IQ4_NL: return "IQ4_NL";
+        case GgmlType::IQ3_S: return "IQ3_S";
+        case GgmlType::IQ2_S: return "IQ2_S";
+        case GgmlType::IQ4_XS: return "IQ4_XS";
+        case GgmlType::I8: return "I8";
+        case GgmlType::I16: return "I16";
+        case GgmlType::I32: return "I32";
+        case GgmlType::I64: return "I64";
+        case GgmlType::F64: return "F64";
+        case GgmlType::IQ1_M: return "IQ1_M";
+        case GgmlType::BF16: return "BF16";
+    }
+    return "type" + std::to_string(static_cast<uint32_t>(type));
+}
+
+std::string GgufFile::file_type_name(long long file_type) {
+    // llama_ftype values; gaps are retired types
+    static const char* names[] = {
+        "F32", "F16", "Q4_0", "Q4_1", "", "", "", "Q8_0", "Q5_0", "Q5_1", "Q2_K",
+        "Q3_K_S", "Q3_K_M", "Q3_K_L", "Q4_K_S", "Q4_K_M", "Q5_K_S", "Q5_K_M", "Q6_K",
+        "IQ2_XXS", "IQ2_XS", "Q2_K_S", "IQ3_XS", "IQ3_XXS", "IQ1_S", "IQ4_NL", "IQ3_S",
+        "IQ3_M", "IQ2_S", "IQ2_M", "IQ4_XS", "IQ1_M", "BF16"
+    };
+    file_type &= ~1024LL; // LLAMA_FTYPE_GUESSED
+    if (file_type < 0 || file_type >= static_cast<long long>(sizeof(names) / sizeof(names[0]))) {
+        return "";
+    }
+    return names[file_type];
+}
+
+bool GgufFile::type_layout(GgmlType type, size_t& block_elements, size_t& block_bytes) {
+    // Sizes from ggml's type traits
+    switch (type) {
+        case GgmlType::F32: block_elements = 1; block_bytes = 4; return true;
+        case GgmlType::F16: block_elements = 1; block_bytes = 2; return true;
+        case GgmlType::BF16: block_elements = 1; block_bytes = 2; return true;
+        case GgmlType::F64: block_elements = 1; block_bytes = 8; return true;
+        case GgmlType::I8: block_elements = 1; block_bytes = 1; return true;
+        case GgmlType::I16: block_elements = 1; block_bytes = 2; return true;
+        case GgmlType::I32: block_elements = 1; block_bytes = 4; return true;
+        case GgmlType::I64: block_elements = 1; block_bytes = 8; return true;
+        case GgmlType::Q4_0: block_elements = 32; block_bytes = 18; return true;
+        case GgmlType::Q4_1: block_elements = 32; block_bytes = 20; return true;
+        case GgmlType::Q5_0: block_elements = 32; block_bytes = 22; return true;
+        case GgmlType::Q5_1: block_elements = 32; block_bytes = 24; return true;
+        case GgmlType::Q8_0: block_elements = 32; block_bytes = 34; return true;
+        case GgmlType::Q8_1: block_elements = 32; block_bytes = 36; return true;
+        case GgmlType::IQ4_NL: block_elements = 32; block_bytes = 18; return true;
+        case GgmlType::Q2_K: block_elements = 256; block_bytes = 84; return true;
+        case GgmlType::Q3_K: block_elements = 256; block_bytes = 110; return true;
+        case GgmlType::Q4_K: block_elements = 256; block_bytes = 144; return true;
+        case GgmlType::Q5_K: block_elements = 256; block_bytes = 176; return true;
+        case GgmlType::Q6_K: block_elements = 256; block_bytes = 210; return true;
+        case GgmlType::Q8_K: block_elements = 256; block_bytes = 292; return true;
+        case GgmlType::IQ2_XXS: block_elements = 256; block_bytes = 66; return true;
+        case GgmlType::IQ2_XS: block_elements = 256; block_bytes = 74; return true;
+        case GgmlType::IQ3_XXS: block_elements = 256; block_bytes = 98; return true;
+        case GgmlType::IQ1_S: block_elements = 256; block_bytes = 50; return true;
+        case GgmlType::IQ3_S: block_elements = 256; block_bytes = 110; return true;
+        case GgmlType::IQ2_S: block_elements = 256; block_bytes = 82; return true;
+        case GgmlType::IQ4_XS: block_elements = 256; block_bytes = 136; return true;
+        case GgmlType::IQ1_M: block_elements = 256; block_bytes = 56; return true;
+    }
+    return false;
+}
@@ -0,0 +1,359 @@
+#include "image_pipeline.h"
+#include "sha256.h"
+#include "system_utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <sched.h>
+
+namespace {
+
+// Bump when the payload for the same source and target changes
+const char* const cache_version = "png-stored-1";
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The server decodes PNG and JPEG itself
+bool server_format(const std::string& data) {
+    return (data.size() >= 8 && data.compare(0, 8, "\x89PNG\r\n\x1a\n") == 0) ||
+           (data.size() >= 2 && static_cast<unsigned char>(data[0]) == 0xFF &&
+            static_cast<unsigned char>(data[1]) == 0xD8);
+}
+
+int allowed_cpus() {
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+    return std::max(1, CPU_COUNT(&allowed));
+}
+
+// Input throughput of one base64 encoder in MB/s, best of three
+double base64_mbps(const std::string& sample, KernelIsa isa) {
+    double best = 0.0;
+    for (int i = 0; i < 3; i++) {
+        auto start = std::chrono::steady_clock::now();
+        std::string encoded = base64_encode(sample, isa);
+        double elapsed = seconds_since(start);
+        if (elapsed > 0 && !encoded.empty()) {
+            best = std::max(best, sample.size() / (1024.0 * 1024.0) / elapsed);
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+std::string PpmDecoder::name() const {
+    return "ppm";
+}
+
+bool PpmDecoder::accepts(const std::string& header) const {
+    return header.size() >= 3 && header[0] == 'P' && header[1] == '6' &&
+           (header[2] == ' ' || header[2] == '\t' || header[2] == '\n' || header[2] == '\r' || header[2] == '#');
+}
+
+bool PpmDecoder::decode(const std::string& data, RgbImage& image) const {
+    return decode_ppm(data, image);
+}
+
+ImagePipeline::ImagePipeline(int worker_threads, const std::string& cache_path)
+    : threads(worker_threads > 0 ? worker_threads : allowed_cpus()),
+      cache_dir(cache_path == "-" ? "" : (cache_path.empty() ? default_cache_dir() : cache_path)) {
+    decoders.push_back(std::make_unique<PpmDecoder>());
+}
+
+std::string ImagePipeline::default_cache_dir() {
+    std::string cache;
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg) {
+        cache = xdg;
+    } else {
+        const char* home = std::getenv("HOME");
+        cache = std::string(home ? home : ".") + "/.cache";
+    }
+    return cache + "/edge_ai_benchmark/images";
+}
+
+void ImagePipeline::add_decoder(std::unique_ptr<ImageDecoder> decoder) {
+    if (decoder) {
+        decoders.push_back(std::move(decoder));
+    }
+}
+
+const ImageDecoder* ImagePipeline::find_decoder(const std::string& data) const {
+    const std::string header = data.substr(0, 16);
+    for (const auto& decoder : decoders) {
+        if (decoder->accepts(header)) {
+            return decoder.get();
+        }
+    }
+    return nullptr;
+}
+
+bool ImagePipeline::can_decode(const std::string& path) const {
+    std::ifstream file(path, std::ios::binary);
+    char header[16] = {};
+    file.read(header, sizeof(header));
+    return find_decoder(std::string(header, file.gcount())) != nullptr;
+}
+
+bool ImagePipeline::read_cache(const std::string& key, ImagePayload& payload) const {
+    std::ifstream file(cache_dir + "/" + key + ".b64", std::ios::binary);
+    std::string header;
+    if (!file.is_open() || !std::getline(file, header)) {
+        return false;
+    }
+    json meta = json::parse(header, nullptr, false);
+    if (meta.is_discarded() || !meta.is_object()) {
+        return false;
+    }
+    std::string base64((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (base64.empty() || base64.size() != meta.value("base64_bytes", size_t(0))) {
+        return false; // Truncated or from another version
+    }
+    payload.width = meta.value("width", 0);
+    payload.height = meta.value("height", 0);
+    payload.encoded_bytes = meta.value("encoded_bytes", size_t(0));
+    payload.base64 = std::move(base64);
+    return true;
+}
+
+void ImagePipeline::write_cache(const std::string& key, const ImagePayload& payload) const {
+    // Write aside and rename, so a reader never sees half an entry
+    std::stringstream tmp_name;
+    tmp_name << cache_dir << "/" << key << ".tmp." << std::this_thread::get_id();
+    {
+        std::ofstream file(tmp_name.str(), std::ios::binary);
+        if (!file.is_open()) {
+            return;
+        }
+        json meta = {
+            {"width", payload.width},
+            {"height", payload.height},
+            {"encoded_bytes", payload.encoded_bytes},
+            {"base64_bytes", payload.base64.size()}
+        };
+        file << meta.dump() << "\n" << payload.base64;
+        if (!file.good()) {
+            file.close();
+            std::remove(tmp_name.str().c_str());
+            return;
+        }
+    }
+    std::rename(tmp_name.str().c_str(), (cache_dir + "/" + key + ".b64").c_str());
+}
+
+ImagePayload ImagePipeline::prepare_one(const ImageJob& job, PreprocessStats& stats) const {
+    ImagePayload payload;
+    payload.name = job.name;
+    payload.native = job.size <= 0;
+    payload.width = 0;
+    payload.height = 0;
+    payload.encoded_bytes = 0;
+    payload.cached = false;
+    payload.ok = false;
+
+    auto start = std::chrono::steady_clock::now();
+    std::string source;
+    if (!job.path.empty() && !read_binary_file(job.path, source)) {
+        payload.error = "could not read " + job.path;
+        return payload;
+    }
+    stats.read_seconds += seconds_since(start);
+
+    // Content address: what the payload is made from and what is done to it
+    start = std::chrono::steady_clock::now();
+    Sha256 sha;
+    sha.update(std::string(cache_version) + "\n");
+    sha.update(job.path.empty() ? "pattern:" + std::to_string(job.size) + "\n"
+                                : (payload.native ? "native\n" : "scale:" + std::to_string(job.size) + "\n"));
+    sha.update(source);
+    const std::string key = sha.hex_digest();
+    stats.hash_seconds += seconds_since(start);
+
+    if (!cache_dir.empty()) {
+        start = std::chrono::steady_clock::now();
+        bool hit = read_cache(key, payload);
+        stats.cache_seconds += seconds_since(start);
+        if (hit) {
+            payload.cached = true;
+            payload.ok = true;
+            stats.cache_hits++;
+            stats.base64_bytes += payload.base64.size();
+            return payload;
+        }
+    }
+
+    std::string encoded;
+    if (job.path.empty()) {
+        start = std::chrono::steady_clock::now();
+        RgbImage pattern = test_pattern(job.size, job.size, static_cast<unsigned>(job.size));
+        stats.resize_seconds += seconds_since(start);
+        start = std::chrono::steady_clock::now();
+        encoded = encode_png(pattern);
+        stats.png_seconds += seconds_since(start);
+        payload.width = pattern.width;
+        payload.height = pattern.height;
+    } else if (payload.native && server_format(source)) {
+        encoded = std::move(source);
+        image_dimensions(encoded, payload.width, payload.height);
+    } else {
+        const ImageDecoder* decoder = find_decoder(source);
+        if (!decoder) {
+            payload.error = "no decoder for " + job.path;
+            return payload;
+        }
+        start = std::chrono::steady_clock::now();
+        RgbImage image;
+        bool decoded = decoder->decode(source, image);
+        stats.decode_seconds += seconds_since(start);
+        if (!decoded) {
+            payload.error = decoder->name() + " decoder could not read " + job.path;
+            return payload;
+        }
+        if (!payload.native) {
+            // Longest side becomes the target size, keeping the aspect ratio
+            start = std::chrono::steady_clock::now();
+            double scale = static_cast<double>(job.size) / std::max(image.width, image.height);
+            image = resize_image(image,
+                                 std::max(1, static_cast<int>(image.width * scale + 0.5)),
+                                 std::max(1, static_cast<int>(image.height * scale + 0.5)));
+            stats.resize_seconds += seconds_since(start);
+        }
+        start = std::chrono::steady_clock::now();
+        encoded = encode_png(image);
+        stats.png_seconds += seconds_since(start);
+        payload.width = image.width;
+        payload.height = image.height;
+    }
+
+    start = std::chrono::steady_clock::now();
+    payload.encoded_bytes = encoded.size();
+    payload.base64 = base64_encode(encoded);
+    stats.base64_seconds += seconds_since(start);
+    stats.base64_bytes += payload.base64.size();
+    payload.ok = true;
+
+    if (!cache_dir.empty()) {
+        start = std::chrono::steady_clock::now();
+        write_cache(key, payload);
+        stats.cache_seconds += seconds_since(start);
+    }
+    return payload;
+}
+
+std::vector<ImagePayload> ImagePipeline::prepare(const std::vector<ImageJob>& jobs) {
+    std::vector<ImagePayload> payloads(jobs.size());
+    last_stats = PreprocessStats();
+    last_stats.jobs = static_cast<int>(jobs.size());
+    last_stats.threads = std::max(1, std::min<int>(threads, static_cast<int>(jobs.size())));
+    last_stats.isa = isa_name(best_isa());
+
+    if (!cache_dir.empty() && !make_directories(cache_dir)) {
+        std::cerr << "Warning: image payload cache disabled" << std::endl;
+        cache_dir.clear();
+    }
+
+    std::atomic<size_t> next_job(0);
+    std::mutex stats_mutex;
+    auto worker = [&]() {
+        PreprocessStats local;
+        for (size_t i = next_job++; i < jobs.size(); i = next_job++) {
+            payloads[i] = prepare_one(jobs[i], local);
+        }
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        last_stats.cache_hits += local.cache_hits;
+        last_stats.read_seconds += local.read_seconds;
+        last_stats.decode_seconds += local.decode_seconds;
+        last_stats.resize_seconds += local.resize_seconds;
+        last_stats.png_seconds += local.png_seconds;
+        last_stats.base64_seconds += local.base64_seconds;
+        last_stats.hash_seconds += local.hash_seconds;
+        last_stats.cache_seconds += local.cache_seconds;
+        last_stats.base64_bytes += local.base64_bytes;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < last_stats.threads; i++) {
+        workers.emplace_back(worker);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    last_stats.wall_seconds = seconds_since(start);
+
+    // What the vectorized encoder buys on this CPU, on 4 MB of random bytes
+    std::string sample(4 * 1024 * 1024, '\0');
+    std::mt19937 random(1);
+    for (auto& byte : sample) {
+        byte = static_cast<char>(random());
+    }
+    last_stats.base64_scalar_mbps = base64_mbps(sample, KernelIsa::SCALAR);
+    last_stats.base64_simd_mbps = base64_mbps(sample, best_isa());
+    return payloads;
+}
+
+const PreprocessStats& ImagePipeline::stats() const {
+    return last_stats;
+}
+
+const std::string& ImagePipeline::get_cache_dir() const {
+    return cache_dir;
+}
+
+void ImagePipeline::print(const PreprocessStats& stats) {
+    std::cout << "Payloads: " << stats.jobs << " (" << stats.cache_hits << " from cache), "
+              << format_memory(stats.base64_bytes / 1024) << " of base64, prepared by "
+              << stats.threads << " thread(s) in " << std::fixed << std::setprecision(3)
+              << stats.wall_seconds << "s" << std::endl;
+    std::cout << "CPU time by stage:";
+    const std::pair<const char*, double> stages[] = {
+        {"read", stats.read_seconds}, {"hash", stats.hash_seconds}, {"cache", stats.cache_seconds},
+        {"decode", stats.decode_seconds}, {"resize", stats.resize_seconds}, {"png", stats.png_seconds},
+        {"base64", stats.base64_seconds}
+    };
+    for (const auto& stage : stages) {
+        std::cout << " " << stage.first << " " << std::setprecision(1) << 1000.0 * stage.second << " ms";
+    }
+    std::cout << std::endl;
+    std::cout << "base64 encoder: scalar " << std::setprecision(0) << stats.base64_scalar_mbps << " MB/s, "
+              << stats.isa << " " << stats.base64_simd_mbps << " MB/s" << std::defaultfloat << std::endl;
+    std::cout << "Timed requests did no image work; every payload was ready before the first one" << std::endl;
+}
+
+json ImagePipeline::to_json(const PreprocessStats& stats) {
+    return {
+        {"jobs", stats.jobs},
+        {"cache_hits", stats.cache_hits},
+        {"threads", stats.threads},
+        {"wall_s", stats.wall_seconds},
+        {"cpu_s", {
+            {"read", stats.read_seconds},
+            {"hash", stats.hash_seconds},
+            {"cache", stats.cache_seconds},
+            {"decode", stats.decode_seconds},
+            {"resize", stats.resize_seconds},
+            {"png", stats.png_seconds},
+            {"base64", stats.base64_seconds}
+        }},
+        {"base64_bytes", stats.base64_bytes},
+        {"base64_isa", stats.isa},
+        {"base64_scalar_mb_per_s", stats.base64_scalar_mbps},
+        {"base64_simd_mb_per_s", stats.base64_simd_mbps}
+    };
+}
@@ -0,0 +1,406 @@
+#include "image_utils.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BASE64_X86 1
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define BASE64_NEON 1
+#endif
+
+namespace {
+
+uint32_t crc32(const std::string& data, size_t offset) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> entries{};
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[n] = c;
+        }
+        return entries;
+    }();
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = offset; i < data.size(); i++) {
+        c = table[(c ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+void put_u32(std::string& out, uint32_t value) {
+    out.push_back(static_cast<char>(value >> 24));
+    out.push_back(static_cast<char>(value >> 16));
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+uint32_t get_u32(const std::string& data, size_t offset) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(data[offset])) << 24) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(data[offset + 1])) << 16) |
+           (static_cast<uint32_t>(static_cast<unsigned char>(data[offset + 2])) << 8) |
+           static_cast<uint32_t>(static_cast<unsigned char>(data[offset + 3]));
+}
+
+void put_chunk(std::string& out, const char* type, const std::string& body) {
+    put_u32(out, static_cast<uint32_t>(body.size()));
+    size_t start = out.size();
+    out.append(type, 4);
+    out += body;
+    put_u32(out, crc32(out, start));
+}
+
+/**
+ * @brief Next header field of a PPM: skips whitespace and # comments
+ */
+bool ppm_field(const std::string& data, size_t& pos, int& value) {
+    while (pos < data.size()) {
+        if (std::isspace(static_cast<unsigned char>(data[pos]))) {
+            pos++;
+        } else if (data[pos] == '#') {
+            while (pos < data.size() && data[pos] != '\n') {
+                pos++;
+            }
+        } else {
+            break;
+        }
+    }
+    if (pos >= data.size() || !std::isdigit(static_cast<unsigned char>(data[pos]))) {
+        return false;
+    }
+    long parsed = 0;
+    while (pos < data.size() && std::isdigit(static_cast<unsigned char>(data[pos]))) {
+        parsed = parsed * 10 + (data[pos++] - '0');
+        if (parsed > 1 << 20) {
+            return false;
+        }
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+} // namespace
+
+bool read_binary_file(const std::string& path, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+bool image_dimensions(const std::string& data, int& width, int& height) {
+    // PNG: the IHDR chunk comes first
+    if (data.size() >= 24 && data.compare(0, 8, "\x89PNG\r\n\x1a\n") == 0 && data.compare(12, 4, "IHDR") == 0) {
+        width = static_cast<int>(get_u32(data, 16));
+        height = static_cast<int>(get_u32(data, 20));
+        return true;
+    }
+
+    // JPEG: walk the markers up to the first start-of-frame
+    if (data.size() >= 4 && static_cast<unsigned char>(data[0]) == 0xFF && static_cast<unsigned char>(data[1]) == 0xD8) {
+        size_t pos = 2;
+        while (pos + 9 < data.size()) {
+            if (static_cast<unsigned char>(data[pos]) != 0xFF) {
+                return false;
+            }
+            unsigned char marker = static_cast<unsigned char>(data[pos + 1]);
+            if (marker == 0xFF) {
+                pos++;
+                continue;
+            }
+            size_t length = (static_cast<unsigned char>(data[pos + 2]) << 8) | static_cast<unsigned char>(data[pos + 3]);
+            bool frame = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+            if (frame) {
+                height = (static_cast<unsigned char>(data[pos + 5]) << 8) | static_cast<unsigned char>(data[pos + 6]);
+                width = (static_cast<unsigned char>(data[pos + 7]) << 8) | static_cast<unsigned char>(data[pos + 8]);
+                return true;
+            }
+            pos += 2 + length;
+        }
+        return false;
+    }
+
+    size_t pos = 2;
+    return data.size() > 2 && data[0] == 'P' && data[1] == '6' &&
+           ppm_field(data, pos, width) && ppm_field(data, pos, height);
+}
+
+bool decode_ppm(const std::string& data, RgbImage& image) {
+    if (data.size() < 2 || data[0] != 'P' || data[1] != '6') {
+        return false;
+    }
+    size_t pos = 2;
+    int width = 0;
+    int height = 0;
+    int maxval = 0;
+    if (!ppm_field(data, pos, width) || !ppm_field(data, pos, height) || !ppm_field(data, pos, maxval)) {
+        return false;
+    }
+    pos++; // Single whitespace byte before the raster
+    size_t bytes = static_cast<size_t>(width) * height * 3;
+    if (width <= 0 || height <= 0 || maxval <= 0 || maxval > 255 || pos + bytes > data.size()) {
+        return false;
+    }
+
+    image.width = width;
+    image.height = height;
+    image.pixels.assign(data.begin() + pos, data.begin() + pos + bytes);
+    if (maxval != 255) {
+        for (auto& value : image.pixels) {
+            value = static_cast<unsigned char>(std::min(255, value * 255 / maxval));
+        }
+    }
+    return true;
+}
+
+RgbImage resize_image(const RgbImage& image, int width, int height) {
+    RgbImage out;
+    out.width = std::max(1, width);
+    out.height = std::max(1, height);
+    out.pixels.resize(static_cast<size_t>(out.width) * out.height * 3);
+    if (image.width <= 0 || image.height <= 0) {
+        return out;
+    }
+
+    // Source columns and 8-bit weights for every output column, sampled at pixel centres
+    const int out_row = out.width * 3;
+    std::vector<int> left(out_row), right(out_row), weight(out_row);
+    const float scale_x = static_cast<float>(image.width) / out.width;
+    for (int x = 0; x < out.width; x++) {
+        float sx = std::max(0.0f, (x + 0.5f) * scale_x - 0.5f);
+        int x0 = std::min(static_cast<int>(sx), image.width - 1);
+        int x1 = std::min(x0 + 1, image.width - 1);
+        int w = static_cast<int>((sx - x0) * 256.0f + 0.5f);
+        for (int c = 0; c < 3; c++) {
+            left[x * 3 + c] = x0 * 3 + c;
+            right[x * 3 + c] = x1 * 3 + c;
+            weight[x * 3 + c] = w;
+        }
+    }
+
+    // Separable: blend each needed source row horizontally once, then blend two rows vertically.
+    // Fixed point (x256 per pass) keeps the loops in integers so the compiler vectorizes them.
+    std::vector<int> upper(out_row), lower(out_row);
+    int upper_row = -1;
+    int lower_row = -1;
+    auto horizontal = [&](int row, std::vector<int>& dst) {
+        const unsigned char* src = &image.pixels[static_cast<size_t>(row) * image.width * 3];
+        for (int i = 0; i < out_row; i++) {
+            dst[i] = src[left[i]] * (256 - weight[i]) + src[right[i]] * weight[i];
+        }
+    };
+
+    const float scale_y = static_cast<float>(image.height) / out.height;
+    for (int y = 0; y < out.height; y++) {
+        float sy = std::max(0.0f, (y + 0.5f) * scale_y - 0.5f);
+        int y0 = std::min(static_cast<int>(sy), image.height - 1);
+        int y1 = std::min(y0 + 1, image.height - 1);
+        int wy = static_cast<int>((sy - y0) * 256.0f + 0.5f);
+        if (y0 != upper_row) {
+            if (y0 == lower_row) {
+                std::swap(upper, lower);
+                std::swap(upper_row, lower_row);
+            } else {
+                horizontal(y0, upper);
+                upper_row = y0;
+            }
+        }
+        if (y1 != lower_row) {
+            horizontal(y1, lower);
+            lower_row = y1;
+        }
+        unsigned char* dst = &out.pixels[static_cast<size_t>(y) * out_row];
+        for (int i = 0; i < out_row; i++) {
+            dst[i] = static_cast<unsigned char>((upper[i] * (256 - wy) + lower[i] * wy + (1 << 15)) >> 16);
+        }
+    }
+    return out;
+}
+
+RgbImage test_pattern(int width, int height, unsigned seed) {
+    RgbImage image;
+    image.width = std::max(1, width);
+    image.height = std::max(1, height);
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height * 3);
+    const int cell = std::max(4, std::min(image.width, image.height) / 8);
+    for (int y = 0; y < image.height; y++) {
+        for (int x = 0; x < image.width; x++) {
+            unsigned char* p = &image.pixels[(static_cast<size_t>(y) * image.width + x) * 3];
+            bool checker = (((x + seed) / cell) + (y / cell)) % 2 == 0;
+            p[0] = static_cast<unsigned char>(255 * x / image.width);
+            p[1] = static_cast<unsigned char>(255 * y / image.height);
+            p[2] = static_cast<unsigned char>(checker ? 200 : (seed * 37) & 0xFF);
+        }
+    }
+    return image;
+}
+
+std::string encode_png(const RgbImage& image) {
+    // Filtered scanlines: filter type 0 (none) before every row
+    const size_t row_bytes = static_cast<size_t>(image.width) * 3;
+    std::string raw;
+    raw.reserve((row_bytes + 1) * image.height);
+    for (int y = 0; y < image.height; y++) {
+        raw.push_back('\0');
+        raw.append(reinterpret_cast<const char*>(&image.pixels[y * row_bytes]), row_bytes);
+    }
+
+    // zlib stream of stored blocks (at most 65535 bytes each) and the Adler-32 checksum
+    std::string idat = "\x78\x01";
+    uint32_t a = 1;
+    uint32_t b = 0;
+    size_t pos = 0;
+    do {
+        size_t length = std::min<size_t>(65535, raw.size() - pos);
+        bool last = pos + length == raw.size();
+        idat.push_back(last ? '\x01' : '\x00');
+        idat.push_back(static_cast<char>(length & 0xFF));
+        idat.push_back(static_cast<char>(length >> 8));
+        idat.push_back(static_cast<char>(~length & 0xFF));
+        idat.push_back(static_cast<char>((~length >> 8) & 0xFF));
+        idat.append(raw, pos, length);
+        for (size_t i = pos; i < pos + length; i++) {
+            a = (a + static_cast<unsigned char>(raw[i])) % 65521;
+            b = (b + a) % 65521;
+        }
+        pos += length;
+    } while (pos < raw.size());
+    put_u32(idat, (b << 16) | a);
+
+    std::string header;
+    put_u32(header, static_cast<uint32_t>(image.width));
+    put_u32(header, static_cast<uint32_t>(image.height));
+    header += std::string("\x08\x02\x00\x00\x00", 5); // 8-bit RGB, deflate, adaptive filtering, no interlace
+
+    std::string png = "\x89PNG\r\n\x1a\n";
+    put_chunk(png, "IHDR", header);
+    put_chunk(png, "IDAT", idat);
+    put_chunk(png, "IEND", "");
+    return png;
+}
+
+namespace {
+
+const char base64_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Encodes data[i..] to the end, including the padding
+void base64_scalar(const std::string& data, size_t i, std::string& out) {
+    for (; i + 2 < data.size(); i += 3) {
+        uint32_t n = (static_cast<unsigned char>(data[i]) << 16) |
+                     (static_cast<unsigned char>(data[i + 1]) << 8) |
+                     static_cast<unsigned char>(data[i + 2]);
+        out.push_back(base64_alphabet[(n >> 18) & 63]);
+        out.push_back(base64_alphabet[(n >> 12) & 63]);
+        out.push_back(base64_alphabet[(n >> 6) & 63]);
+        out.push_back(base64_alphabet[n & 63]);
+    }
+    if (i < data.size()) {
+        uint32_t n = static_cast<unsigned char>(data[i]) << 16;
+        if (i + 1 < data.size()) {
+            n |= static_cast<unsigned char>(data[i + 1]) << 8;
+        }
+        out.push_back(base64_alphabet[(n >> 18) & 63]);
+        out.push_back(base64_alphabet[(n >> 12) & 63]);
+        out.push_back(i + 1 < data.size() ? base64_alphabet[(n >> 6) & 63] : '=');
+        out.push_back('=');
+    }
+}
+
+#ifdef BASE64_X86
+// 12 bytes to 16 characters per step (W. Mula's method); returns the bytes consumed
+SSSE3_TARGET size_t base64_ssse3(const std::string& data, std::string& out) {
+    const __m128i split = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    // Offset from a 6-bit index to its character, chosen by the index range
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                          '/' - 63, 'A', 0, 0);
+    const size_t start = out.size();
+    size_t i = 0;
+    // Each load reads 16 bytes of which 12 are used
+    size_t steps = data.size() >= 16 ? (data.size() - 4) / 12 : 0;
+    out.resize(start + steps * 16);
+    char* dst = &out[start];
+    for (size_t step = 0; step < steps; step++, i += 12, dst += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data.data() + i));
+        in = _mm_shuffle_epi8(in, split);
+        // Move the four 6-bit fields of every 3 bytes into their own byte
+        __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+        __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+        __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        __m128i indices = _mm_or_si128(t1, t3);
+        // 0-25 -> 13, 26-51 -> 0, 52-61 -> 1-10, 62 -> 11, 63 -> 12
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+        __m128i chars = _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), chars);
+    }
+    return i;
+}
+#endif // BASE64_X86
+
+#ifdef BASE64_NEON
+// 48 bytes to 64 characters per step; returns the bytes consumed
+size_t base64_neon(const std::string& data, std::string& out) {
+    const uint8x16x4_t table = vld1q_u8_x4(reinterpret_cast<const uint8_t*>(base64_alphabet));
+    const size_t start = out.size();
+    size_t steps = data.size() / 48;
+    out.resize(start + steps * 64);
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(data.data());
+    uint8_t* dst = reinterpret_cast<uint8_t*>(&out[start]);
+    for (size_t step = 0; step < steps; step++, src += 48, dst += 64) {
+        uint8x16x3_t in = vld3q_u8(src);
+        uint8x16x4_t indices;
+        indices.val[0] = vshrq_n_u8(in.val[0], 2);
+        indices.val[1] = vorrq_u8(vshlq_n_u8(vandq_u8(in.val[0], vdupq_n_u8(0x03)), 4), vshrq_n_u8(in.val[1], 4));
+        indices.val[2] = vorrq_u8(vshlq_n_u8(vandq_u8(in.val[1], vdupq_n_u8(0x0F)), 2), vshrq_n_u8(in.val[2], 6));
+        indices.val[3] = vandq_u8(in.val[2], vdupq_n_u8(0x3F));
+        uint8x16x4_t chars;
+        for (int k = 0; k < 4; k++) {
+            chars.val[k] = vqtbl4q_u8(table, indices.val[k]);
+        }
+        vst4q_u8(dst, chars);
+    }
+    return steps * 48;
+}
+#endif // BASE64_NEON
+
+} // namespace
+
+std::string base64_encode(const std::string& data, KernelIsa isa) {
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    size_t done = 0;
+    if (isa_supported(isa)) {
+#ifdef BASE64_X86
+        if (isa == KernelIsa::SSE || isa == KernelIsa::AVX2) {
+            done = base64_ssse3(data, out);
+        }
+#endif
+#ifdef BASE64_NEON
+        if (isa == KernelIsa::NEON) {
+            done = base64_neon(data, out);
+        }
+#endif
+    }
+    base64_scalar(data, done, out);
+    return out;
+}
+
+std::string base64_encode(const std::string& data) {
+    static const KernelIsa isa = best_isa();
+    return base64_encode(data, isa);
+}
@@ -0,0 +1,386 @@
+#include "interference_matrix.h"
+#include "memory_monitor.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const int interference_seed = 42;
+
+// A victim request that spends this long loading its model was evicted by the other one
+const double reload_threshold_seconds = 0.5;
+
+double median(std::vector<double> values) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+std::string short_name(const std::string& name, size_t width) {
+    return name.size() > width ? name.substr(0, width - 3) + "..." : name;
+}
+
+std::string format_factor(double factor) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << factor << "x";
+    return out.str();
+}
+
+} // namespace
+
+InterferenceMatrix::InterferenceMatrix(const std::string& prompt_path, const std::string& output_path,
+                                       bool use_memory_mapping)
+    : api("http://localhost:11434", use_memory_mapping),
+      prompt_file(prompt_path),
+      output_file(output_path),
+      num_predict(128),
+      repeats(3),
+      session(std::random_device{}()) {
+    // curl_global_init is not thread-safe; do it before the background thread starts
+    OllamaAPI::initialize();
+}
+
+InterferenceMatrix::~InterferenceMatrix() {
+    OllamaAPI::cleanup();
+}
+
+void InterferenceMatrix::add_model(const std::string& model_name) {
+    if (std::find(models.begin(), models.end(), model_name) == models.end()) {
+        models.push_back(model_name);
+    }
+}
+
+void InterferenceMatrix::set_num_predict(int tokens) {
+    num_predict = std::max(1, tokens);
+}
+
+void InterferenceMatrix::set_repeats(int count) {
+    repeats = std::max(1, count);
+}
+
+InterferenceCell InterferenceMatrix::measure(const std::string& victim, const std::string& load,
+                                             const std::string& prompt) {
+    InterferenceCell cell;
+    cell.victim = victim;
+    cell.load = load;
+    cell.ok = false;
+    cell.decode_rate = 0.0;
+    cell.ttft_seconds = 0.0;
+    cell.decode_slowdown = 1.0;
+    cell.ttft_slowdown = 1.0;
+    cell.load_requests = 0;
+    cell.load_decode_rate = 0.0;
+    cell.reloaded = false;
+    cell.peak_memory = 0;
+
+    json options = {
+        {"num_predict", num_predict},
+        {"seed", interference_seed},
+        {"temperature", 0}
+    };
+
+    MemoryMonitor memory_monitor("ollama", 50);
+    memory_monitor.start();
+
+    // The other model generates back to back until the victim is done
+    std::atomic<bool> stop(false);
+    std::atomic<int> completed(0);
+    std::mutex load_mutex;
+    std::string load_error;
+    int load_tokens = 0;
+    double load_seconds = 0.0;
+    std::thread background;
+    if (!load.empty()) {
+        background = std::thread([&]() {
+            while (!stop) {
+                GenerationMetrics metrics;
+                std::string response = api.generate(load, prompt, false, false, &metrics, &options);
+                std::lock_guard<std::mutex> lock(load_mutex);
+                if (response.rfind("Error:", 0) == 0) {
+                    load_error = response;
+                    break;
+                }
+                // The first request only brings the load up to speed
+                if (completed++ > 0) {
+                    load_tokens += metrics.eval_count;
+                    load_seconds += metrics.eval_duration;
+                }
+            }
+            stop = true;
+        });
+        while (completed == 0 && !stop) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    }
+
+    std::vector<double> rates;
+    std::vector<double> ttfts;
+    for (int i = 0; i < repeats && cell.error.empty(); i++) {
+        if (!load.empty() && stop) {
+            break;
+        }
+        std::string tagged = "[" + std::to_string(session++) + "] " + prompt;
+        GenerationMetrics metrics;
+        std::string response = api.generate(victim, tagged, true, false, &metrics, &options);
+        if (response.rfind("Error:", 0) == 0 || metrics.eval_count == 0) {
+            cell.error = response.rfind("Error:", 0) == 0 ? response : "Error: no tokens generated";
+            break;
+        }
+        rates.push_back(metrics.decode_rate());
+        ttfts.push_back(metrics.token_times.empty() ? metrics.wall_time : metrics.token_times.front());
+        cell.reloaded = cell.reloaded || metrics.load_duration > reload_threshold_seconds;
+    }
+
+    stop = true;
+    if (background.joinable()) {
+        background.join();
+    }
+    memory_monitor.stop();
+
+    if (!load_error.empty() && cell.error.empty()) {
+        cell.error = "load model " + load + ": " + load_error;
+    }
+    cell.ok = cell.error.empty() && !rates.empty();
+    cell.decode_rate = median(rates);
+    cell.ttft_seconds = median(ttfts);
+    cell.load_requests = std::max(0, completed.load() - 1);
+    cell.load_decode_rate = load_seconds > 0 ? load_tokens / load_seconds : 0.0;
+    cell.peak_memory = memory_monitor.get_peak_memory();
+    cell.swap = memory_monitor.get_swap_activity();
+    return cell;
+}
+
+void InterferenceMatrix::run() {
+    if (models.size() < 2) {
+        std::cerr << "Error: The interference matrix needs at least two models" << std::endl;
+        return;
+    }
+
+    std::ifstream file(prompt_file);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string prompt = buffer.str();
+    if (prompt.empty()) {
+        std::cerr << "Error: Empty prompt or failed to read prompt file" << std::endl;
+        return;
+    }
+
+    std::cout << "========== INTERFERENCE MATRIX ==========" << std::endl;
+    std::cout << "Models: " << models.size() << " (" << models.size() * (models.size() - 1) << " ordered pairs)" << std::endl;
+    std::cout << "Requests: " << repeats << " per cell, " << num_predict << " output tokens" << std::endl;
+    std::cout << "Both models of a pair must fit in memory at once (OLLAMA_MAX_LOADED_MODELS)" << std::endl;
+    std::cout << "=========================================" << std::endl;
+
+    // Load every model once so load time never lands in a measurement
+    json warmup_options = {{"num_predict", 1}};
+    std::vector<std::string> usable;
+    for (const auto& model : models) {
+        std::string response = api.generate(model, "Hello", false, false, nullptr, &warmup_options);
+        if (response.rfind("Error:", 0) == 0) {
+            std::cerr << "Error: interference matrix could not run " << model << ": " << response << std::endl;
+        } else {
+            usable.push_back(model);
+        }
+    }
+    if (usable.size() < 2) {
+        std::cerr << "Error: The interference matrix needs at least two models that run" << std::endl;
+        return;
+    }
+
+    std::vector<InterferenceCell> cells;
+    for (const auto& model : usable) {
+        std::cout << "\n" << model << " alone..." << std::flush;
+        InterferenceCell cell = measure(model, "", prompt);
+        std::cout << " " << std::fixed << std::setprecision(2) << cell.decode_rate << " tokens/sec"
+                  << std::defaultfloat << std::endl;
+        cells.push_back(cell);
+    }
+
+    for (const auto& victim : usable) {
+        const InterferenceCell* alone = nullptr;
+        for (const auto& cell : cells) {
+            if (cell.victim == victim && cell.load.empty()) {
+                alone = &cell;
+            }
+        }
+        double alone_rate = alone && alone->ok ? alone->decode_rate : 0.0;
+        double alone_ttft = alone && alone->ok ? alone->ttft_seconds : 0.0;
+
+        for (const auto& load : usable) {
+            if (load == victim) {
+                continue;
+            }
+            std::cout << victim << " under " << load << "..." << std::flush;
+            InterferenceCell cell = measure(victim, load, prompt);
+            if (cell.ok && cell.decode_rate > 0 && alone_rate > 0) {
+                cell.decode_slowdown = alone_rate / cell.decode_rate;
+            }
+            if (cell.ok && alone_ttft > 0) {
+                cell.ttft_slowdown = cell.ttft_seconds / alone_ttft;
+            }
+            std::cout << " " << std::fixed << std::setprecision(2) << cell.decode_rate << " tokens/sec ("
+                      << format_factor(cell.decode_slowdown) << " slower)" << std::defaultfloat << std::endl;
+            cells.push_back(cell);
+        }
+    }
+
+    for (const auto& model : usable) {
+        api.unload_model(model);
+    }
+
+    std::cout << "\nINTERFERENCE MATRIX:" << std::endl;
+    print(usable, cells);
+
+    if (!output_file.empty()) {
+        std::ofstream out(output_file);
+        if (out.is_open()) {
+            json j;
+            j["metadata"]["prompt_file"] = prompt_file;
+            j["metadata"]["models"] = usable;
+            j["metadata"]["num_predict"] = num_predict;
+            j["metadata"]["repeats"] = repeats;
+            j["interference"] = to_json(cells);
+            out << std::setw(4) << j << std::endl;
+            std::cout << "\nJSON results saved to " << output_file << std::endl;
+        } else {
+            std::cerr << "Error: Could not open output file " << output_file << std::endl;
+        }
+    }
+}
+
+void InterferenceMatrix::print(const std::vector<std::string>& models, const std::vector<InterferenceCell>& cells) {
+    auto find = [&](const std::string& victim, const std::string& load) -> const InterferenceCell* {
+        for (const auto& cell : cells) {
+            if (cell.victim == victim && cell.load == load) {
+                return &cell;
+            }
+        }
+        return nullptr;
+    };
+
+    // Rows are the measured model, columns the model running beside it
+    auto matrix = [&](const std::string& title, bool decode) {
+        std::cout << title << std::endl;
+        std::cout << std::left << std::setw(22) << "Model \\ under load";
+        for (const auto& load : models) {
+            std::cout << std::setw(15) << short_name(load, 13);
+        }
+        std::cout << std::endl << std::string(22 + 15 * models.size(), '-') << std::endl;
+        for (const auto& victim : models) {
+            std::cout << std::left << std::setw(22) << short_name(victim, 20);
+            for (const auto& load : models) {
+                const InterferenceCell* cell = find(victim, load == victim ? "" : load);
+                std::ostringstream text;
+                if (!cell || !cell->ok) {
+                    text << "failed";
+                } else if (load == victim) {
+                    text << std::fixed << std::setprecision(decode ? 2 : 3)
+                         << (decode ? cell->decode_rate : cell->ttft_seconds) << (decode ? " t/s" : " s");
+                } else {
+                    text << format_factor(decode ? cell->decode_slowdown : cell->ttft_slowdown);
+                }
+                std::cout << std::setw(15) << text.str();
+            }
+            std::cout << std::endl;
+        }
+    };
+
+    matrix("Decode slowdown (alone tokens/s on the diagonal):", true);
+    std::cout << std::endl;
+    matrix("TTFT slowdown (alone TTFT on the diagonal):", false);
+
+    std::cout << "\nBy pair:" << std::endl;
+    std::cout << std::left << std::setw(22) << "Model"
+              << std::setw(22) << "Under load from"
+              << std::setw(12) << "Decode t/s"
+              << std::setw(9) << "TTFT s"
+              << std::setw(10) << "Load t/s"
+              << std::setw(12) << "Peak RSS"
+              << std::setw(12) << "Swap in"
+              << "Swap out" << std::endl;
+    std::cout << std::string(108, '-') << std::endl;
+    for (const auto& cell : cells) {
+        if (!cell.ok) {
+            continue;
+        }
+        std::cout << std::left << std::setw(22) << short_name(cell.victim, 20)
+                  << std::setw(22) << (cell.load.empty() ? "(alone)" : short_name(cell.load, 20))
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << cell.decode_rate
+                  << std::setprecision(3) << std::setw(9) << cell.ttft_seconds
+                  << std::setprecision(2) << std::setw(10) << cell.load_decode_rate
+                  << std::setw(12) << format_memory(cell.peak_memory)
+                  << std::setw(12) << format_memory(pages_to_kb(cell.swap.pages_in))
+                  << format_memory(pages_to_kb(cell.swap.pages_out))
+                  << std::defaultfloat << std::endl;
+    }
+
+    // Which pairs share a device best: the worse of the two decode slowdowns
+    std::vector<std::pair<double, std::string>> pairs;
+    for (size_t a = 0; a < models.size(); a++) {
+        for (size_t b = a + 1; b < models.size(); b++) {
+            const InterferenceCell* ab = find(models[a], models[b]);
+            const InterferenceCell* ba = find(models[b], models[a]);
+            if (!ab || !ba || !ab->ok || !ba->ok) {
+                continue;
+            }
+            bool swapped = ab->swap.swap_in_active() || ba->swap.swap_in_active();
+            bool reloaded = ab->reloaded || ba->reloaded;
+            pairs.push_back({std::max(ab->decode_slowdown, ba->decode_slowdown),
+                             models[a] + " + " + models[b] + (swapped ? " (swap-in)" : "")
+                             + (reloaded ? " (models evicted each other)" : "")});
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    if (!pairs.empty()) {
+        std::cout << "\nPairs by worst decode slowdown:" << std::endl;
+        for (const auto& pair : pairs) {
+            std::cout << "  " << std::left << std::setw(8) << format_factor(pair.first) << pair.second << std::endl;
+        }
+    }
+
+    for (const auto& cell : cells) {
+        if (!cell.ok) {
+            std::cout << "  " << cell.victim << (cell.load.empty() ? " alone" : " under " + cell.load) << ": "
+                      << cell.error << std::endl;
+        }
+    }
+}
+
+json InterferenceMatrix::to_json(const std::vector<InterferenceCell>& cells) {
+    json j = json::array();
+    for (const auto& cell : cells) {
+        json entry = {
+            {"model", cell.victim},
+            {"load", cell.load.empty() ? json(nullptr) : json(cell.load)},
+            {"ok", cell.ok},
+            {"decode_tokens_per_second", cell.decode_rate},
+            {"ttft_s", cell.ttft_seconds},
+            {"decode_slowdown", cell.decode_slowdown},
+            {"ttft_slowdown", cell.ttft_slowdown},
+            {"load_requests", cell.load_requests},
+            {"load_decode_tokens_per_second", cell.load_decode_rate},
+            {"reloaded", cell.reloaded},
+            {"peak_memory_kb", cell.peak_memory},
+            {"swap_in_pages", cell.swap.pages_in},
+            {"swap_out_pages", cell.swap.pages_out},
+            {"swap_used_delta_kb", cell.swap.swap_used_delta_kb}
+        };
+        if (!cell.error.empty()) {
+            entry["error"] = cell.error;
+        }
+        j.push_back(entry);
+    }
+    return j;
+}
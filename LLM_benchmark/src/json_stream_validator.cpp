@@ -0,0 +1,408 @@
+#include "json_stream_validator.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+bool type_matches(const json& value, const std::string& type) {
+    if (type == "object") return value.is_object();
+    if (type == "array") return value.is_array();
+    if (type == "string") return value.is_string();
+    if (type == "boolean") return value.is_boolean();
+    if (type == "null") return value.is_null();
+    if (type == "number") return value.is_number();
+    if (type == "integer") {
+        return value.is_number_integer() ||
+               (value.is_number_float() && std::floor(value.get<double>()) == value.get<double>());
+    }
+    return true; // Unknown types are not ours to reject
+}
+
+bool check(const json& value, const json& schema, const std::string& path, std::string& problem) {
+    if (!schema.is_object()) {
+        return true;
+    }
+
+    if (schema.contains("type")) {
+        const json& type = schema["type"];
+        bool ok = false;
+        if (type.is_string()) {
+            ok = type_matches(value, type.get<std::string>());
+        } else if (type.is_array()) {
+            for (const auto& option : type) {
+                ok = ok || (option.is_string() && type_matches(value, option.get<std::string>()));
+            }
+        } else {
+            ok = true;
+        }
+        if (!ok) {
+            problem = path + ": expected " + (type.is_string() ? type.get<std::string>() : type.dump());
+            return false;
+        }
+    }
+
+    if (schema.contains("enum") && schema["enum"].is_array()) {
+        const json& choices = schema["enum"];
+        if (std::find(choices.begin(), choices.end(), value) == choices.end()) {
+            problem = path + ": not one of " + choices.dump();
+            return false;
+        }
+    }
+
+    if (value.is_object()) {
+        for (const auto& key : schema.value("required", json::array())) {
+            if (key.is_string() && !value.contains(key.get<std::string>())) {
+                problem = path + ": missing \"" + key.get<std::string>() + "\"";
+                return false;
+            }
+        }
+        const json properties = schema.value("properties", json::object());
+        const bool closed = schema.contains("additionalProperties") && schema["additionalProperties"] == false;
+        for (const auto& [key, member] : value.items()) {
+            if (properties.contains(key)) {
+                if (!check(member, properties[key], path + "." + key, problem)) {
+                    return false;
+                }
+            } else if (closed) {
+                problem = path + ": unexpected \"" + key + "\"";
+                return false;
+            }
+        }
+    }
+
+    if (value.is_array() && schema.contains("items")) {
+        for (size_t i = 0; i < value.size(); i++) {
+            if (!check(value[i], schema["items"], path + "[" + std::to_string(i) + "]", problem)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+JsonStreamValidator::JsonStreamValidator() {
+    reset();
+}
+
+void JsonStreamValidator::reset() {
+    state = Status::Incomplete;
+    expect = Expect::Value;
+    lex = Lex::None;
+    num = Num::Sign;
+    stack.clear();
+    string_is_key = false;
+    unicode_left = 0;
+    unicode_value = 0;
+    low_surrogate_next = false;
+    utf8_left = 0;
+    utf8_low = 0x80;
+    utf8_high = 0xBF;
+    literal.clear();
+    offset = 0;
+    max_depth = 0;
+    message.clear();
+}
+
+void JsonStreamValidator::fail(const std::string& reason) {
+    state = Status::Invalid;
+    message = reason;
+}
+
+void JsonStreamValidator::value_done() {
+    expect = stack.empty() ? Expect::Done : Expect::CommaOrEnd;
+}
+
+void JsonStreamValidator::push_utf8(unsigned char byte) {
+    if (utf8_left > 0) {
+        if (byte < utf8_low || byte > utf8_high) {
+            fail("invalid UTF-8");
+            return;
+        }
+        utf8_left--;
+        utf8_low = 0x80;
+        utf8_high = 0xBF;
+        return;
+    }
+
+    // Lead byte; the first continuation range rules out overlong forms,
+    // UTF-16 surrogates (ED A0..BF) and code points past U+10FFFF
+    if (byte >= 0xC2 && byte <= 0xDF) {
+        utf8_left = 1;
+    } else if (byte == 0xE0) {
+        utf8_left = 2;
+        utf8_low = 0xA0;
+    } else if (byte == 0xED) {
+        utf8_left = 2;
+        utf8_high = 0x9F;
+    } else if (byte >= 0xE1 && byte <= 0xEF) {
+        utf8_left = 2;
+    } else if (byte == 0xF0) {
+        utf8_left = 3;
+        utf8_low = 0x90;
+    } else if (byte >= 0xF1 && byte <= 0xF3) {
+        utf8_left = 3;
+    } else if (byte == 0xF4) {
+        utf8_left = 3;
+        utf8_high = 0x8F;
+    } else {
+        fail("invalid UTF-8");
+    }
+}
+
+void JsonStreamValidator::unicode_done() {
+    const bool high = unicode_value >= 0xD800 && unicode_value <= 0xDBFF;
+    const bool low = unicode_value >= 0xDC00 && unicode_value <= 0xDFFF;
+    if (low_surrogate_next) {
+        if (!low) {
+            fail("unpaired surrogate in \\u escape");
+            return;
+        }
+        low_surrogate_next = false;
+    } else if (high) {
+        low_surrogate_next = true;
+    } else if (low) {
+        fail("unpaired surrogate in \\u escape");
+        return;
+    }
+    lex = Lex::String;
+}
+
+void JsonStreamValidator::push(char c) {
+    switch (lex) {
+    case Lex::String:
+        if (low_surrogate_next && c != '\\') {
+            fail("unpaired surrogate in \\u escape");
+        } else if (utf8_left > 0 || static_cast<unsigned char>(c) >= 0x80) {
+            push_utf8(static_cast<unsigned char>(c));
+        } else if (c == '"') {
+            lex = Lex::None;
+            if (string_is_key) {
+                expect = Expect::Colon;
+            } else {
+                value_done();
+            }
+        } else if (c == '\\') {
+            lex = Lex::Escape;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            fail("control character in a string");
+        }
+        return;
+    case Lex::Escape:
+        if (c == 'u') {
+            lex = Lex::Unicode;
+            unicode_left = 4;
+            unicode_value = 0;
+        } else if (low_surrogate_next) {
+            fail("unpaired surrogate in \\u escape");
+        } else if (c != '\0' && std::strchr("\"\\/bfnrt", c)) {
+            lex = Lex::String;
+        } else {
+            fail(std::string("bad escape \\") + c);
+        }
+        return;
+    case Lex::Unicode:
+        if (!std::isxdigit(static_cast<unsigned char>(c))) {
+            fail("bad \\u escape");
+            return;
+        }
+        unicode_value = unicode_value * 16 +
+                        (std::isdigit(static_cast<unsigned char>(c)) ? c - '0' : (c | 0x20) - 'a' + 10);
+        if (--unicode_left == 0) {
+            unicode_done();
+        }
+        return;
+    case Lex::Literal:
+        if (c != literal[0]) {
+            fail("bad literal");
+            return;
+        }
+        literal.erase(0, 1);
+        if (literal.empty()) {
+            lex = Lex::None;
+            value_done();
+        }
+        return;
+    case Lex::Number: {
+        const bool digit = c >= '0' && c <= '9';
+        const bool exponent = c == 'e' || c == 'E';
+        switch (num) {
+        case Num::Sign:
+            if (c == '0') { num = Num::Zero; return; }
+            if (digit) { num = Num::Int; return; }
+            break;
+        case Num::Zero:
+            if (c == '.') { num = Num::Point; return; }
+            if (exponent) { num = Num::Exp; return; }
+            break;
+        case Num::Int:
+            if (digit) return;
+            if (c == '.') { num = Num::Point; return; }
+            if (exponent) { num = Num::Exp; return; }
+            break;
+        case Num::Point:
+            if (digit) { num = Num::Frac; return; }
+            break;
+        case Num::Frac:
+            if (digit) return;
+            if (exponent) { num = Num::Exp; return; }
+            break;
+        case Num::Exp:
+            if (c == '+' || c == '-') { num = Num::ExpSign; return; }
+            if (digit) { num = Num::ExpDigits; return; }
+            break;
+        case Num::ExpSign:
+            if (digit) { num = Num::ExpDigits; return; }
+            break;
+        case Num::ExpDigits:
+            if (digit) return;
+            break;
+        }
+        // The number ends here; the byte is read as structure below
+        if (num != Num::Zero && num != Num::Int && num != Num::Frac && num != Num::ExpDigits) {
+            fail("incomplete number");
+            return;
+        }
+        lex = Lex::None;
+        value_done();
+        break;
+    }
+    case Lex::None:
+        break;
+    }
+
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        return;
+    }
+
+    switch (expect) {
+    case Expect::Done:
+        fail("data after the end of the document");
+        return;
+    case Expect::Colon:
+        if (c == ':') {
+            expect = Expect::Value;
+        } else {
+            fail("expected ':'");
+        }
+        return;
+    case Expect::CommaOrEnd:
+        if (c == ',') {
+            expect = stack.back() == '{' ? Expect::Key : Expect::Value;
+            return;
+        }
+        break; // A closing bracket is handled below
+    case Expect::FirstKeyOrEnd:
+        if (c == '}') {
+            break;
+        }
+        [[fallthrough]];
+    case Expect::Key:
+        if (c == '"') {
+            lex = Lex::String;
+            string_is_key = true;
+        } else {
+            fail("expected a key");
+        }
+        return;
+    case Expect::FirstValueOrEnd:
+        if (c == ']') {
+            break;
+        }
+        [[fallthrough]];
+    case Expect::Value:
+        switch (c) {
+        case '{':
+            stack.push_back('{');
+            max_depth = std::max(max_depth, stack.size());
+            expect = Expect::FirstKeyOrEnd;
+            return;
+        case '[':
+            stack.push_back('[');
+            max_depth = std::max(max_depth, stack.size());
+            expect = Expect::FirstValueOrEnd;
+            return;
+        case '"':
+            lex = Lex::String;
+            string_is_key = false;
+            return;
+        case 't': lex = Lex::Literal; literal = "rue"; return;
+        case 'f': lex = Lex::Literal; literal = "alse"; return;
+        case 'n': lex = Lex::Literal; literal = "ull"; return;
+        case '-': lex = Lex::Number; num = Num::Sign; return;
+        case '0': lex = Lex::Number; num = Num::Zero; return;
+        default:
+            if (c >= '1' && c <= '9') {
+                lex = Lex::Number;
+                num = Num::Int;
+            } else {
+                fail(std::string("unexpected '") + c + "'");
+            }
+            return;
+        }
+    }
+
+    // Closing bracket
+    if ((c != '}' && c != ']') || stack.empty() || (c == '}') != (stack.back() == '{')) {
+        fail(c == '}' || c == ']' ? std::string("mismatched '") + c + "'" : "expected ',' or a closing bracket");
+        return;
+    }
+    stack.pop_back();
+    value_done();
+}
+
+JsonStreamValidator::Status JsonStreamValidator::feed(const std::string& chunk) {
+    for (char c : chunk) {
+        if (state == Status::Invalid) {
+            break;
+        }
+        push(c);
+        if (state != Status::Invalid) {
+            offset++;
+        }
+    }
+    if (state != Status::Invalid) {
+        state = expect == Expect::Done && lex == Lex::None ? Status::Complete : Status::Incomplete;
+    }
+    return state;
+}
+
+JsonStreamValidator::Status JsonStreamValidator::finish() {
+    if (state == Status::Invalid) {
+        return state;
+    }
+    if (lex == Lex::Number && (num == Num::Zero || num == Num::Int || num == Num::Frac || num == Num::ExpDigits)) {
+        lex = Lex::None;
+        value_done();
+    }
+    if (expect != Expect::Done || lex != Lex::None) {
+        fail(offset == 0 ? "empty document" : "document ends early");
+        return state;
+    }
+    state = Status::Complete;
+    return state;
+}
+
+JsonStreamValidator::Status JsonStreamValidator::status() const {
+    return state;
+}
+
+size_t JsonStreamValidator::error_offset() const {
+    return offset;
+}
+
+const std::string& JsonStreamValidator::error() const {
+    return message;
+}
+
+size_t JsonStreamValidator::depth() const {
+    return max_depth;
+}
+
+bool JsonStreamValidator::matches_schema(const json& value, const json& schema, std::string& problem) {
+    problem.clear();
+    return check(value, schema, "$", problem);
+}
@@ -0,0 +1,386 @@
+#include "llama_model.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+WorkerPool::WorkerPool(int threads)
+    : job(nullptr), job_items(0), generation(0), pending(0), stopping(false) {
+    for (int i = 1; i < std::max(1, threads); ++i) {
+        workers.emplace_back(&WorkerPool::worker_loop, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    start_cv.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkerPool::worker_loop(int index) {
+    unsigned long seen = 0;
+    while (true) {
+        const std::function<void(int, int)>* task;
+        int items;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            start_cv.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            task = job;
+            items = job_items;
+        }
+
+        const int chunk = (items + size() - 1) / size();
+        const int begin = index * chunk;
+        const int end = std::min(items, begin + chunk);
+        if (begin < end) {
+            (*task)(begin, end);
+        }
+
+        std::lock_guard<std::mutex> lock(mtx);
+        if (--pending == 0) {
+            done_cv.notify_one();
+        }
+    }
+}
+
+void WorkerPool::run(int items, const std::function<void(int, int)>& fn) {
+    if (workers.empty() || items < 2) {
+        fn(0, items);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        job = &fn;
+        job_items = items;
+        pending = static_cast<int>(workers.size());
+        generation++;
+    }
+    start_cv.notify_all();
+
+    const int chunk = (items + size() - 1) / size();
+    fn(0, std::min(items, chunk));
+
+    std::unique_lock<std::mutex> lock(mtx);
+    done_cv.wait(lock, [&] { return pending == 0; });
+    job = nullptr;
+}
+
+int WorkerPool::size() const {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+LlamaModel::LlamaModel(int threads, int context_length)
+    : n_embd(0), n_layer(0), n_head(0), n_head_kv(0), head_dim(0), kv_dim(0), n_ff(0), n_vocab(0),
+      n_ctx(0), requested_ctx(context_length), rms_eps(1e-5f), output_norm(nullptr) {
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    pool = std::make_unique<WorkerPool>(threads);
+}
+
+bool LlamaModel::bind_weight(const GgufFile& file, const std::string& name, int rows, int cols, LlamaWeight& weight) {
+    const GgufTensor* tensor = file.find_tensor(name);
+    if (!tensor) {
+        std::cerr << "Error: Model has no tensor " << name << std::endl;
+        return false;
+    }
+    if (tensor->dims.size() != 2 || tensor->dims[0] != static_cast<uint64_t>(cols) ||
+        tensor->dims[1] != static_cast<uint64_t>(rows)) {
+        std::cerr << "Error: Tensor " << name << " does not have the expected shape " << cols << "x" << rows << std::endl;
+        return false;
+    }
+
+    weight = LlamaWeight();
+    weight.data = tensor->data;
+    weight.rows = rows;
+    weight.cols = cols;
+
+    switch (tensor->type) {
+        case GgmlType::F32:
+            weight.is_f32 = true;
+            weight.stride = static_cast<size_t>(cols) * sizeof(float);
+            return true;
+        case GgmlType::F16: weight.format = QuantFormat::F16; break;
+        case GgmlType::Q4_0: weight.format = QuantFormat::Q4_0; break;
+        case GgmlType::Q8_0: weight.format = QuantFormat::Q8_0; break;
+        case GgmlType::Q4_K: weight.format = QuantFormat::Q4_K; break;
+        case GgmlType::Q6_K: weight.format = QuantFormat::Q6_K; break;
+        default:
+            std::cerr << "Error: Tensor " << name << " uses " << GgufFile::type_name(tensor->type)
+                      << ", which has no kernel here" << std::endl;
+            return false;
+    }
+
+    if (cols % block_elements(weight.format) != 0) {
+        std::cerr << "Error: Tensor " << name << " has " << cols << " columns, not a multiple of the "
+                  << format_name(weight.format) << " block size" << std::endl;
+        return false;
+    }
+
+    weight.stride = row_size(weight.format, cols);
+    weight.kernel = get_dot_kernel(weight.format, best_isa());
+    if (!weight.kernel) {
+        weight.kernel = get_dot_kernel(weight.format, KernelIsa::SCALAR);
+    }
+    return true;
+}
+
+bool LlamaModel::bind_norm(const GgufFile& file, const std::string& name, int n, const float*& norm) {
+    const GgufTensor* tensor = file.find_tensor(name);
+    if (!tensor || tensor->type != GgmlType::F32 || tensor->elements() != static_cast<uint64_t>(n)) {
+        std::cerr << "Error: Model has no F32 norm tensor " << name << " of size " << n << std::endl;
+        return false;
+    }
+    norm = reinterpret_cast<const float*>(tensor->data);
+    return true;
+}
+
+bool LlamaModel::load(const GgufFile& file) {
+    std::string arch = file.get_string("general.architecture");
+    if (arch != "llama") {
+        std::cerr << "Error: Architecture '" << arch << "' is not supported (only llama)" << std::endl;
+        return false;
+    }
+
+    n_embd = static_cast<int>(file.get_int("llama.embedding_length"));
+    n_layer = static_cast<int>(file.get_int("llama.block_count"));
+    n_head = static_cast<int>(file.get_int("llama.attention.head_count"));
+    n_head_kv = static_cast<int>(file.get_int("llama.attention.head_count_kv", n_head));
+    n_ff = static_cast<int>(file.get_int("llama.feed_forward_length"));
+    rms_eps = static_cast<float>(file.get_float("llama.attention.layer_norm_rms_epsilon", 1e-5));
+
+    if (n_embd <= 0 || n_layer <= 0 || n_head <= 0 || n_head_kv <= 0 || n_ff <= 0 ||
+        n_embd % n_head != 0 || n_head % n_head_kv != 0) {
+        std::cerr << "Error: Inconsistent llama hyperparameters in " << file.get_path() << std::endl;
+        return false;
+    }
+    head_dim = n_embd / n_head;
+    kv_dim = head_dim * n_head_kv;
+
+    const GgufTensor* embeddings = file.find_tensor("token_embd.weight");
+    if (!embeddings || embeddings->dims.size() != 2) {
+        std::cerr << "Error: Model has no token_embd.weight" << std::endl;
+        return false;
+    }
+    n_vocab = static_cast<int>(embeddings->dims[1]);
+
+    if (!bind_weight(file, "token_embd.weight", n_vocab, n_embd, token_embd) ||
+        !bind_norm(file, "output_norm.weight", n_embd, output_norm)) {
+        return false;
+    }
+    // Models with tied embeddings have no output matrix
+    const char* output_name = file.find_tensor("output.weight") ? "output.weight" : "token_embd.weight";
+    if (!bind_weight(file, output_name, n_vocab, n_embd, output)) {
+        return false;
+    }
+
+    layers.assign(n_layer, Layer());
+    for (int l = 0; l < n_layer; ++l) {
+        const std::string prefix = "blk." + std::to_string(l) + ".";
+        Layer& layer = layers[l];
+        if (!bind_norm(file, prefix + "attn_norm.weight", n_embd, layer.attn_norm) ||
+            !bind_weight(file, prefix + "attn_q.weight", n_embd, n_embd, layer.wq) ||
+            !bind_weight(file, prefix + "attn_k.weight", kv_dim, n_embd, layer.wk) ||
+            !bind_weight(file, prefix + "attn_v.weight", kv_dim, n_embd, layer.wv) ||
+            !bind_weight(file, prefix + "attn_output.weight", n_embd, n_embd, layer.wo) ||
+            !bind_norm(file, prefix + "ffn_norm.weight", n_embd, layer.ffn_norm) ||
+            !bind_weight(file, prefix + "ffn_gate.weight", n_ff, n_embd, layer.gate) ||
+            !bind_weight(file, prefix + "ffn_up.weight", n_ff, n_embd, layer.up) ||
+            !bind_weight(file, prefix + "ffn_down.weight", n_embd, n_ff, layer.down)) {
+            return false;
+        }
+    }
+
+    // Adjacent pairs are rotated (GGUF stores llama Q/K already permuted for this)
+    const int rope_dim = static_cast<int>(file.get_int("llama.rope.dimension_count", head_dim));
+    const double rope_base = file.get_float("llama.rope.freq_base", 10000.0);
+    rope_freqs.assign(std::min(rope_dim, head_dim) / 2, 0.0f);
+    for (size_t i = 0; i < rope_freqs.size(); ++i) {
+        rope_freqs[i] = static_cast<float>(std::pow(rope_base, -2.0 * i / rope_dim));
+    }
+    // Llama 3.1 style long-context scaling ships as per-pair divisors
+    const GgufTensor* factors = file.find_tensor("rope_freqs.weight");
+    if (factors && factors->type == GgmlType::F32 && factors->elements() >= rope_freqs.size()) {
+        const float* values = reinterpret_cast<const float*>(factors->data);
+        for (size_t i = 0; i < rope_freqs.size(); ++i) {
+            rope_freqs[i] /= values[i];
+        }
+    }
+
+    const int trained_ctx = static_cast<int>(file.get_int("llama.context_length", 2048));
+    n_ctx = std::max(1, std::min(requested_ctx, trained_ctx));
+
+    key_cache.assign(static_cast<size_t>(n_layer) * n_ctx * kv_dim, 0.0f);
+    value_cache.assign(static_cast<size_t>(n_layer) * n_ctx * kv_dim, 0.0f);
+
+    x.assign(n_embd, 0.0f);
+    xb.assign(n_embd, 0.0f);
+    xb2.assign(n_embd, 0.0f);
+    q.assign(n_embd, 0.0f);
+    hb.assign(n_ff, 0.0f);
+    hb2.assign(n_ff, 0.0f);
+    att.assign(static_cast<size_t>(n_head) * n_ctx, 0.0f);
+    logits.assign(n_vocab, 0.0f);
+
+    return true;
+}
+
+void LlamaModel::matmul(const LlamaWeight& weight, const float* in, float* out) {
+    if (weight.is_f32) {
+        pool->run(weight.rows, [&](int begin, int end) {
+            for (int r = begin; r < end; ++r) {
+                const float* row = reinterpret_cast<const float*>(weight.data + r * weight.stride);
+                float sum = 0.0f;
+                for (int c = 0; c < weight.cols; ++c) {
+                    sum += row[c] * in[c];
+                }
+                out[r] = sum;
+            }
+        });
+        return;
+    }
+
+    quantize_activations(weight.format, in, weight.cols, activations);
+    const uint8_t* quantized = activations.data();
+    pool->run(weight.rows, [&](int begin, int end) {
+        for (int r = begin; r < end; ++r) {
+            out[r] = weight.kernel(weight.cols, weight.data + r * weight.stride, quantized);
+        }
+    });
+}
+
+void LlamaModel::rms_norm(float* out, const float* in, const float* weight) {
+    float sum = 0.0f;
+    for (int i = 0; i < n_embd; ++i) {
+        sum += in[i] * in[i];
+    }
+    const float scale = 1.0f / std::sqrt(sum / n_embd + rms_eps);
+    for (int i = 0; i < n_embd; ++i) {
+        out[i] = in[i] * scale * weight[i];
+    }
+}
+
+void LlamaModel::rope(float* vec, int heads, int pos) {
+    for (size_t i = 0; i < rope_freqs.size(); ++i) {
+        const float theta = pos * rope_freqs[i];
+        const float cos_theta = std::cos(theta);
+        const float sin_theta = std::sin(theta);
+        for (int h = 0; h < heads; ++h) {
+            float* pair = vec + h * head_dim + 2 * i;
+            const float x0 = pair[0];
+            const float x1 = pair[1];
+            pair[0] = x0 * cos_theta - x1 * sin_theta;
+            pair[1] = x0 * sin_theta + x1 * cos_theta;
+        }
+    }
+}
+
+const float* LlamaModel::forward(int token, int pos) {
+    const uint8_t* embedding = token_embd.data + static_cast<size_t>(token) * token_embd.stride;
+    if (token_embd.is_f32) {
+        std::memcpy(x.data(), embedding, n_embd * sizeof(float));
+    } else {
+        dequantize_row(token_embd.format, embedding, x.data(), n_embd);
+    }
+
+    const float scale = 1.0f / std::sqrt(static_cast<float>(head_dim));
+    const int group = n_head / n_head_kv;
+
+    for (int l = 0; l < n_layer; ++l) {
+        const Layer& layer = layers[l];
+        const size_t layer_offset = static_cast<size_t>(l) * n_ctx * kv_dim;
+        float* k = key_cache.data() + layer_offset + static_cast<size_t>(pos) * kv_dim;
+        float* v = value_cache.data() + layer_offset + static_cast<size_t>(pos) * kv_dim;
+
+        // Attention: keys and values for this position go straight into the cache
+        rms_norm(xb.data(), x.data(), layer.attn_norm);
+        matmul(layer.wq, xb.data(), q.data());
+        matmul(layer.wk, xb.data(), k);
+        matmul(layer.wv, xb.data(), v);
+        rope(q.data(), n_head, pos);
+        rope(k, n_head_kv, pos);
+
+        pool->run(n_head, [&](int begin, int end) {
+            for (int h = begin; h < end; ++h) {
+                const float* query = q.data() + h * head_dim;
+                const size_t head_offset = static_cast<size_t>(h / group) * head_dim;
+                float* scores = att.data() + static_cast<size_t>(h) * n_ctx;
+
+                float max_score = -std::numeric_limits<float>::infinity();
+                for (int t = 0; t <= pos; ++t) {
+                    const float* key = key_cache.data() + layer_offset + static_cast<size_t>(t) * kv_dim + head_offset;
+                    float dot = 0.0f;
+                    for (int i = 0; i < head_dim; ++i) {
+                        dot += query[i] * key[i];
+                    }
+                    scores[t] = dot * scale;
+                    max_score = std::max(max_score, scores[t]);
+                }
+
+                float total = 0.0f;
+                for (int t = 0; t <= pos; ++t) {
+                    scores[t] = std::exp(scores[t] - max_score);
+                    total += scores[t];
+                }
+
+                float* out = xb2.data() + h * head_dim;
+                std::fill(out, out + head_dim, 0.0f);
+                for (int t = 0; t <= pos; ++t) {
+                    const float* value = value_cache.data() + layer_offset + static_cast<size_t>(t) * kv_dim + head_offset;
+                    const float weight = scores[t] / total;
+                    for (int i = 0; i < head_dim; ++i) {
+                        out[i] += weight * value[i];
+                    }
+                }
+            }
+        });
+
+        matmul(layer.wo, xb2.data(), xb.data());
+        for (int i = 0; i < n_embd; ++i) {
+            x[i] += xb[i];
+        }
+
+        // Feed-forward: down(silu(gate(x)) * up(x))
+        rms_norm(xb.data(), x.data(), layer.ffn_norm);
+        matmul(layer.gate, xb.data(), hb.data());
+        matmul(layer.up, xb.data(), hb2.data());
+        for (int i = 0; i < n_ff; ++i) {
+            hb[i] = hb[i] / (1.0f + std::exp(-hb[i])) * hb2[i];
+        }
+        matmul(layer.down, hb.data(), xb.data());
+        for (int i = 0; i < n_embd; ++i) {
+            x[i] += xb[i];
+        }
+    }
+
+    rms_norm(x.data(), x.data(), output_norm);
+    matmul(output, x.data(), logits.data());
+    return logits.data();
+}
+
+int LlamaModel::get_context_length() const {
+    return n_ctx;
+}
+
+int LlamaModel::get_vocab_size() const {
+    return n_vocab;
+}
+
+int LlamaModel::get_threads() const {
+    return pool->size();
+}
+
+size_t LlamaModel::get_kv_cache_bytes() const {
+    return (key_cache.size() + value_cache.size()) * sizeof(float);
+}
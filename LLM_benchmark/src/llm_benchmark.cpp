@@ -6,8 +6,25 @@
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <tuple>
+#include <cmath>
+#include <deque>
 using json = nlohmann::json;
 
+namespace {
+
+json thermal_to_json(const ThermalSummary& thermal) {
+    return {
+        {"samples", thermal.samples},
+        {"throttled_samples", thermal.throttled_samples},
+        {"max_temp_c", thermal.max_temp_c},
+        {"mean_freq_mhz", thermal.mean_freq_mhz},
+        {"min_freq_ratio", thermal.min_freq_ratio}
+    };
+}
+
+} // namespace
+
 LLMBenchmark::LLMBenchmark(
     const std::string& prompt_path, 
     const std::string& output_path, 
@@ -25,7 +42,14 @@ LLMBenchmark::LLMBenchmark(
     use_mmap(use_memory_mapping), 
     swap_size(swap_mb), 
     swappiness(swap_priority),
-    api(OllamaAPI("http://localhost:11434", use_memory_mapping)) {
+    backend(std::make_unique<OllamaAPI>("http://localhost:11434", use_memory_mapping)),
+    discard_throttled(false),
+    footprint_reader(std::make_unique<ModelFootprintReader>()),
+    admission(true),
+    tokenizer_bench_mb(0),
+    use_profile(true),
+    fixed_length(0),
+    fixed_seed(42) {
     
     // Initialize cURL
     OllamaAPI::initialize();
@@ -56,8 +80,293 @@ void LLMBenchmark::add_model(const std::string& model_name) {
     models.push_back(model_name);
 }
 
+void LLMBenchmark::enable_thermal_tracking(const std::string& sysfs_root, int interval_ms, bool discard) {
+    thermal_monitor = std::make_unique<ThermalMonitor>(sysfs_root, interval_ms);
+    discard_throttled = discard;
+    
+    if (!thermal_monitor->available()) {
+        std::cerr << "Warning: no thermal zones or cpufreq entries found under " << sysfs_root << std::endl;
+    }
+}
+
+void LLMBenchmark::enable_energy_tracking(std::unique_ptr<PowerSource> source) {
+    power_source = std::move(source);
+    
+    if (!power_source->available()) {
+        std::cerr << "Warning: " << power_source->description() << " is not readable, energy will not be reported" << std::endl;
+    }
+}
+
+void LLMBenchmark::enable_bandwidth_probe(size_t array_mb, int threads) {
+    bandwidth_probe = std::make_unique<BandwidthProbe>(array_mb, threads);
+}
+
+void LLMBenchmark::enable_quant_bench(const std::vector<std::pair<int, int>>& shapes) {
+    quant_bench = std::make_unique<QuantKernelBench>(shapes);
+}
+
+void LLMBenchmark::set_backend(std::unique_ptr<InferenceBackend> inference) {
+    backend = std::move(inference);
+}
+
+void LLMBenchmark::set_models_dir(const std::string& models_dir) {
+    footprint_reader = std::make_unique<ModelFootprintReader>(models_dir);
+    std::lock_guard<std::mutex> lock(tokenizer_mutex);
+    tokenizers.clear();
+}
+
+void LLMBenchmark::enable_tokenizer_bench(size_t text_mb) {
+    tokenizer_bench_mb = std::max<size_t>(1, text_mb);
+}
+
+void LLMBenchmark::enable_prefill_sweep(int min_tokens, int max_tokens, double factor) {
+    prefill_sweep = std::make_unique<PrefillSweep>(min_tokens, max_tokens, factor);
+}
+
+void LLMBenchmark::enable_decode_sweep(int min_tokens, int max_tokens) {
+    decode_sweep = std::make_unique<DecodeSweep>(min_tokens, max_tokens);
+}
+
+void LLMBenchmark::enable_chat_bench(const std::vector<ChatScript>& scripts, int reply_tokens) {
+    chat_scripts = scripts;
+    chat_bench = std::make_unique<ChatBenchmark>(reply_tokens);
+}
+
+void LLMBenchmark::enable_prefix_cache_bench(const std::string& prefix) {
+    prefix_cache_bench = std::make_unique<PrefixCacheBench>(prefix);
+}
+
+void LLMBenchmark::enable_structured_bench(const json& schema, int num_predict) {
+    structured_bench = std::make_unique<StructuredOutputBench>(schema, num_predict);
+}
+
+void LLMBenchmark::enable_vision_bench(const std::string& image_dir, const std::vector<int>& sizes, int num_predict,
+                                       int threads, const std::string& cache_dir) {
+    vision_bench = std::make_unique<VisionBench>(image_dir, sizes, num_predict, threads, cache_dir);
+}
+
+void LLMBenchmark::enable_option_sweep(const OptionGrid& grid, int repeats, const std::string& csv_path) {
+    option_sweep = std::make_unique<OptionSweep>(grid, repeats);
+    option_sweep_csv = csv_path;
+}
+
+void LLMBenchmark::run_tokenizer_bench(const std::string& prompt) {
+    // Repeat the prompt so each model encodes the same realistic text
+    std::string text;
+    const size_t target = tokenizer_bench_mb * 1024 * 1024;
+    text.reserve(target + prompt.size());
+    while (text.size() < target) {
+        text += prompt;
+        text += '\n';
+    }
+    
+    tokenizer_results.clear();
+    for (const auto& model : models) {
+        const Tokenizer* tokenizer = tokenizer_for(model);
+        if (!tokenizer) {
+            continue;
+        }
+        auto start = std::chrono::steady_clock::now();
+        size_t tokens = tokenizer->count(text);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        tokenizer_results.push_back({model, tokenizer->kind(), tokenizer->vocab_size(), text.size(), tokens, seconds});
+    }
+    
+    std::cout << "\nTOKENIZER THROUGHPUT (" << tokenizer_bench_mb << " MB of the prompt, one thread):" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model" 
+            << std::setw(6) << "Type" 
+            << std::setw(10) << "Vocab" 
+            << std::setw(12) << "Tokens" 
+            << std::setw(10) << "Bytes/tok" 
+            << std::setw(12) << "Mtokens/s" 
+            << "MB/s" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    for (const auto& result : tokenizer_results) {
+        double seconds = std::max(result.seconds, 1e-9);
+        std::cout << std::left << std::setw(20) << result.model_name 
+                << std::setw(6) << result.kind 
+                << std::setw(10) << result.vocab_size 
+                << std::setw(12) << result.tokens 
+                << std::setw(10) << std::fixed << std::setprecision(2) 
+                << static_cast<double>(result.bytes) / std::max<size_t>(1, result.tokens) 
+                << std::setw(12) << result.tokens / seconds / 1e6 
+                << std::setprecision(1) << result.bytes / seconds / 1048576.0 << std::endl;
+    }
+    if (tokenizer_results.empty()) {
+        std::cout << "No model vocabularies found in " << footprint_reader->get_models_dir() << std::endl;
+    }
+    std::cout << "===================================" << std::endl;
+}
+
+void LLMBenchmark::enable_fixed_length(int num_predict, int seed) {
+    fixed_length = std::max(1, num_predict);
+    fixed_seed = seed;
+}
+
+json LLMBenchmark::request_options(const std::string& model) const {
+    json options = json::object();
+    auto tuned = tuned_options.find(model);
+    if (tuned != tuned_options.end()) {
+        options.update(tuned->second);
+    }
+    if (fixed_length > 0) {
+        options["num_predict"] = fixed_length;
+        options["seed"] = fixed_seed;
+        options["stop"] = json::array();
+        options["ignore_eos"] = true;
+    }
+    return options;
+}
+
+void LLMBenchmark::set_admission(bool enabled) {
+    admission = enabled;
+}
+
+void LLMBenchmark::predict_memory(unsigned long device_ram_mb) {
+    if (models.empty()) {
+        add_all_models();
+    }
+    if (device_ram_mb == 0) {
+        device_ram_mb = get_system_memory().first;
+    }
+    
+    const RuntimeConfig config = backend->runtime_config();
+    std::cout << "\nPREDICTED MEMORY (" << backend->name() << ", num_ctx " << config.context_length 
+              << ", device RAM " << format_memory(device_ram_mb * 1024) << "):" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model" 
+            << std::setw(8) << "Ctx" 
+            << std::setw(12) << "Weights" 
+            << std::setw(12) << "KV cache" 
+            << std::setw(12) << "Compute" 
+            << std::setw(12) << "Predicted" 
+            << std::setw(10) << "% of RAM" 
+            << "Fits" << std::endl;
+    std::cout << std::string(90, '-') << std::endl;
+    
+    for (const auto& model : models) {
+        MemoryPrediction prediction = MemoryPredictor::predict(footprint_reader->read(model), config);
+        std::cout << std::left << std::setw(20) << model;
+        if (!prediction.valid()) {
+            std::cout << "no GGUF blob in " << footprint_reader->get_models_dir() << std::endl;
+            continue;
+        }
+        double share = 100.0 * prediction.total_kb() / (device_ram_mb * 1024.0);
+        std::cout << std::setw(8) << prediction.context_length 
+                << std::setw(12) << format_memory(prediction.weights_kb) 
+                << std::setw(12) << format_memory(prediction.kv_cache_kb) 
+                << std::setw(12) << format_memory(prediction.compute_kb) 
+                << std::setw(12) << format_memory(prediction.total_kb()) 
+                << std::setw(10) << std::fixed << std::setprecision(1) << share 
+                << (share <= 100.0 ? "yes" : "no") << std::endl;
+    }
+}
+
+void LLMBenchmark::set_profile(const std::string& path, bool apply) {
+    profile_path = path;
+    use_profile = apply;
+}
+
+std::string LLMBenchmark::load_profile() {
+    tuned_options.clear();
+    if (!use_profile) {
+        return "OFF";
+    }
+
+    DeviceProfile profile(profile_path);
+    if (!profile.load()) {
+        return "none (" + profile.get_path() + ")";
+    }
+    if (!profile.matches_device()) {
+        const json& device = profile.get_device();
+        std::cerr << "Warning: " << profile.get_path() << " was tuned on " << device.value("hostname", "?")
+                  << " (" << device.value("cpu", "?") << "); its settings are not applied" << std::endl;
+        return "not applied (" + profile.get_path() + " is from another device)";
+    }
+
+    for (const auto& model : models) {
+        const TunedSettings* settings = profile.get(model, backend->name());
+        if (settings && settings->options.is_object() && !settings->options.empty()) {
+            tuned_options[model] = settings->options;
+        }
+    }
+    return profile.get_path() + " (" + std::to_string(tuned_options.size()) + " of " +
+           std::to_string(models.size()) + " models tuned)";
+}
+
+void LLMBenchmark::autotune(Autotuner& tuner) {
+    if (models.empty()) {
+        add_all_models();
+    }
+
+    DeviceProfile profile(profile_path);
+    if (profile.load() && !profile.matches_device()) {
+        std::cerr << "Warning: " << profile.get_path() << " was tuned on another device; starting a new profile" << std::endl;
+        profile = DeviceProfile(profile_path);
+    }
+
+    std::cout << "\nAUTOTUNE (" << backend->name() << ", objective " << tuner.get_objective() << ", "
+              << tuner.candidates(*backend).size() << " candidates per model):" << std::endl;
+
+    std::vector<TuneResult> tune_results;
+    for (const auto& model : models) {
+        std::cout << "\n[" << get_timestamp() << "] Tuning " << model << std::endl;
+        TuneResult result = tuner.run(*backend, model, tokenizer_for(model));
+        std::cout << std::endl;
+        Autotuner::print(result);
+        if (result.ok) {
+            auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+            std::stringstream tuned_at;
+            tuned_at << std::put_time(std::localtime(&now), "%Y-%m-%d %H:%M:%S");
+
+            TunedSettings settings;
+            settings.objective = result.objective;
+            settings.options = result.options;
+            settings.decode_tps = result.decode_tps;
+            settings.ttft_seconds = result.ttft_seconds;
+            settings.tuned_at = tuned_at.str();
+            profile.set(model, backend->name(), settings);
+        }
+        tune_results.push_back(result);
+    }
+
+    bool any_tuned = std::any_of(tune_results.begin(), tune_results.end(), [](const TuneResult& result) { return result.ok; });
+    if (any_tuned && profile.save()) {
+        std::cout << "\nDevice profile saved to " << profile.get_path() << std::endl;
+    }
+
+    if (!output_file.empty()) {
+        std::ofstream out(output_file);
+        if (out.is_open()) {
+            json j;
+            j["metadata"]["backend"] = backend->name();
+            j["metadata"]["profile"] = profile.get_path();
+            j["device"] = DeviceProfile::identify();
+            j["autotune"] = json::array();
+            for (const auto& result : tune_results) {
+                j["autotune"].push_back(Autotuner::to_json(result));
+            }
+            out << std::setw(4) << j << std::endl;
+            std::cout << "JSON results saved to " << output_file << std::endl;
+        } else {
+            std::cerr << "Error: Could not open output file " << output_file << std::endl;
+        }
+    }
+}
+
+void LLMBenchmark::enable_storage_probe(const std::string& models_dir, size_t block_kb, unsigned long long size_mb) {
+    storage_probe = std::make_unique<StorageProbe>(models_dir, block_kb, size_mb);
+}
+
+const std::vector<LLMBenchmark::Result>& LLMBenchmark::get_results() const {
+    return last_results;
+}
+
+const std::vector<StorageMeasurement>& LLMBenchmark::get_storage_results() const {
+    return storage_results;
+}
+
 void LLMBenchmark::add_all_models() {
-    models = api.list_models();
+    models = backend->list_models();
     if (verbose) {
         std::cout << "Found " << models.size() << " models:" << std::endl;
         for (const auto& model : models) {
@@ -103,8 +412,35 @@ std::string LLMBenchmark::get_timestamp() {
     return ss.str();
 }
 
-int LLMBenchmark::estimate_tokens(const std::string& text) {
-    // Simple approximation: ~4 chars per token
+const Tokenizer* LLMBenchmark::tokenizer_for(const std::string& model) {
+    std::lock_guard<std::mutex> lock(tokenizer_mutex);
+    auto it = tokenizers.find(model);
+    if (it != tokenizers.end()) {
+        return it->second.get();
+    }
+    
+    // The vocabulary is copied out, so the file can be closed again
+    std::unique_ptr<Tokenizer> tokenizer;
+    ModelFootprint footprint = footprint_reader->read(model);
+    GgufFile file;
+    if (!footprint.path.empty() && file.open(footprint.path)) {
+        tokenizer = std::make_unique<Tokenizer>();
+        if (!tokenizer->load(file)) {
+            tokenizer.reset();
+        }
+    }
+    return (tokenizers[model] = std::move(tokenizer)).get();
+}
+
+int LLMBenchmark::count_tokens(const std::string& model, const std::string& text, bool* exact) {
+    const Tokenizer* tokenizer = tokenizer_for(model);
+    if (exact) {
+        *exact = tokenizer != nullptr;
+    }
+    if (tokenizer) {
+        return static_cast<int>(tokenizer->count(text));
+    }
+    // Rough approximation: ~4 chars per token
     return text.length() / 4;
 }
 
@@ -149,6 +485,221 @@ std::vector<std::pair<std::string, std::string>> LLMBenchmark::parse_prompt_sect
     return sections;
 }
 
+LLMBenchmark::Result LLMBenchmark::benchmark_model(
+    const std::string& model, 
+    const std::string& prompt, 
+    const std::vector<std::pair<std::string, std::string>>& prompt_sections, 
+    unsigned long baseline_memory
+) {
+    Result result;
+    result.model_name = model;
+    result.baseline_memory = baseline_memory;
+    result.peak_memory = 0;
+    result.energy_joules = -1.0;
+    result.token_budget = fixed_length;
+    result.normalized_tps = 0.0;
+    result.footprint = footprint_reader->read(model);
+    result.predicted_memory = MemoryPredictor::predict(result.footprint, backend->runtime_config());
+    result.peak_pss = 0;
+    
+    {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        std::cout << "\n[" << get_timestamp() << "] Starting inference on model " << model << std::endl;
+    }
+    
+    // Setup memory monitoring if enabled
+    MemoryMonitor memory_monitor("ollama");
+    if (track_memory) {
+        memory_monitor.start();
+    }
+    
+    // Full model evaluation
+    double thermal_start = thermal_monitor ? thermal_monitor->sample_now() : 0.0;
+    EnergyMark energy_start = power_source ? power_source->mark() : EnergyMark{};
+    auto full_start = std::chrono::high_resolution_clock::now();
+    const json request = request_options(model);
+    const json* options = request.empty() ? nullptr : &request;
+    result.response = backend->generate(model, prompt, false, verbose, &result.generation, options);
+    auto full_end = std::chrono::high_resolution_clock::now();
+    if (power_source) {
+        result.energy_joules = power_source->energy_between(energy_start, power_source->mark());
+    }
+    if (thermal_monitor) {
+        result.thermal = thermal_monitor->summarize(thermal_start, thermal_monitor->sample_now());
+    }
+    
+    // Capture peak memory
+    if (track_memory) {
+        memory_monitor.stop();
+        result.peak_memory = memory_monitor.get_peak_memory();
+        result.peak_pss = memory_monitor.get_peak_pss();
+        result.swap = memory_monitor.get_swap_activity();
+        
+        // Alternatively, use direct Ollama process monitoring
+        unsigned long ollama_memory = get_ollama_memory_usage();
+        result.peak_memory = std::max(result.peak_memory, ollama_memory);
+    }
+    
+    result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(full_end - full_start);
+    
+    // Prefer the server-reported decode rate, fall back to a rough estimate
+    bool exact_count = true;
+    result.prompt_tokens = count_tokens(model, prompt, &exact_count);
+    if (!exact_count) {
+        result.prompt_tokens = 0;
+    }
+    if (result.generation.eval_count > 0) {
+        result.output_tokens = result.generation.eval_count;
+        result.token_source = "server";
+    } else {
+        result.output_tokens = count_tokens(model, result.response, &exact_count);
+        result.token_source = exact_count ? "tokenizer" : "estimate";
+    }
+    result.tokens_per_second = result.generation.eval_count > 0 
+                             ? result.generation.decode_rate() 
+                             : 1000.0 * result.output_tokens / std::max<long>(1, result.duration.count());
+    if (fixed_length > 0 && result.generation.eval_count >= fixed_length) {
+        result.normalized_tps = result.generation.decode_rate();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        std::cout << "[" << get_timestamp() << "] Completed full inference on model " << model 
+                << " in " << format_duration(result.duration) << std::endl;
+        std::cout << "[" << get_timestamp() << "] Response tokens: " 
+                << (result.generation.eval_count > 0 ? "" : "~") << result.output_tokens 
+                << " (" << result.tokens_per_second << " tokens/sec)" << std::endl;
+        
+        if (result.energy_joules >= 0 && result.output_tokens > 0) {
+            std::cout << "[" << get_timestamp() << "] Energy: " << result.energy_joules << " J (" 
+                    << result.energy_joules / result.output_tokens << " J/token)" << std::endl;
+        }
+        
+        if (track_memory) {
+            std::cout << "[" << get_timestamp() << "] Peak memory: " 
+                    << format_memory(result.peak_memory) 
+                    << " (+" << format_memory(result.memory_increase()) 
+                    << " from baseline)" << std::endl;
+            std::cout << "[" << get_timestamp() << "] Swap activity: " 
+                    << format_memory(pages_to_kb(result.swap.pages_in)) << " in, " 
+                    << format_memory(pages_to_kb(result.swap.pages_out)) << " out" << std::endl;
+        }
+    }
+    
+    // Section-by-section evaluation if verbose
+    if (verbose) {
+        for (const auto& section : prompt_sections) {
+            {
+                std::lock_guard<std::mutex> lock(output_mutex);
+                std::cout << "[" << get_timestamp() << "] Testing section: " << section.first << std::endl;
+            }
+            
+            std::string section_prompt = "## " + section.first + "\n" + section.second;
+            
+            // Setup memory monitoring for section
+            MemoryMonitor section_memory_monitor("ollama");
+            if (track_memory) {
+                section_memory_monitor.start();
+            }
+            
+            GenerationMetrics section_generation;
+            double section_thermal_start = thermal_monitor ? thermal_monitor->sample_now() : 0.0;
+            EnergyMark section_energy_start = power_source ? power_source->mark() : EnergyMark{};
+            auto section_start = std::chrono::high_resolution_clock::now();
+            std::string section_response = backend->generate(model, section_prompt, false, false, &section_generation, options);
+            auto section_end = std::chrono::high_resolution_clock::now();
+            
+            SectionMetrics metrics;
+            metrics.energy_joules = power_source 
+                                  ? power_source->energy_between(section_energy_start, power_source->mark()) 
+                                  : -1.0;
+            if (thermal_monitor) {
+                metrics.thermal = thermal_monitor->summarize(section_thermal_start, thermal_monitor->sample_now());
+            }
+            metrics.duration = std::chrono::duration_cast<std::chrono::milliseconds>(section_end - section_start);
+            metrics.memory = 0;
+            metrics.output_tokens = section_generation.eval_count > 0 
+                                  ? section_generation.eval_count 
+                                  : count_tokens(model, section_response);
+            metrics.tokens_per_second = section_generation.eval_count > 0 
+                                      ? section_generation.decode_rate() 
+                                      : 1000.0 * metrics.output_tokens 
+                                        / std::max<long>(1, metrics.duration.count());
+            
+            // Capture section memory
+            if (track_memory) {
+                section_memory_monitor.stop();
+                metrics.memory = section_memory_monitor.get_peak_memory();
+                metrics.swap = section_memory_monitor.get_swap_activity();
+                
+                // Use direct Ollama process monitoring if available
+                unsigned long ollama_section_memory = get_ollama_memory_usage();
+                metrics.memory = std::max(metrics.memory, ollama_section_memory);
+            }
+            
+            {
+                std::lock_guard<std::mutex> lock(output_mutex);
+                std::cout << "[" << get_timestamp() << "] Completed section: " << section.first 
+                        << " in " << format_duration(metrics.duration) << std::endl;
+                        
+                if (track_memory) {
+                    std::cout << "[" << get_timestamp() << "] Section memory: " 
+                            << format_memory(metrics.memory) 
+                            << " | Swap: " << format_memory(pages_to_kb(metrics.swap.pages_in)) << " in, " 
+                            << format_memory(pages_to_kb(metrics.swap.pages_out)) << " out" << std::endl;
+                }
+            }
+            
+            result.section_responses[section.first] = section_response;
+            result.section_metrics[section.first] = metrics;
+        }
+    }
+    
+    if (track_memory) {
+        detect_swap_slowdowns(result);
+        
+        std::lock_guard<std::mutex> lock(output_mutex);
+        for (const auto& alert : result.swap_alerts) {
+            std::cout << "[" << get_timestamp() << "] SWAP ALERT (" << model << "): " << alert << std::endl;
+        }
+    }
+    
+    return result;
+}
+
+void LLMBenchmark::detect_swap_slowdowns(Result& result) {
+    const double drop_threshold = 0.8; // Alert below 80% of the swap-free reference rate
+    
+    // Collect (label, rate, swap) for every request made against this model
+    std::vector<std::tuple<std::string, double, SwapActivity>> requests;
+    requests.emplace_back("full prompt", result.tokens_per_second, result.swap);
+    for (const auto& [section, metrics] : result.section_metrics) {
+        requests.emplace_back("section '" + section + "'", metrics.tokens_per_second, metrics.swap);
+    }
+    
+    double reference_rate = 0.0;
+    for (const auto& [label, rate, swap] : requests) {
+        if (!swap.swap_in_active()) {
+            reference_rate = std::max(reference_rate, rate);
+        }
+    }
+    
+    if (reference_rate <= 0.0) {
+        return; // Every request swapped (or none produced tokens), nothing to compare against
+    }
+    
+    for (const auto& [label, rate, swap] : requests) {
+        if (swap.swap_in_active() && rate < reference_rate * drop_threshold) {
+            std::stringstream ss;
+            ss << label << " decoded at " << std::fixed << std::setprecision(2) << rate 
+               << " tokens/sec (" << std::setprecision(0) << (100.0 * (1.0 - rate / reference_rate)) 
+               << "% below " << std::setprecision(2) << reference_rate << " without swap) while " 
+               << format_memory(pages_to_kb(swap.pages_in)) << " was swapped in";
+            result.swap_alerts.push_back(ss.str());
+        }
+    }
+}
+
 void LLMBenchmark::run() {
     if (models.empty()) {
         std::cerr << "Error: No models specified for benchmark" << std::endl;
@@ -161,18 +712,32 @@ void LLMBenchmark::run() {
         return;
     }
     
-    int estimated_tokens = estimate_tokens(prompt);
+    bool exact_prompt_count = false;
+    int prompt_tokens = count_tokens(models.front(), prompt, &exact_prompt_count);
     auto prompt_sections = parse_prompt_sections(prompt);
+    std::string profile_status = load_profile();
     
     std::cout << "========== EDGE AI LLM BENCHMARK ==========" << std::endl;
     std::cout << "Prompt file: " << prompt_file << std::endl;
+    std::cout << "Backend: " << backend->name() << std::endl;
+    std::cout << "Device profile: " << profile_status << std::endl;
     std::cout << "Models to test: " << models.size() << std::endl;
     std::cout << "Number of prompt sections: " << prompt_sections.size() << std::endl;
-    std::cout << "Estimated tokens in prompt: " << estimated_tokens << std::endl;
+    if (exact_prompt_count) {
+        std::cout << "Tokens in prompt: " << prompt_tokens << " (" << models.front() << " tokenizer)" << std::endl;
+    } else {
+        std::cout << "Estimated tokens in prompt: " << prompt_tokens << std::endl;
+    }
     std::cout << "Verbose mode: " << (verbose ? "ON" : "OFF") << std::endl;
-    std::cout << "Parallel execution: " << (parallel ? "ON" : "OFF") << std::endl;
+    std::cout << "Parallel execution: " << (parallel ? (admission ? "ON (memory admission)" : "ON") : "OFF") << std::endl;
     std::cout << "Memory tracking: " << (track_memory ? "ON" : "OFF") << std::endl;
     std::cout << "Memory-mapped loading: " << (use_mmap ? "ON" : "OFF") << std::endl;
+    std::cout << "Energy source: " << (power_source ? power_source->description() : "OFF") << std::endl;
+    if (fixed_length > 0) {
+        std::cout << "Fixed-length generation: " << fixed_length << " tokens, seed " << fixed_seed << std::endl;
+    } else {
+        std::cout << "Fixed-length generation: OFF" << std::endl;
+    }
     
     if (swap_size > 0) {
         std::cout << "Swap configuration: " << swap_size << "MB with swappiness " << swappiness << std::endl;
@@ -182,6 +747,56 @@ void LLMBenchmark::run() {
     
     std::cout << "===================================" << std::endl;
     
+    if (storage_probe) {
+        // Runs before any model is loaded so its blobs can be evicted from the page cache
+        storage_results = storage_probe->run();
+        
+        std::cout << "\nSTORAGE READ THROUGHPUT (" << storage_probe->get_models_dir() << "):" << std::endl;
+        std::cout << std::left << std::setw(12) << "Method" 
+                << std::setw(14) << "Pattern" 
+                << std::setw(12) << "Block" 
+                << "MB/s" << std::endl;
+        std::cout << std::string(50, '-') << std::endl;
+        for (const auto& measurement : storage_results) {
+            std::cout << std::left << std::setw(12) << measurement.method 
+                    << std::setw(14) << measurement.pattern 
+                    << std::setw(12) << format_memory(measurement.block_size / 1024) 
+                    << std::fixed << std::setprecision(1) << measurement.mb_per_s() << std::endl;
+        }
+        std::cout << "===================================" << std::endl;
+    }
+    
+    if (bandwidth_probe) {
+        bandwidth_results = bandwidth_probe->run();
+        
+        std::cout << "\nMEMORY BANDWIDTH (STREAM):" << std::endl;
+        std::cout << std::left << std::setw(12) << "Kernel" 
+                << std::setw(10) << "Threads" 
+                << "GB/s" << std::endl;
+        std::cout << std::string(30, '-') << std::endl;
+        for (const auto& result : bandwidth_results) {
+            std::cout << std::left << std::setw(12) << result.kernel 
+                    << std::setw(10) << result.threads 
+                    << std::fixed << std::setprecision(2) << result.gb_per_s << std::endl;
+        }
+        std::cout << "===================================" << std::endl;
+    }
+    
+    if (quant_bench) {
+        std::cout << "\nQUANTIZED KERNELS:" << std::endl;
+        quant_results = quant_bench->run();
+        QuantKernelBench::print(quant_results);
+        std::cout << "===================================" << std::endl;
+    }
+    
+    if (tokenizer_bench_mb > 0) {
+        run_tokenizer_bench(prompt);
+    }
+    
+    if (power_source && parallel) {
+        std::cout << "Note: energy counters are system-wide, so per-request energy overlaps in parallel mode" << std::endl;
+    }
+    
     std::vector<Result> results;
     
     // Get baseline memory before starting
@@ -191,227 +806,209 @@ void LLMBenchmark::run() {
         std::cout << "Baseline Ollama memory usage: " << format_memory(baseline_memory) << std::endl;
     }
     
+    if (thermal_monitor) {
+        thermal_monitor->start();
+    }
+    
     auto benchmark_start = std::chrono::high_resolution_clock::now();
 
     if (parallel) {
-        // Run models in parallel
-        std::vector<std::future<Result>> futures;
+        // Run models in parallel, admitting each only when its predicted memory
+        // fits next to the models still running
+        const unsigned long budget_kb = get_system_memory().second * 1024;
+        unsigned long admitted_kb = 0;
+        std::deque<std::pair<std::future<Result>, unsigned long>> running;
         
         for (const auto& model : models) {
-            futures.push_back(std::async(std::launch::async, [this, &prompt, &prompt_sections, model, baseline_memory]() {
-                Result result;
-                result.model_name = model;
-                result.baseline_memory = baseline_memory;
-                
-                {
-                    std::lock_guard<std::mutex> lock(output_mutex);
-                    std::cout << "\n[" << get_timestamp() << "] Starting inference on model " << model << std::endl;
-                }
-                
-                // Setup memory monitoring if enabled
-                MemoryMonitor memory_monitor("ollama");
-                if (track_memory) {
-                    memory_monitor.start();
-                }
-                
-                // Full model evaluation
-                auto full_start = std::chrono::high_resolution_clock::now();
-                result.response = api.generate(model, prompt, false, verbose);
-                auto full_end = std::chrono::high_resolution_clock::now();
-                
-                // Capture peak memory
-                if (track_memory) {
-                    memory_monitor.stop();
-                    result.peak_memory = memory_monitor.get_peak_memory();
-                    
-                    // Alternatively, use direct Ollama process monitoring
-                    unsigned long ollama_memory = get_ollama_memory_usage();
-                    result.peak_memory = std::max(result.peak_memory, ollama_memory);
-                }
-                
-                result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(full_end - full_start);
-                
-                // Calculate tokens per second (very approximate)
-                int output_tokens = estimate_tokens(result.response);
-                result.tokens_per_second = 1000.0 * output_tokens / result.duration.count();
-                
-                {
-                    std::lock_guard<std::mutex> lock(output_mutex);
-                    std::cout << "[" << get_timestamp() << "] Completed full inference on model " << model 
-                            << " in " << format_duration(result.duration) << std::endl;
-                    std::cout << "[" << get_timestamp() << "] Response tokens: ~" << output_tokens 
-                            << " (" << result.tokens_per_second << " tokens/sec)" << std::endl;
-                    
-                    if (track_memory) {
-                        std::cout << "[" << get_timestamp() << "] Peak memory: " 
-                                << format_memory(result.peak_memory) 
-                                << " (+" << format_memory(result.peak_memory - result.baseline_memory) 
-                                << " from baseline)" << std::endl;
+            unsigned long needed_kb = 0;
+            if (admission) {
+                needed_kb = MemoryPredictor::predict(footprint_reader->read(model), backend->runtime_config()).total_kb();
+                while (!running.empty() && admitted_kb + needed_kb > budget_kb) {
+                    {
+                        std::lock_guard<std::mutex> lock(output_mutex);
+                        std::cout << "[" << get_timestamp() << "] Holding " << model << " (predicted " 
+                                  << format_memory(needed_kb) << ", " << format_memory(admitted_kb) << " of " 
+                                  << format_memory(budget_kb) << " admitted)" << std::endl;
                     }
+                    results.push_back(running.front().first.get());
+                    admitted_kb -= running.front().second;
+                    running.pop_front();
                 }
-                
-                // Section-by-section evaluation if verbose
-                if (verbose) {
-                    for (const auto& section : prompt_sections) {
-                        {
-                            std::lock_guard<std::mutex> lock(output_mutex);
-                            std::cout << "[" << get_timestamp() << "] Testing section: " << section.first << std::endl;
-                        }
-                        
-                        std::string section_prompt = "## " + section.first + "\n" + section.second;
-                        
-                        // Setup memory monitoring for section
-                        MemoryMonitor section_memory_monitor("ollama");
-                        if (track_memory) {
-                            section_memory_monitor.start();
-                        }
-                        
-                        auto section_start = std::chrono::high_resolution_clock::now();
-                        std::string section_response = api.generate(model, section_prompt, false, false);
-                        auto section_end = std::chrono::high_resolution_clock::now();
-                        
-                        // Capture section memory
-                        unsigned long section_memory = 0;
-                        if (track_memory) {
-                            section_memory_monitor.stop();
-                            section_memory = section_memory_monitor.get_peak_memory();
-                            
-                            // Use direct Ollama process monitoring if available
-                            unsigned long ollama_section_memory = get_ollama_memory_usage();
-                            section_memory = std::max(section_memory, ollama_section_memory);
-                        }
-                        
-                        std::chrono::milliseconds section_duration = 
-                            std::chrono::duration_cast<std::chrono::milliseconds>(section_end - section_start);
-                        
-                        {
-                            std::lock_guard<std::mutex> lock(output_mutex);
-                            std::cout << "[" << get_timestamp() << "] Completed section: " << section.first 
-                                    << " in " << format_duration(section_duration) << std::endl;
-                                    
-                            if (track_memory) {
-                                std::cout << "[" << get_timestamp() << "] Section memory: " 
-                                        << format_memory(section_memory) << std::endl;
-                            }
-                        }
-                        
-                        result.section_responses[section.first] = section_response;
-                        result.section_metrics[section.first] = {section_duration, section_memory};
-                    }
+                if (needed_kb > budget_kb) {
+                    std::lock_guard<std::mutex> lock(output_mutex);
+                    std::cerr << "Warning: " << model << " is predicted to need " << format_memory(needed_kb) 
+                              << " but only " << format_memory(budget_kb) << " is available" << std::endl;
                 }
-                
-                return result;
-            }));
+            }
+            running.emplace_back(std::async(std::launch::async, [this, &prompt, &prompt_sections, model, baseline_memory]() {
+                return benchmark_model(model, prompt, prompt_sections, baseline_memory);
+            }), needed_kb);
+            admitted_kb += needed_kb;
         }
         
         // Collect results
-        for (auto& future : futures) {
-            results.push_back(future.get());
+        for (auto& entry : running) {
+            results.push_back(entry.first.get());
         }
     } else {
         // Run models sequentially
         for (const auto& model : models) {
-            Result result;
-            result.model_name = model;
-            result.baseline_memory = baseline_memory;
-            
-            std::cout << "\n[" << get_timestamp() << "] Starting inference on model " << model << std::endl;
-            
-            // Setup memory monitoring if enabled
-            MemoryMonitor memory_monitor("ollama");
-            if (track_memory) {
-                memory_monitor.start();
-            }
-            
-            // Full model evaluation
-            auto full_start = std::chrono::high_resolution_clock::now();
-            result.response = api.generate(model, prompt, false, verbose);
-            auto full_end = std::chrono::high_resolution_clock::now();
-            
-            // Capture peak memory
-            if (track_memory) {
-                memory_monitor.stop();
-                result.peak_memory = memory_monitor.get_peak_memory();
-                
-                // Alternatively, use direct Ollama process monitoring
-                unsigned long ollama_memory = get_ollama_memory_usage();
-                result.peak_memory = std::max(result.peak_memory, ollama_memory);
+            results.push_back(benchmark_model(model, prompt, prompt_sections, baseline_memory));
+        }
+    }
+    
+    auto benchmark_end = std::chrono::high_resolution_clock::now();
+    
+    if (thermal_monitor) {
+        thermal_monitor->stop();
+    }
+    std::chrono::milliseconds total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        benchmark_end - benchmark_start);
+    
+    // The sweeps run after the main pass so they never compete with parallel models
+    auto sweep_context = [this](const std::string& model) {
+        int context_length = backend->runtime_config().context_length;
+        ModelFootprint footprint = footprint_reader->read(model);
+        if (footprint.context_length > 0) {
+            context_length = static_cast<int>(std::min<long long>(context_length, footprint.context_length));
+        }
+        return context_length;
+    };
+    
+    if (prefill_sweep) {
+        for (const auto& model : models) {
+            int context_length = sweep_context(model);
+            std::cout << "\nPrefill sweep of " << model << " up to " << context_length << " tokens of context..." << std::endl;
+            auto points = prefill_sweep->run(*backend, model, tokenizer_for(model), context_length);
+            prefill_points.insert(prefill_points.end(), points.begin(), points.end());
+        }
+        
+        std::cout << "\nPREFILL SWEEP (one output token per request):" << std::endl;
+        PrefillSweep::print(prefill_points);
+        std::cout << "===================================" << std::endl;
+    }
+    
+    if (decode_sweep) {
+        for (const auto& model : models) {
+            int context_length = sweep_context(model);
+            std::cout << "\nDecode sweep of " << model << " in " << context_length << " tokens of context..." << std::endl;
+            auto points = decode_sweep->run(*backend, model, tokenizer_for(model), context_length);
+            decode_points.insert(decode_points.end(), points.begin(), points.end());
+        }
+        
+        std::cout << "\nDECODE SWEEP (streamed, fixed prompt and seed):" << std::endl;
+        DecodeSweep::print(decode_points);
+        std::cout << "===================================" << std::endl;
+    }
+    
+    if (chat_bench) {
+        // Conversations go through /api/chat, which only the Ollama server has
+        OllamaAPI* api = dynamic_cast<OllamaAPI*>(backend.get());
+        if (!api) {
+            std::cerr << "Error: the chat benchmark needs the Ollama backend" << std::endl;
+        } else {
+            for (const auto& model : models) {
+                std::cout << "\nPlaying " << chat_scripts.size() << " conversation(s) on " << model << "..." << std::endl;
+                auto turns = chat_bench->run(*api, model, chat_scripts);
+                chat_results.insert(chat_results.end(), turns.begin(), turns.end());
             }
             
-            result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(full_end - full_start);
-            
-            // Calculate tokens per second (very approximate)
-            int output_tokens = estimate_tokens(result.response);
-            result.tokens_per_second = 1000.0 * output_tokens / result.duration.count();
-            
-            std::cout << "[" << get_timestamp() << "] Completed full inference on model " << model 
-                    << " in " << format_duration(result.duration) << std::endl;
-            std::cout << "[" << get_timestamp() << "] Response tokens: ~" << output_tokens 
-                    << " (" << result.tokens_per_second << " tokens/sec)" << std::endl;
-            
-            if (track_memory) {
-                std::cout << "[" << get_timestamp() << "] Peak memory: " 
-                        << format_memory(result.peak_memory) 
-                        << " (+" << format_memory(result.peak_memory - result.baseline_memory) 
-                        << " from baseline)" << std::endl;
+            std::cout << "\nMULTI-TURN PREFILL (cold history vs chat KV reuse vs generate context):" << std::endl;
+            ChatBenchmark::print(chat_results);
+            std::cout << "===================================" << std::endl;
+        }
+    }
+    
+    if (prefix_cache_bench) {
+        for (const auto& model : models) {
+            std::cout << "\nSending " << prompt_sections.size() << " section(s) to " << model 
+                      << " behind a shared prefix..." << std::endl;
+            auto points = prefix_cache_bench->run(*backend, model, prompt_sections, tokenizer_for(model));
+            prefix_cache_points.insert(prefix_cache_points.end(), points.begin(), points.end());
+        }
+        
+        std::cout << "\nSHARED PREFIX CACHE (" << count_tokens(models.front(), prefix_cache_bench->get_prefix()) 
+                  << "-token prefix, warm vs cold):" << std::endl;
+        PrefixCacheBench::print(prefix_cache_points);
+        std::cout << "===================================" << std::endl;
+    }
+    
+    if (structured_bench) {
+        // The format field is a server feature
+        OllamaAPI* api = dynamic_cast<OllamaAPI*>(backend.get());
+        if (!api) {
+            std::cerr << "Error: the structured output benchmark needs the Ollama backend" << std::endl;
+        } else {
+            for (const auto& model : models) {
+                std::cout << "\nGenerating " << prompt_sections.size() << " section(s) on " << model 
+                          << " free, as JSON and to a schema..." << std::endl;
+                auto runs = structured_bench->run(*api, model, prompt_sections);
+                structured_runs.insert(structured_runs.end(), runs.begin(), runs.end());
             }
             
-            // Section-by-section evaluation if verbose
-            if (verbose) {
-                for (const auto& section : prompt_sections) {
-                    std::cout << "[" << get_timestamp() << "] Testing section: " << section.first << std::endl;
-                    
-                    std::string section_prompt = "## " + section.first + "\n" + section.second;
-                    
-                    // Setup memory monitoring for section
-                    MemoryMonitor section_memory_monitor("ollama");
-                    if (track_memory) {
-                        section_memory_monitor.start();
-                    }
-                    
-                    auto section_start = std::chrono::high_resolution_clock::now();
-                    std::string section_response = api.generate(model, section_prompt, false, false);
-                    auto section_end = std::chrono::high_resolution_clock::now();
-                    
-                    // Capture section memory
-                    unsigned long section_memory = 0;
-                    if (track_memory) {
-                        section_memory_monitor.stop();
-                        section_memory = section_memory_monitor.get_peak_memory();
-                        
-                        // Use direct Ollama process monitoring if available
-                        unsigned long ollama_section_memory = get_ollama_memory_usage();
-                        section_memory = std::max(section_memory, ollama_section_memory);
-                    }
-                    
-                    std::chrono::milliseconds section_duration = 
-                        std::chrono::duration_cast<std::chrono::milliseconds>(section_end - section_start);
-                    
-                    std::cout << "[" << get_timestamp() << "] Completed section: " << section.first 
-                            << " in " << format_duration(section_duration) << std::endl;
-                            
-                    if (track_memory) {
-                        std::cout << "[" << get_timestamp() << "] Section memory: " 
-                                << format_memory(section_memory) << std::endl;
-                    }
-                    
-                    result.section_responses[section.first] = section_response;
-                    result.section_metrics[section.first] = {section_duration, section_memory};
-                }
+            std::cout << "\nSTRUCTURED OUTPUT (constrained decoding vs free output):" << std::endl;
+            StructuredOutputBench::print(structured_runs);
+            std::cout << "===================================" << std::endl;
+        }
+    }
+    
+    if (vision_bench) {
+        // Images are a server feature
+        OllamaAPI* api = dynamic_cast<OllamaAPI*>(backend.get());
+        if (!api) {
+            std::cerr << "Error: the vision benchmark needs the Ollama backend" << std::endl;
+        } else {
+            for (const auto& model : models) {
+                std::cout << "\nSending images to " << model << "..." << std::endl;
+                auto points = vision_bench->run(*api, model);
+                vision_points.insert(vision_points.end(), points.begin(), points.end());
             }
             
-            results.push_back(result);
+            std::cout << "\nVISION-LANGUAGE WORKLOAD (vision = prefill beyond the text-only prompt):" << std::endl;
+            VisionBench::print(vision_points);
+            std::cout << "\nIMAGE PREPROCESSING:" << std::endl;
+            ImagePipeline::print(vision_bench->preprocess_stats());
+            std::cout << "===================================" << std::endl;
         }
     }
     
-    auto benchmark_end = std::chrono::high_resolution_clock::now();
-    std::chrono::milliseconds total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-        benchmark_end - benchmark_start);
+    if (option_sweep) {
+        for (const auto& model : models) {
+            std::cout << "\nOptions grid on " << model << " (" << option_sweep->combinations().size() 
+                      << " combinations):" << std::endl;
+            auto rows = option_sweep->run(*backend, model, prompt);
+            option_rows.insert(option_rows.end(), rows.begin(), rows.end());
+        }
+        
+        std::cout << "\nOPTIONS GRID:" << std::endl;
+        OptionSweep::print(option_rows);
+        if (!option_sweep_csv.empty() && OptionSweep::write_csv(option_sweep_csv, option_rows)) {
+            std::cout << "Grid rows saved to " << option_sweep_csv << std::endl;
+        }
+        std::cout << "===================================" << std::endl;
+    }
     
     // Sort results by duration
     std::sort(results.begin(), results.end(), 
             [](const Result& a, const Result& b) { return a.duration < b.duration; });
     
+    last_results = results;
+    
+    std::vector<RooflineRow> roofline;
+    if (!bandwidth_results.empty()) {
+        roofline = compute_roofline(results);
+    }
+    
+    // Throughput measured at reduced CPU frequency is optionally left out of the ranking
+    auto rate_cell = [this](const Result& result) {
+        if (discard_throttled && result.thermal.throttled()) {
+            return std::string("throttled");
+        }
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << result.tokens_per_second;
+        return ss.str();
+    };
+    
     // Summary report
     std::cout << "\n========== BENCHMARK RESULTS ==========" << std::endl;
     std::cout << "Total benchmark time: " << format_duration(total_duration) << std::endl;
@@ -423,17 +1020,33 @@ void LLMBenchmark::run() {
                 << std::setw(15) << "Time" 
                 << std::setw(15) << "Tokens/sec" 
                 << std::setw(15) << "Memory" 
-                << std::setw(15) << "Mem increase" << std::endl;
-        std::cout << std::string(80, '-') << std::endl;
+                << std::setw(15) << "Mem increase" 
+                << std::setw(15) << "Swap in" 
+                << std::setw(15) << "Swap out" << std::endl;
+        std::cout << std::string(110, '-') << std::endl;
         
         for (const auto& result : results) {
             std::cout << std::left << std::setw(20) << result.model_name 
                     << std::setw(15) << format_duration(result.duration) 
-                    << std::setw(15) << std::fixed << std::setprecision(2) << result.tokens_per_second
+                    << std::setw(15) << rate_cell(result)
                     << std::setw(15) << format_memory(result.peak_memory)
-                    << std::setw(15) << format_memory(result.peak_memory - result.baseline_memory) 
+                    << std::setw(15) << format_memory(result.memory_increase()) 
+                    << std::setw(15) << format_memory(pages_to_kb(result.swap.pages_in)) 
+                    << std::setw(15) << format_memory(pages_to_kb(result.swap.pages_out)) 
                     << std::endl;
         }
+        
+        // Surface throughput drops that coincided with swap-in
+        bool any_alerts = false;
+        for (const auto& result : results) {
+            for (const auto& alert : result.swap_alerts) {
+                if (!any_alerts) {
+                    std::cout << "\nSWAP ALERTS:" << std::endl;
+                    any_alerts = true;
+                }
+                std::cout << "  " << result.model_name << ": " << alert << std::endl;
+            }
+        }
     } else {
         std::cout << std::left << std::setw(20) << "Model" 
                 << std::setw(15) << "Time" 
@@ -443,7 +1056,7 @@ void LLMBenchmark::run() {
         for (const auto& result : results) {
             std::cout << std::left << std::setw(20) << result.model_name 
                     << std::setw(15) << format_duration(result.duration) 
-                    << std::setw(15) << std::fixed << std::setprecision(2) << result.tokens_per_second << std::endl;
+                    << std::setw(15) << rate_cell(result) << std::endl;
         }
     }
     
@@ -468,7 +1081,7 @@ void LLMBenchmark::run() {
                 
     //             if (track_memory) {
     //                 out << "Peak memory: " << format_memory(result.peak_memory) << std::endl;
-    //                 out << "Memory increase: " << format_memory(result.peak_memory - result.baseline_memory) << std::endl;
+    //                 out << "Memory increase: " << format_memory(result.memory_increase()) << std::endl;
     //             }
                 
     //             if (!result.section_responses.empty()) {
@@ -523,7 +1136,13 @@ void LLMBenchmark::run() {
             
             // Add benchmark metadata
             j["metadata"]["prompt_file"] = prompt_file;
+            j["metadata"]["backend"] = backend->name();
             j["metadata"]["total_time"] = format_duration(total_duration);
+            if (fixed_length > 0) {
+                // Responses of a forced length; the ROUGE evaluator refuses to score them
+                j["metadata"]["fixed_length"] = fixed_length;
+                j["metadata"]["seed"] = fixed_seed;
+            }
             
             if (track_memory) {
                 j["metadata"]["baseline_memory"] = format_memory(baseline_memory);
@@ -536,11 +1155,84 @@ void LLMBenchmark::run() {
                 
                 // Store performance metrics
                 j["metrics"][result.model_name]["duration_ms"] = result.duration.count();
-                j["metrics"][result.model_name]["tokens_per_second"] = result.tokens_per_second;
+                if (discard_throttled && result.thermal.throttled()) {
+                    j["metrics"][result.model_name]["tokens_per_second"] = nullptr;
+                    j["metrics"][result.model_name]["discarded_throttled"] = true;
+                } else {
+                    j["metrics"][result.model_name]["tokens_per_second"] = result.tokens_per_second;
+                }
+                
+                auto tuned = tuned_options.find(result.model_name);
+                if (tuned != tuned_options.end()) {
+                    j["metrics"][result.model_name]["tuned_options"] = tuned->second;
+                }
+                
+                if (fixed_length > 0) {
+                    j["metrics"][result.model_name]["token_budget"] = result.token_budget;
+                    j["metrics"][result.model_name]["budget_met"] = result.normalized_tps > 0;
+                    j["metrics"][result.model_name]["normalized_tokens_per_second"] = result.normalized_tps;
+                }
+                
+                if (thermal_monitor) {
+                    j["metrics"][result.model_name]["thermal"] = thermal_to_json(result.thermal);
+                }
+                
+                if (power_source && result.energy_joules >= 0) {
+                    j["metrics"][result.model_name]["energy_j"] = result.energy_joules;
+                    if (result.output_tokens > 0) {
+                        j["metrics"][result.model_name]["joules_per_token"] = result.energy_joules / result.output_tokens;
+                    }
+                    if (result.energy_joules > 0) {
+                        j["metrics"][result.model_name]["tokens_per_joule"] = result.output_tokens / result.energy_joules;
+                    }
+                }
                 
                 if (track_memory) {
                     j["metrics"][result.model_name]["peak_memory_kb"] = result.peak_memory;
-                    j["metrics"][result.model_name]["memory_increase_kb"] = result.peak_memory - result.baseline_memory;
+                    j["metrics"][result.model_name]["memory_increase_kb"] = result.memory_increase();
+                    j["metrics"][result.model_name]["swap_in_pages"] = result.swap.pages_in;
+                    j["metrics"][result.model_name]["swap_out_pages"] = result.swap.pages_out;
+                    j["metrics"][result.model_name]["swap_used_delta_kb"] = result.swap.swap_used_delta_kb;
+                    j["metrics"][result.model_name]["peak_swap_growth_kb"] = result.swap.peak_swap_growth_kb;
+                    j["metrics"][result.model_name]["swap_alerts"] = result.swap_alerts;
+                }
+                
+                j["metrics"][result.model_name]["output_tokens"] = result.output_tokens;
+                j["metrics"][result.model_name]["token_source"] = result.token_source;
+                if (result.prompt_tokens > 0) {
+                    j["metrics"][result.model_name]["prompt_tokens"] = result.prompt_tokens;
+                }
+                
+                if (result.generation.eval_count > 0) {
+                    j["metrics"][result.model_name]["prompt_eval_count"] = result.generation.prompt_eval_count;
+                    j["metrics"][result.model_name]["eval_count"] = result.generation.eval_count;
+                    j["metrics"][result.model_name]["load_duration_s"] = result.generation.load_duration;
+                    j["metrics"][result.model_name]["prompt_eval_duration_s"] = result.generation.prompt_eval_duration;
+                    j["metrics"][result.model_name]["eval_duration_s"] = result.generation.eval_duration;
+                }
+                
+                if (result.predicted_memory.valid()) {
+                    j["metrics"][result.model_name]["memory_prediction"] = result.predicted_memory.to_json();
+                    // Concurrent runs measure every running model at once, not this one
+                    if (track_memory && concurrent_runs()) {
+                        j["metrics"][result.model_name]["memory_prediction"]["comparable"] = false;
+                    } else if (track_memory) {
+                        unsigned long measured = result.memory_increase();
+                        j["metrics"][result.model_name]["memory_prediction"]["measured_rss_kb"] = measured;
+                        j["metrics"][result.model_name]["memory_prediction"]["peak_pss_kb"] = result.peak_pss;
+                        if (measured > 0) {
+                            j["metrics"][result.model_name]["memory_prediction"]["error_pct"] = 
+                                result.predicted_memory.error_pct(measured);
+                        }
+                    }
+                }
+                
+                if (result.footprint.valid()) {
+                    j["metrics"][result.model_name]["footprint"] = result.footprint.to_json();
+                    j["metrics"][result.model_name]["gparams_per_second"] = 
+                        result.footprint.gparams_per_second(result.tokens_per_second);
+                    j["metrics"][result.model_name]["weight_gb_per_second"] = 
+                        result.footprint.weight_gb_per_second(result.tokens_per_second);
                 }
                 
                 // Store section responses if available
@@ -551,17 +1243,136 @@ void LLMBenchmark::run() {
                         auto metrics_it = result.section_metrics.find(section);
                         if (metrics_it != result.section_metrics.end()) {
                             j["section_metrics"][result.model_name][section]["duration_ms"] = 
-                                metrics_it->second.first.count();
+                                metrics_it->second.duration.count();
+                            j["section_metrics"][result.model_name][section]["tokens_per_second"] = 
+                                metrics_it->second.tokens_per_second;
+                            
+                            if (thermal_monitor) {
+                                j["section_metrics"][result.model_name][section]["thermal"] = 
+                                    thermal_to_json(metrics_it->second.thermal);
+                            }
+                            
+                            if (power_source && metrics_it->second.energy_joules >= 0) {
+                                j["section_metrics"][result.model_name][section]["energy_j"] = 
+                                    metrics_it->second.energy_joules;
+                            }
                             
                             if (track_memory) {
                                 j["section_metrics"][result.model_name][section]["memory_kb"] = 
-                                    metrics_it->second.second;
+                                    metrics_it->second.memory;
+                                j["section_metrics"][result.model_name][section]["swap_in_pages"] = 
+                                    metrics_it->second.swap.pages_in;
+                                j["section_metrics"][result.model_name][section]["swap_out_pages"] = 
+                                    metrics_it->second.swap.pages_out;
+                                j["section_metrics"][result.model_name][section]["swap_used_delta_kb"] = 
+                                    metrics_it->second.swap.swap_used_delta_kb;
                             }
                         }
                     }
                 }
             }
             
+            if (!storage_results.empty()) {
+                j["storage"]["models_dir"] = storage_probe->get_models_dir();
+                for (const auto& measurement : storage_results) {
+                    j["storage"]["measurements"].push_back({
+                        {"method", measurement.method},
+                        {"pattern", measurement.pattern},
+                        {"block_size", measurement.block_size},
+                        {"bytes", measurement.bytes},
+                        {"seconds", measurement.seconds},
+                        {"mb_per_s", measurement.mb_per_s()}
+                    });
+                }
+                
+                double bandwidth = load_bandwidth();
+                for (const auto& result : results) {
+                    unsigned long long model_bytes = 0;
+                    StorageProbe::find_model_blob(storage_probe->get_models_dir(), result.model_name, model_bytes);
+                    if (model_bytes > 0 && bandwidth > 0) {
+                        j["metrics"][result.model_name]["model_bytes"] = model_bytes;
+                        j["metrics"][result.model_name]["expected_load_s"] = model_bytes / 1048576.0 / bandwidth;
+                    }
+                }
+            }
+            
+            if (!bandwidth_results.empty()) {
+                for (const auto& result : bandwidth_results) {
+                    j["bandwidth"].push_back({
+                        {"kernel", result.kernel},
+                        {"threads", result.threads},
+                        {"gb_per_s", result.gb_per_s}
+                    });
+                }
+                for (const auto& row : roofline) {
+                    j["metrics"][row.model_name]["weight_bytes"] = row.info.size;
+                    j["metrics"][row.model_name]["quantization"] = row.info.quantization_level;
+                    j["metrics"][row.model_name]["decode_ceiling_tps"] = row.ceiling_tps;
+                    j["metrics"][row.model_name]["bandwidth_efficiency_pct"] = row.efficiency_pct;
+                }
+            }
+            
+            for (const auto& result : tokenizer_results) {
+                j["tokenizer_bench"].push_back({
+                    {"model", result.model_name},
+                    {"type", result.kind},
+                    {"vocab_size", result.vocab_size},
+                    {"bytes", result.bytes},
+                    {"tokens", result.tokens},
+                    {"seconds", result.seconds},
+                    {"tokens_per_second", result.seconds > 0 ? result.tokens / result.seconds : 0.0}
+                });
+            }
+            
+            if (!quant_results.empty()) {
+                j["quant_kernels"] = QuantKernelBench::to_json(quant_results);
+            }
+            
+            if (!prefill_points.empty()) {
+                j["prefill_sweep"] = PrefillSweep::to_json(prefill_points);
+            }
+            
+            if (!decode_points.empty()) {
+                j["decode_sweep"] = DecodeSweep::to_json(decode_points);
+            }
+            
+            if (!chat_results.empty()) {
+                j["chat_bench"] = ChatBenchmark::to_json(chat_results);
+            }
+            
+            if (!prefix_cache_points.empty()) {
+                j["prefix_cache"] = PrefixCacheBench::to_json(prefix_cache_points);
+            }
+            
+            if (!structured_runs.empty()) {
+                j["structured_output"] = StructuredOutputBench::to_json(structured_runs);
+            }
+            
+            if (!vision_points.empty()) {
+                j["vision"] = VisionBench::to_json(vision_points);
+                j["vision_preprocess"] = ImagePipeline::to_json(vision_bench->preprocess_stats());
+            }
+            
+            if (!option_rows.empty()) {
+                j["option_sweep"] = OptionSweep::to_json(option_rows);
+            }
+            
+            if (thermal_monitor) {
+                j["thermal_timeline"] = json::array();
+                for (const auto& sample : thermal_monitor->get_samples()) {
+                    if (discard_throttled && sample.throttled) {
+                        continue;
+                    }
+                    j["thermal_timeline"].push_back({
+                        {"time_s", sample.time_s},
+                        {"max_temp_c", sample.max_temp_c},
+                        {"mean_freq_mhz", sample.mean_freq_mhz},
+                        {"freq_ratio", sample.freq_ratio},
+                        {"throttled", sample.throttled}
+                    });
+                }
+            }
+            
             // Write formatted JSON to file
             out << std::setw(4) << j << std::endl;
             out.close();
@@ -580,7 +1391,7 @@ void LLMBenchmark::run() {
             
             if (track_memory) {
                 std::cout << " | Memory: " << format_memory(result.peak_memory) 
-                        << " (+" << format_memory(result.peak_memory - result.baseline_memory) 
+                        << " (+" << format_memory(result.memory_increase()) 
                         << " from baseline)";
             }
             
@@ -594,10 +1405,11 @@ void LLMBenchmark::run() {
                     
                     auto metrics_it = result.section_metrics.find(section.first);
                     if (metrics_it != result.section_metrics.end()) {
-                        std::cout << "Time: " << format_duration(metrics_it->second.first);
+                        std::cout << "Time: " << format_duration(metrics_it->second.duration);
                         
                         if (track_memory) {
-                            std::cout << " | Memory: " << format_memory(metrics_it->second.second);
+                            std::cout << " | Memory: " << format_memory(metrics_it->second.memory);
+                            std::cout << " | Swap in: " << format_memory(pages_to_kb(metrics_it->second.swap.pages_in));
                         }
                         
                         std::cout << std::endl;
@@ -632,14 +1444,14 @@ void LLMBenchmark::run() {
         // Find the model with the highest memory usage for scaling
         unsigned long max_memory_increase = 0;
         for (const auto& result : results) {
-            max_memory_increase = std::max(max_memory_increase, result.peak_memory - result.baseline_memory);
+            max_memory_increase = std::max(max_memory_increase, result.memory_increase());
         }
         
         // Simple ASCII bar chart
         const int chart_width = 50; // characters
         
         for (const auto& result : results) {
-            unsigned long memory_increase = result.peak_memory - result.baseline_memory;
+            unsigned long memory_increase = result.memory_increase();
             int bar_length = (max_memory_increase > 0) 
                            ? static_cast<int>((memory_increase * chart_width) / max_memory_increase) 
                            : 0;
@@ -649,4 +1461,461 @@ void LLMBenchmark::run() {
             std::cout << format_memory(memory_increase) << std::endl;
         }
     }
+    
+    report_footprint(results);
+    
+    if (fixed_length > 0) {
+        report_fixed_length(results);
+    }
+    
+    if (track_memory) {
+        report_memory_prediction(results);
+    }
+    
+    if (thermal_monitor) {
+        report_thermal(results);
+    }
+    
+    if (power_source) {
+        report_energy(results);
+    }
+    
+    if (!storage_results.empty()) {
+        report_load_io(results);
+    }
+    
+    if (!bandwidth_results.empty()) {
+        report_roofline(roofline);
+    }
+    
+    if (!quant_results.empty()) {
+        report_kernel_ceiling(results);
+    }
+}
+
+void LLMBenchmark::report_footprint(const std::vector<Result>& results) {
+    bool any = std::any_of(results.begin(), results.end(),
+                           [](const Result& result) { return result.footprint.valid(); });
+    if (!any) {
+        return;
+    }
+    
+    std::cout << "\nMODEL FOOTPRINT (GGUF header):" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model" 
+            << std::setw(10) << "Arch" 
+            << std::setw(10) << "Params" 
+            << std::setw(12) << "Weights" 
+            << std::setw(8) << "Bits" 
+            << std::setw(8) << "Type" 
+            << std::setw(8) << "Ctx" 
+            << std::setw(8) << "Layers" 
+            << std::setw(8) << "Heads" 
+            << std::setw(12) << "Tokens/sec" 
+            << std::setw(10) << "Gparam/s" 
+            << "Weight GB/s" << std::endl;
+    std::cout << std::string(125, '-') << std::endl;
+    
+    for (const auto& result : results) {
+        const ModelFootprint& footprint = result.footprint;
+        std::cout << std::left << std::setw(20) << result.model_name;
+        if (!footprint.valid()) {
+            std::cout << "no GGUF blob in " << footprint_reader->get_models_dir() << std::endl;
+            continue;
+        }
+        
+        std::stringstream params, heads;
+        if (footprint.parameter_count >= 1000000000ULL) {
+            params << std::fixed << std::setprecision(2) << footprint.parameter_count / 1e9 << "B";
+        } else {
+            params << std::fixed << std::setprecision(1) << footprint.parameter_count / 1e6 << "M";
+        }
+        heads << footprint.head_count << "/" << footprint.head_count_kv;
+        std::cout << std::setw(10) << footprint.architecture 
+                << std::setw(10) << params.str() 
+                << std::setw(12) << format_memory(footprint.weight_bytes / 1024) 
+                << std::setw(8) << std::fixed << std::setprecision(2) << footprint.bits_per_weight() 
+                << std::setw(8) << footprint.dominant_type() 
+                << std::setw(8) << footprint.context_length 
+                << std::setw(8) << footprint.block_count 
+                << std::setw(8) << heads.str() 
+                << std::setw(12) << result.tokens_per_second 
+                << std::setw(10) << footprint.gparams_per_second(result.tokens_per_second) 
+                << footprint.weight_gb_per_second(result.tokens_per_second) << std::endl;
+    }
+}
+
+bool LLMBenchmark::concurrent_runs() const {
+    return parallel && models.size() > 1;
+}
+
+void LLMBenchmark::report_memory_prediction(const std::vector<Result>& results) {
+    bool any = std::any_of(results.begin(), results.end(),
+                           [](const Result& result) { return result.predicted_memory.valid(); });
+    if (!any) {
+        return;
+    }
+    
+    std::cout << "\nPREDICTED VS MEASURED MEMORY:" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model" 
+            << std::setw(8) << "Ctx" 
+            << std::setw(12) << "Weights" 
+            << std::setw(12) << "KV cache" 
+            << std::setw(12) << "Compute" 
+            << std::setw(12) << "Predicted" 
+            << std::setw(14) << "RSS increase" 
+            << std::setw(12) << "Peak PSS" 
+            << "Error" << std::endl;
+    std::cout << std::string(110, '-') << std::endl;
+    
+    // In parallel runs the server's RSS holds every model running at the same time
+    bool comparable = !concurrent_runs();
+    for (const auto& result : results) {
+        const MemoryPrediction& prediction = result.predicted_memory;
+        if (!prediction.valid()) {
+            continue;
+        }
+        unsigned long measured = comparable ? result.memory_increase() : 0;
+        std::cout << std::left << std::setw(20) << result.model_name 
+                << std::setw(8) << prediction.context_length 
+                << std::setw(12) << format_memory(prediction.weights_kb) 
+                << std::setw(12) << format_memory(prediction.kv_cache_kb) 
+                << std::setw(12) << format_memory(prediction.compute_kb) 
+                << std::setw(12) << format_memory(prediction.total_kb()) 
+                << std::setw(14) << (comparable ? format_memory(measured) : "-") 
+                << std::setw(12) << (comparable && result.peak_pss > 0 ? format_memory(result.peak_pss) : "-");
+        if (measured > 0) {
+            std::cout << std::showpos << std::fixed << std::setprecision(1) << prediction.error_pct(measured) 
+                      << std::noshowpos << "%";
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::endl;
+    }
+    if (!comparable) {
+        std::cout << "Models ran in parallel, so the measured memory covers all of them and is not compared" << std::endl;
+    }
+}
+
+void LLMBenchmark::report_kernel_ceiling(const std::vector<Result>& results) {
+    std::cout << "\nDECODE VS SINGLE-THREAD MATVEC KERNEL:" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model" 
+            << std::setw(10) << "Quant" 
+            << std::setw(10) << "Kernel" 
+            << std::setw(14) << "Kernel GB/s" 
+            << std::setw(14) << "Ceiling t/s" 
+            << "Tokens/sec" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    
+    auto models_info = backend->list_model_info();
+    for (const auto& result : results) {
+        auto it = std::find_if(models_info.begin(), models_info.end(),
+                               [&](const ModelInfo& info) { return info.name == result.model_name; });
+        std::string format = it != models_info.end() ? QuantKernelBench::kernel_format_for(it->quantization_level) : "";
+        double kernel_bandwidth = QuantKernelBench::best_matvec_bandwidth(quant_results, format);
+        
+        std::cout << std::left << std::setw(20) << result.model_name 
+                << std::setw(10) << (it != models_info.end() ? it->quantization_level : "-");
+        if (format.empty() || kernel_bandwidth <= 0 || it->size == 0) {
+            std::cout << "no matching kernel" << std::endl;
+            continue;
+        }
+        
+        // One core streaming the weights once per token
+        std::cout << std::setw(10) << format 
+                << std::setw(14) << std::fixed << std::setprecision(2) << kernel_bandwidth 
+                << std::setw(14) << kernel_bandwidth * 1e9 / it->size 
+                << result.tokens_per_second << std::endl;
+    }
+}
+
+std::vector<LLMBenchmark::RooflineRow> LLMBenchmark::compute_roofline(const std::vector<Result>& results) {
+    std::vector<RooflineRow> rows;
+    
+    // Every generated token streams all weights through the CPU once; KV cache reads are ignored
+    double bandwidth = BandwidthProbe::best(bandwidth_results, "triad") * 1e9;
+    if (bandwidth <= 0) {
+        return rows;
+    }
+    
+    auto models_info = backend->list_model_info();
+    for (const auto& result : results) {
+        auto it = std::find_if(models_info.begin(), models_info.end(),
+                               [&](const ModelInfo& info) { return info.name == result.model_name; });
+        RooflineRow row;
+        row.model_name = result.model_name;
+        if (it != models_info.end()) {
+            row.info = *it;
+        }
+        // Tensor bytes from the GGUF header exclude metadata and the tokenizer
+        if (result.footprint.valid()) {
+            row.info.size = result.footprint.weight_bytes;
+            if (row.info.quantization_level.empty()) {
+                row.info.quantization_level = result.footprint.file_type;
+            }
+        }
+        if (row.info.size == 0) {
+            continue;
+        }
+        
+        row.ceiling_tps = bandwidth / row.info.size;
+        row.tokens_per_second = result.tokens_per_second;
+        row.efficiency_pct = 100.0 * result.tokens_per_second / row.ceiling_tps;
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+void LLMBenchmark::report_roofline(const std::vector<RooflineRow>& rows) {
+    std::cout << "\nDECODE EFFICIENCY VS MEMORY BANDWIDTH (" << std::fixed << std::setprecision(2) 
+              << BandwidthProbe::best(bandwidth_results, "triad") << " GB/s triad):" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model" 
+            << std::setw(10) << "Params" 
+            << std::setw(10) << "Quant" 
+            << std::setw(12) << "Weights" 
+            << std::setw(14) << "Ceiling t/s" 
+            << std::setw(12) << "Tokens/sec" 
+            << "Efficiency" << std::endl;
+    std::cout << std::string(90, '-') << std::endl;
+    
+    for (const auto& row : rows) {
+        std::cout << std::left << std::setw(20) << row.model_name 
+                << std::setw(10) << (row.info.parameter_size.empty() ? "-" : row.info.parameter_size) 
+                << std::setw(10) << (row.info.quantization_level.empty() ? "-" : row.info.quantization_level) 
+                << std::setw(12) << format_memory(row.info.size / 1024) 
+                << std::setw(14) << std::setprecision(2) << row.ceiling_tps 
+                << std::setw(12) << row.tokens_per_second 
+                << std::setprecision(1) << row.efficiency_pct << "%" << std::endl;
+    }
+    
+    if (rows.empty()) {
+        std::cout << "No model sizes available from the server" << std::endl;
+    }
+}
+
+double LLMBenchmark::load_bandwidth() const {
+    // The server reads weights through mmap when enabled, otherwise with plain reads
+    const std::string method = use_mmap ? "mmap" : "buffered";
+    for (const auto& measurement : storage_results) {
+        if (measurement.method == method && measurement.pattern == "sequential") {
+            return measurement.mb_per_s();
+        }
+    }
+    return 0.0;
+}
+
+void LLMBenchmark::report_load_io(const std::vector<Result>& results) {
+    double bandwidth = load_bandwidth();
+    if (bandwidth <= 0) {
+        return;
+    }
+    
+    std::cout << "\nLOAD TIME VS STORAGE BANDWIDTH (" << std::fixed << std::setprecision(1) << bandwidth 
+              << " MB/s " << (use_mmap ? "mmap" : "buffered") << " sequential):" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model" 
+            << std::setw(12) << "Size" 
+            << std::setw(14) << "Load (s)" 
+            << std::setw(14) << "I/O (s)" 
+            << "Verdict" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    
+    for (const auto& result : results) {
+        unsigned long long model_bytes = 0;
+        StorageProbe::find_model_blob(storage_probe->get_models_dir(), result.model_name, model_bytes);
+        std::cout << std::left << std::setw(20) << result.model_name;
+        if (model_bytes == 0) {
+            std::cout << "manifest not found in " << storage_probe->get_models_dir() << std::endl;
+            continue;
+        }
+        
+        double io_seconds = model_bytes / 1048576.0 / bandwidth;
+        double load_seconds = result.generation.load_duration;
+        
+        // A load much faster than the disk allows was served from the page cache
+        std::string verdict;
+        if (load_seconds < 0.5 * io_seconds) {
+            verdict = "warm (page cache)";
+        } else if (load_seconds <= 1.5 * io_seconds) {
+            verdict = "I/O bound";
+        } else {
+            verdict = "compute bound (" + std::to_string(static_cast<int>(100.0 * io_seconds / load_seconds)) + "% I/O)";
+        }
+        
+        std::cout << std::setw(12) << format_memory(model_bytes / 1024) 
+                << std::setw(14) << std::setprecision(2) << load_seconds 
+                << std::setw(14) << io_seconds 
+                << verdict << std::endl;
+    }
+}
+
+void LLMBenchmark::report_fixed_length(const std::vector<Result>& results) {
+    std::vector<const Result*> ranked;
+    for (const auto& result : results) {
+        ranked.push_back(&result);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const Result* a, const Result* b) {
+        return a->normalized_tps > b->normalized_tps;
+    });
+    
+    std::cout << "\nFIXED-LENGTH GENERATION (" << fixed_length << " tokens, seed " << fixed_seed << "):" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model" 
+            << std::setw(10) << "Tokens" 
+            << std::setw(12) << "Prefill s" 
+            << std::setw(12) << "Decode s" 
+            << std::setw(12) << "Decode t/s" 
+            << "Response s" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    
+    for (const Result* result : ranked) {
+        std::cout << std::left << std::setw(20) << result->model_name 
+                << std::setw(10) << result->generation.eval_count 
+                << std::setw(12) << std::fixed << std::setprecision(3) << result->generation.prompt_eval_duration 
+                << std::setw(12) << result->generation.eval_duration 
+                << std::setw(12) << std::setprecision(2) << result->normalized_tps 
+                << std::setprecision(3) << result->duration.count() / 1000.0 << std::defaultfloat << std::endl;
+    }
+    
+    for (const Result* result : ranked) {
+        if (result->normalized_tps <= 0) {
+            std::cout << "  " << result->model_name << " stopped after " << result->generation.eval_count << " of " 
+                      << fixed_length << " tokens; its rate is left out of the comparison" << std::endl;
+        }
+    }
+}
+
+void LLMBenchmark::report_energy(const std::vector<Result>& results) {
+    std::cout << "\nENERGY PER TOKEN (" << power_source->description() << "):" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model" 
+            << std::setw(12) << "Requests" 
+            << std::setw(12) << "Tokens" 
+            << std::setw(14) << "Energy (J)" 
+            << std::setw(12) << "J/token" 
+            << "Tokens/J" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    
+    for (const auto& result : results) {
+        // Sum every request of the model that has an energy reading
+        int requests = 0;
+        long tokens = 0;
+        double joules = 0.0;
+        if (result.energy_joules >= 0) {
+            requests++;
+            tokens += result.output_tokens;
+            joules += result.energy_joules;
+        }
+        for (const auto& [section, metrics] : result.section_metrics) {
+            if (metrics.energy_joules >= 0) {
+                requests++;
+                tokens += metrics.output_tokens;
+                joules += metrics.energy_joules;
+            }
+        }
+        
+        std::cout << std::left << std::setw(20) << result.model_name << std::setw(12) << requests;
+        if (requests == 0) {
+            std::cout << "no energy readings" << std::endl;
+            continue;
+        }
+        std::cout << std::setw(12) << tokens 
+                << std::setw(14) << std::fixed << std::setprecision(2) << joules 
+                << std::setw(12) << std::setprecision(4) << (tokens > 0 ? joules / tokens : 0.0) 
+                << std::setprecision(2) << (joules > 0 ? tokens / joules : 0.0) << std::endl;
+    }
+}
+
+void LLMBenchmark::report_thermal(const std::vector<Result>& results) {
+    // One row per request so throttling can be lined up against decode rate
+    struct RequestRow {
+        std::string model;
+        std::string request;
+        double tokens_per_second;
+        ThermalSummary thermal;
+    };
+    std::vector<RequestRow> rows;
+    for (const auto& result : results) {
+        rows.push_back({result.model_name, "full prompt", result.tokens_per_second, result.thermal});
+        for (const auto& [section, metrics] : result.section_metrics) {
+            rows.push_back({result.model_name, section, metrics.tokens_per_second, metrics.thermal});
+        }
+    }
+    
+    std::cout << "\nTHERMAL / CPU FREQUENCY BY REQUEST:" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model" 
+            << std::setw(20) << "Request" 
+            << std::setw(12) << "Tokens/sec" 
+            << std::setw(12) << "Mean MHz" 
+            << std::setw(12) << "Min ratio" 
+            << std::setw(10) << "Max C" 
+            << "Throttled" << std::endl;
+    std::cout << std::string(100, '-') << std::endl;
+    
+    for (const auto& row : rows) {
+        std::stringstream throttled;
+        if (row.thermal.samples > 0) {
+            throttled << std::fixed << std::setprecision(0) 
+                      << (100.0 * row.thermal.throttled_samples / row.thermal.samples) << "%";
+        } else {
+            throttled << "-";
+        }
+        if (discard_throttled && row.thermal.throttled()) {
+            throttled << " (discarded)";
+        }
+        
+        std::cout << std::left << std::setw(20) << row.model 
+                << std::setw(20) << row.request.substr(0, 19) 
+                << std::setw(12) << std::fixed << std::setprecision(2) << row.tokens_per_second 
+                << std::setw(12) << std::setprecision(0) << row.thermal.mean_freq_mhz 
+                << std::setw(12) << std::setprecision(2) << row.thermal.min_freq_ratio 
+                << std::setw(10) << std::setprecision(1) << row.thermal.max_temp_c 
+                << throttled.str() << std::endl;
+    }
+    
+    // Pearson correlation between mean CPU frequency and decode rate across requests
+    std::vector<std::pair<double, double>> points;
+    for (const auto& row : rows) {
+        if (row.thermal.samples > 0 && row.tokens_per_second > 0 && 
+            !(discard_throttled && row.thermal.throttled())) {
+            points.push_back({row.thermal.mean_freq_mhz, row.tokens_per_second});
+        }
+    }
+    
+    if (points.size() >= 3) {
+        double n = static_cast<double>(points.size());
+        double mean_x = 0.0, mean_y = 0.0;
+        for (const auto& [x, y] : points) {
+            mean_x += x / n;
+            mean_y += y / n;
+        }
+        double cov = 0.0, var_x = 0.0, var_y = 0.0;
+        for (const auto& [x, y] : points) {
+            cov += (x - mean_x) * (y - mean_y);
+            var_x += (x - mean_x) * (x - mean_x);
+            var_y += (y - mean_y) * (y - mean_y);
+        }
+        if (var_x > 0 && var_y > 0) {
+            std::cout << "Frequency/decode-rate correlation: " << std::fixed << std::setprecision(2) 
+                      << cov / std::sqrt(var_x * var_y) << " across " << points.size() << " requests" << std::endl;
+        }
+    }
+    
+    int throttled_requests = 0;
+    for (const auto& row : rows) {
+        if (row.thermal.throttled()) throttled_requests++;
+    }
+    if (throttled_requests > 0) {
+        std::cout << "WARNING: " << throttled_requests << " of " << rows.size() 
+                  << " requests ran while the CPU was throttled" << std::endl;
+    }
+    
+    if (verbose) {
+        std::cout << "\nTHERMAL TIMELINE:" << std::endl;
+        for (const auto& sample : thermal_monitor->get_samples()) {
+            if (discard_throttled && sample.throttled) {
+                continue;
+            }
+            std::cout << "  t=" << std::setw(8) << std::fixed << std::setprecision(1) << sample.time_s 
+                      << " temp=" << std::setw(6) << sample.max_temp_c 
+                      << " freq=" << std::setprecision(0) << sample.mean_freq_mhz << " MHz"
+                      << (sample.throttled ? "  THROTTLED" : "") << std::endl;
+        }
+    }
 }
\ No newline at end of file
@@ -1,8 +1,34 @@
 #include "llm_benchmark.h"
+#include "memory_experiment.h"
+#include "min_ram_finder.h"
+#include "embed_benchmark.h"
+#include "interference_matrix.h"
+#include "server_batching.h"
+#include "gguf_backend.h"
 #include <iostream>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
 #include <string>
 #include <vector>
 
+/**
+ * @brief Split a comma-separated option value
+ * @param value Option value (e.g. "10,60,100")
+ * @return Non-empty items
+ */
+std::vector<std::string> split_list(const std::string& value) {
+    std::vector<std::string> items;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
 /**
  * @brief Display help message
  * @param argv Program name
@@ -20,8 +46,139 @@ void display_help(const char* argv) {
     std::cout << "  --prompt, -i FILE      Specify prompt file (default: prompt.txt)" << std::endl;
     std::cout << "  --output, -o FILE      Save detailed results to file" << std::endl;
     std::cout << "  --model, -m MODEL      Specify a model to test (can be used multiple times)" << std::endl;
+    std::cout << "  --thermal              Sample CPU temperature and frequency alongside memory" << std::endl;
+    std::cout << "  --thermal-interval MS  Thermal sampling interval (default 1000)" << std::endl;
+    std::cout << "  --discard-throttled    Leave throughput measured while throttled out of the results" << std::endl;
+    std::cout << "  --energy SOURCE        Report joules per token: powercap (under --sysfs-root)," << std::endl;
+    std::cout << "                         powercap:DIR, or csv:FILE (external meter log of timestamp,watts)" << std::endl;
+    std::cout << "  --bandwidth            Measure memory bandwidth (STREAM) and report decode rate as a" << std::endl;
+    std::cout << "                         percentage of bandwidth / weight bytes" << std::endl;
+    std::cout << "  --bw-size MB           Size of each bandwidth array (default 128)" << std::endl;
+    std::cout << "  --bw-threads N         Threads for the multithreaded pass (default: all allowed CPUs)" << std::endl;
+    std::cout << "  --quant-bench          Benchmark Q4_0/Q4_K/Q6_K/Q8_0/F16 dot and matvec kernels (scalar and SIMD)" << std::endl;
+    std::cout << "  --quant-shapes LIST    Layer shapes as ROWSxCOLS (default 2048x2048,5632x2048,4096x4096,11008x4096)" << std::endl;
+    std::cout << "  --tokenizer-bench      Time each model's GGUF tokenizer (SentencePiece or BPE) on the prompt" << std::endl;
+    std::cout << "  --tokenizer-mb MB      Text encoded per model by the tokenizer benchmark (default 8)" << std::endl;
+    std::cout << "  --storage-bench        Measure read throughput of the model filesystem and compare it" << std::endl;
+    std::cout << "                         with each model's load time" << std::endl;
+    std::cout << "  --storage-dir DIR      Models directory to probe (default: $OLLAMA_MODELS or ~/.ollama/models)" << std::endl;
+    std::cout << "  --storage-block KB     Read block size for the storage probe (default 1024)" << std::endl;
+    std::cout << "  --storage-size MB      Bytes read per sequential pass (default 512)" << std::endl;
+    std::cout << "  --fixed-length N       Every model generates exactly N tokens (stop tokens disabled) so" << std::endl;
+    std::cout << "                         throughput compares the same work; not for quality evaluation" << std::endl;
+    std::cout << "  --seed N               Sampling seed in fixed-length mode (default 42)" << std::endl;
     std::cout << "  --help, -h             Show this help message" << std::endl;
     std::cout << std::endl;
+    std::cout << "In-process Backend:" << std::endl;
+    std::cout << "  --backend NAME         ollama (HTTP server, default) or gguf (CPU decode in this process," << std::endl;
+    std::cout << "                         no server needed; llama-architecture models)" << std::endl;
+    std::cout << "  --models-dir DIR       Where Ollama model names are resolved to GGUF blobs, for gguf and for" << std::endl;
+    std::cout << "                         the model footprint report (default: $OLLAMA_MODELS or" << std::endl;
+    std::cout << "                         ~/.ollama/models); -m also accepts a path to a .gguf file" << std::endl;
+    std::cout << "  --gguf-threads N       Decode threads (default: all CPUs)" << std::endl;
+    std::cout << "  --gguf-ctx N           KV cache length in tokens (default 2048)" << std::endl;
+    std::cout << "  --gguf-max-tokens N    Tokens to generate per request (default 256)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Memory Prediction:" << std::endl;
+    std::cout << "  --predict-memory       Print each model's predicted memory (weights + KV cache + compute)" << std::endl;
+    std::cout << "                         and whether it fits, then exit without running it" << std::endl;
+    std::cout << "  --device-ram MB        RAM of the target device for --predict-memory (default: this machine)" << std::endl;
+    std::cout << "  --num-ctx N            Context length requested from Ollama (default: server default, 2048)" << std::endl;
+    std::cout << "  --no-admission         In parallel mode, start every model at once instead of waiting" << std::endl;
+    std::cout << "                         until its predicted memory fits in available RAM" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Prefill and Decode Sweeps:" << std::endl;
+    std::cout << "  --prefill-sweep        After the models run, time prefill and TTFT with synthetic prompts" << std::endl;
+    std::cout << "                         growing geometrically up to the context length (1 output token)" << std::endl;
+    std::cout << "  --sweep-min N          Shortest prompt in tokens (default 16)" << std::endl;
+    std::cout << "  --sweep-max N          Longest prompt in tokens (default: context length)" << std::endl;
+    std::cout << "  --sweep-factor F       Ratio between consecutive prompt lengths (default 2)" << std::endl;
+    std::cout << "  --decode-sweep         After the models run, stream a fixed prompt with doubling num_predict" << std::endl;
+    std::cout << "                         and report decode latency by token position and memory growth" << std::endl;
+    std::cout << "  --decode-min N         Shortest output in tokens (default 16)" << std::endl;
+    std::cout << "  --decode-max N         Longest output in tokens (default 2048, capped by the context)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options Grid:" << std::endl;
+    std::cout << "  --grid SPEC            After the models run, run the prompt with every combination of Ollama" << std::endl;
+    std::cout << "                         options, e.g. \"num_thread=2,4;num_batch=128,512;num_ctx=2048\"" << std::endl;
+    std::cout << "  --grid-file FILE       Grid as a JSON object of option -> list of values" << std::endl;
+    std::cout << "  --grid-repeat N        Runs per combination (default 1)" << std::endl;
+    std::cout << "  --grid-csv FILE        Also write one row per combination to a CSV file" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Autotune:" << std::endl;
+    std::cout << "  --autotune             Search num_thread, num_batch and num_ctx for each model by successive" << std::endl;
+    std::cout << "                         halving, save the winners to the device profile and exit" << std::endl;
+    std::cout << "  --tune-objective OBJ   decode (maximize tokens/s, default) or ttft (minimize time to first token)" << std::endl;
+    std::cout << "  --tune-threads LIST    num_thread candidates (default: 1, 2, 4, ... up to the CPU count)" << std::endl;
+    std::cout << "  --tune-batch LIST      num_batch candidates (default 32,64,128,256,512; not searched with gguf)" << std::endl;
+    std::cout << "  --tune-ctx LIST        num_ctx candidates (default: not searched)" << std::endl;
+    std::cout << "  --profile FILE         Device profile (default ~/.config/edge_ai_benchmark/<hostname>.json)" << std::endl;
+    std::cout << "                         Benchmark runs send each model's tuned options when a profile exists" << std::endl;
+    std::cout << "  --no-profile           Do not apply tuned options from the device profile" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Multi-turn Chat:" << std::endl;
+    std::cout << "  --chat-bench           After the models run, play conversations through /api/chat and compare" << std::endl;
+    std::cout << "                         per-turn prefill with KV reuse, with the generate context array, and cold" << std::endl;
+    std::cout << "  --chat-script FILE     Conversations as JSON: [{\"name\", \"system\", \"turns\": [...]}]" << std::endl;
+    std::cout << "                         (default: a built-in five-turn assistant conversation)" << std::endl;
+    std::cout << "  --chat-reply N         Tokens generated per turn (default 64)" << std::endl;
+    std::cout << "  --prefix-cache         Send the prompt sections back to back behind a shared prefix and compare" << std::endl;
+    std::cout << "                         prefill with the prefix cached (warm) and not (cold)" << std::endl;
+    std::cout << "  --prefix-file FILE     Shared prefix text (default: a built-in system preamble)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Structured Output:" << std::endl;
+    std::cout << "  --structured           After the models run, generate each prompt section free, with format" << std::endl;
+    std::cout << "                         \"json\" and with a JSON schema; report decode overhead and TTFT change" << std::endl;
+    std::cout << "                         and validate the streamed output" << std::endl;
+    std::cout << "  --structured-schema FILE  JSON schema to request (default: summary, key_points, confidence)" << std::endl;
+    std::cout << "  --structured-tokens N  Output token limit per request (default 256)" << std::endl;
+    std::cout << "  --vision               After the models run, send images through the images field, timing the" << std::endl;
+    std::cout << "                         vision encoder apart from text decode, and sweep the image resolution" << std::endl;
+    std::cout << "  --vision-dir DIR       PNG/JPEG/PPM images to send (PPM images are also resized for the sweep;" << std::endl;
+    std::cout << "                         without them the sweep uses a generated test pattern)" << std::endl;
+    std::cout << "  --vision-sizes LIST    Longest image side in pixels for the sweep (default 224,448,672,896)" << std::endl;
+    std::cout << "  --vision-tokens N      Output token limit per request (default 64)" << std::endl;
+    std::cout << "  --vision-threads N     Image preprocessing threads (default: all allowed CPUs)" << std::endl;
+    std::cout << "  --vision-cache DIR     Base64 payload cache (default ~/.cache/edge_ai_benchmark/images)" << std::endl;
+    std::cout << "  --no-vision-cache      Prepare every payload from scratch" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Memory Experiment Mode:" << std::endl;
+    std::cout << "  --experiment, -x       Run every combination of the settings below and compare" << std::endl;
+    std::cout << "  --exp-swappiness LIST  Swappiness values to try (e.g. 10,60,100)" << std::endl;
+    std::cout << "  --exp-swap LIST        Extra swap file sizes in MB to try (e.g. 0,2048)" << std::endl;
+    std::cout << "  --exp-mmap LIST        mmap modes to try (default: off,on)" << std::endl;
+    std::cout << "  --exp-thp LIST         Transparent hugepage modes to try (e.g. always,madvise,never)" << std::endl;
+    std::cout << "  --sysfs-root DIR       Resolve /proc and /sys under DIR (fixture tree for testing;" << std::endl;
+    std::cout << "                         also used by --thermal and --energy powercap)" << std::endl;
+    std::cout << "  --dry-run              Print system changes instead of applying them" << std::endl;
+    std::cout << "  Original settings are restored afterwards, including on Ctrl-C" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Minimum RAM Finder:" << std::endl;
+    std::cout << "  --min-ram              Binary-search the smallest memory budget meeting a throughput floor" << std::endl;
+    std::cout << "  --ram-method METHOD    cgroup (memory.max on the server, default) or balloon (mlocked allocation)" << std::endl;
+    std::cout << "  --ram-floor TPS        Throughput floor in tokens/sec (default: 80% of the unlimited rate)" << std::endl;
+    std::cout << "  --ram-range MIN,MAX    Budget range in MB (default: 256 to total RAM)" << std::endl;
+    std::cout << "  --ram-resolution MB    Stop when the search bracket is narrower than MB (default 128)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Embedding Benchmark:" << std::endl;
+    std::cout << "  --embed FILE           Embed every line of FILE with /api/embed and report documents/s, tokens/s," << std::endl;
+    std::cout << "                         latency percentiles and server memory (default model: nomic-embed-text)" << std::endl;
+    std::cout << "  --embed-batch LIST     Documents per request to try (default 16)" << std::endl;
+    std::cout << "  --embed-concurrency LIST  Concurrent requests to try (default 1)" << std::endl;
+    std::cout << "  --embed-docs N         Use only the first N documents of the corpus" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Interference Matrix:" << std::endl;
+    std::cout << "  --interference         Measure every model alone, then under load from every other model," << std::endl;
+    std::cout << "                         and report decode and TTFT slowdowns with memory and swap per pair" << std::endl;
+    std::cout << "  --interference-tokens N  Output tokens per request (default 128)" << std::endl;
+    std::cout << "  --interference-runs N  Requests per cell, the median is kept (default 3)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Server Batching:" << std::endl;
+    std::cout << "  --batching             Send K equal-length requests to one model at once and report per-request" << std::endl;
+    std::cout << "                         and aggregate tokens/s, speedup over K=1 and memory growth" << std::endl;
+    std::cout << "  --batching-k LIST      Simultaneous requests to try (default 1,2,4,8)" << std::endl;
+    std::cout << "  --batching-tokens N    Output tokens per request (default 128)" << std::endl;
+    std::cout << std::endl;
     std::cout << "Memory Optimization:" << std::endl;
     std::cout << "  For models exceeding 4GB RAM, use --swap 4096 --swappiness 10 --mmap" << std::endl;
     std::cout << "  This creates a 4GB swap file with optimal swappiness and enables memory mapping" << std::endl;
@@ -39,6 +196,86 @@ int main(int argc, char* argv[]) {
     unsigned long swap_size = 0;      // Swap size in MB (0 = don't configure)
     int swappiness = 10;              // Default swappiness value
     std::vector<std::string> specific_models;
+    bool experiment = false;          // Memory configuration experiment mode
+    std::vector<int> exp_swappiness;
+    std::vector<unsigned long> exp_swap;
+    std::vector<bool> exp_mmap;
+    std::vector<std::string> exp_thp;
+    std::string sysfs_root = "/";
+    bool dry_run = false;
+    bool track_thermal = false;       // Thermal/cpufreq sampling
+    int thermal_interval = 1000;
+    std::string energy_source;        // Empty disables energy accounting
+    bool storage_bench = false;       // Storage read-throughput probe
+    bool bandwidth = false;           // STREAM bandwidth probe and roofline report
+    size_t bw_size_mb = 128;
+    bool quant_kernels = false;       // Quantized kernel microbenchmark
+    bool tokenizer_bench = false;     // Tokenizer throughput benchmark
+    size_t tokenizer_mb = 8;
+    bool prefill = false;             // Prompt-length sweep
+    int sweep_min = 16;
+    int sweep_max = 0;
+    double sweep_factor = 2.0;
+    bool decode = false;              // Output-length sweep
+    int decode_min = 16;
+    int decode_max = 2048;
+    bool chat = false;                // Multi-turn chat benchmark
+    std::string chat_script;
+    int chat_reply = 64;
+    bool prefix_cache = false;        // Shared-prefix cache benchmark
+    std::string prefix_file;
+    bool structured = false;          // Structured-output benchmark
+    json structured_schema = StructuredOutputBench::default_schema();
+    int structured_tokens = 256;
+    bool vision = false;              // Vision-language workload
+    std::string vision_dir;
+    std::vector<int> vision_sizes = VisionBench::default_sizes();
+    int vision_tokens = 64;
+    int vision_threads = 0;
+    std::string vision_cache;
+    OptionGrid option_grid;           // Options grid sweep (empty disables it)
+    int grid_repeat = 1;
+    std::string grid_csv;
+    int fixed_length = 0;             // Fixed-length generation (0 disables it)
+    int fixed_seed = 42;
+    bool tune = false;                // Autotune mode
+    std::string tune_objective = "decode";
+    std::vector<int> tune_threads;
+    std::vector<int> tune_batch;
+    std::vector<int> tune_ctx;
+    std::string profile_file;         // Empty for this device's default profile
+    bool use_profile = true;
+    std::vector<std::pair<int, int>> quant_shapes = QuantKernelBench::default_shapes();
+    int bw_threads = 0;
+    std::string storage_dir;
+    size_t storage_block_kb = 1024;
+    unsigned long long storage_size_mb = 512;
+    bool discard_throttled = false;
+    std::string backend_name = "ollama"; // Inference backend
+    std::string models_dir;
+    int gguf_threads = 0;
+    int gguf_ctx = 2048;
+    int gguf_max_tokens = 256;
+    bool predict_only = false;        // Print predicted memory and exit
+    unsigned long device_ram_mb = 0;
+    int num_ctx = 0;                  // 0 leaves the Ollama default
+    bool admission = true;            // Memory admission for parallel runs
+    bool min_ram = false;             // Minimum RAM finder mode
+    std::string ram_method = "cgroup";
+    double ram_floor = 0.0;
+    unsigned long ram_min = 256;
+    unsigned long ram_max = 0;
+    unsigned long ram_resolution = 128;
+    std::string embed_corpus;         // Embedding benchmark corpus (empty disables it)
+    std::vector<int> embed_batch;
+    std::vector<int> embed_concurrency;
+    size_t embed_docs = 0;
+    bool interference = false;        // Concurrent-model interference matrix
+    int interference_tokens = 128;
+    int interference_runs = 3;
+    bool batching = false;            // Server-side batching efficiency test
+    std::vector<int> batching_levels;
+    int batching_tokens = 128;
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -73,27 +310,503 @@ int main(int argc, char* argv[]) {
                 if (swappiness < 0) swappiness = 0;
                 if (swappiness > 100) swappiness = 100;
             }
+        } else if (arg == "--experiment" || arg == "-x") {
+            experiment = true;
+        } else if (arg == "--exp-swappiness") {
+            if (i + 1 < argc) {
+                for (const auto& item : split_list(argv[++i])) {
+                    exp_swappiness.push_back(std::max(0, std::min(100, std::stoi(item))));
+                }
+            }
+        } else if (arg == "--exp-swap") {
+            if (i + 1 < argc) {
+                for (const auto& item : split_list(argv[++i])) {
+                    exp_swap.push_back(std::stoul(item));
+                }
+            }
+        } else if (arg == "--exp-mmap") {
+            if (i + 1 < argc) {
+                for (const auto& item : split_list(argv[++i])) {
+                    exp_mmap.push_back(item == "on" || item == "1" || item == "true");
+                }
+            }
+        } else if (arg == "--exp-thp") {
+            if (i + 1 < argc) {
+                exp_thp = split_list(argv[++i]);
+            }
+        } else if (arg == "--sysfs-root") {
+            if (i + 1 < argc) {
+                sysfs_root = argv[++i];
+            }
+        } else if (arg == "--dry-run") {
+            dry_run = true;
+        } else if (arg == "--thermal") {
+            track_thermal = true;
+        } else if (arg == "--thermal-interval") {
+            if (i + 1 < argc) {
+                thermal_interval = std::max(10, std::stoi(argv[++i]));
+            }
+        } else if (arg == "--discard-throttled") {
+            discard_throttled = true;
+        } else if (arg == "--bandwidth") {
+            bandwidth = true;
+        } else if (arg == "--bw-size") {
+            if (i + 1 < argc) {
+                bw_size_mb = std::stoul(argv[++i]);
+            }
+        } else if (arg == "--bw-threads") {
+            if (i + 1 < argc) {
+                bw_threads = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--quant-bench") {
+            quant_kernels = true;
+        } else if (arg == "--quant-shapes") {
+            if (i + 1 < argc && !QuantKernelBench::parse_shapes(argv[++i], quant_shapes)) {
+                std::cerr << "Error: Invalid --quant-shapes (use ROWSxCOLS, cols a multiple of 256)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--tokenizer-bench") {
+            tokenizer_bench = true;
+        } else if (arg == "--tokenizer-mb") {
+            if (i + 1 < argc) {
+                tokenizer_mb = std::stoul(argv[++i]);
+            }
+        } else if (arg == "--prefill-sweep") {
+            prefill = true;
+        } else if (arg == "--sweep-min") {
+            if (i + 1 < argc) {
+                sweep_min = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--sweep-max") {
+            if (i + 1 < argc) {
+                sweep_max = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--sweep-factor") {
+            if (i + 1 < argc) {
+                sweep_factor = std::stod(argv[++i]);
+            }
+        } else if (arg == "--decode-sweep") {
+            decode = true;
+        } else if (arg == "--decode-min") {
+            if (i + 1 < argc) {
+                decode_min = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--decode-max") {
+            if (i + 1 < argc) {
+                decode_max = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--chat-bench") {
+            chat = true;
+        } else if (arg == "--chat-script") {
+            if (i + 1 < argc) {
+                chat_script = argv[++i];
+            }
+        } else if (arg == "--chat-reply") {
+            if (i + 1 < argc) {
+                chat_reply = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--prefix-cache") {
+            prefix_cache = true;
+        } else if (arg == "--prefix-file") {
+            if (i + 1 < argc) {
+                prefix_file = argv[++i];
+            }
+        } else if (arg == "--structured") {
+            structured = true;
+        } else if (arg == "--structured-schema") {
+            if (i + 1 < argc && !StructuredOutputBench::load_schema(argv[++i], structured_schema)) {
+                return 1;
+            }
+        } else if (arg == "--vision") {
+            vision = true;
+        } else if (arg == "--vision-dir") {
+            if (i + 1 < argc) {
+                vision_dir = argv[++i];
+            }
+        } else if (arg == "--vision-sizes") {
+            if (i + 1 < argc) {
+                vision_sizes.clear();
+                for (const auto& item : split_list(argv[++i])) {
+                    vision_sizes.push_back(std::stoi(item));
+                }
+            }
+        } else if (arg == "--vision-tokens") {
+            if (i + 1 < argc) {
+                vision_tokens = std::max(1, std::stoi(argv[++i]));
+            }
+        } else if (arg == "--vision-threads") {
+            if (i + 1 < argc) {
+                vision_threads = std::max(0, std::stoi(argv[++i]));
+            }
+        } else if (arg == "--vision-cache") {
+            if (i + 1 < argc) {
+                vision_cache = argv[++i];
+            }
+        } else if (arg == "--no-vision-cache") {
+            vision_cache = "-";
+        } else if (arg == "--structured-tokens") {
+            if (i + 1 < argc) {
+                structured_tokens = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--grid") {
+            if (i + 1 < argc && !OptionSweep::parse(argv[++i], option_grid)) {
+                std::cerr << "Error: Invalid --grid (use name=v1,v2;name=v1,...)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--grid-file") {
+            if (i + 1 < argc && !OptionSweep::load(argv[++i], option_grid)) {
+                return 1;
+            }
+        } else if (arg == "--grid-repeat") {
+            if (i + 1 < argc) {
+                grid_repeat = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--grid-csv") {
+            if (i + 1 < argc) {
+                grid_csv = argv[++i];
+            }
+        } else if (arg == "--fixed-length") {
+            if (i + 1 < argc) {
+                fixed_length = std::max(1, std::stoi(argv[++i]));
+            }
+        } else if (arg == "--seed") {
+            if (i + 1 < argc) {
+                fixed_seed = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--autotune") {
+            tune = true;
+        } else if (arg == "--tune-objective") {
+            if (i + 1 < argc) {
+                tune_objective = argv[++i];
+                if (tune_objective != "decode" && tune_objective != "ttft") {
+                    std::cerr << "Error: --tune-objective must be decode or ttft" << std::endl;
+                    return 1;
+                }
+            }
+        } else if (arg == "--tune-threads" || arg == "--tune-batch" || arg == "--tune-ctx") {
+            std::vector<int>& values = arg == "--tune-threads" ? tune_threads
+                                     : arg == "--tune-batch" ? tune_batch : tune_ctx;
+            if (i + 1 < argc && !Autotuner::parse_list(argv[++i], values)) {
+                std::cerr << "Error: Invalid " << arg << " (use a comma-separated list, e.g. 2,4)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--profile") {
+            if (i + 1 < argc) {
+                profile_file = argv[++i];
+            }
+        } else if (arg == "--no-profile") {
+            use_profile = false;
+        } else if (arg == "--storage-bench") {
+            storage_bench = true;
+        } else if (arg == "--storage-dir") {
+            if (i + 1 < argc) {
+                storage_dir = argv[++i];
+            }
+        } else if (arg == "--storage-block") {
+            if (i + 1 < argc) {
+                storage_block_kb = std::stoul(argv[++i]);
+            }
+        } else if (arg == "--storage-size") {
+            if (i + 1 < argc) {
+                storage_size_mb = std::stoull(argv[++i]);
+            }
+        } else if (arg == "--energy") {
+            if (i + 1 < argc) {
+                energy_source = argv[++i];
+            }
+        } else if (arg == "--backend") {
+            if (i + 1 < argc) {
+                backend_name = argv[++i];
+            }
+        } else if (arg == "--models-dir") {
+            if (i + 1 < argc) {
+                models_dir = argv[++i];
+            }
+        } else if (arg == "--gguf-threads") {
+            if (i + 1 < argc) {
+                gguf_threads = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--gguf-ctx") {
+            if (i + 1 < argc) {
+                gguf_ctx = std::max(16, std::stoi(argv[++i]));
+            }
+        } else if (arg == "--gguf-max-tokens") {
+            if (i + 1 < argc) {
+                gguf_max_tokens = std::max(1, std::stoi(argv[++i]));
+            }
+        } else if (arg == "--predict-memory") {
+            predict_only = true;
+        } else if (arg == "--device-ram") {
+            if (i + 1 < argc) {
+                device_ram_mb = std::stoul(argv[++i]);
+            }
+        } else if (arg == "--num-ctx") {
+            if (i + 1 < argc) {
+                num_ctx = std::max(0, std::stoi(argv[++i]));
+            }
+        } else if (arg == "--no-admission") {
+            admission = false;
+        } else if (arg == "--min-ram") {
+            min_ram = true;
+        } else if (arg == "--ram-method") {
+            if (i + 1 < argc) {
+                ram_method = argv[++i];
+            }
+        } else if (arg == "--ram-floor") {
+            if (i + 1 < argc) {
+                ram_floor = std::stod(argv[++i]);
+            }
+        } else if (arg == "--ram-range") {
+            if (i + 1 < argc) {
+                auto bounds = split_list(argv[++i]);
+                if (bounds.size() == 2) {
+                    ram_min = std::stoul(bounds[0]);
+                    ram_max = std::stoul(bounds[1]);
+                }
+            }
+        } else if (arg == "--ram-resolution") {
+            if (i + 1 < argc) {
+                ram_resolution = std::stoul(argv[++i]);
+            }
+        } else if (arg == "--embed") {
+            if (i + 1 < argc) {
+                embed_corpus = argv[++i];
+            }
+        } else if (arg == "--embed-batch") {
+            if (i + 1 < argc) {
+                for (const auto& item : split_list(argv[++i])) {
+                    embed_batch.push_back(std::stoi(item));
+                }
+            }
+        } else if (arg == "--embed-concurrency") {
+            if (i + 1 < argc) {
+                for (const auto& item : split_list(argv[++i])) {
+                    embed_concurrency.push_back(std::stoi(item));
+                }
+            }
+        } else if (arg == "--embed-docs") {
+            if (i + 1 < argc) {
+                embed_docs = std::stoul(argv[++i]);
+            }
+        } else if (arg == "--interference") {
+            interference = true;
+        } else if (arg == "--interference-tokens") {
+            if (i + 1 < argc) {
+                interference_tokens = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--interference-runs") {
+            if (i + 1 < argc) {
+                interference_runs = std::stoi(argv[++i]);
+            }
+        } else if (arg == "--batching") {
+            batching = true;
+        } else if (arg == "--batching-k") {
+            if (i + 1 < argc) {
+                for (const auto& item : split_list(argv[++i])) {
+                    batching_levels.push_back(std::stoi(item));
+                }
+            }
+        } else if (arg == "--batching-tokens") {
+            if (i + 1 < argc) {
+                batching_tokens = std::stoi(argv[++i]);
+            }
         } else if (arg == "--help" || arg == "-h") {
             display_help(argv[0]);
             return 0;
         }
     }
     
+    if (specific_models.empty()) {
+        // Use default models
+        if (embed_corpus.empty()) {
+            specific_models = {"mistral:7b", "tinyllama:latest", "phi:latest"};
+        } else {
+            specific_models = {"nomic-embed-text:latest"};
+        }
+    }
+    
     try {
+        if (experiment) {
+            MemoryExperiment memory_experiment(prompt_file, output_file, sysfs_root, dry_run);
+            for (const auto& model : specific_models) {
+                memory_experiment.add_model(model);
+            }
+            memory_experiment.set_swappiness_values(exp_swappiness);
+            memory_experiment.set_swap_sizes(exp_swap);
+            memory_experiment.set_mmap_modes(exp_mmap);
+            memory_experiment.set_thp_modes(exp_thp);
+            memory_experiment.run();
+            return 0;
+        }
+        
+        if (!embed_corpus.empty()) {
+            EmbedBenchmark embed_benchmark(embed_corpus, output_file, use_mmap);
+            for (const auto& model : specific_models) {
+                embed_benchmark.add_model(model);
+            }
+            embed_benchmark.set_batch_sizes(embed_batch);
+            embed_benchmark.set_concurrency(embed_concurrency);
+            embed_benchmark.set_max_documents(embed_docs);
+            embed_benchmark.run();
+            return 0;
+        }
+        
+        if (interference) {
+            InterferenceMatrix interference_matrix(prompt_file, output_file, use_mmap);
+            for (const auto& model : specific_models) {
+                interference_matrix.add_model(model);
+            }
+            interference_matrix.set_num_predict(interference_tokens);
+            interference_matrix.set_repeats(interference_runs);
+            interference_matrix.run();
+            return 0;
+        }
+        
+        if (batching) {
+            ServerBatchingBench batching_bench(prompt_file, output_file, use_mmap);
+            for (const auto& model : specific_models) {
+                batching_bench.add_model(model);
+            }
+            if (!batching_levels.empty()) {
+                batching_bench.set_levels(batching_levels);
+            }
+            batching_bench.set_num_predict(batching_tokens);
+            batching_bench.run();
+            return 0;
+        }
+        
+        if (min_ram) {
+            std::unique_ptr<MemoryLimiter> limiter;
+            if (ram_method == "balloon") {
+                limiter = std::make_unique<BalloonLimiter>();
+            } else {
+                std::string cgroup_root = (sysfs_root == "/" ? "" : sysfs_root) + "/sys/fs/cgroup";
+                limiter = std::make_unique<CgroupLimiter>(cgroup_root);
+            }
+            
+            MinimumRamFinder finder(prompt_file, output_file, std::move(limiter), use_mmap);
+            for (const auto& model : specific_models) {
+                finder.add_model(model);
+            }
+            finder.set_floor(ram_floor);
+            finder.set_range(ram_min, ram_max);
+            finder.set_resolution(ram_resolution);
+            finder.run();
+            return 0;
+        }
+        
         // Create benchmark instance with memory optimization
         LLMBenchmark benchmark(prompt_file, output_file, verbose, parallel, track_memory, 
                               use_mmap, swap_size, swappiness);
         
-        // Add specified models or default models
-        if (specific_models.empty()) {
-            // Use default models
-            benchmark.add_model("mistral:7b");
-            benchmark.add_model("tinyllama:latest");
-            benchmark.add_model("phi:latest");
-        } else {
-            for (const auto& model : specific_models) {
-                benchmark.add_model(model);
+        if (!models_dir.empty()) {
+            benchmark.set_models_dir(models_dir);
+        }
+        
+        if (backend_name == "gguf") {
+            benchmark.set_backend(std::make_unique<GgufBackend>(models_dir, gguf_threads, gguf_ctx, gguf_max_tokens));
+        } else if (backend_name != "ollama") {
+            std::cerr << "Error: unknown backend '" << backend_name << "' (expected ollama or gguf)" << std::endl;
+            return 1;
+        } else if (num_ctx > 0) {
+            auto api = std::make_unique<OllamaAPI>("http://localhost:11434", use_mmap);
+            api->set_num_ctx(num_ctx);
+            benchmark.set_backend(std::move(api));
+        }
+        benchmark.set_admission(admission);
+        benchmark.set_profile(profile_file, use_profile);
+        
+        if (fixed_length > 0) {
+            benchmark.enable_fixed_length(fixed_length, fixed_seed);
+        }
+        
+        if (track_thermal || discard_throttled) {
+            benchmark.enable_thermal_tracking(sysfs_root, thermal_interval, discard_throttled);
+        }
+        
+        if (bandwidth) {
+            benchmark.enable_bandwidth_probe(bw_size_mb, bw_threads);
+        }
+        
+        if (quant_kernels) {
+            benchmark.enable_quant_bench(quant_shapes);
+        }
+        
+        if (tokenizer_bench) {
+            benchmark.enable_tokenizer_bench(tokenizer_mb);
+        }
+        
+        if (prefill) {
+            benchmark.enable_prefill_sweep(sweep_min, sweep_max, sweep_factor);
+        }
+        
+        if (decode) {
+            benchmark.enable_decode_sweep(decode_min, decode_max);
+        }
+        
+        if (chat) {
+            std::vector<ChatScript> scripts = ChatBenchmark::default_scripts();
+            if (!chat_script.empty() && !ChatBenchmark::load_scripts(chat_script, scripts)) {
+                return 1;
             }
+            benchmark.enable_chat_bench(scripts, chat_reply);
+        }
+        
+        if (prefix_cache) {
+            std::string prefix;
+            if (!prefix_file.empty()) {
+                std::ifstream file(prefix_file);
+                if (!file.is_open()) {
+                    std::cerr << "Error: Could not open prefix file " << prefix_file << std::endl;
+                    return 1;
+                }
+                std::stringstream buffer;
+                buffer << file.rdbuf();
+                prefix = buffer.str();
+            }
+            benchmark.enable_prefix_cache_bench(prefix);
+        }
+        
+        if (structured) {
+            benchmark.enable_structured_bench(structured_schema, structured_tokens);
+        }
+        
+        if (vision) {
+            benchmark.enable_vision_bench(vision_dir, vision_sizes, vision_tokens, vision_threads, vision_cache);
+        }
+        
+        if (!option_grid.empty()) {
+            benchmark.enable_option_sweep(option_grid, grid_repeat, grid_csv);
+        }
+        
+        if (storage_bench) {
+            benchmark.enable_storage_probe(storage_dir, storage_block_kb, storage_size_mb);
+        }
+        
+        if (!energy_source.empty()) {
+            auto source = create_power_source(energy_source, sysfs_root);
+            if (!source) {
+                std::cerr << "Error: unknown energy source '" << energy_source 
+                          << "' (expected powercap, powercap:DIR or csv:FILE)" << std::endl;
+                return 1;
+            }
+            benchmark.enable_energy_tracking(std::move(source));
+        }
+        
+        // Add specified models or default models
+        for (const auto& model : specific_models) {
+            benchmark.add_model(model);
+        }
+        
+        if (predict_only) {
+            benchmark.predict_memory(device_ram_mb);
+            return 0;
+        }
+        
+        if (tune) {
+            Autotuner tuner(tune_objective, tune_threads, tune_batch, tune_ctx);
+            benchmark.autotune(tuner);
+            return 0;
         }
         
         // Run the benchmark
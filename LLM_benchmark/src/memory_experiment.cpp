@@ -0,0 +1,453 @@
+#include "memory_experiment.h"
+#include "llm_benchmark.h"
+#include "system_utils.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/swap.h>
+#include <unistd.h>
+using json = nlohmann::json;
+
+namespace {
+
+const char* const SWAPPINESS_PATH = "/proc/sys/vm/swappiness";
+const char* const THP_PATH = "/sys/kernel/mm/transparent_hugepage/enabled";
+
+// Restore state mirrored into fixed buffers so the signal handler can
+// write it back using only async-signal-safe calls
+struct PendingRestore {
+    char path[512];
+    char value[128];
+};
+
+const int MAX_PENDING = 16;
+PendingRestore g_pending[MAX_PENDING];
+volatile sig_atomic_t g_pending_count = 0;
+char g_swap_file[512];
+volatile sig_atomic_t g_swap_active = 0;
+volatile sig_atomic_t g_guard_active = 0;
+
+struct sigaction g_previous_actions[3];
+const int HANDLED_SIGNALS[3] = {SIGINT, SIGTERM, SIGHUP};
+
+void restore_pending_state() {
+    for (int i = 0; i < g_pending_count; ++i) {
+        int fd = open(g_pending[i].path, O_WRONLY | O_TRUNC);
+        if (fd >= 0) {
+            ssize_t ignored = write(fd, g_pending[i].value, strlen(g_pending[i].value));
+            (void)ignored;
+            close(fd);
+        }
+    }
+    g_pending_count = 0;
+
+    if (g_swap_active) {
+        swapoff(g_swap_file);
+        unlink(g_swap_file);
+        g_swap_active = 0;
+    }
+}
+
+void restore_on_signal(int sig) {
+    restore_pending_state();
+
+    const char msg[] = "\nInterrupted: original memory settings restored\n";
+    ssize_t ignored = write(STDERR_FILENO, msg, sizeof(msg) - 1);
+    (void)ignored;
+
+    // Re-raise with the default action so the exit status reflects the signal
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+std::string parse_bracketed_mode(const std::string& options) {
+    size_t open_pos = options.find('[');
+    size_t close_pos = options.find(']', open_pos);
+    if (open_pos == std::string::npos || close_pos == std::string::npos) {
+        return options;
+    }
+    return options.substr(open_pos + 1, close_pos - open_pos - 1);
+}
+
+} // namespace
+
+std::string MemoryConfig::label() const {
+    std::stringstream ss;
+    ss << "swappiness=" << (swappiness < 0 ? "default" : std::to_string(swappiness))
+       << " swap=" << swap_mb << "MB"
+       << " mmap=" << (use_mmap ? "on" : "off")
+       << " thp=" << (thp_mode.empty() ? "default" : thp_mode);
+    return ss.str();
+}
+
+SystemStateGuard::SystemStateGuard(const std::string& root_dir, bool dry_run_only, const std::string& swap_path)
+    : root(root_dir), dry_run(dry_run_only), swap_file(swap_path), swap_active(false) {
+    if (g_guard_active) {
+        throw std::runtime_error("Only one SystemStateGuard may be active at a time");
+    }
+    g_guard_active = 1;
+    g_pending_count = 0;
+    g_swap_active = 0;
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = restore_on_signal;
+    sigemptyset(&action.sa_mask);
+    for (int i = 0; i < 3; ++i) {
+        sigaction(HANDLED_SIGNALS[i], &action, &g_previous_actions[i]);
+    }
+}
+
+SystemStateGuard::~SystemStateGuard() {
+    restore();
+
+    for (int i = 0; i < 3; ++i) {
+        sigaction(HANDLED_SIGNALS[i], &g_previous_actions[i], nullptr);
+    }
+    g_guard_active = 0;
+}
+
+std::string SystemStateGuard::resolve(const std::string& path) const {
+    if (root.empty() || root == "/") {
+        return path;
+    }
+    std::string prefix = root;
+    if (prefix.back() == '/') {
+        prefix.pop_back();
+    }
+    return prefix + path;
+}
+
+bool SystemStateGuard::can_touch_swap() const {
+    return !dry_run && (root.empty() || root == "/");
+}
+
+bool SystemStateGuard::set_value(const std::string& path, const std::string& value) {
+    std::string full_path = resolve(path);
+
+    bool recorded = false;
+    for (const auto& original : originals) {
+        if (original.first == full_path) {
+            recorded = true;
+            break;
+        }
+    }
+
+    if (!recorded) {
+        std::string original_value = read_system_value(full_path);
+        if (original_value.empty()) {
+            std::cerr << "Cannot read " << full_path << "; leaving it unchanged" << std::endl;
+            return false;
+        }
+        // Sysfs selection files list every option; only the bracketed one is written back
+        if (path == THP_PATH) {
+            original_value = parse_bracketed_mode(original_value);
+        }
+        originals.push_back({full_path, original_value});
+
+        if (!dry_run && g_pending_count < MAX_PENDING) {
+            PendingRestore& pending = g_pending[g_pending_count];
+            std::snprintf(pending.path, sizeof(pending.path), "%s", full_path.c_str());
+            std::snprintf(pending.value, sizeof(pending.value), "%s\n", original_value.c_str());
+            g_pending_count = g_pending_count + 1;
+        }
+    }
+
+    if (dry_run) {
+        std::cout << "[dry-run] write '" << value << "' to " << full_path << std::endl;
+        return true;
+    }
+    return write_system_value(full_path, value);
+}
+
+bool SystemStateGuard::apply(const MemoryConfig& config) {
+    bool ok = true;
+    if (config.swappiness >= 0) {
+        ok = set_swappiness(config.swappiness) && ok;
+    }
+    if (!config.thp_mode.empty()) {
+        ok = set_thp_mode(config.thp_mode) && ok;
+    }
+    ok = set_swap_size(config.swap_mb) && ok;
+    return ok;
+}
+
+bool SystemStateGuard::set_swappiness(int value) {
+    return set_value(SWAPPINESS_PATH, std::to_string(value));
+}
+
+bool SystemStateGuard::set_thp_mode(const std::string& mode) {
+    // Read the option list once; a fixture file only holds the last value written
+    if (thp_options.empty()) {
+        thp_options = read_system_value(resolve(THP_PATH));
+    }
+    if (thp_options.find(mode) == std::string::npos) {
+        std::cerr << "Transparent hugepage mode '" << mode << "' not supported (available: "
+                  << thp_options << ")" << std::endl;
+        return false;
+    }
+    return set_value(THP_PATH, mode);
+}
+
+bool SystemStateGuard::set_swap_size(unsigned long size_mb) {
+    std::string full_path = resolve(swap_file);
+
+    release_swap();
+    if (size_mb == 0) {
+        return true;
+    }
+
+    if (!can_touch_swap()) {
+        std::cout << "[" << (dry_run ? "dry-run" : "fixture") << "] create and enable "
+                  << size_mb << "MB swap file " << full_path << std::endl;
+        return true;
+    }
+
+    if (!create_swap_file(full_path, size_mb)) {
+        return false;
+    }
+
+    // Register before swapon so an interrupt in between still removes the file
+    std::snprintf(g_swap_file, sizeof(g_swap_file), "%s", full_path.c_str());
+    g_swap_active = 1;
+    swap_active = true;
+
+    if (!enable_swap_file(full_path)) {
+        release_swap();
+        return false;
+    }
+    return true;
+}
+
+void SystemStateGuard::release_swap() {
+    if (!swap_active) {
+        return;
+    }
+    std::string full_path = resolve(swap_file);
+    disable_swap_file(full_path);
+    unlink(full_path.c_str());
+    swap_active = false;
+    g_swap_active = 0;
+}
+
+void SystemStateGuard::restore() {
+    // Block the handled signals so the handler and this path don't race
+    sigset_t block, previous;
+    sigemptyset(&block);
+    for (int sig : HANDLED_SIGNALS) {
+        sigaddset(&block, sig);
+    }
+    sigprocmask(SIG_BLOCK, &block, &previous);
+
+    release_swap();
+
+    for (auto it = originals.rbegin(); it != originals.rend(); ++it) {
+        if (dry_run) {
+            std::cout << "[dry-run] restore '" << it->second << "' to " << it->first << std::endl;
+        } else if (!write_system_value(it->first, it->second)) {
+            std::cerr << "Failed to restore " << it->first << " to '" << it->second << "'" << std::endl;
+        }
+    }
+    originals.clear();
+    g_pending_count = 0;
+
+    sigprocmask(SIG_SETMASK, &previous, nullptr);
+}
+
+MemoryExperiment::MemoryExperiment(
+    const std::string& prompt_path,
+    const std::string& output_path,
+    const std::string& root_dir,
+    bool dry_run_only
+) : prompt_file(prompt_path),
+    output_file(output_path),
+    root(root_dir),
+    dry_run(dry_run_only),
+    swappiness_values({-1}),
+    swap_sizes({0}),
+    mmap_modes({false, true}),
+    thp_modes({""}) {}
+
+void MemoryExperiment::add_model(const std::string& model_name) {
+    models.push_back(model_name);
+}
+
+void MemoryExperiment::set_swappiness_values(const std::vector<int>& values) {
+    if (!values.empty()) swappiness_values = values;
+}
+
+void MemoryExperiment::set_swap_sizes(const std::vector<unsigned long>& sizes_mb) {
+    if (!sizes_mb.empty()) swap_sizes = sizes_mb;
+}
+
+void MemoryExperiment::set_mmap_modes(const std::vector<bool>& modes) {
+    if (!modes.empty()) mmap_modes = modes;
+}
+
+void MemoryExperiment::set_thp_modes(const std::vector<std::string>& modes) {
+    if (!modes.empty()) thp_modes = modes;
+}
+
+std::vector<MemoryConfig> MemoryExperiment::build_matrix() const {
+    std::vector<MemoryConfig> matrix;
+    for (int swappiness : swappiness_values) {
+        for (unsigned long swap_mb : swap_sizes) {
+            for (bool use_mmap : mmap_modes) {
+                for (const auto& thp_mode : thp_modes) {
+                    matrix.push_back({swappiness, swap_mb, use_mmap, thp_mode});
+                }
+            }
+        }
+    }
+    return matrix;
+}
+
+void MemoryExperiment::run() {
+    if (models.empty()) {
+        std::cerr << "Error: No models specified for memory experiment" << std::endl;
+        return;
+    }
+
+    std::vector<MemoryConfig> matrix = build_matrix();
+
+    std::cout << "========== MEMORY CONFIGURATION EXPERIMENT ==========" << std::endl;
+    std::cout << "Configurations: " << matrix.size() << std::endl;
+    std::cout << "System root: " << root << (dry_run ? " (dry run)" : "") << std::endl;
+    std::cout << "=====================================================" << std::endl;
+
+    // Results per configuration keyed by model, empty when the config could not be applied
+    std::vector<std::map<std::string, LLMBenchmark::Result>> outcomes(matrix.size());
+    std::vector<bool> applied(matrix.size(), false);
+
+    {
+        SystemStateGuard guard(root, dry_run);
+
+        for (size_t i = 0; i < matrix.size(); ++i) {
+            std::cout << "\n>>> Configuration " << (i + 1) << "/" << matrix.size()
+                      << ": " << matrix[i].label() << std::endl;
+
+            if (!guard.apply(matrix[i])) {
+                std::cerr << "Skipping configuration: settings could not be applied" << std::endl;
+                continue;
+            }
+            applied[i] = true;
+
+            // Evict the models so every configuration pays its own load
+            // under its own swappiness, THP and mmap settings
+            for (const auto& model : models) {
+                api.unload_model(model);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+            LLMBenchmark benchmark(prompt_file, "", false, false, true, matrix[i].use_mmap, 0, 0);
+            for (const auto& model : models) {
+                benchmark.add_model(model);
+            }
+            benchmark.run();
+
+            for (const auto& result : benchmark.get_results()) {
+                outcomes[i][result.model_name] = result;
+            }
+        }
+
+        // Guard destructor restores the original settings here
+    }
+
+    // Comparison table: one row per model, one column per configuration
+    std::cout << "\n========== MEMORY CONFIGURATION COMPARISON ==========" << std::endl;
+    for (size_t i = 0; i < matrix.size(); ++i) {
+        std::cout << "  C" << (i + 1) << ": " << matrix[i].label()
+                  << (applied[i] ? "" : " (not applied)") << std::endl;
+    }
+
+    std::cout << "\nDecode tokens/sec by configuration:" << std::endl;
+    std::cout << std::left << std::setw(20) << "Model";
+    for (size_t i = 0; i < matrix.size(); ++i) {
+        std::cout << std::setw(10) << ("C" + std::to_string(i + 1));
+    }
+    std::cout << "Best" << std::endl;
+    std::cout << std::string(20 + 10 * matrix.size() + 10, '-') << std::endl;
+
+    json j;
+    std::map<size_t, int> wins;
+
+    for (const auto& model : models) {
+        std::cout << std::left << std::setw(20) << model;
+
+        int best = -1;
+        double best_rate = 0.0;
+        for (size_t i = 0; i < matrix.size(); ++i) {
+            auto it = outcomes[i].find(model);
+            if (it == outcomes[i].end()) {
+                std::cout << std::setw(10) << "-";
+                continue;
+            }
+            double rate = it->second.tokens_per_second;
+            std::stringstream cell;
+            cell << std::fixed << std::setprecision(2) << rate;
+            std::cout << std::setw(10) << cell.str();
+
+            if (rate > best_rate) {
+                best_rate = rate;
+                best = static_cast<int>(i);
+            }
+        }
+
+        if (best >= 0) {
+            std::cout << "C" << (best + 1);
+            wins[best]++;
+            j["winners"][model] = matrix[best].label();
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::endl;
+    }
+
+    if (!wins.empty()) {
+        std::cout << "\nWins per configuration:" << std::endl;
+        for (const auto& [index, count] : wins) {
+            std::cout << "  C" << (index + 1) << " (" << matrix[index].label() << "): "
+                      << count << " model(s)" << std::endl;
+        }
+    }
+
+    if (!output_file.empty()) {
+        std::ofstream out(output_file);
+        if (out.is_open()) {
+            for (size_t i = 0; i < matrix.size(); ++i) {
+                json config;
+                config["label"] = matrix[i].label();
+                config["swappiness"] = matrix[i].swappiness;
+                config["swap_mb"] = matrix[i].swap_mb;
+                config["mmap"] = matrix[i].use_mmap;
+                config["thp_mode"] = matrix[i].thp_mode;
+                config["applied"] = static_cast<bool>(applied[i]);
+
+                for (const auto& [model, result] : outcomes[i]) {
+                    config["results"][model]["tokens_per_second"] = result.tokens_per_second;
+                    config["results"][model]["duration_ms"] = result.duration.count();
+                    config["results"][model]["peak_memory_kb"] = result.peak_memory;
+                    config["results"][model]["load_duration_s"] = result.generation.load_duration;
+                    config["results"][model]["swap_in_pages"] = result.swap.pages_in;
+                    config["results"][model]["swap_out_pages"] = result.swap.pages_out;
+                }
+                j["configurations"].push_back(config);
+            }
+
+            out << std::setw(4) << j << std::endl;
+            std::cout << "\nJSON comparison saved to " << output_file << std::endl;
+        } else {
+            std::cerr << "Error: Could not open output file " << output_file << std::endl;
+        }
+    }
+}
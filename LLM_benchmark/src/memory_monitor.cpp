@@ -6,13 +6,16 @@
 #include <sys/resource.h> // For getrusage and RUSAGE_SELF
 
 MemoryMonitor::MemoryMonitor(const std::string& process, int interval_ms) 
-    : should_run(false), peak_memory(0), process_name(process), sample_interval_ms(interval_ms) {}
+    : should_run(false), peak_memory(0), peak_pss(0), process_name(process), sample_interval_ms(interval_ms),
+      min_swap_free(0) {}
 
 MemoryMonitor::~MemoryMonitor() {
     stop();
 }
 
-unsigned long MemoryMonitor::get_memory_usage() {
+unsigned long MemoryMonitor::get_memory_usage(unsigned long& pss) {
+    pss = 0;
+    
     // Method 1: Use getrusage
     struct rusage usage;
     getrusage(RUSAGE_SELF, &usage);
@@ -59,6 +62,11 @@ unsigned long MemoryMonitor::get_memory_usage() {
                             std::stringstream ss(smaps_line.substr(4));
                             ss >> rss_value;
                             detailed_memory += rss_value;
+                        } else if (smaps_line.substr(0, 4) == "Pss:") {
+                            unsigned long pss_value;
+                            std::stringstream ss(smaps_line.substr(4));
+                            ss >> pss_value;
+                            pss += pss_value;
                         }
                     }
                     smaps_file.close();
@@ -67,16 +75,33 @@ unsigned long MemoryMonitor::get_memory_usage() {
         }
     }
     
+    // Without a separate process the model lives in this one (in-process backend)
+    if (detailed_memory == 0) {
+        std::ifstream rollup_file("/proc/self/smaps_rollup");
+        std::string rollup_line;
+        while (std::getline(rollup_file, rollup_line)) {
+            if (rollup_line.substr(0, 4) == "Pss:") {
+                std::stringstream ss(rollup_line.substr(4));
+                ss >> pss;
+                break;
+            }
+        }
+    }
+    
     // Use the highest value among the methods that returned data
     return std::max({self_memory, proc_memory, detailed_memory});
 }
 
 void MemoryMonitor::monitor_memory() {
     while (should_run) {
-        unsigned long current = get_memory_usage();
+        unsigned long pss = 0;
+        unsigned long current = get_memory_usage(pss);
+        SwapStats swap = get_swap_stats();
         {
             std::lock_guard<std::mutex> lock(mtx);
             peak_memory = std::max(peak_memory, current);
+            peak_pss = std::max(peak_pss, pss);
+            min_swap_free = std::min(min_swap_free, swap.swap_free_kb);
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(sample_interval_ms));
     }
@@ -87,6 +112,10 @@ void MemoryMonitor::start() {
     if (!should_run) {
         should_run = true;
         peak_memory = 0;
+        peak_pss = 0;
+        swap_start = get_swap_stats();
+        swap_end = swap_start;
+        min_swap_free = swap_start.swap_free_kb;
         monitor_thread = std::thread(&MemoryMonitor::monitor_memory, this);
     }
 }
@@ -96,10 +125,28 @@ void MemoryMonitor::stop() {
     
     if (monitor_thread.joinable()) {
         monitor_thread.join();
+        
+        std::lock_guard<std::mutex> lock(mtx);
+        swap_end = get_swap_stats();
+        min_swap_free = std::min(min_swap_free, swap_end.swap_free_kb);
     }
 }
 
 unsigned long MemoryMonitor::get_peak_memory() {
     std::lock_guard<std::mutex> lock(mtx);
     return peak_memory;
+}
+
+unsigned long MemoryMonitor::get_peak_pss() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return peak_pss;
+}
+
+SwapActivity MemoryMonitor::get_swap_activity() {
+    std::lock_guard<std::mutex> lock(mtx);
+    SwapActivity activity = swap_activity_between(swap_start, swap_end);
+    if (swap_start.swap_free_kb > min_swap_free) {
+        activity.peak_swap_growth_kb = swap_start.swap_free_kb - min_swap_free;
+    }
+    return activity;
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "memory_predictor.h"
+#include <algorithm>
+
+bool MemoryPrediction::valid() const {
+    return weights_kb > 0;
+}
+
+unsigned long MemoryPrediction::total_kb() const {
+    return weights_kb + kv_cache_kb + compute_kb;
+}
+
+double MemoryPrediction::error_pct(unsigned long measured_kb) const {
+    if (measured_kb == 0) {
+        return 0.0;
+    }
+    return 100.0 * (static_cast<double>(total_kb()) - measured_kb) / measured_kb;
+}
+
+json MemoryPrediction::to_json() const {
+    return {
+        {"weights_kb", weights_kb},
+        {"kv_cache_kb", kv_cache_kb},
+        {"compute_kb", compute_kb},
+        {"total_kb", total_kb()},
+        {"context_length", context_length}
+    };
+}
+
+MemoryPrediction MemoryPredictor::predict(const ModelFootprint& footprint, const RuntimeConfig& config) {
+    MemoryPrediction prediction;
+    if (!footprint.valid()) {
+        return prediction;
+    }
+
+    // Requests beyond the trained context are capped by the runtime
+    long long n_ctx = config.context_length;
+    if (footprint.context_length > 0) {
+        n_ctx = std::min(n_ctx, footprint.context_length);
+    }
+    const long long n_batch = std::max(1LL, std::min<long long>(config.batch_size, n_ctx));
+    const long long n_embd = footprint.embedding_length;
+    const long long n_head = std::max(1LL, footprint.head_count);
+    const long long head_dim = n_embd / n_head;
+    const long long kv_dim = head_dim * footprint.head_count_kv;
+
+    const double kv_bytes = 2.0 * footprint.block_count * n_ctx * kv_dim * config.kv_element_bytes;
+
+    // F32 activations of one batch: residual, normed input, Q, attention
+    // output, two FFN hidden vectors, and scores over the whole context
+    const double activation_bytes = 4.0 * n_batch * (4 * n_embd + 2 * footprint.feed_forward_length + n_head * n_ctx);
+    const double logits_bytes = 4.0 * footprint.vocab_size;
+
+    prediction.weights_kb = static_cast<unsigned long>(footprint.weight_bytes / 1024);
+    prediction.kv_cache_kb = static_cast<unsigned long>(kv_bytes / 1024);
+    prediction.compute_kb = static_cast<unsigned long>((activation_bytes + logits_bytes) / 1024);
+    prediction.context_length = static_cast<int>(n_ctx);
+    return prediction;
+}
@@ -0,0 +1,362 @@
+#include "min_ram_finder.h"
+#include "memory_monitor.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <map>
+#include <thread>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CgroupLimiter::CgroupLimiter(const std::string& root, const std::string& process)
+    : cgroup_root(root), cgroup_dir(root + "/edge_ai_benchmark"), process_name(process), prepared(false) {}
+
+CgroupLimiter::~CgroupLimiter() {
+    release();
+}
+
+bool CgroupLimiter::prepare() {
+    if (prepared) {
+        return true;
+    }
+
+    std::vector<int> pids = find_process_ids(process_name);
+    if (pids.empty()) {
+        std::cerr << "No '" << process_name << "' process found to place in a cgroup" << std::endl;
+        return false;
+    }
+
+    // The memory controller must be enabled for children of the root group
+    std::string controllers = read_system_value(cgroup_root + "/cgroup.subtree_control");
+    if (controllers.find("memory") == std::string::npos &&
+        !write_system_value(cgroup_root + "/cgroup.subtree_control", "+memory")) {
+        return false;
+    }
+
+    if (mkdir(cgroup_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Cannot create cgroup " << cgroup_dir << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    for (int pid : pids) {
+        // cgroup v2 entries look like "0::/system.slice/ollama.service"
+        std::string membership = read_system_value("/proc/" + std::to_string(pid) + "/cgroup");
+        size_t sep = membership.find("::");
+        std::string origin = cgroup_root + (sep == std::string::npos ? "/" : membership.substr(sep + 2));
+
+        if (!write_system_value(cgroup_dir + "/cgroup.procs", std::to_string(pid))) {
+            release();
+            return false;
+        }
+        moved.push_back({pid, origin});
+    }
+
+    prepared = true;
+    return true;
+}
+
+bool CgroupLimiter::apply(unsigned long limit_mb) {
+    if (!prepare()) {
+        return false;
+    }
+    std::string value = limit_mb == 0 ? "max" : std::to_string(limit_mb * 1024UL * 1024UL);
+    return write_system_value(cgroup_dir + "/memory.max", value);
+}
+
+void CgroupLimiter::release() {
+    if (!prepared) {
+        return;
+    }
+    write_system_value(cgroup_dir + "/memory.max", "max");
+
+    // Processes spawned inside the group (model runners) follow the server back out
+    std::string fallback = moved.empty() ? cgroup_root : moved.front().second;
+    std::stringstream members(read_system_value(cgroup_dir + "/cgroup.procs"));
+    std::string pid;
+    while (members >> pid) {
+        std::string origin = fallback;
+        for (const auto& entry : moved) {
+            if (std::to_string(entry.first) == pid) {
+                origin = entry.second;
+            }
+        }
+        write_system_value(origin + "/cgroup.procs", pid);
+    }
+
+    rmdir(cgroup_dir.c_str());
+    moved.clear();
+    prepared = false;
+}
+
+std::string CgroupLimiter::description() const {
+    return "cgroup v2 memory.max on '" + process_name + "' (" + cgroup_dir + ")";
+}
+
+BalloonLimiter::BalloonLimiter() : balloon(nullptr), balloon_bytes(0), locked(false) {}
+
+BalloonLimiter::~BalloonLimiter() {
+    release();
+}
+
+bool BalloonLimiter::apply(unsigned long limit_mb) {
+    release();
+    if (limit_mb == 0) {
+        return true;
+    }
+
+    unsigned long available_mb = get_system_memory().second;
+    if (available_mb <= limit_mb) {
+        std::cerr << "Only " << available_mb << "MB available, balloon not needed for a "
+                  << limit_mb << "MB budget" << std::endl;
+        return true;
+    }
+
+    balloon_bytes = static_cast<size_t>(available_mb - limit_mb) * 1024 * 1024;
+    balloon = mmap(nullptr, balloon_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (balloon == MAP_FAILED) {
+        std::cerr << "Cannot map " << (balloon_bytes >> 20) << "MB balloon: " << std::strerror(errno) << std::endl;
+        balloon = nullptr;
+        balloon_bytes = 0;
+        return false;
+    }
+
+    locked = mlock(balloon, balloon_bytes) == 0;
+    if (!locked) {
+        std::cerr << "mlock failed (" << std::strerror(errno)
+                  << "); balloon pages may be swapped out" << std::endl;
+    }
+
+    // Touch every page so the memory is actually committed
+    const long page_size = sysconf(_SC_PAGESIZE);
+    volatile char* bytes = static_cast<char*>(balloon);
+    for (size_t offset = 0; offset < balloon_bytes; offset += page_size) {
+        bytes[offset] = 1;
+    }
+    return true;
+}
+
+void BalloonLimiter::release() {
+    if (balloon) {
+        if (locked) {
+            munlock(balloon, balloon_bytes);
+        }
+        munmap(balloon, balloon_bytes);
+    }
+    balloon = nullptr;
+    balloon_bytes = 0;
+    locked = false;
+}
+
+std::string BalloonLimiter::description() const {
+    return "mlocked balloon reducing MemAvailable";
+}
+
+MinimumRamFinder::MinimumRamFinder(
+    const std::string& prompt_path,
+    const std::string& output_path,
+    std::unique_ptr<MemoryLimiter> memory_limiter,
+    bool use_memory_mapping
+) : api(OllamaAPI("http://localhost:11434", use_memory_mapping)),
+    prompt_file(prompt_path),
+    output_file(output_path),
+    limiter(std::move(memory_limiter)),
+    floor_tps(0.0),
+    floor_fraction(0.8),
+    min_mb(256),
+    max_mb(0),
+    resolution_mb(128) {
+    OllamaAPI::initialize();
+}
+
+MinimumRamFinder::~MinimumRamFinder() {
+    OllamaAPI::cleanup();
+}
+
+void MinimumRamFinder::add_model(const std::string& model_name) {
+    models.push_back(model_name);
+}
+
+void MinimumRamFinder::set_floor(double tokens_per_second) {
+    floor_tps = tokens_per_second;
+}
+
+void MinimumRamFinder::set_range(unsigned long lower_mb, unsigned long upper_mb) {
+    if (upper_mb > 0 && lower_mb > upper_mb) {
+        std::cerr << "Warning: RAM range " << lower_mb << "," << upper_mb << " is inverted, searching "
+                  << upper_mb << "MB - " << lower_mb << "MB" << std::endl;
+        std::swap(lower_mb, upper_mb);
+    }
+    min_mb = lower_mb;
+    max_mb = upper_mb;
+}
+
+void MinimumRamFinder::set_resolution(unsigned long step_mb) {
+    resolution_mb = std::max(1UL, step_mb);
+}
+
+RamProbe MinimumRamFinder::probe(const std::string& model, const std::string& prompt, unsigned long limit_mb) {
+    RamProbe result{limit_mb, false, 0.0, 0, SwapActivity()};
+
+    // Evict the model first so it is loaded again under the new budget
+    limiter->apply(0);
+    api.unload_model(model);
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    if (!limiter->apply(limit_mb)) {
+        std::cerr << "Could not apply a " << limit_mb << "MB budget" << std::endl;
+        return result;
+    }
+
+    MemoryMonitor monitor("ollama");
+    monitor.start();
+    GenerationMetrics metrics;
+    std::string response = api.generate(model, prompt, false, false, &metrics);
+    monitor.stop();
+
+    result.ok = metrics.eval_count > 0 && response.rfind("Error:", 0) != 0;
+    result.tokens_per_second = result.ok ? metrics.decode_rate() : 0.0;
+    result.peak_memory = std::max(monitor.get_peak_memory(), get_ollama_memory_usage());
+    result.swap = monitor.get_swap_activity();
+
+    std::cout << "  " << std::left << std::setw(12)
+              << (limit_mb == 0 ? "unlimited" : std::to_string(limit_mb) + " MB")
+              << std::fixed << std::setprecision(2) << result.tokens_per_second << " tokens/sec"
+              << (result.ok ? "" : " (failed)")
+              << " | swap in: " << format_memory(pages_to_kb(result.swap.pages_in)) << std::endl;
+    return result;
+}
+
+void MinimumRamFinder::run() {
+    if (models.empty()) {
+        std::cerr << "Error: No models specified for minimum-RAM search" << std::endl;
+        return;
+    }
+
+    std::ifstream file(prompt_file);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string prompt = buffer.str();
+    if (prompt.empty()) {
+        std::cerr << "Error: Empty prompt or failed to read prompt file" << std::endl;
+        return;
+    }
+
+    unsigned long upper = max_mb > 0 ? max_mb : get_system_memory().first;
+    if (min_mb >= upper) {
+        std::cerr << "Error: RAM search range is empty (lower bound " << min_mb << "MB, upper bound "
+                  << upper << "MB)" << std::endl;
+        return;
+    }
+
+    std::cout << "========== MINIMUM RAM FINDER ==========" << std::endl;
+    std::cout << "Limiter: " << limiter->description() << std::endl;
+    std::cout << "Search range: " << min_mb << "MB - " << upper << "MB (resolution " << resolution_mb << "MB)" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    json j;
+
+    for (const auto& model : models) {
+        std::cout << "\nModel: " << model << std::endl;
+        std::vector<RamProbe> curve;
+
+        RamProbe reference = probe(model, prompt, 0);
+        curve.push_back(reference);
+        if (!reference.ok) {
+            std::cerr << "Model failed without a memory limit, skipping" << std::endl;
+            continue;
+        }
+
+        double floor = floor_tps > 0 ? floor_tps : reference.tokens_per_second * floor_fraction;
+        std::cout << "  Throughput floor: " << std::fixed << std::setprecision(2) << floor << " tokens/sec" << std::endl;
+
+        // Invariant: hi meets the floor, lo does not (or is untested)
+        unsigned long lo = min_mb;
+        unsigned long hi = upper;
+        RamProbe top = probe(model, prompt, hi);
+        curve.push_back(top);
+
+        long cliff_mb = -1;
+        if (top.ok && top.tokens_per_second >= floor) {
+            RamProbe bottom = probe(model, prompt, lo);
+            curve.push_back(bottom);
+
+            if (bottom.ok && bottom.tokens_per_second >= floor) {
+                hi = lo;
+            } else {
+                while (hi - lo > resolution_mb) {
+                    unsigned long mid = lo + (hi - lo) / 2;
+                    RamProbe point = probe(model, prompt, mid);
+                    curve.push_back(point);
+                    if (point.ok && point.tokens_per_second >= floor) {
+                        hi = mid;
+                    } else {
+                        lo = mid;
+                    }
+                }
+            }
+            cliff_mb = static_cast<long>(hi);
+        }
+        limiter->apply(0);
+
+        // Curve sorted by budget, unlimited last
+        std::sort(curve.begin(), curve.end(), [](const RamProbe& a, const RamProbe& b) {
+            if (a.limit_mb == 0 || b.limit_mb == 0) return b.limit_mb == 0 && a.limit_mb != 0;
+            return a.limit_mb < b.limit_mb;
+        });
+
+        std::cout << "\n  Tokens/sec versus available RAM:" << std::endl;
+        const int chart_width = 40;
+        double max_rate = 0.0;
+        for (const auto& point : curve) {
+            max_rate = std::max(max_rate, point.tokens_per_second);
+        }
+        for (const auto& point : curve) {
+            int bar_length = max_rate > 0 ? static_cast<int>(chart_width * point.tokens_per_second / max_rate) : 0;
+            std::cout << "  " << std::left << std::setw(12)
+                      << (point.limit_mb == 0 ? "unlimited" : std::to_string(point.limit_mb) + " MB")
+                      << "[" << std::string(bar_length, '#') << std::string(chart_width - bar_length, ' ') << "] "
+                      << std::fixed << std::setprecision(2) << point.tokens_per_second
+                      << (point.tokens_per_second >= floor ? "" : " (below floor)") << std::endl;
+        }
+
+        if (cliff_mb > 0) {
+            std::cout << "  Cliff point: " << cliff_mb << " MB (smallest budget meeting "
+                      << std::setprecision(2) << floor << " tokens/sec)" << std::endl;
+        } else {
+            std::cout << "  Cliff point: not found (floor missed even at " << upper << " MB)" << std::endl;
+        }
+
+        j["models"][model]["floor_tokens_per_second"] = floor;
+        j["models"][model]["unlimited_tokens_per_second"] = reference.tokens_per_second;
+        j["models"][model]["cliff_mb"] = cliff_mb > 0 ? json(cliff_mb) : json(nullptr);
+        for (const auto& point : curve) {
+            j["models"][model]["curve"].push_back({
+                {"limit_mb", point.limit_mb},
+                {"ok", point.ok},
+                {"tokens_per_second", point.tokens_per_second},
+                {"peak_memory_kb", point.peak_memory},
+                {"swap_in_pages", point.swap.pages_in}
+            });
+        }
+    }
+
+    limiter->release();
+
+    if (!output_file.empty()) {
+        std::ofstream out(output_file);
+        if (out.is_open()) {
+            j["metadata"]["limiter"] = limiter->description();
+            j["metadata"]["range_mb"] = {min_mb, upper};
+            j["metadata"]["resolution_mb"] = resolution_mb;
+            out << std::setw(4) << j << std::endl;
+            std::cout << "\nJSON results saved to " << output_file << std::endl;
+        } else {
+            std::cerr << "Error: Could not open output file " << output_file << std::endl;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include "model_footprint.h"
+#include "gguf_file.h"
+#include "storage_probe.h"
+#include <algorithm>
+#include <sys/stat.h>
+
+bool ModelFootprint::valid() const {
+    return parameter_count > 0;
+}
+
+double ModelFootprint::bits_per_weight() const {
+    return parameter_count > 0 ? 8.0 * weight_bytes / parameter_count : 0.0;
+}
+
+std::string ModelFootprint::dominant_type() const {
+    return tensor_types.empty() ? "" : tensor_types.front().type;
+}
+
+double ModelFootprint::gparams_per_second(double tokens_per_second) const {
+    return tokens_per_second * parameter_count / 1e9;
+}
+
+double ModelFootprint::weight_gb_per_second(double tokens_per_second) const {
+    return tokens_per_second * weight_bytes / 1e9;
+}
+
+json ModelFootprint::to_json() const {
+    json j = {
+        {"path", path},
+        {"architecture", architecture},
+        {"file_type", file_type},
+        {"parameter_count", parameter_count},
+        {"weight_bytes", weight_bytes},
+        {"bits_per_weight", bits_per_weight()},
+        {"context_length", context_length},
+        {"block_count", block_count},
+        {"head_count", head_count},
+        {"head_count_kv", head_count_kv},
+        {"embedding_length", embedding_length},
+        {"feed_forward_length", feed_forward_length},
+        {"vocab_size", vocab_size},
+        {"tensor_types", json::array()}
+    };
+    for (const auto& stats : tensor_types) {
+        j["tensor_types"].push_back({
+            {"type", stats.type},
+            {"tensors", stats.tensors},
+            {"parameters", stats.parameters},
+            {"bytes", stats.bytes}
+        });
+    }
+    return j;
+}
+
+ModelFootprintReader::ModelFootprintReader(const std::string& dir)
+    : models_dir(dir.empty() ? StorageProbe::default_models_dir() : dir) {
+}
+
+ModelFootprint ModelFootprintReader::read(const std::string& model) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = cache.find(model);
+    if (it != cache.end()) {
+        return it->second;
+    }
+
+    ModelFootprint footprint;
+    std::string path = locate(models_dir, model);
+    if (!path.empty()) {
+        read_file(path, footprint);
+    }
+    cache[model] = footprint;
+    return footprint;
+}
+
+const std::string& ModelFootprintReader::get_models_dir() const {
+    return models_dir;
+}
+
+std::string ModelFootprintReader::locate(const std::string& models_dir, const std::string& model) {
+    struct stat info;
+    if (stat(model.c_str(), &info) == 0 && S_ISREG(info.st_mode)) {
+        return model;
+    }
+    unsigned long long size = 0;
+    return StorageProbe::find_model_blob(models_dir, model, size);
+}
+
+bool ModelFootprintReader::read_file(const std::string& path, ModelFootprint& footprint) {
+    GgufFile file;
+    if (!file.open(path, true)) {
+        return false;
+    }
+
+    footprint = ModelFootprint();
+    footprint.path = path;
+    footprint.architecture = file.get_string("general.architecture");
+    footprint.file_type = GgufFile::file_type_name(file.get_int("general.file_type", -1));
+    footprint.context_length = file.get_int(file.arch_key("context_length"));
+    footprint.block_count = file.get_int(file.arch_key("block_count"));
+    footprint.head_count = file.get_int(file.arch_key("attention.head_count"));
+    footprint.head_count_kv = file.get_int(file.arch_key("attention.head_count_kv"), footprint.head_count);
+    footprint.embedding_length = file.get_int(file.arch_key("embedding_length"));
+    footprint.feed_forward_length = file.get_int(file.arch_key("feed_forward_length"));
+    footprint.vocab_size = file.get_int(file.arch_key("vocab_size"));
+    const GgufTensor* embeddings = file.find_tensor("token_embd.weight");
+    if (footprint.vocab_size == 0 && embeddings && embeddings->dims.size() == 2) {
+        footprint.vocab_size = static_cast<long long>(embeddings->dims[1]);
+    }
+
+    std::map<std::string, TensorTypeStats> by_type;
+    for (const auto& tensor : file.get_tensors()) {
+        TensorTypeStats& stats = by_type[GgufFile::type_name(tensor.type)];
+        stats.tensors++;
+        stats.parameters += tensor.elements();
+        stats.bytes += tensor.bytes;
+        footprint.parameter_count += tensor.elements();
+        footprint.weight_bytes += tensor.bytes;
+    }
+    for (auto& [type, stats] : by_type) {
+        stats.type = type;
+        footprint.tensor_types.push_back(stats);
+    }
+    std::sort(footprint.tensor_types.begin(), footprint.tensor_types.end(),
+              [](const TensorTypeStats& a, const TensorTypeStats& b) { return a.bytes > b.bytes; });
+    return true;
+}
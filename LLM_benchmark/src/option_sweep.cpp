@@ -0,0 +1,305 @@
+#include "option_sweep.h"
+#include "memory_monitor.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+
+namespace {
+
+// Options that make Ollama reload the model when they change
+const char* const reload_options[] = {"num_ctx", "num_batch", "num_thread", "num_gpu", "use_mlock", "use_mmap"};
+
+bool causes_reload(const std::string& name) {
+    return std::find(std::begin(reload_options), std::end(reload_options), name) != std::end(reload_options);
+}
+
+json parse_value(const std::string& text) {
+    json value = json::parse(text, nullptr, false);
+    if (!value.is_discarded() && (value.is_number() || value.is_boolean())) {
+        return value;
+    }
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::string csv_field(const std::string& text) {
+    if (text.find_first_of(",\"\n") == std::string::npos) {
+        return text;
+    }
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+std::string value_text(const json& value) {
+    return value.is_string() ? value.get<std::string>() : value.dump();
+}
+
+} // namespace
+
+double OptionSweepRow::prefill_rate() const {
+    return prefill_seconds > 0 ? prompt_tokens / prefill_seconds : 0.0;
+}
+
+double OptionSweepRow::decode_rate() const {
+    return decode_seconds > 0 ? output_tokens / decode_seconds : 0.0;
+}
+
+OptionSweep::OptionSweep(const OptionGrid& option_grid, int repeat_count)
+    : grid(option_grid), repeats(std::max(1, repeat_count)), session(std::random_device{}()) {
+    std::stable_partition(grid.begin(), grid.end(), [](const std::pair<std::string, std::vector<json>>& entry) {
+        return causes_reload(entry.first);
+    });
+}
+
+bool OptionSweep::parse(const std::string& spec, OptionGrid& grid) {
+    grid.clear();
+    std::stringstream entries(spec);
+    std::string entry;
+    while (std::getline(entries, entry, ';')) {
+        if (trim(entry).empty()) {
+            continue;
+        }
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos || trim(entry.substr(0, equals)).empty()) {
+            std::cerr << "Error: grid entry '" << entry << "' is not name=values" << std::endl;
+            return false;
+        }
+
+        std::vector<json> values;
+        std::stringstream list(entry.substr(equals + 1));
+        std::string value;
+        while (std::getline(list, value, ',')) {
+            if (!trim(value).empty()) {
+                values.push_back(parse_value(trim(value)));
+            }
+        }
+        if (values.empty()) {
+            std::cerr << "Error: grid entry '" << entry << "' has no values" << std::endl;
+            return false;
+        }
+        grid.emplace_back(trim(entry.substr(0, equals)), values);
+    }
+    return !grid.empty();
+}
+
+bool OptionSweep::load(const std::string& path, OptionGrid& grid) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open grid file " << path << std::endl;
+        return false;
+    }
+
+    json j = json::parse(file, nullptr, false);
+    if (j.is_discarded() || !j.is_object() || j.empty()) {
+        std::cerr << "Error: grid file " << path << " is not a JSON object of options" << std::endl;
+        return false;
+    }
+
+    grid.clear();
+    for (const auto& [name, values] : j.items()) {
+        if (values.is_array()) {
+            grid.emplace_back(name, values.get<std::vector<json>>());
+        } else {
+            grid.emplace_back(name, std::vector<json>{values});
+        }
+    }
+    return true;
+}
+
+std::vector<json> OptionSweep::combinations() const {
+    std::vector<json> result = {json::object()};
+    // The first option ends up in the outer loop, so it changes least often
+    for (auto entry = grid.rbegin(); entry != grid.rend(); ++entry) {
+        std::vector<json> expanded;
+        for (const auto& value : entry->second) {
+            for (const auto& partial : result) {
+                json combination = partial;
+                combination[entry->first] = value;
+                expanded.push_back(combination);
+            }
+        }
+        result = expanded;
+    }
+    return result;
+}
+
+std::vector<OptionSweepRow> OptionSweep::run(InferenceBackend& backend, const std::string& model, const std::string& prompt) {
+    std::vector<OptionSweepRow> rows;
+    const std::string process = backend.name() == "ollama" ? "ollama" : "";
+    auto all = combinations();
+
+    for (size_t i = 0; i < all.size(); i++) {
+        for (int repeat = 1; repeat <= repeats; repeat++) {
+            std::cout << "  [" << i + 1 << "/" << all.size() << "] " << all[i].dump() << std::endl;
+
+            // A unique tag keeps runs that share a loaded model off Ollama's prompt cache
+            std::string tagged = "[" + std::to_string(session++) + "] " + prompt;
+
+            MemoryMonitor memory_monitor(process, 100);
+            memory_monitor.start();
+            GenerationMetrics metrics;
+            std::string response = backend.generate(model, tagged, true, false, &metrics, &all[i]);
+            memory_monitor.stop();
+
+            OptionSweepRow row;
+            row.model_name = model;
+            row.options = all[i];
+            row.repeat = repeat;
+            row.ok = response.rfind("Error:", 0) != 0 && metrics.eval_count > 0;
+            row.error = row.ok ? "" : (response.rfind("Error:", 0) == 0 ? response : "Error: no tokens generated");
+            row.wall_seconds = metrics.wall_time;
+            row.load_seconds = metrics.load_duration;
+            row.ttft_seconds = metrics.token_times.empty() ? 0.0 : metrics.token_times.front();
+            row.prompt_tokens = metrics.prompt_eval_count;
+            row.prefill_seconds = metrics.prompt_eval_duration;
+            row.output_tokens = metrics.eval_count;
+            row.decode_seconds = metrics.eval_duration;
+            row.peak_memory_kb = memory_monitor.get_peak_memory();
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+void OptionSweep::print(const std::vector<OptionSweepRow>& rows) {
+    // Fastest decode of each model, and the options that differ between rows
+    std::map<std::string, double> best;
+    std::map<std::string, json> first_value;
+    std::vector<std::string> varying;
+    for (const auto& row : rows) {
+        if (row.ok) {
+            best[row.model_name] = std::max(best[row.model_name], row.decode_rate());
+        }
+        for (const auto& [name, value] : row.options.items()) {
+            auto it = first_value.find(name);
+            if (it == first_value.end()) {
+                first_value[name] = value;
+            } else if (it->second != value && std::find(varying.begin(), varying.end(), name) == varying.end()) {
+                varying.push_back(name);
+            }
+        }
+    }
+
+    std::cout << std::left << std::setw(20) << "Model"
+              << std::setw(9) << "Load s"
+              << std::setw(9) << "TTFT s"
+              << std::setw(12) << "Prefill t/s"
+              << std::setw(12) << "Decode t/s"
+              << std::setw(10) << "Peak MB"
+              << "Options" << std::endl;
+    std::cout << std::string(100, '-') << std::endl;
+
+    for (const auto& row : rows) {
+        std::string options;
+        for (const auto& [name, value] : row.options.items()) {
+            if (varying.empty() || std::find(varying.begin(), varying.end(), name) != varying.end()) {
+                options += (options.empty() ? "" : " ") + name + "=" + value_text(value);
+            }
+        }
+        std::cout << std::left << std::setw(20) << row.model_name;
+        if (!row.ok) {
+            std::cout << std::setw(52) << row.error << options << std::endl;
+            continue;
+        }
+        std::stringstream decode;
+        decode << std::fixed << std::setprecision(2) << row.decode_rate();
+        if (row.decode_rate() > 0 && row.decode_rate() == best[row.model_name]) {
+            decode << " *";
+        }
+        std::cout << std::setw(9) << std::fixed << std::setprecision(2) << row.load_seconds
+                  << std::setw(9) << std::setprecision(3) << row.ttft_seconds
+                  << std::setw(12) << std::setprecision(1) << row.prefill_rate()
+                  << std::setw(12) << decode.str()
+                  << std::setw(10) << row.peak_memory_kb / 1024.0
+                  << options << std::defaultfloat << std::endl;
+    }
+    std::cout << "* fastest decode of the model";
+    if (!varying.empty() && varying.size() < first_value.size()) {
+        std::cout << "; options not shown are the same in every row";
+    }
+    std::cout << std::endl;
+}
+
+json OptionSweep::to_json(const std::vector<OptionSweepRow>& rows) {
+    json j = json::array();
+    for (const auto& row : rows) {
+        json entry = {
+            {"model", row.model_name},
+            {"repeat", row.repeat},
+            {"ok", row.ok},
+            {"wall_s", row.wall_seconds},
+            {"load_s", row.load_seconds},
+            {"ttft_s", row.ttft_seconds},
+            {"prompt_tokens", row.prompt_tokens},
+            {"prefill_s", row.prefill_seconds},
+            {"prefill_tokens_per_second", row.prefill_rate()},
+            {"output_tokens", row.output_tokens},
+            {"decode_s", row.decode_seconds},
+            {"decode_tokens_per_second", row.decode_rate()},
+            {"peak_memory_kb", row.peak_memory_kb}
+        };
+        if (!row.ok) {
+            entry["error"] = row.error;
+        }
+        // Options become columns of the same row
+        entry.update(row.options);
+        j.push_back(entry);
+    }
+    return j;
+}
+
+bool OptionSweep::write_csv(const std::string& path, const std::vector<OptionSweepRow>& rows) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Could not open CSV file " << path << std::endl;
+        return false;
+    }
+
+    // One column per option that appears in any row, in first-seen order
+    std::vector<std::string> names;
+    for (const auto& row : rows) {
+        for (const auto& [name, value] : row.options.items()) {
+            if (std::find(names.begin(), names.end(), name) == names.end()) {
+                names.push_back(name);
+            }
+        }
+    }
+
+    out << "model";
+    for (const auto& name : names) {
+        out << "," << csv_field(name);
+    }
+    out << ",repeat,ok,wall_s,load_s,ttft_s,prompt_tokens,prefill_s,prefill_tokens_per_second,"
+        << "output_tokens,decode_s,decode_tokens_per_second,peak_memory_kb,error" << std::endl;
+
+    for (const auto& row : rows) {
+        out << csv_field(row.model_name);
+        for (const auto& name : names) {
+            out << "," << (row.options.contains(name) ? csv_field(value_text(row.options[name])) : "");
+        }
+        out << "," << row.repeat << "," << (row.ok ? "true" : "false")
+            << "," << row.wall_seconds << "," << row.load_seconds << "," << row.ttft_seconds
+            << "," << row.prompt_tokens << "," << row.prefill_seconds << "," << row.prefill_rate()
+            << "," << row.output_tokens << "," << row.decode_seconds << "," << row.decode_rate()
+            << "," << row.peak_memory_kb << "," << csv_field(row.error) << std::endl;
+    }
+    return true;
+}
@@ -0,0 +1,165 @@
+#include "power_source.h"
+#include "system_utils.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <glob.h>
+#include <sys/stat.h>
+
+PowercapSource::PowercapSource(const std::string& dir) : powercap_dir(dir) {
+    glob_t matches;
+    std::string pattern = powercap_dir + "/*/energy_uj";
+    if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+        for (size_t i = 0; i < matches.gl_pathc; ++i) {
+            std::string path = matches.gl_pathv[i];
+            std::string zone_dir = path.substr(0, path.rfind('/'));
+            std::string zone = zone_dir.substr(zone_dir.rfind('/') + 1);
+
+            // Top-level zones have a single index ("intel-rapl:0"); the MMIO
+            // interface reports the same package energy a second time
+            if (std::count(zone.begin(), zone.end(), ':') != 1 || zone.find("mmio") != std::string::npos) {
+                continue;
+            }
+
+            std::string range = read_system_value(zone_dir + "/max_energy_range_uj");
+            zones.push_back({path, range.empty() ? 0ULL : std::stoull(range)});
+        }
+    }
+    globfree(&matches);
+}
+
+bool PowercapSource::available() const {
+    return !zones.empty();
+}
+
+std::string PowercapSource::description() const {
+    return "powercap (" + std::to_string(zones.size()) + " zone(s) under " + powercap_dir + ")";
+}
+
+EnergyMark PowercapSource::mark() {
+    EnergyMark snapshot;
+    snapshot.time = std::chrono::system_clock::now();
+    for (const auto& zone : zones) {
+        std::string value = read_system_value(zone.first);
+        snapshot.counters.push_back(value.empty() ? 0ULL : std::stoull(value));
+    }
+    return snapshot;
+}
+
+double PowercapSource::energy_between(const EnergyMark& start, const EnergyMark& end) {
+    if (start.counters.size() != zones.size() || end.counters.size() != zones.size()) {
+        return -1.0;
+    }
+
+    unsigned long long total_uj = 0;
+    for (size_t i = 0; i < zones.size(); ++i) {
+        if (end.counters[i] >= start.counters[i]) {
+            total_uj += end.counters[i] - start.counters[i];
+        } else if (zones[i].second > 0) {
+            // Counter wrapped around max_energy_range_uj
+            total_uj += zones[i].second - start.counters[i] + end.counters[i];
+        }
+    }
+    return total_uj / 1e6;
+}
+
+CsvPowerLog::CsvPowerLog(const std::string& path) : log_path(path), loaded_size(-1) {
+    refresh();
+}
+
+void CsvPowerLog::refresh() {
+    struct stat info;
+    if (stat(log_path.c_str(), &info) != 0 || info.st_size == loaded_size) {
+        return;
+    }
+
+    std::ifstream file(log_path);
+    if (!file.is_open()) {
+        return;
+    }
+
+    samples.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::stringstream ss(line);
+        double timestamp, watts;
+        if (ss >> timestamp >> watts) {
+            samples.push_back({timestamp, watts});
+        }
+    }
+    std::sort(samples.begin(), samples.end());
+    loaded_size = info.st_size;
+}
+
+bool CsvPowerLog::available() const {
+    struct stat info;
+    return stat(log_path.c_str(), &info) == 0;
+}
+
+std::string CsvPowerLog::description() const {
+    return "external meter log " + log_path;
+}
+
+EnergyMark CsvPowerLog::mark() {
+    return {std::chrono::system_clock::now(), {}};
+}
+
+double CsvPowerLog::watts_at(double t) const {
+    auto upper = std::lower_bound(samples.begin(), samples.end(), std::make_pair(t, -1e300));
+    if (upper == samples.begin()) {
+        return upper->second;
+    }
+    if (upper == samples.end()) {
+        return samples.back().second;
+    }
+    auto lower = upper - 1;
+    double span = upper->first - lower->first;
+    double weight = span > 0 ? (t - lower->first) / span : 0.0;
+    return lower->second + weight * (upper->second - lower->second);
+}
+
+double CsvPowerLog::energy_between(const EnergyMark& start, const EnergyMark& end) {
+    std::lock_guard<std::mutex> lock(mtx);
+    refresh();
+
+    double from = std::chrono::duration<double>(start.time.time_since_epoch()).count();
+    double to = std::chrono::duration<double>(end.time.time_since_epoch()).count();
+
+    // The log has to cover the interval, otherwise the meter wasn't running
+    if (samples.size() < 2 || samples.front().first > from || samples.back().first < to) {
+        return -1.0;
+    }
+
+    // Trapezoidal integration over the samples inside [from, to]
+    double joules = 0.0;
+    double prev_t = from;
+    double prev_w = watts_at(from);
+    for (const auto& [t, w] : samples) {
+        if (t <= from) continue;
+        if (t >= to) break;
+        joules += 0.5 * (prev_w + w) * (t - prev_t);
+        prev_t = t;
+        prev_w = w;
+    }
+    joules += 0.5 * (prev_w + watts_at(to)) * (to - prev_t);
+    return joules;
+}
+
+std::unique_ptr<PowerSource> create_power_source(const std::string& spec, const std::string& sysfs_root) {
+    if (spec == "powercap") {
+        std::string root = sysfs_root == "/" ? "" : sysfs_root;
+        return std::make_unique<PowercapSource>(root + "/sys/class/powercap");
+    }
+    if (spec.rfind("powercap:", 0) == 0) {
+        return std::make_unique<PowercapSource>(spec.substr(9));
+    }
+    if (spec.rfind("csv:", 0) == 0) {
+        return std::make_unique<CsvPowerLog>(spec.substr(4));
+    }
+    return nullptr;
+}
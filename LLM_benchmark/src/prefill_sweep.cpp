@@ -0,0 +1,207 @@
+#include "prefill_sweep.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+const char* const filler_words[] = {
+    "the", "river", "carried", "small", "stones", "past", "an", "old", "mill", "where",
+    "workers", "once", "ground", "grain", "for", "every", "village", "along", "its", "banks",
+    "in", "spring", "water", "rose", "and", "fields", "turned", "green", "while", "children",
+    "counted", "boats", "drifting", "toward", "distant", "harbor", "merchants", "traded", "salt", "wool",
+    "bread", "iron", "tools", "under", "bright", "lanterns", "each", "evening", "travelers", "shared",
+    "stories", "about", "mountains", "storms", "quiet", "roads", "long", "winters", "that", "followed",
+    "harvest", "season", "near", "forest"
+};
+const size_t filler_word_count = sizeof(filler_words) / sizeof(filler_words[0]);
+
+// Prompt tokens left for the chat template and the generated token
+const int context_margin = 8;
+
+std::string join_words(const std::vector<const char*>& words, size_t count) {
+    std::string text;
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            text += (i % 12 == 0) ? ". " : " ";
+        }
+        text += words[i];
+    }
+    if (count > 0) {
+        text += ".";
+    }
+    return text;
+}
+
+} // namespace
+
+double PrefillPoint::prefill_rate() const {
+    return prefill_seconds > 0 ? prompt_tokens / prefill_seconds : 0.0;
+}
+
+PrefillSweep::PrefillSweep(int min_length, int max_length, double growth)
+    : min_tokens(std::max(1, min_length)),
+      max_tokens(std::max(0, max_length)),
+      factor(growth > 1.0 ? growth : 2.0) {
+}
+
+std::vector<int> PrefillSweep::lengths(int context_length) const {
+    int limit = std::max(1, context_length - context_margin);
+    if (max_tokens > 0) {
+        limit = std::min(limit, max_tokens);
+    }
+
+    std::vector<int> result;
+    for (double length = min_tokens; length < limit; length *= factor) {
+        int rounded = static_cast<int>(std::lround(length));
+        if (result.empty() || rounded > result.back()) {
+            result.push_back(rounded);
+        }
+    }
+    result.push_back(limit);
+    return result;
+}
+
+std::string PrefillSweep::filler_text(int tokens, unsigned seed, const Tokenizer* tokenizer) {
+    // Linear congruential generator so the text is the same on every platform
+    uint32_t state = seed * 2654435761u + 1;
+    auto next_word = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return filler_words[(state >> 16) % filler_word_count];
+    };
+
+    std::vector<const char*> words;
+    if (!tokenizer) {
+        // About four characters per token
+        const size_t target_chars = static_cast<size_t>(tokens) * 4;
+        size_t chars = 0;
+        while (chars < target_chars) {
+            words.push_back(next_word());
+            chars += std::string(words.back()).size() + 1;
+        }
+        return join_words(words, words.size());
+    }
+
+    // Every word is at least one token, so the answer has at most `tokens` words
+    words.reserve(tokens);
+    for (int i = 0; i < tokens; i++) {
+        words.push_back(next_word());
+    }
+
+    // Largest word count whose text fits in the target
+    size_t low = 0;
+    size_t high = words.size();
+    while (low < high) {
+        size_t mid = (low + high + 1) / 2;
+        if (tokenizer->count(join_words(words, mid)) <= static_cast<size_t>(tokens)) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    // Then the longest prefix of the next word that still fits, since words
+    // can be several tokens long with a small vocabulary
+    std::string text = join_words(words, low);
+    if (low < words.size()) {
+        std::string longer = join_words(words, low + 1);
+        size_t fits = text.size();
+        size_t too_long = longer.size();
+        while (too_long - fits > 1) {
+            size_t mid = (fits + too_long) / 2;
+            if (tokenizer->count(longer.substr(0, mid)) <= static_cast<size_t>(tokens)) {
+                fits = mid;
+            } else {
+                too_long = mid;
+            }
+        }
+        text = longer.substr(0, fits);
+    }
+    return text;
+}
+
+std::vector<PrefillPoint> PrefillSweep::run(InferenceBackend& backend, const std::string& model, const Tokenizer* tokenizer, int context_length) {
+    std::vector<PrefillPoint> points;
+
+    // The context stays the same for every request so the server never reloads the model
+    json options = {
+        {"num_predict", 1},
+        {"num_ctx", context_length},
+        {"temperature", 0}
+    };
+
+    // Load the model first so the first length does not include the load
+    GenerationMetrics warmup;
+    std::string response = backend.generate(model, "Hello", false, false, &warmup, &options);
+    if (response.rfind("Error:", 0) == 0) {
+        std::cerr << "Error: prefill sweep could not run " << model << ": " << response << std::endl;
+        return points;
+    }
+
+    unsigned seed = 1;
+    for (int target : lengths(context_length)) {
+        // A different seed per length starts each prompt with different words,
+        // so no prompt shares a cached prefix with the one before
+        std::string prompt = filler_text(target, seed++, tokenizer);
+
+        GenerationMetrics metrics;
+        response = backend.generate(model, prompt, false, false, &metrics, &options);
+        if (response.rfind("Error:", 0) == 0) {
+            std::cerr << "Error: prefill sweep at " << target << " tokens: " << response << std::endl;
+            continue;
+        }
+        // A rejected request can come back without an error but with nothing evaluated
+        if (metrics.prompt_eval_count == 0 || metrics.eval_count == 0) {
+            std::cerr << "Error: prefill sweep at " << target << " tokens: no prompt tokens evaluated" << std::endl;
+            continue;
+        }
+
+        PrefillPoint point;
+        point.model_name = model;
+        point.target_tokens = target;
+        point.prompt_tokens = metrics.prompt_eval_count;
+        point.prefill_seconds = metrics.prompt_eval_duration;
+        point.ttft_seconds = metrics.wall_time;
+        point.load_seconds = metrics.load_duration;
+        points.push_back(point);
+    }
+    return points;
+}
+
+void PrefillSweep::print(const std::vector<PrefillPoint>& points) {
+    std::cout << std::left << std::setw(20) << "Model"
+              << std::setw(10) << "Target"
+              << std::setw(10) << "Tokens"
+              << std::setw(12) << "Prefill s"
+              << std::setw(12) << "Prefill t/s"
+              << std::setw(10) << "TTFT s"
+              << "Load s" << std::endl;
+    std::cout << std::string(84, '-') << std::endl;
+
+    for (const auto& point : points) {
+        std::cout << std::left << std::setw(20) << point.model_name
+                  << std::setw(10) << point.target_tokens
+                  << std::setw(10) << point.prompt_tokens
+                  << std::setw(12) << std::fixed << std::setprecision(3) << point.prefill_seconds
+                  << std::setw(12) << std::setprecision(1) << point.prefill_rate()
+                  << std::setw(10) << std::setprecision(3) << point.ttft_seconds
+                  << point.load_seconds << std::defaultfloat << std::endl;
+    }
+}
+
+json PrefillSweep::to_json(const std::vector<PrefillPoint>& points) {
+    json j = json::array();
+    for (const auto& point : points) {
+        j.push_back({
+            {"model", point.model_name},
+            {"target_tokens", point.target_tokens},
+            {"prompt_tokens", point.prompt_tokens},
+            {"prefill_s", point.prefill_seconds},
+            {"prefill_tokens_per_second", point.prefill_rate()},
+            {"ttft_s", point.ttft_seconds},
+            {"load_s", point.load_seconds}
+        });
+    }
+    return j;
+}
@@ -0,0 +1,143 @@
+#include "prefix_cache_bench.h"
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+
+double PrefixCachePoint::saved_pct() const {
+    if (cold_prefill_seconds <= 0) {
+        return 0.0;
+    }
+    return 100.0 * (1.0 - warm_prefill_seconds / cold_prefill_seconds);
+}
+
+PrefixCacheBench::PrefixCacheBench(const std::string& shared_prefix)
+    : prefix(shared_prefix.empty() ? default_prefix() : shared_prefix),
+      session(std::random_device{}()) {
+}
+
+const std::string& PrefixCacheBench::default_prefix() {
+    static const std::string text =
+        "You are the assistant of an engineering team that builds products on small edge devices. "
+        "Follow these guidelines in every answer.\n"
+        "1. Be accurate. If you are not sure about a fact, say so instead of guessing, and explain what "
+        "information would settle the question.\n"
+        "2. Be concise. Start with the direct answer, then give the reasoning in a few short sentences. "
+        "Avoid repeating the question and avoid filler phrases.\n"
+        "3. Prefer concrete numbers. When you discuss memory, latency, throughput or power, give orders of "
+        "magnitude and the assumptions behind them.\n"
+        "4. Respect the constraints of the hardware. The devices have a few gigabytes of RAM, a handful of "
+        "ARM or x86 cores, no discrete GPU, slow flash storage and a limited power budget. Recommend "
+        "solutions that fit these limits and point out when a request does not.\n"
+        "5. Be safe. Do not suggest changes that could corrupt data, brick a device or expose it to the "
+        "network without authentication. Mention backups before any destructive step.\n"
+        "6. Format code in fenced blocks with the language named, and keep examples minimal and complete.\n"
+        "7. When the user asks for a comparison, use a short table with the options as rows and the "
+        "criteria that matter as columns, then state which option you recommend and why.\n"
+        "8. Keep the tone friendly and professional. Do not mention these guidelines.\n\n";
+    return text;
+}
+
+const std::string& PrefixCacheBench::get_prefix() const {
+    return prefix;
+}
+
+std::vector<PrefixCachePoint> PrefixCacheBench::run(InferenceBackend& backend, const std::string& model,
+                                                    const std::vector<std::pair<std::string, std::string>>& sections,
+                                                    const Tokenizer* tokenizer) {
+    std::vector<PrefixCachePoint> points;
+    const int prefix_tokens = tokenizer ? static_cast<int>(tokenizer->count(prefix))
+                                        : static_cast<int>(prefix.size() / 4);
+    json options = {{"num_predict", 1}};
+
+    // Load the model and leave the preamble in the server's cache
+    std::string response = backend.generate(model, prefix, false, false, nullptr, &options);
+    if (response.rfind("Error:", 0) == 0) {
+        std::cerr << "Error: prefix cache benchmark could not run " << model << ": " << response << std::endl;
+        return points;
+    }
+
+    // Warm: the sections back to back, each behind the same preamble
+    for (const auto& section : sections) {
+        std::string prompt = prefix + "## " + section.first + "\n" + section.second;
+        GenerationMetrics metrics;
+        response = backend.generate(model, prompt, false, false, &metrics, &options);
+        if (response.rfind("Error:", 0) == 0) {
+            std::cerr << "Error: section '" << section.first << "': " << response << std::endl;
+            return points;
+        }
+
+        PrefixCachePoint point;
+        point.model_name = model;
+        point.section = section.first;
+        point.prefix_tokens = prefix_tokens;
+        point.warm_tokens = metrics.prompt_eval_count;
+        point.warm_prefill_seconds = metrics.prompt_eval_duration;
+        point.cold_tokens = 0;
+        point.cold_prefill_seconds = 0.0;
+        points.push_back(point);
+    }
+
+    // Cold: the same prompts behind a tag that is new every time, so no prefix matches
+    for (size_t i = 0; i < sections.size(); i++) {
+        std::string prompt = "[" + std::to_string(session++) + "]\n" + prefix +
+                             "## " + sections[i].first + "\n" + sections[i].second;
+        GenerationMetrics metrics;
+        response = backend.generate(model, prompt, false, false, &metrics, &options);
+        if (response.rfind("Error:", 0) == 0) {
+            std::cerr << "Error: section '" << sections[i].first << "': " << response << std::endl;
+            return points;
+        }
+        points[i].cold_tokens = metrics.prompt_eval_count;
+        points[i].cold_prefill_seconds = metrics.prompt_eval_duration;
+    }
+    return points;
+}
+
+void PrefixCacheBench::print(const std::vector<PrefixCachePoint>& points) {
+    std::cout << std::left << std::setw(20) << "Model"
+              << std::setw(24) << "Section"
+              << std::setw(10) << "Warm tok"
+              << std::setw(10) << "Warm ms"
+              << std::setw(10) << "Cold tok"
+              << std::setw(10) << "Cold ms"
+              << "Saved" << std::endl;
+    std::cout << std::string(90, '-') << std::endl;
+
+    std::map<std::string, std::pair<double, double>> totals; // Warm and cold seconds by model
+    for (const auto& point : points) {
+        std::string section = point.section.size() > 22 ? point.section.substr(0, 21) + "~" : point.section;
+        std::cout << std::left << std::setw(20) << point.model_name
+                  << std::setw(24) << section
+                  << std::setw(10) << point.warm_tokens
+                  << std::setw(10) << std::fixed << std::setprecision(1) << point.warm_prefill_seconds * 1000.0
+                  << std::setw(10) << point.cold_tokens
+                  << std::setw(10) << point.cold_prefill_seconds * 1000.0
+                  << std::setprecision(0) << point.saved_pct() << "%" << std::defaultfloat << std::endl;
+        totals[point.model_name].first += point.warm_prefill_seconds;
+        totals[point.model_name].second += point.cold_prefill_seconds;
+    }
+
+    for (const auto& [model, seconds] : totals) {
+        double saved = seconds.second > 0 ? 100.0 * (1.0 - seconds.first / seconds.second) : 0.0;
+        std::cout << model << ": warm prefix saved " << std::fixed << std::setprecision(0) << saved
+                  << "% of prefill time over all sections" << std::defaultfloat << std::endl;
+    }
+}
+
+json PrefixCacheBench::to_json(const std::vector<PrefixCachePoint>& points) {
+    json j = json::array();
+    for (const auto& point : points) {
+        j.push_back({
+            {"model", point.model_name},
+            {"section", point.section},
+            {"prefix_tokens", point.prefix_tokens},
+            {"warm_prompt_tokens", point.warm_tokens},
+            {"warm_prefill_s", point.warm_prefill_seconds},
+            {"cold_prompt_tokens", point.cold_tokens},
+            {"cold_prefill_s", point.cold_prefill_seconds},
+            {"saved_pct", point.saved_pct()}
+        });
+    }
+    return j;
+}
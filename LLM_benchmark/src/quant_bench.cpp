@@ -0,0 +1,199 @@
+#include "quant_bench.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+QuantKernelBench::QuantKernelBench(const std::vector<std::pair<int, int>>& layer_shapes, double min_time_s)
+    : shapes(layer_shapes), min_seconds(min_time_s) {
+}
+
+std::vector<std::pair<int, int>> QuantKernelBench::default_shapes() {
+    // TinyLlama attention and FFN, then Llama-7B attention and FFN
+    return {{2048, 2048}, {5632, 2048}, {4096, 4096}, {11008, 4096}};
+}
+
+bool QuantKernelBench::parse_shapes(const std::string& spec, std::vector<std::pair<int, int>>& out) {
+    out.clear();
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t separator = item.find('x');
+        if (separator == std::string::npos) {
+            return false;
+        }
+        int rows = std::atoi(item.substr(0, separator).c_str());
+        int cols = std::atoi(item.substr(separator + 1).c_str());
+        if (rows <= 0 || cols <= 0 || cols % QK_K != 0) {
+            return false;
+        }
+        out.push_back({rows, cols});
+    }
+    return !out.empty();
+}
+
+template <typename Function>
+double QuantKernelBench::time_calls(Function&& function) const {
+    function(); // Warm caches and page in the weights
+
+    long calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    do {
+        function();
+        calls++;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < min_seconds);
+
+    return elapsed / calls;
+}
+
+std::vector<QuantKernelResult> QuantKernelBench::run() {
+    std::vector<QuantKernelResult> results;
+
+    std::vector<KernelIsa> isas;
+    for (KernelIsa isa : {KernelIsa::SCALAR, KernelIsa::SSE, KernelIsa::AVX2, KernelIsa::NEON}) {
+        if (isa_supported(isa)) {
+            isas.push_back(isa);
+        }
+    }
+
+    std::cout << "Quantized kernel benchmark:";
+    for (KernelIsa isa : isas) {
+        std::cout << " " << isa_name(isa);
+    }
+    std::cout << " (best: " << isa_name(best_isa()) << ")" << std::endl;
+
+    std::mt19937 rng(7);
+    std::normal_distribution<float> weight_dist(0.0f, 0.02f);
+    std::normal_distribution<float> activation_dist(0.0f, 1.0f);
+
+    for (const auto& [rows, cols] : shapes) {
+        std::vector<float> x(cols);
+        for (auto& value : x) {
+            value = activation_dist(rng);
+        }
+
+        for (QuantFormat format : {QuantFormat::Q4_0, QuantFormat::Q4_K, QuantFormat::Q6_K, QuantFormat::Q8_0, QuantFormat::F16}) {
+            // Quantize row by row so the float matrix never has to exist in full
+            const size_t stride = row_size(format, cols);
+            std::vector<uint8_t> weights(stride * rows);
+            std::vector<float> row(cols);
+            for (int r = 0; r < rows; ++r) {
+                for (auto& value : row) {
+                    value = weight_dist(rng);
+                }
+                quantize_row(format, row.data(), weights.data() + r * stride, cols);
+            }
+
+            std::vector<uint8_t> activations;
+            quantize_activations(format, x.data(), cols, activations);
+
+            std::vector<float> reference(rows);
+            matvec(get_dot_kernel(format, KernelIsa::SCALAR), format, rows, cols,
+                   weights.data(), activations.data(), reference.data());
+            float reference_scale = 0.0f;
+            for (float value : reference) {
+                reference_scale = std::max(reference_scale, std::fabs(value));
+            }
+
+            for (KernelIsa isa : isas) {
+                DotKernel kernel = get_dot_kernel(format, isa);
+                if (!kernel) {
+                    continue;
+                }
+
+                std::vector<float> y(rows);
+                double matvec_seconds = time_calls([&] {
+                    matvec(kernel, format, rows, cols, weights.data(), activations.data(), y.data());
+                });
+
+                double max_error = 0.0;
+                for (int r = 0; r < rows; ++r) {
+                    max_error = std::max(max_error, static_cast<double>(std::fabs(y[r] - reference[r])));
+                }
+                double relative_error = reference_scale > 0 ? max_error / reference_scale : 0.0;
+
+                volatile float sink = 0.0f;
+                double dot_seconds = time_calls([&] {
+                    sink = sink + kernel(cols, weights.data(), activations.data());
+                });
+
+                const double flops = 2.0 * rows * cols;
+                const double bytes = static_cast<double>(stride) * rows + activations.size();
+                results.push_back({format_name(format), isa_name(isa), "dot", 1, cols, dot_seconds,
+                                   2.0 * cols / dot_seconds / 1e9,
+                                   (stride + activations.size()) / dot_seconds / 1e9, relative_error});
+                results.push_back({format_name(format), isa_name(isa), "matvec", rows, cols, matvec_seconds,
+                                   flops / matvec_seconds / 1e9, bytes / matvec_seconds / 1e9, relative_error});
+            }
+        }
+    }
+
+    return results;
+}
+
+void QuantKernelBench::print(const std::vector<QuantKernelResult>& results) {
+    std::cout << std::left << std::setw(8) << "Format"
+              << std::setw(9) << "ISA"
+              << std::setw(8) << "Op"
+              << std::setw(14) << "Shape"
+              << std::setw(12) << "us/call"
+              << std::setw(10) << "GFLOP/s"
+              << std::setw(10) << "GB/s"
+              << "Error" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(8) << result.format
+                  << std::setw(9) << result.isa
+                  << std::setw(8) << result.op
+                  << std::setw(14) << (std::to_string(result.rows) + "x" + std::to_string(result.cols))
+                  << std::setw(12) << std::fixed << std::setprecision(2) << result.seconds * 1e6
+                  << std::setw(10) << result.gflops
+                  << std::setw(10) << result.gb_per_s
+                  << std::scientific << std::setprecision(1) << result.max_rel_error
+                  << std::defaultfloat << std::endl;
+    }
+}
+
+json QuantKernelBench::to_json(const std::vector<QuantKernelResult>& results) {
+    json j = json::array();
+    for (const auto& result : results) {
+        j.push_back({
+            {"format", result.format},
+            {"isa", result.isa},
+            {"op", result.op},
+            {"rows", result.rows},
+            {"cols", result.cols},
+            {"seconds_per_call", result.seconds},
+            {"gflops", result.gflops},
+            {"gb_per_s", result.gb_per_s},
+            {"max_rel_error", result.max_rel_error}
+        });
+    }
+    return j;
+}
+
+double QuantKernelBench::best_matvec_bandwidth(const std::vector<QuantKernelResult>& results, const std::string& format) {
+    double best = 0.0;
+    for (const auto& result : results) {
+        if (result.format == format && result.op == "matvec") {
+            best = std::max(best, result.gb_per_s);
+        }
+    }
+    return best;
+}
+
+std::string QuantKernelBench::kernel_format_for(const std::string& quantization_level) {
+    // Q4_K_S and Q4_K_M store most tensors as Q4_K
+    for (const std::string format : {"Q4_0", "Q8_0", "Q4_K", "Q6_K", "F16"}) {
+        if (quantization_level.rfind(format, 0) == 0) {
+            return format;
+        }
+    }
+    return "";
+}
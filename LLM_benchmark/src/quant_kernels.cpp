@@ -0,0 +1,1034 @@
+#include "quant_kernels.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define QUANT_X86 1
+#define SSE_TARGET __attribute__((target("ssse3")))
+#define AVX2_TARGET __attribute__((target("avx2,fma,f16c")))
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define QUANT_NEON 1
+#endif
+
+float fp16_to_fp32(uint16_t h) {
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1F;
+    uint32_t mantissa = h & 0x3FF;
+    uint32_t bits;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Subnormal half: normalize into a float exponent
+            exponent = 127 - 15 + 1;
+            while (!(mantissa & 0x400)) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+uint16_t fp32_to_fp16(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    uint32_t raw_exponent = (x >> 23) & 0xFF;
+    int32_t exponent = static_cast<int32_t>(raw_exponent) - 127 + 15;
+    uint32_t mantissa = x & 0x7FFFFF;
+
+    if (raw_exponent == 0xFF) {
+        return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+    }
+    if (exponent >= 31) {
+        return sign | 0x7C00;
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t midpoint = 1u << (shift - 1);
+        if (remainder > midpoint || (remainder == midpoint && (half & 1))) {
+            half++;
+        }
+        return sign | half;
+    }
+
+    uint32_t half = sign | (exponent << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        half++; // A carry into the exponent is still correct rounding
+    }
+    return half;
+}
+
+namespace {
+
+// Lookup table for fp16 conversion on paths without hardware support
+const float* fp16_table() {
+    static const std::vector<float> table = [] {
+        std::vector<float> values(65536);
+        for (uint32_t i = 0; i < 65536; ++i) {
+            values[i] = fp16_to_fp32(static_cast<uint16_t>(i));
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+inline int nearest_int(float value) {
+    return static_cast<int>(std::lround(value));
+}
+
+inline void get_scale_min_k4(int j, const uint8_t* q, uint8_t& scale, uint8_t& min) {
+    if (j < 4) {
+        scale = q[j] & 63;
+        min = q[j + 4] & 63;
+    } else {
+        scale = (q[j + 4] & 0xF) | ((q[j - 4] >> 6) << 4);
+        min = (q[j + 4] >> 4) | ((q[j] >> 6) << 4);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Quantization
+// ---------------------------------------------------------------------------
+
+void quantize_q4_0(const float* x, BlockQ4_0* y, int n) {
+    for (int i = 0; i < n / QK4_0; ++i) {
+        const float* block = x + i * QK4_0;
+        float amax = 0.0f;
+        float max = 0.0f;
+        for (int j = 0; j < QK4_0; ++j) {
+            if (std::fabs(block[j]) > amax) {
+                amax = std::fabs(block[j]);
+                max = block[j];
+            }
+        }
+
+        const float d = max / -8.0f;
+        const float id = d != 0.0f ? 1.0f / d : 0.0f;
+        y[i].d = fp32_to_fp16(d);
+
+        for (int j = 0; j < QK4_0 / 2; ++j) {
+            uint8_t q0 = std::min(15, static_cast<int>(block[j] * id + 8.5f));
+            uint8_t q1 = std::min(15, static_cast<int>(block[j + QK4_0 / 2] * id + 8.5f));
+            y[i].qs[j] = q0 | (q1 << 4);
+        }
+    }
+}
+
+void quantize_q8_0(const float* x, BlockQ8_0* y, int n) {
+    for (int i = 0; i < n / QK8_0; ++i) {
+        const float* block = x + i * QK8_0;
+        float amax = 0.0f;
+        for (int j = 0; j < QK8_0; ++j) {
+            amax = std::max(amax, std::fabs(block[j]));
+        }
+
+        const float d = amax / 127.0f;
+        const float id = d != 0.0f ? 1.0f / d : 0.0f;
+        y[i].d = fp32_to_fp16(d);
+
+        for (int j = 0; j < QK8_0; ++j) {
+            y[i].qs[j] = static_cast<int8_t>(nearest_int(block[j] * id));
+        }
+    }
+}
+
+void quantize_q8_K(const float* x, BlockQ8_K* y, int n) {
+    for (int i = 0; i < n / QK_K; ++i) {
+        const float* block = x + i * QK_K;
+        float amax = 0.0f;
+        for (int j = 0; j < QK_K; ++j) {
+            amax = std::max(amax, std::fabs(block[j]));
+        }
+
+        const float d = amax / 127.0f;
+        const float id = d != 0.0f ? 1.0f / d : 0.0f;
+        y[i].d = d;
+
+        for (int j = 0; j < QK_K; ++j) {
+            y[i].qs[j] = static_cast<int8_t>(nearest_int(block[j] * id));
+        }
+        for (int j = 0; j < QK_K / 16; ++j) {
+            int sum = 0;
+            for (int k = 0; k < 16; ++k) {
+                sum += y[i].qs[j * 16 + k];
+            }
+            y[i].bsums[j] = static_cast<int16_t>(sum);
+        }
+    }
+}
+
+// Min/max fit per sub-block; simpler than ggml's iterative search but the same layout
+void quantize_q4_K(const float* x, BlockQ4_K* y, int n) {
+    for (int i = 0; i < n / QK_K; ++i) {
+        const float* block = x + i * QK_K;
+        float scales[QK_K / 32];
+        float mins[QK_K / 32];
+        float max_scale = 0.0f;
+        float max_min = 0.0f;
+
+        for (int j = 0; j < QK_K / 32; ++j) {
+            float lo = std::min(0.0f, *std::min_element(block + 32 * j, block + 32 * (j + 1)));
+            float hi = *std::max_element(block + 32 * j, block + 32 * (j + 1));
+            scales[j] = (hi - lo) / 15.0f;
+            mins[j] = -lo;
+            max_scale = std::max(max_scale, scales[j]);
+            max_min = std::max(max_min, mins[j]);
+        }
+
+        const float inv_scale = max_scale > 0 ? 63.0f / max_scale : 0.0f;
+        const float inv_min = max_min > 0 ? 63.0f / max_min : 0.0f;
+        std::memset(y[i].scales, 0, sizeof(y[i].scales));
+        for (int j = 0; j < QK_K / 32; ++j) {
+            uint8_t ls = std::min(63, nearest_int(inv_scale * scales[j]));
+            uint8_t lm = std::min(63, nearest_int(inv_min * mins[j]));
+            if (j < 4) {
+                y[i].scales[j] = ls;
+                y[i].scales[j + 4] = lm;
+            } else {
+                y[i].scales[j + 4] = (ls & 0xF) | ((lm & 0xF) << 4);
+                y[i].scales[j - 4] |= ((ls >> 4) << 6);
+                y[i].scales[j] |= ((lm >> 4) << 6);
+            }
+        }
+        y[i].d = fp32_to_fp16(max_scale / 63.0f);
+        y[i].dmin = fp32_to_fp16(max_min / 63.0f);
+
+        uint8_t levels[QK_K];
+        const float d = fp16_to_fp32(y[i].d);
+        const float dmin = fp16_to_fp32(y[i].dmin);
+        for (int j = 0; j < QK_K / 32; ++j) {
+            uint8_t sc, m;
+            get_scale_min_k4(j, y[i].scales, sc, m);
+            const float dl = d * sc;
+            const float ml = dmin * m;
+            for (int k = 0; k < 32; ++k) {
+                int level = dl != 0.0f ? nearest_int((block[32 * j + k] + ml) / dl) : 0;
+                levels[32 * j + k] = static_cast<uint8_t>(std::max(0, std::min(15, level)));
+            }
+        }
+
+        // Each 32 bytes hold 64 weights: low nibbles first, then high nibbles
+        for (int j = 0; j < QK_K; j += 64) {
+            for (int k = 0; k < 32; ++k) {
+                y[i].qs[j / 2 + k] = levels[j + k] | (levels[j + k + 32] << 4);
+            }
+        }
+    }
+}
+
+// Max-magnitude scale per sub-block of 16, then 8-bit scales relative to the largest
+void quantize_q6_K(const float* x, BlockQ6_K* y, int n) {
+    for (int i = 0; i < n / QK_K; ++i) {
+        const float* block = x + i * QK_K;
+        float scales[QK_K / 16];
+        float max_scale = 0.0f;
+        float max_abs_scale = 0.0f;
+
+        for (int j = 0; j < QK_K / 16; ++j) {
+            float amax = 0.0f;
+            float max = 0.0f;
+            for (int k = 0; k < 16; ++k) {
+                if (std::fabs(block[16 * j + k]) > amax) {
+                    amax = std::fabs(block[16 * j + k]);
+                    max = block[16 * j + k];
+                }
+            }
+            scales[j] = max / -32.0f;
+            if (std::fabs(scales[j]) > max_abs_scale) {
+                max_abs_scale = std::fabs(scales[j]);
+                max_scale = scales[j];
+            }
+        }
+
+        const float inv_scale = max_abs_scale > 0 ? -128.0f / max_scale : 0.0f;
+        y[i].d = fp32_to_fp16(max_abs_scale > 0 ? 1.0f / inv_scale : 0.0f);
+        const float d = fp16_to_fp32(y[i].d);
+
+        uint8_t levels[QK_K];
+        for (int j = 0; j < QK_K / 16; ++j) {
+            y[i].scales[j] = static_cast<int8_t>(std::min(127, nearest_int(inv_scale * scales[j])));
+            const float dl = d * y[i].scales[j];
+            for (int k = 0; k < 16; ++k) {
+                int level = dl != 0.0f ? nearest_int(block[16 * j + k] / dl) : 0;
+                levels[16 * j + k] = static_cast<uint8_t>(std::max(-32, std::min(31, level)) + 32);
+            }
+        }
+
+        // Each 128 weights: low nibbles of 0-31/64-95 and 32-63/96-127 share ql bytes, top bits go to qh
+        uint8_t* ql = y[i].ql;
+        uint8_t* qh = y[i].qh;
+        for (int j = 0; j < QK_K; j += 128) {
+            for (int k = 0; k < 32; ++k) {
+                ql[k] = (levels[j + k] & 0xF) | ((levels[j + k + 64] & 0xF) << 4);
+                ql[k + 32] = (levels[j + k + 32] & 0xF) | ((levels[j + k + 96] & 0xF) << 4);
+                qh[k] = (levels[j + k] >> 4) | ((levels[j + k + 32] >> 4) << 2) |
+                        ((levels[j + k + 64] >> 4) << 4) | ((levels[j + k + 96] >> 4) << 6);
+            }
+            ql += 64;
+            qh += 32;
+        }
+    }
+}
+
+// Unpack the 6-bit weights of a Q6_K block to signed values in weight order
+inline void unpack_q6_K(const BlockQ6_K& block, int8_t* out) {
+    const uint8_t* ql = block.ql;
+    const uint8_t* qh = block.qh;
+    for (int j = 0; j < QK_K; j += 128) {
+        for (int k = 0; k < 32; ++k) {
+            out[j + k] = static_cast<int8_t>(((ql[k] & 0xF) | (((qh[k] >> 0) & 3) << 4)) - 32);
+            out[j + k + 32] = static_cast<int8_t>(((ql[k + 32] & 0xF) | (((qh[k] >> 2) & 3) << 4)) - 32);
+            out[j + k + 64] = static_cast<int8_t>(((ql[k] >> 4) | (((qh[k] >> 4) & 3) << 4)) - 32);
+            out[j + k + 96] = static_cast<int8_t>(((ql[k + 32] >> 4) | (((qh[k] >> 6) & 3) << 4)) - 32);
+        }
+        ql += 64;
+        qh += 32;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Scalar kernels
+// ---------------------------------------------------------------------------
+
+float dot_q4_0_scalar(int n, const void* vw, const void* vx) {
+    const BlockQ4_0* w = static_cast<const BlockQ4_0*>(vw);
+    const BlockQ8_0* x = static_cast<const BlockQ8_0*>(vx);
+    const float* table = fp16_table();
+    float sum = 0.0f;
+
+    for (int i = 0; i < n / QK4_0; ++i) {
+        int sumi = 0;
+        for (int j = 0; j < QK4_0 / 2; ++j) {
+            const int v0 = (w[i].qs[j] & 0x0F) - 8;
+            const int v1 = (w[i].qs[j] >> 4) - 8;
+            sumi += v0 * x[i].qs[j] + v1 * x[i].qs[j + QK4_0 / 2];
+        }
+        sum += sumi * table[w[i].d] * table[x[i].d];
+    }
+    return sum;
+}
+
+float dot_q8_0_scalar(int n, const void* vw, const void* vx) {
+    const BlockQ8_0* w = static_cast<const BlockQ8_0*>(vw);
+    const BlockQ8_0* x = static_cast<const BlockQ8_0*>(vx);
+    const float* table = fp16_table();
+    float sum = 0.0f;
+
+    for (int i = 0; i < n / QK8_0; ++i) {
+        int sumi = 0;
+        for (int j = 0; j < QK8_0; ++j) {
+            sumi += w[i].qs[j] * x[i].qs[j];
+        }
+        sum += sumi * table[w[i].d] * table[x[i].d];
+    }
+    return sum;
+}
+
+float dot_q4_K_scalar(int n, const void* vw, const void* vx) {
+    const BlockQ4_K* w = static_cast<const BlockQ4_K*>(vw);
+    const BlockQ8_K* x = static_cast<const BlockQ8_K*>(vx);
+    const float* table = fp16_table();
+    float sum = 0.0f;
+
+    for (int i = 0; i < n / QK_K; ++i) {
+        uint8_t sc[8], m[8];
+        int sumi_mins = 0;
+        for (int j = 0; j < 8; ++j) {
+            get_scale_min_k4(j, w[i].scales, sc[j], m[j]);
+            sumi_mins += m[j] * (x[i].bsums[2 * j] + x[i].bsums[2 * j + 1]);
+        }
+
+        int sumi = 0;
+        const uint8_t* q4 = w[i].qs;
+        const int8_t* q8 = x[i].qs;
+        for (int j = 0; j < QK_K / 64; ++j) {
+            int s1 = 0, s2 = 0;
+            for (int k = 0; k < 32; ++k) {
+                s1 += (q4[k] & 0x0F) * q8[k];
+                s2 += (q4[k] >> 4) * q8[k + 32];
+            }
+            sumi += s1 * sc[2 * j] + s2 * sc[2 * j + 1];
+            q4 += 32;
+            q8 += 64;
+        }
+
+        sum += x[i].d * table[w[i].d] * sumi - x[i].d * table[w[i].dmin] * sumi_mins;
+    }
+    return sum;
+}
+
+float dot_q6_K_scalar(int n, const void* vw, const void* vx) {
+    const BlockQ6_K* w = static_cast<const BlockQ6_K*>(vw);
+    const BlockQ8_K* x = static_cast<const BlockQ8_K*>(vx);
+    const float* table = fp16_table();
+    float sum = 0.0f;
+
+    for (int i = 0; i < n / QK_K; ++i) {
+        int8_t q6[QK_K];
+        unpack_q6_K(w[i], q6);
+
+        int sumi = 0;
+        for (int j = 0; j < QK_K / 16; ++j) {
+            int s = 0;
+            for (int k = 0; k < 16; ++k) {
+                s += q6[16 * j + k] * x[i].qs[16 * j + k];
+            }
+            sumi += s * w[i].scales[j];
+        }
+        sum += x[i].d * table[w[i].d] * sumi;
+    }
+    return sum;
+}
+
+float dot_f16_scalar(int n, const void* vw, const void* vx) {
+    const uint16_t* w = static_cast<const uint16_t*>(vw);
+    const float* x = static_cast<const float*>(vx);
+    const float* table = fp16_table();
+    float sum = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        sum += table[w[i]] * x[i];
+    }
+    return sum;
+}
+
+#ifdef QUANT_X86
+
+// ---------------------------------------------------------------------------
+// SSE (SSSE3) kernels
+// ---------------------------------------------------------------------------
+
+SSE_TARGET inline float hsum_sse(__m128 v) {
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_movehdup_ps(v));
+    return _mm_cvtss_f32(v);
+}
+
+// Signed 8-bit dot product of 16 pairs into four 32-bit sums
+SSE_TARGET inline __m128i dot_i8_sse(__m128i a, __m128i b) {
+    const __m128i products = _mm_maddubs_epi16(_mm_sign_epi8(a, a), _mm_sign_epi8(b, a));
+    return _mm_madd_epi16(products, _mm_set1_epi16(1));
+}
+
+SSE_TARGET float dot_q4_0_sse(int n, const void* vw, const void* vx) {
+    const BlockQ4_0* w = static_cast<const BlockQ4_0*>(vw);
+    const BlockQ8_0* x = static_cast<const BlockQ8_0*>(vx);
+    const float* table = fp16_table();
+    const __m128i low_mask = _mm_set1_epi8(0x0F);
+    const __m128i offset = _mm_set1_epi8(8);
+    __m128 acc = _mm_setzero_ps();
+
+    for (int i = 0; i < n / QK4_0; ++i) {
+        const __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w[i].qs));
+        const __m128i lo = _mm_sub_epi8(_mm_and_si128(bits, low_mask), offset);
+        const __m128i hi = _mm_sub_epi8(_mm_and_si128(_mm_srli_epi16(bits, 4), low_mask), offset);
+        const __m128i sumi = _mm_add_epi32(
+            dot_i8_sse(lo, _mm_loadu_si128(reinterpret_cast<const __m128i*>(x[i].qs))),
+            dot_i8_sse(hi, _mm_loadu_si128(reinterpret_cast<const __m128i*>(x[i].qs + 16))));
+        const __m128 d = _mm_set1_ps(table[w[i].d] * table[x[i].d]);
+        acc = _mm_add_ps(acc, _mm_mul_ps(d, _mm_cvtepi32_ps(sumi)));
+    }
+    return hsum_sse(acc);
+}
+
+SSE_TARGET float dot_q8_0_sse(int n, const void* vw, const void* vx) {
+    const BlockQ8_0* w = static_cast<const BlockQ8_0*>(vw);
+    const BlockQ8_0* x = static_cast<const BlockQ8_0*>(vx);
+    const float* table = fp16_table();
+    __m128 acc = _mm_setzero_ps();
+
+    for (int i = 0; i < n / QK8_0; ++i) {
+        const __m128i sumi = _mm_add_epi32(
+            dot_i8_sse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w[i].qs)),
+                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(x[i].qs))),
+            dot_i8_sse(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w[i].qs + 16)),
+                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(x[i].qs + 16))));
+        const __m128 d = _mm_set1_ps(table[w[i].d] * table[x[i].d]);
+        acc = _mm_add_ps(acc, _mm_mul_ps(d, _mm_cvtepi32_ps(sumi)));
+    }
+    return hsum_sse(acc);
+}
+
+SSE_TARGET float dot_q4_K_sse(int n, const void* vw, const void* vx) {
+    const BlockQ4_K* w = static_cast<const BlockQ4_K*>(vw);
+    const BlockQ8_K* x = static_cast<const BlockQ8_K*>(vx);
+    const float* table = fp16_table();
+    const __m128i low_mask = _mm_set1_epi8(0x0F);
+    __m128 acc = _mm_setzero_ps();
+    float mins = 0.0f;
+
+    for (int i = 0; i < n / QK_K; ++i) {
+        uint8_t sc[8], m[8];
+        int sumi_mins = 0;
+        for (int j = 0; j < 8; ++j) {
+            get_scale_min_k4(j, w[i].scales, sc[j], m[j]);
+            sumi_mins += m[j] * (x[i].bsums[2 * j] + x[i].bsums[2 * j + 1]);
+        }
+
+        __m128i sumi = _mm_setzero_si128();
+        const uint8_t* q4 = w[i].qs;
+        const int8_t* q8 = x[i].qs;
+        for (int j = 0; j < QK_K / 64; ++j) {
+            const __m128i bits0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q4));
+            const __m128i bits1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q4 + 16));
+
+            // Nibbles are unsigned, so maddubs can take them directly
+            __m128i lo = _mm_add_epi16(
+                _mm_maddubs_epi16(_mm_and_si128(bits0, low_mask), _mm_loadu_si128(reinterpret_cast<const __m128i*>(q8))),
+                _mm_maddubs_epi16(_mm_and_si128(bits1, low_mask), _mm_loadu_si128(reinterpret_cast<const __m128i*>(q8 + 16))));
+            __m128i hi = _mm_add_epi16(
+                _mm_maddubs_epi16(_mm_and_si128(_mm_srli_epi16(bits0, 4), low_mask),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(q8 + 32))),
+                _mm_maddubs_epi16(_mm_and_si128(_mm_srli_epi16(bits1, 4), low_mask),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(q8 + 48))));
+
+            sumi = _mm_add_epi32(sumi, _mm_madd_epi16(lo, _mm_set1_epi16(sc[2 * j])));
+            sumi = _mm_add_epi32(sumi, _mm_madd_epi16(hi, _mm_set1_epi16(sc[2 * j + 1])));
+            q4 += 32;
+            q8 += 64;
+        }
+
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(x[i].d * table[w[i].d]), _mm_cvtepi32_ps(sumi)));
+        mins += x[i].d * table[w[i].dmin] * sumi_mins;
+    }
+    return hsum_sse(acc) - mins;
+}
+
+SSE_TARGET float dot_f16_sse(int n, const void* vw, const void* vx) {
+    const uint16_t* w = static_cast<const uint16_t*>(vw);
+    const float* x = static_cast<const float*>(vx);
+    const float* table = fp16_table();
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+
+    // No fp16 conversion instruction before F16C, so widen through the table
+    for (int i = 0; i < n; i += 8) {
+        const __m128 w0 = _mm_set_ps(table[w[i + 3]], table[w[i + 2]], table[w[i + 1]], table[w[i]]);
+        const __m128 w1 = _mm_set_ps(table[w[i + 7]], table[w[i + 6]], table[w[i + 5]], table[w[i + 4]]);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(w0, _mm_loadu_ps(x + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(w1, _mm_loadu_ps(x + i + 4)));
+    }
+    return hsum_sse(_mm_add_ps(acc0, acc1));
+}
+
+// ---------------------------------------------------------------------------
+// AVX2 kernels
+// ---------------------------------------------------------------------------
+
+AVX2_TARGET inline float hsum_avx(__m256 v) {
+    __m128 r = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    r = _mm_add_ps(r, _mm_movehl_ps(r, r));
+    r = _mm_add_ss(r, _mm_movehdup_ps(r));
+    return _mm_cvtss_f32(r);
+}
+
+AVX2_TARGET inline __m256 dot_i8_avx2(__m256i a, __m256i b) {
+    const __m256i products = _mm256_maddubs_epi16(_mm256_sign_epi8(a, a), _mm256_sign_epi8(b, a));
+    return _mm256_cvtepi32_ps(_mm256_madd_epi16(products, _mm256_set1_epi16(1)));
+}
+
+AVX2_TARGET float dot_q4_0_avx2(int n, const void* vw, const void* vx) {
+    const BlockQ4_0* w = static_cast<const BlockQ4_0*>(vw);
+    const BlockQ8_0* x = static_cast<const BlockQ8_0*>(vx);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    const __m256i offset = _mm256_set1_epi8(8);
+    __m256 acc = _mm256_setzero_ps();
+
+    for (int i = 0; i < n / QK4_0; ++i) {
+        // Low nibbles in the lower lane, high nibbles in the upper lane
+        const __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w[i].qs));
+        __m256i q = _mm256_set_m128i(_mm_srli_epi16(bits, 4), bits);
+        q = _mm256_sub_epi8(_mm256_and_si256(q, low_mask), offset);
+
+        const __m256 d = _mm256_set1_ps(_cvtsh_ss(w[i].d) * _cvtsh_ss(x[i].d));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x[i].qs));
+        acc = _mm256_fmadd_ps(d, dot_i8_avx2(q, y), acc);
+    }
+    return hsum_avx(acc);
+}
+
+AVX2_TARGET float dot_q8_0_avx2(int n, const void* vw, const void* vx) {
+    const BlockQ8_0* w = static_cast<const BlockQ8_0*>(vw);
+    const BlockQ8_0* x = static_cast<const BlockQ8_0*>(vx);
+    __m256 acc = _mm256_setzero_ps();
+
+    for (int i = 0; i < n / QK8_0; ++i) {
+        const __m256 d = _mm256_set1_ps(_cvtsh_ss(w[i].d) * _cvtsh_ss(x[i].d));
+        const __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w[i].qs));
+        const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x[i].qs));
+        acc = _mm256_fmadd_ps(d, dot_i8_avx2(q, y), acc);
+    }
+    return hsum_avx(acc);
+}
+
+AVX2_TARGET float dot_q4_K_avx2(int n, const void* vw, const void* vx) {
+    const BlockQ4_K* w = static_cast<const BlockQ4_K*>(vw);
+    const BlockQ8_K* x = static_cast<const BlockQ8_K*>(vx);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    __m256 acc = _mm256_setzero_ps();
+    float mins = 0.0f;
+
+    for (int i = 0; i < n / QK_K; ++i) {
+        uint8_t sc[8], m[8];
+        int sumi_mins = 0;
+        for (int j = 0; j < 8; ++j) {
+            get_scale_min_k4(j, w[i].scales, sc[j], m[j]);
+            sumi_mins += m[j] * (x[i].bsums[2 * j] + x[i].bsums[2 * j + 1]);
+        }
+
+        __m256i sumi = _mm256_setzero_si256();
+        const uint8_t* q4 = w[i].qs;
+        const int8_t* q8 = x[i].qs;
+        for (int j = 0; j < QK_K / 64; ++j) {
+            const __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q4));
+            const __m256i lo = _mm256_and_si256(bits, low_mask);
+            const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(bits, 4), low_mask);
+
+            const __m256i p_lo = _mm256_maddubs_epi16(lo, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q8)));
+            const __m256i p_hi = _mm256_maddubs_epi16(hi, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q8 + 32)));
+            sumi = _mm256_add_epi32(sumi, _mm256_madd_epi16(p_lo, _mm256_set1_epi16(sc[2 * j])));
+            sumi = _mm256_add_epi32(sumi, _mm256_madd_epi16(p_hi, _mm256_set1_epi16(sc[2 * j + 1])));
+            q4 += 32;
+            q8 += 64;
+        }
+
+        acc = _mm256_fmadd_ps(_mm256_set1_ps(x[i].d * _cvtsh_ss(w[i].d)), _mm256_cvtepi32_ps(sumi), acc);
+        mins += x[i].d * _cvtsh_ss(w[i].dmin) * sumi_mins;
+    }
+    return hsum_avx(acc) - mins;
+}
+
+AVX2_TARGET float dot_q6_K_avx2(int n, const void* vw, const void* vx) {
+    const BlockQ6_K* w = static_cast<const BlockQ6_K*>(vw);
+    const BlockQ8_K* x = static_cast<const BlockQ8_K*>(vx);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    const __m256i two_bits = _mm256_set1_epi8(0x03);
+    const __m256i offset = _mm256_set1_epi8(32);
+    __m256 acc = _mm256_setzero_ps();
+
+    for (int i = 0; i < n / QK_K; ++i) {
+        const uint8_t* ql = w[i].ql;
+        const uint8_t* qh = w[i].qh;
+        const int8_t* q8 = x[i].qs;
+        const int8_t* sc = w[i].scales;
+        __m256i sumi = _mm256_setzero_si256();
+
+        for (int j = 0; j < QK_K / 128; ++j) {
+            const __m256i bits0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ql));
+            const __m256i bits1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ql + 32));
+            const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(qh));
+
+            // Weights are stored as unsigned 0..63; maddubs takes them as-is and the
+            // 32 offset comes off afterwards as 32 * sum(q8)
+            const __m256i q[4] = {
+                _mm256_or_si256(_mm256_and_si256(bits0, low_mask),
+                                _mm256_slli_epi16(_mm256_and_si256(high, two_bits), 4)),
+                _mm256_or_si256(_mm256_and_si256(bits1, low_mask),
+                                _mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi16(high, 2), two_bits), 4)),
+                _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(bits0, 4), low_mask),
+                                _mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi16(high, 4), two_bits), 4)),
+                _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi16(bits1, 4), low_mask),
+                                _mm256_slli_epi16(_mm256_and_si256(_mm256_srli_epi16(high, 6), two_bits), 4)),
+            };
+
+            for (int k = 0; k < 4; ++k) {
+                const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q8 + 32 * k));
+                const __m256i products = _mm256_sub_epi16(_mm256_maddubs_epi16(q[k], y),
+                                                          _mm256_maddubs_epi16(offset, y));
+                // Each 128-bit lane covers one sub-block of 16
+                const __m256i scales = _mm256_set_m128i(_mm_set1_epi16(sc[2 * k + 1]), _mm_set1_epi16(sc[2 * k]));
+                sumi = _mm256_add_epi32(sumi, _mm256_madd_epi16(products, scales));
+            }
+
+            ql += 64;
+            qh += 32;
+            q8 += 128;
+            sc += 8;
+        }
+
+        acc = _mm256_fmadd_ps(_mm256_set1_ps(x[i].d * _cvtsh_ss(w[i].d)), _mm256_cvtepi32_ps(sumi), acc);
+    }
+    return hsum_avx(acc);
+}
+
+AVX2_TARGET float dot_f16_avx2(int n, const void* vw, const void* vx) {
+    const uint16_t* w = static_cast<const uint16_t*>(vw);
+    const float* x = static_cast<const float*>(vx);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+
+    for (int i = 0; i < n; i += 16) {
+        const __m256 w0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i)));
+        const __m256 w1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(w + i + 8)));
+        acc0 = _mm256_fmadd_ps(w0, _mm256_loadu_ps(x + i), acc0);
+        acc1 = _mm256_fmadd_ps(w1, _mm256_loadu_ps(x + i + 8), acc1);
+    }
+    return hsum_avx(_mm256_add_ps(acc0, acc1));
+}
+
+#endif // QUANT_X86
+
+#ifdef QUANT_NEON
+
+// ---------------------------------------------------------------------------
+// NEON kernels (AArch64)
+// ---------------------------------------------------------------------------
+
+inline int32x4_t dot_i8_neon(int8x16_t a, int8x16_t b) {
+    const int16x8_t lo = vmull_s8(vget_low_s8(a), vget_low_s8(b));
+    const int16x8_t hi = vmull_high_s8(a, b);
+    return vaddq_s32(vpaddlq_s16(lo), vpaddlq_s16(hi));
+}
+
+float dot_q4_0_neon(int n, const void* vw, const void* vx) {
+    const BlockQ4_0* w = static_cast<const BlockQ4_0*>(vw);
+    const BlockQ8_0* x = static_cast<const BlockQ8_0*>(vx);
+    const float* table = fp16_table();
+    const uint8x16_t low_mask = vdupq_n_u8(0x0F);
+    const int8x16_t offset = vdupq_n_s8(8);
+    float32x4_t acc = vdupq_n_f32(0.0f);
+
+    for (int i = 0; i < n / QK4_0; ++i) {
+        const uint8x16_t bits = vld1q_u8(w[i].qs);
+        const int8x16_t lo = vsubq_s8(vreinterpretq_s8_u8(vandq_u8(bits, low_mask)), offset);
+        const int8x16_t hi = vsubq_s8(vreinterpretq_s8_u8(vshrq_n_u8(bits, 4)), offset);
+        const int32x4_t sumi = vaddq_s32(dot_i8_neon(lo, vld1q_s8(x[i].qs)),
+                                         dot_i8_neon(hi, vld1q_s8(x[i].qs + 16)));
+        acc = vmlaq_n_f32(acc, vcvtq_f32_s32(sumi), table[w[i].d] * table[x[i].d]);
+    }
+    return vaddvq_f32(acc);
+}
+
+float dot_q8_0_neon(int n, const void* vw, const void* vx) {
+    const BlockQ8_0* w = static_cast<const BlockQ8_0*>(vw);
+    const BlockQ8_0* x = static_cast<const BlockQ8_0*>(vx);
+    const float* table = fp16_table();
+    float32x4_t acc = vdupq_n_f32(0.0f);
+
+    for (int i = 0; i < n / QK8_0; ++i) {
+        const int32x4_t sumi = vaddq_s32(dot_i8_neon(vld1q_s8(w[i].qs), vld1q_s8(x[i].qs)),
+                                         dot_i8_neon(vld1q_s8(w[i].qs + 16), vld1q_s8(x[i].qs + 16)));
+        acc = vmlaq_n_f32(acc, vcvtq_f32_s32(sumi), table[w[i].d] * table[x[i].d]);
+    }
+    return vaddvq_f32(acc);
+}
+
+float dot_q4_K_neon(int n, const void* vw, const void* vx) {
+    const BlockQ4_K* w = static_cast<const BlockQ4_K*>(vw);
+    const BlockQ8_K* x = static_cast<const BlockQ8_K*>(vx);
+    const float* table = fp16_table();
+    const uint8x16_t low_mask = vdupq_n_u8(0x0F);
+    float sum = 0.0f;
+
+    for (int i = 0; i < n / QK_K; ++i) {
+        uint8_t sc[8], m[8];
+        int sumi_mins = 0;
+        for (int j = 0; j < 8; ++j) {
+            get_scale_min_k4(j, w[i].scales, sc[j], m[j]);
+            sumi_mins += m[j] * (x[i].bsums[2 * j] + x[i].bsums[2 * j + 1]);
+        }
+
+        int32x4_t sumi = vdupq_n_s32(0);
+        const uint8_t* q4 = w[i].qs;
+        const int8_t* q8 = x[i].qs;
+        for (int j = 0; j < QK_K / 64; ++j) {
+            const uint8x16_t bits0 = vld1q_u8(q4);
+            const uint8x16_t bits1 = vld1q_u8(q4 + 16);
+            const int32x4_t lo = vaddq_s32(
+                dot_i8_neon(vreinterpretq_s8_u8(vandq_u8(bits0, low_mask)), vld1q_s8(q8)),
+                dot_i8_neon(vreinterpretq_s8_u8(vandq_u8(bits1, low_mask)), vld1q_s8(q8 + 16)));
+            const int32x4_t hi = vaddq_s32(
+                dot_i8_neon(vreinterpretq_s8_u8(vshrq_n_u8(bits0, 4)), vld1q_s8(q8 + 32)),
+                dot_i8_neon(vreinterpretq_s8_u8(vshrq_n_u8(bits1, 4)), vld1q_s8(q8 + 48)));
+            sumi = vmlaq_n_s32(sumi, lo, sc[2 * j]);
+            sumi = vmlaq_n_s32(sumi, hi, sc[2 * j + 1]);
+            q4 += 32;
+            q8 += 64;
+        }
+
+        sum += x[i].d * table[w[i].d] * vaddvq_s32(sumi) - x[i].d * table[w[i].dmin] * sumi_mins;
+    }
+    return sum;
+}
+
+float dot_f16_neon(int n, const void* vw, const void* vx) {
+    const uint16_t* w = static_cast<const uint16_t*>(vw);
+    const float* x = static_cast<const float*>(vx);
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+
+    for (int i = 0; i < n; i += 8) {
+        const float32x4_t w0 = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(w + i)));
+        const float32x4_t w1 = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(w + i + 4)));
+        acc0 = vfmaq_f32(acc0, w0, vld1q_f32(x + i));
+        acc1 = vfmaq_f32(acc1, w1, vld1q_f32(x + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1));
+}
+
+#endif // QUANT_NEON
+
+} // namespace
+
+std::string format_name(QuantFormat format) {
+    switch (format) {
+        case QuantFormat::Q4_0: return "Q4_0";
+        case QuantFormat::Q8_0: return "Q8_0";
+        case QuantFormat::Q4_K: return "Q4_K";
+        case QuantFormat::Q6_K: return "Q6_K";
+        case QuantFormat::F16: return "F16";
+    }
+    return "unknown";
+}
+
+std::string isa_name(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::SCALAR: return "scalar";
+        case KernelIsa::SSE: return "sse";
+        case KernelIsa::AVX2: return "avx2";
+        case KernelIsa::NEON: return "neon";
+    }
+    return "unknown";
+}
+
+int block_elements(QuantFormat format) {
+    switch (format) {
+        case QuantFormat::Q4_0: return QK4_0;
+        case QuantFormat::Q8_0: return QK8_0;
+        case QuantFormat::Q4_K: return QK_K;
+        case QuantFormat::Q6_K: return QK_K;
+        case QuantFormat::F16: return 16; // Widest SIMD step of the F16 kernels
+    }
+    return 1;
+}
+
+size_t row_size(QuantFormat format, int n) {
+    switch (format) {
+        case QuantFormat::Q4_0: return (n / QK4_0) * sizeof(BlockQ4_0);
+        case QuantFormat::Q8_0: return (n / QK8_0) * sizeof(BlockQ8_0);
+        case QuantFormat::Q4_K: return (n / QK_K) * sizeof(BlockQ4_K);
+        case QuantFormat::Q6_K: return (n / QK_K) * sizeof(BlockQ6_K);
+        case QuantFormat::F16: return n * sizeof(uint16_t);
+    }
+    return 0;
+}
+
+void quantize_row(QuantFormat format, const float* x, void* out, int n) {
+    switch (format) {
+        case QuantFormat::Q4_0:
+            quantize_q4_0(x, static_cast<BlockQ4_0*>(out), n);
+            break;
+        case QuantFormat::Q8_0:
+            quantize_q8_0(x, static_cast<BlockQ8_0*>(out), n);
+            break;
+        case QuantFormat::Q4_K:
+            quantize_q4_K(x, static_cast<BlockQ4_K*>(out), n);
+            break;
+        case QuantFormat::Q6_K:
+            quantize_q6_K(x, static_cast<BlockQ6_K*>(out), n);
+            break;
+        case QuantFormat::F16: {
+            uint16_t* y = static_cast<uint16_t*>(out);
+            for (int i = 0; i < n; ++i) {
+                y[i] = fp32_to_fp16(x[i]);
+            }
+            break;
+        }
+    }
+}
+
+void dequantize_row(QuantFormat format, const void* in, float* y, int n) {
+    const float* table = fp16_table();
+    switch (format) {
+        case QuantFormat::Q4_0: {
+            const BlockQ4_0* x = static_cast<const BlockQ4_0*>(in);
+            for (int i = 0; i < n / QK4_0; ++i) {
+                const float d = table[x[i].d];
+                for (int j = 0; j < QK4_0 / 2; ++j) {
+                    y[i * QK4_0 + j] = ((x[i].qs[j] & 0x0F) - 8) * d;
+                    y[i * QK4_0 + j + QK4_0 / 2] = ((x[i].qs[j] >> 4) - 8) * d;
+                }
+            }
+            break;
+        }
+        case QuantFormat::Q8_0: {
+            const BlockQ8_0* x = static_cast<const BlockQ8_0*>(in);
+            for (int i = 0; i < n / QK8_0; ++i) {
+                const float d = table[x[i].d];
+                for (int j = 0; j < QK8_0; ++j) {
+                    y[i * QK8_0 + j] = x[i].qs[j] * d;
+                }
+            }
+            break;
+        }
+        case QuantFormat::Q4_K: {
+            const BlockQ4_K* x = static_cast<const BlockQ4_K*>(in);
+            for (int i = 0; i < n / QK_K; ++i) {
+                const float d = table[x[i].d];
+                const float dmin = table[x[i].dmin];
+                const uint8_t* q = x[i].qs;
+                float* out = y + i * QK_K;
+                for (int j = 0; j < QK_K / 64; ++j) {
+                    uint8_t sc, m;
+                    get_scale_min_k4(2 * j, x[i].scales, sc, m);
+                    const float d1 = d * sc, m1 = dmin * m;
+                    get_scale_min_k4(2 * j + 1, x[i].scales, sc, m);
+                    const float d2 = d * sc, m2 = dmin * m;
+                    for (int k = 0; k < 32; ++k) {
+                        *out++ = d1 * (q[k] & 0x0F) - m1;
+                    }
+                    for (int k = 0; k < 32; ++k) {
+                        *out++ = d2 * (q[k] >> 4) - m2;
+                    }
+                    q += 32;
+                }
+            }
+            break;
+        }
+        case QuantFormat::Q6_K: {
+            const BlockQ6_K* x = static_cast<const BlockQ6_K*>(in);
+            int8_t q6[QK_K];
+            for (int i = 0; i < n / QK_K; ++i) {
+                const float d = table[x[i].d];
+                unpack_q6_K(x[i], q6);
+                for (int j = 0; j < QK_K; ++j) {
+                    y[i * QK_K + j] = d * x[i].scales[j / 16] * q6[j];
+                }
+            }
+            break;
+        }
+        case QuantFormat::F16: {
+            const uint16_t* x = static_cast<const uint16_t*>(in);
+            for (int i = 0; i < n; ++i) {
+                y[i] = table[x[i]];
+            }
+            break;
+        }
+    }
+}
+
+void quantize_activations(QuantFormat format, const float* x, int n, std::vector<uint8_t>& out) {
+    switch (format) {
+        case QuantFormat::Q4_0:
+        case QuantFormat::Q8_0:
+            out.resize((n / QK8_0) * sizeof(BlockQ8_0));
+            quantize_q8_0(x, reinterpret_cast<BlockQ8_0*>(out.data()), n);
+            break;
+        case QuantFormat::Q4_K:
+        case QuantFormat::Q6_K:
+            out.resize((n / QK_K) * sizeof(BlockQ8_K));
+            quantize_q8_K(x, reinterpret_cast<BlockQ8_K*>(out.data()), n);
+            break;
+        case QuantFormat::F16:
+            out.resize(n * sizeof(float));
+            std::memcpy(out.data(), x, n * sizeof(float));
+            break;
+    }
+}
+
+bool isa_supported(KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::SCALAR:
+            return true;
+#ifdef QUANT_X86
+        case KernelIsa::SSE:
+            return __builtin_cpu_supports("ssse3");
+        case KernelIsa::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+                   __builtin_cpu_supports("f16c");
+#endif
+#ifdef QUANT_NEON
+        case KernelIsa::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+KernelIsa best_isa() {
+    for (KernelIsa isa : {KernelIsa::AVX2, KernelIsa::NEON, KernelIsa::SSE}) {
+        if (isa_supported(isa)) {
+            return isa;
+        }
+    }
+    return KernelIsa::SCALAR;
+}
+
+DotKernel get_dot_kernel(QuantFormat format, KernelIsa isa) {
+    switch (isa) {
+        case KernelIsa::SCALAR:
+            switch (format) {
+                case QuantFormat::Q4_0: return dot_q4_0_scalar;
+                case QuantFormat::Q8_0: return dot_q8_0_scalar;
+                case QuantFormat::Q4_K: return dot_q4_K_scalar;
+                case QuantFormat::Q6_K: return dot_q6_K_scalar;
+                case QuantFormat::F16: return dot_f16_scalar;
+            }
+            break;
+#ifdef QUANT_X86
+        case KernelIsa::SSE:
+            switch (format) {
+                case QuantFormat::Q4_0: return dot_q4_0_sse;
+                case QuantFormat::Q8_0: return dot_q8_0_sse;
+                case QuantFormat::Q4_K: return dot_q4_K_sse;
+                case QuantFormat::Q6_K: return nullptr;
+                case QuantFormat::F16: return dot_f16_sse;
+            }
+            break;
+        case KernelIsa::AVX2:
+            switch (format) {
+                case QuantFormat::Q4_0: return dot_q4_0_avx2;
+                case QuantFormat::Q8_0: return dot_q8_0_avx2;
+                case QuantFormat::Q4_K: return dot_q4_K_avx2;
+                case QuantFormat::Q6_K: return dot_q6_K_avx2;
+                case QuantFormat::F16: return dot_f16_avx2;
+            }
+            break;
+#endif
+#ifdef QUANT_NEON
+        case KernelIsa::NEON:
+            switch (format) {
+                case QuantFormat::Q4_0: return dot_q4_0_neon;
+                case QuantFormat::Q8_0: return dot_q8_0_neon;
+                case QuantFormat::Q4_K: return dot_q4_K_neon;
+                case QuantFormat::Q6_K: return nullptr;
+                case QuantFormat::F16: return dot_f16_neon;
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+void matvec(DotKernel kernel, QuantFormat format, int rows, int cols, const void* w, const void* x, float* y) {
+    const size_t stride = row_size(format, cols);
+    const uint8_t* row = static_cast<const uint8_t*>(w);
+    for (int r = 0; r < rows; ++r) {
+        y[r] = kernel(cols, row + r * stride, x);
+    }
+}
@@ -163,6 +163,13 @@ bool RougeEvaluator::loadModelOutputs(const std::string& filename) {
         json j;
         file >> j;
         
+        // Forced-length responses run past where the model would have stopped
+        if (j.contains("metadata") && j["metadata"].contains("fixed_length")) {
+            std::cerr << "Error: " << filename << " was generated with --fixed-length; "
+                      << "evaluate the outputs of a normal run instead" << std::endl;
+            return false;
+        }
+        
         // Check if there's a "model_outputs" key for the nested structure
         if (j.contains("model_outputs")) {
             // Handle nested structure from benchmark output
@@ -0,0 +1,369 @@
+#include "server_batching.h"
+#include "memory_monitor.h"
+#include "system_utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const int batching_seed = 42;
+
+/**
+ * @brief Aggregate rate of the model's K=1 round, or 0 if it failed
+ */
+double baseline_rate(const std::vector<BatchingRound>& rounds, const std::string& model) {
+    for (const auto& round : rounds) {
+        if (round.model_name == model && round.concurrency == 1) {
+            return round.aggregate_rate();
+        }
+    }
+    return 0.0;
+}
+
+double speedup(const std::vector<BatchingRound>& rounds, const BatchingRound& round) {
+    double baseline = baseline_rate(rounds, round.model_name);
+    return baseline > 0 ? round.aggregate_rate() / baseline : 0.0;
+}
+
+std::string format_factor(double factor) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << factor << "x";
+    return out.str();
+}
+
+} // namespace
+
+double BatchingRound::aggregate_rate() const {
+    return decode_window > 0 ? tokens / decode_window : 0.0;
+}
+
+ServerBatchingBench::ServerBatchingBench(const std::string& prompt_path, const std::string& output_path,
+                                         bool use_memory_mapping)
+    : api("http://localhost:11434", use_memory_mapping),
+      prompt_file(prompt_path),
+      output_file(output_path),
+      levels({1, 2, 4, 8}),
+      num_predict(128),
+      session(std::random_device{}()) {
+    // curl_global_init is not thread-safe; do it before any request thread starts
+    OllamaAPI::initialize();
+}
+
+ServerBatchingBench::~ServerBatchingBench() {
+    OllamaAPI::cleanup();
+}
+
+void ServerBatchingBench::add_model(const std::string& model_name) {
+    models.push_back(model_name);
+}
+
+void ServerBatchingBench::set_levels(const std::vector<int>& concurrency) {
+    levels = {1};
+    for (int level : concurrency) {
+        if (level > 0) {
+            levels.push_back(level);
+        }
+    }
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+}
+
+void ServerBatchingBench::set_num_predict(int tokens) {
+    num_predict = std::max(1, tokens);
+}
+
+BatchingRound ServerBatchingBench::measure(const std::string& model, const std::string& prompt, int concurrency) {
+    BatchingRound round;
+    round.model_name = model;
+    round.concurrency = concurrency;
+    round.completed = 0;
+    round.failed = 0;
+    round.short_requests = 0;
+    round.tokens = 0;
+    round.mean_rate = 0.0;
+    round.min_rate = 0.0;
+    round.mean_ttft = 0.0;
+    round.max_ttft = 0.0;
+    round.memory_growth = 0;
+
+    // Same length cap and no stop sequences; the server can still end a request at EOS
+    json options = {
+        {"num_predict", num_predict},
+        {"seed", batching_seed},
+        {"temperature", 0},
+        {"stop", json::array()}
+    };
+
+    // Tags are taken up front so each request has its own uncached prompt
+    std::vector<std::string> prompts;
+    for (int i = 0; i < concurrency; i++) {
+        prompts.push_back("[" + std::to_string(session++) + "] " + prompt);
+    }
+
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::mutex round_mutex;
+    std::vector<double> rates;
+    std::vector<double> ttfts;
+    double first_token = -1.0;
+    double last_token = 0.0;
+    std::chrono::steady_clock::time_point start_time;
+
+    auto worker = [&](int index) {
+        ready++;
+        while (!go) {
+            std::this_thread::yield();
+        }
+        double sent = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        GenerationMetrics metrics;
+        std::string response = api.generate(model, prompts[index], true, false, &metrics, &options);
+
+        std::lock_guard<std::mutex> lock(round_mutex);
+        if (response.rfind("Error:", 0) == 0 || metrics.eval_count == 0 || metrics.token_times.empty()) {
+            round.failed++;
+            if (round.error.empty()) {
+                round.error = response.rfind("Error:", 0) == 0 ? response : "Error: no tokens generated";
+            }
+            return;
+        }
+        // A request that stopped early did less work and would skew the rates
+        if (metrics.eval_count != num_predict) {
+            round.short_requests++;
+            return;
+        }
+        round.completed++;
+        round.tokens += metrics.eval_count;
+        rates.push_back(metrics.decode_rate());
+        ttfts.push_back(metrics.token_times.front());
+        double first = sent + metrics.token_times.front();
+        double last = sent + metrics.token_times.back();
+        first_token = first_token < 0 ? first : std::min(first_token, first);
+        last_token = std::max(last_token, last);
+    };
+
+    MemoryMonitor memory_monitor("ollama", 50);
+    memory_monitor.start();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < concurrency; i++) {
+        workers.emplace_back(worker, i);
+    }
+    while (ready < concurrency) {
+        std::this_thread::yield();
+    }
+    start_time = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    memory_monitor.stop();
+
+    round.wall_seconds = elapsed.count();
+    round.decode_window = first_token >= 0 ? last_token - first_token : 0.0;
+    if (!rates.empty()) {
+        double rate_sum = 0.0;
+        double ttft_sum = 0.0;
+        for (size_t i = 0; i < rates.size(); i++) {
+            rate_sum += rates[i];
+            ttft_sum += ttfts[i];
+        }
+        round.mean_rate = rate_sum / rates.size();
+        round.min_rate = *std::min_element(rates.begin(), rates.end());
+        round.mean_ttft = ttft_sum / ttfts.size();
+        round.max_ttft = *std::max_element(ttfts.begin(), ttfts.end());
+    }
+    round.peak_memory = memory_monitor.get_peak_memory();
+    return round;
+}
+
+void ServerBatchingBench::run() {
+    if (models.empty()) {
+        std::cerr << "Error: No models specified for the batching benchmark" << std::endl;
+        return;
+    }
+
+    std::ifstream file(prompt_file);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string prompt = buffer.str();
+    if (prompt.empty()) {
+        std::cerr << "Error: Empty prompt or failed to read prompt file" << std::endl;
+        return;
+    }
+
+    std::cout << "========== SERVER BATCHING ==========" << std::endl;
+    std::cout << "Concurrent requests (K):";
+    for (int level : levels) {
+        std::cout << " " << level;
+    }
+    std::cout << std::endl;
+    std::cout << "Output length: " << num_predict << " tokens per request" << std::endl;
+    std::cout << "Requests beyond the server's OLLAMA_NUM_PARALLEL are queued, not batched" << std::endl;
+    std::cout << "=====================================" << std::endl;
+
+    std::vector<BatchingRound> rounds;
+    json idle_memory;
+    for (const auto& model : models) {
+        std::cout << "\nModel: " << model << std::endl;
+
+        // Load the model first so no round includes the load
+        json warmup_options = {{"num_predict", 1}};
+        std::string response = api.generate(model, "Hello", false, false, nullptr, &warmup_options);
+        if (response.rfind("Error:", 0) == 0) {
+            std::cerr << "Error: batching benchmark could not run " << model << ": " << response << std::endl;
+            continue;
+        }
+        idle_memory[model] = get_ollama_memory_usage();
+
+        unsigned long baseline_peak = 0;
+        for (int level : levels) {
+            std::cout << "  K=" << level << "..." << std::flush;
+            BatchingRound round = measure(model, prompt, level);
+            if (level == 1) {
+                baseline_peak = round.peak_memory;
+            }
+            round.memory_growth = baseline_peak > 0
+                ? static_cast<long>(round.peak_memory) - static_cast<long>(baseline_peak) : 0;
+            std::cout << " " << std::fixed << std::setprecision(2) << round.aggregate_rate()
+                      << " tokens/sec aggregate, " << round.mean_rate << " per request"
+                      << std::defaultfloat << std::endl;
+            rounds.push_back(round);
+        }
+        api.unload_model(model);
+    }
+
+    std::cout << "\nSERVER BATCHING EFFICIENCY:" << std::endl;
+    print(rounds);
+
+    if (!output_file.empty()) {
+        std::ofstream out(output_file);
+        if (out.is_open()) {
+            json j;
+            j["metadata"]["prompt_file"] = prompt_file;
+            j["metadata"]["num_predict"] = num_predict;
+            j["metadata"]["concurrency"] = levels;
+            j["metadata"]["idle_memory_kb"] = idle_memory;
+            j["batching"] = to_json(rounds);
+            out << std::setw(4) << j << std::endl;
+            std::cout << "\nJSON results saved to " << output_file << std::endl;
+        } else {
+            std::cerr << "Error: Could not open output file " << output_file << std::endl;
+        }
+    }
+}
+
+void ServerBatchingBench::print(const std::vector<BatchingRound>& rounds) {
+    std::cout << std::left << std::setw(22) << "Model"
+              << std::setw(5) << "K"
+              << std::setw(12) << "Req t/s"
+              << std::setw(12) << "Min req t/s"
+              << std::setw(12) << "Aggregate"
+              << std::setw(9) << "Speedup"
+              << std::setw(11) << "Mean TTFT"
+              << std::setw(10) << "Max TTFT"
+              << std::setw(11) << "Peak RSS"
+              << "Growth" << std::endl;
+    std::cout << std::string(112, '-') << std::endl;
+
+    std::vector<std::string> model_order;
+    for (const auto& round : rounds) {
+        if (std::find(model_order.begin(), model_order.end(), round.model_name) == model_order.end()) {
+            model_order.push_back(round.model_name);
+        }
+        std::string name = round.model_name.size() > 20 ? round.model_name.substr(0, 17) + "..." : round.model_name;
+        std::string growth = (round.memory_growth < 0 ? "-" : "+") + format_memory(static_cast<unsigned long>(std::labs(round.memory_growth)));
+        std::cout << std::left << std::setw(22) << name
+                  << std::setw(5) << round.concurrency
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << round.mean_rate
+                  << std::setw(12) << round.min_rate
+                  << std::setw(12) << round.aggregate_rate()
+                  << std::setw(9) << format_factor(speedup(rounds, round))
+                  << std::setprecision(3)
+                  << std::setw(11) << round.mean_ttft
+                  << std::setw(10) << round.max_ttft
+                  << std::setw(11) << format_memory(round.peak_memory)
+                  << (round.concurrency == 1 ? "-" : growth)
+                  << (round.failed > 0 ? "  (" + std::to_string(round.failed) + " failed)" : "")
+                  << (round.short_requests > 0 ? "  (" + std::to_string(round.short_requests) + " short)" : "")
+                  << std::defaultfloat << std::endl;
+    }
+
+    // Smallest K within 5% of the best aggregate rate: more slots would only add memory
+    for (const auto& model : model_order) {
+        const BatchingRound* best = nullptr;
+        for (const auto& round : rounds) {
+            if (round.model_name == model && round.failed == 0
+                && (!best || round.aggregate_rate() > best->aggregate_rate())) {
+                best = &round;
+            }
+        }
+        if (!best || best->aggregate_rate() <= 0) {
+            continue;
+        }
+        const BatchingRound* pick = best;
+        for (const auto& round : rounds) {
+            if (round.model_name == model && round.failed == 0 && round.concurrency < pick->concurrency
+                && round.aggregate_rate() >= 0.95 * best->aggregate_rate()) {
+                pick = &round;
+            }
+        }
+        std::cout << "  " << model << ": OLLAMA_NUM_PARALLEL=" << pick->concurrency << " ("
+                  << std::fixed << std::setprecision(2) << pick->aggregate_rate() << " tokens/sec aggregate, "
+                  << speedup(rounds, *pick) << "x K=1, " << pick->min_rate << " tokens/sec for the slowest request)"
+                  << std::defaultfloat << std::endl;
+    }
+
+    bool any_short = false;
+    for (const auto& round : rounds) {
+        any_short = any_short || round.short_requests > 0;
+    }
+    if (any_short) {
+        std::cout << "  Short requests stopped at EOS before the output length and are left out of the rates;"
+                  << " use a prompt with a longer answer or a lower --batching-tokens" << std::endl;
+    }
+
+    for (const auto& round : rounds) {
+        if (!round.error.empty()) {
+            std::cout << "  " << round.model_name << " (K=" << round.concurrency << "): " << round.error << std::endl;
+        }
+    }
+}
+
+json ServerBatchingBench::to_json(const std::vector<BatchingRound>& rounds) {
+    json j = json::array();
+    for (const auto& round : rounds) {
+        json entry = {
+            {"model", round.model_name},
+            {"concurrency", round.concurrency},
+            {"completed", round.completed},
+            {"failed", round.failed},
+            {"short_requests", round.short_requests},
+            {"tokens", round.tokens},
+            {"wall_s", round.wall_seconds},
+            {"decode_window_s", round.decode_window},
+            {"request_tokens_per_second_mean", round.mean_rate},
+            {"request_tokens_per_second_min", round.min_rate},
+            {"aggregate_tokens_per_second", round.aggregate_rate()},
+            {"speedup", speedup(rounds, round)},
+            {"ttft_mean_s", round.mean_ttft},
+            {"ttft_max_s", round.max_ttft},
+            {"peak_memory_kb", round.peak_memory},
+            {"memory_growth_kb", round.memory_growth}
+        };
+        if (!round.error.empty()) {
+            entry["error"] = round.error;
+        }
+        j.push_back(entry);
+    }
+    return j;
+}
@@ -0,0 +1,322 @@
+#include "storage_probe.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using json = nlohmann::json;
+
+namespace {
+
+const size_t direct_alignment = 4096;
+
+bool is_directory(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void drop_cache(int fd) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+}
+
+} // namespace
+
+StorageProbe::StorageProbe(const std::string& dir, size_t block_kb, unsigned long long size_mb)
+    : models_dir(dir.empty() ? default_models_dir() : dir),
+      block_size(std::max<size_t>(4, block_kb) * 1024),
+      max_bytes(std::max<unsigned long long>(1, size_mb) * 1024 * 1024),
+      target_size(0),
+      scratch_file(false) {
+}
+
+StorageProbe::~StorageProbe() {
+    if (scratch_file) {
+        unlink(target_file.c_str());
+    }
+}
+
+const std::string& StorageProbe::get_models_dir() const {
+    return models_dir;
+}
+
+std::string StorageProbe::default_models_dir() {
+    const char* env = std::getenv("OLLAMA_MODELS");
+    if (env && *env) {
+        return env;
+    }
+    const char* home = std::getenv("HOME");
+    if (home && is_directory(std::string(home) + "/.ollama/models")) {
+        return std::string(home) + "/.ollama/models";
+    }
+    // Default for the systemd service installed by the Linux install script
+    return "/usr/share/ollama/.ollama/models";
+}
+
+std::string StorageProbe::find_model_blob(const std::string& models_dir, const std::string& model, unsigned long long& size) {
+    size = 0;
+
+    // "name:tag", "namespace/name:tag" or "host/namespace/name:tag"
+    std::string name = model;
+    std::string tag = "latest";
+    size_t colon = model.rfind(':');
+    if (colon != std::string::npos && model.find('/', colon) == std::string::npos) {
+        name = model.substr(0, colon);
+        tag = model.substr(colon + 1);
+    }
+    int slashes = std::count(name.begin(), name.end(), '/');
+    if (slashes == 0) {
+        name = "registry.ollama.ai/library/" + name;
+    } else if (slashes == 1) {
+        name = "registry.ollama.ai/" + name;
+    }
+
+    std::ifstream manifest(models_dir + "/manifests/" + name + "/" + tag);
+    if (!manifest.is_open()) {
+        return "";
+    }
+
+    json j = json::parse(manifest, nullptr, false);
+    if (j.is_discarded() || !j.contains("layers")) {
+        return "";
+    }
+
+    for (const auto& layer : j["layers"]) {
+        if (layer.value("mediaType", "") == "application/vnd.ollama.image.model") {
+            std::string digest = layer.value("digest", "");
+            std::replace(digest.begin(), digest.end(), ':', '-');
+            size = layer.value("size", 0ULL);
+            return models_dir + "/blobs/" + digest;
+        }
+    }
+    return "";
+}
+
+bool StorageProbe::prepare() {
+    // Largest blob is almost certainly model weights and big enough to defeat readahead
+    std::string blobs_dir = models_dir + "/blobs";
+    if (DIR* dir = opendir(blobs_dir.c_str())) {
+        while (struct dirent* entry = readdir(dir)) {
+            std::string path = blobs_dir + "/" + entry->d_name;
+            struct stat info;
+            if (entry->d_name[0] != '.' && stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode) &&
+                static_cast<unsigned long long>(info.st_size) > target_size) {
+                target_file = path;
+                target_size = info.st_size;
+            }
+        }
+        closedir(dir);
+    }
+
+    if (!target_file.empty() && target_size >= block_size) {
+        return true;
+    }
+
+    // No blobs: write a scratch file on the same filesystem
+    std::string base = is_directory(models_dir) ? models_dir : "/var/tmp";
+    target_file = base + "/.edge_ai_benchmark_storage_probe";
+    target_size = max_bytes;
+
+    int fd = open(target_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        std::cerr << "Error: Could not create " << target_file << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    scratch_file = true;
+
+    std::vector<char> buffer(block_size);
+    std::mt19937 rng(42);
+    for (auto& byte : buffer) {
+        byte = static_cast<char>(rng());
+    }
+    for (unsigned long long written = 0; written < target_size; written += buffer.size()) {
+        if (write(fd, buffer.data(), buffer.size()) != static_cast<ssize_t>(buffer.size())) {
+            std::cerr << "Error: Could not write " << target_file << ": " << strerror(errno) << std::endl;
+            close(fd);
+            return false;
+        }
+    }
+    fdatasync(fd);
+    close(fd);
+
+    std::cout << "No model blobs found in " << models_dir << ", using scratch file " << target_file << std::endl;
+    return true;
+}
+
+std::vector<unsigned long long> StorageProbe::random_offsets(unsigned long long bytes) const {
+    unsigned long long blocks = target_size / block_size;
+    unsigned long long count = std::min(blocks, std::max(1ULL, bytes / block_size));
+
+    std::vector<unsigned long long> offsets;
+    std::mt19937_64 rng(1234);
+    std::uniform_int_distribution<unsigned long long> pick(0, blocks - 1);
+    for (unsigned long long i = 0; i < count; ++i) {
+        offsets.push_back(pick(rng) * block_size);
+    }
+    return offsets;
+}
+
+bool StorageProbe::measure_buffered(bool sequential, StorageMeasurement& out) {
+    int fd = open(target_file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    drop_cache(fd);
+    posix_fadvise(fd, 0, 0, sequential ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM);
+
+    std::vector<char> buffer(block_size);
+    unsigned long long total = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    if (sequential) {
+        unsigned long long limit = std::min(max_bytes, target_size);
+        while (total < limit) {
+            ssize_t n = read(fd, buffer.data(), block_size);
+            if (n <= 0) break;
+            total += n;
+        }
+    } else {
+        for (auto offset : random_offsets(std::min(max_bytes, target_size) / 4)) {
+            ssize_t n = pread(fd, buffer.data(), block_size, offset);
+            if (n <= 0) break;
+            total += n;
+        }
+    }
+
+    out.seconds = seconds_since(start);
+    out.bytes = total;
+    close(fd);
+    return total > 0;
+}
+
+bool StorageProbe::measure_direct(bool sequential, StorageMeasurement& out) {
+    int fd = open(target_file.c_str(), O_RDONLY | O_DIRECT);
+    if (fd < 0) {
+        // tmpfs and some FUSE filesystems refuse O_DIRECT
+        std::cerr << "Warning: O_DIRECT not supported on " << models_dir << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    void* buffer = nullptr;
+    if (posix_memalign(&buffer, direct_alignment, block_size) != 0) {
+        close(fd);
+        return false;
+    }
+
+    unsigned long long total = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    if (sequential) {
+        // Only whole blocks, the unaligned tail would fail with EINVAL
+        unsigned long long limit = std::min(max_bytes, target_size / block_size * block_size);
+        for (unsigned long long offset = 0; offset < limit; offset += block_size) {
+            ssize_t n = pread(fd, buffer, block_size, offset);
+            if (n <= 0) break;
+            total += n;
+        }
+    } else {
+        for (auto offset : random_offsets(std::min(max_bytes, target_size) / 4)) {
+            ssize_t n = pread(fd, buffer, block_size, offset);
+            if (n <= 0) break;
+            total += n;
+        }
+    }
+
+    out.seconds = seconds_since(start);
+    out.bytes = total;
+    free(buffer);
+    close(fd);
+    return total > 0;
+}
+
+bool StorageProbe::measure_mmap(bool sequential, StorageMeasurement& out) {
+    int fd = open(target_file.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    drop_cache(fd);
+
+    void* mapped = mmap(nullptr, target_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    madvise(mapped, target_size, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+
+    const volatile char* bytes = static_cast<const char*>(mapped);
+    long page = sysconf(_SC_PAGESIZE);
+    unsigned long long total = 0;
+    char sink = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    // Touch one byte per page so every page faults in from storage
+    if (sequential) {
+        unsigned long long limit = std::min(max_bytes, target_size);
+        for (unsigned long long offset = 0; offset < limit; offset += page) {
+            sink ^= bytes[offset];
+        }
+        total = limit;
+    } else {
+        for (auto offset : random_offsets(std::min(max_bytes, target_size) / 4)) {
+            for (unsigned long long p = 0; p < block_size; p += page) {
+                sink ^= bytes[offset + p];
+            }
+            total += block_size;
+        }
+    }
+
+    out.seconds = seconds_since(start);
+    out.bytes = total;
+    (void)sink;
+    munmap(mapped, target_size);
+    close(fd);
+    return total > 0;
+}
+
+std::vector<StorageMeasurement> StorageProbe::run() {
+    std::vector<StorageMeasurement> measurements;
+    if (!prepare()) {
+        return measurements;
+    }
+
+    std::cout << "Storage probe: " << target_file << " (" << target_size / 1048576 << " MB), block size "
+              << block_size / 1024 << " KB" << std::endl;
+
+    if (block_size % direct_alignment != 0) {
+        std::cerr << "Warning: block size is not a multiple of " << direct_alignment
+                  << " bytes, skipping O_DIRECT" << std::endl;
+    }
+
+    for (const std::string method : {"buffered", "direct", "mmap"}) {
+        for (bool sequential : {true, false}) {
+            StorageMeasurement measurement{method, sequential ? "sequential" : "random", block_size, 0, 0.0};
+            bool ok = false;
+            if (method == "buffered") {
+                ok = measure_buffered(sequential, measurement);
+            } else if (method == "direct") {
+                ok = block_size % direct_alignment == 0 && measure_direct(sequential, measurement);
+            } else {
+                ok = measure_mmap(sequential, measurement);
+            }
+
+            if (ok) {
+                measurements.push_back(measurement);
+            } else if (method == "direct") {
+                break; // Random O_DIRECT would fail the same way
+            }
+        }
+    }
+
+    return measurements;
+}
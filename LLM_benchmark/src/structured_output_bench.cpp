@@ -0,0 +1,253 @@
+#include "structured_output_bench.h"
+#include "json_stream_validator.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+
+namespace {
+
+const int structured_seed = 42;
+
+// Modes in the order they run and print; the first is the baseline
+const char* const modes[] = {"free", "json", "schema"};
+
+// Sums over the runs of one model and mode
+struct ModeTotals {
+    int runs = 0;
+    int valid = 0;
+    int schema_ok = 0;
+    int tokens = 0;
+    double decode_seconds = 0.0;
+    double ttft_seconds = 0.0;
+
+    double ms_per_token() const {
+        return tokens > 0 ? 1000.0 * decode_seconds / tokens : 0.0;
+    }
+    double mean_ttft() const {
+        return runs > 0 ? ttft_seconds / runs : 0.0;
+    }
+};
+
+} // namespace
+
+double StructuredRun::ms_per_token() const {
+    return output_tokens > 0 ? 1000.0 * decode_seconds / output_tokens : 0.0;
+}
+
+StructuredOutputBench::StructuredOutputBench(const json& output_schema, int num_predict)
+    : schema(output_schema),
+      max_tokens(std::max(1, num_predict)),
+      session(std::random_device{}()) {
+}
+
+json StructuredOutputBench::default_schema() {
+    return {
+        {"type", "object"},
+        {"properties", {
+            {"summary", {{"type", "string"}}},
+            {"key_points", {{"type", "array"}, {"items", {{"type", "string"}}}}},
+            {"confidence", {{"type", "string"}, {"enum", {"low", "medium", "high"}}}}
+        }},
+        {"required", {"summary", "key_points", "confidence"}}
+    };
+}
+
+bool StructuredOutputBench::load_schema(const std::string& path, json& schema) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open schema file " << path << std::endl;
+        return false;
+    }
+    json j = json::parse(file, nullptr, false);
+    if (j.is_discarded() || !j.is_object()) {
+        std::cerr << "Error: " << path << " is not a JSON schema object" << std::endl;
+        return false;
+    }
+    schema = j;
+    return true;
+}
+
+std::vector<StructuredRun> StructuredOutputBench::run(OllamaAPI& api, const std::string& model,
+                                                      const std::vector<std::pair<std::string, std::string>>& sections) {
+    std::vector<StructuredRun> runs;
+    json options = {
+        {"num_predict", max_tokens},
+        {"seed", structured_seed},
+        {"temperature", 0}
+    };
+
+    // Load the model first so the first section does not include the load
+    json warmup_options = {{"num_predict", 1}};
+    std::string response = api.generate(model, "Hello", false, false, nullptr, &warmup_options);
+    if (response.rfind("Error:", 0) == 0) {
+        std::cerr << "Error: structured output benchmark could not run " << model << ": " << response << std::endl;
+        return runs;
+    }
+
+    // The same instruction in every mode, so only the constraint differs
+    const std::string instruction = "\n\nAnswer only with a JSON object that matches this JSON schema:\n" + schema.dump();
+
+    for (const auto& section : sections) {
+        for (const char* mode : modes) {
+            json format = nullptr;
+            if (std::string(mode) == "json") {
+                format = "json";
+            } else if (std::string(mode) == "schema") {
+                format = schema;
+            }
+
+            JsonStreamValidator validator;
+            int pieces = 0;
+            int invalid_at = 0;
+            auto on_piece = [&validator, &pieces, &invalid_at](const std::string& piece) {
+                pieces++;
+                if (invalid_at == 0 && validator.feed(piece) == JsonStreamValidator::Status::Invalid) {
+                    invalid_at = pieces;
+                }
+            };
+
+            std::string prompt = "[" + std::to_string(session++) + "]\n" + section.second + instruction;
+            GenerationMetrics metrics;
+            response = api.generate_structured(model, prompt, format, &metrics, &options, on_piece);
+
+            StructuredRun result;
+            result.model_name = model;
+            result.section = section.first;
+            result.mode = mode;
+            result.ok = response.rfind("Error:", 0) != 0;
+            result.prompt_tokens = metrics.prompt_eval_count;
+            result.prefill_seconds = metrics.prompt_eval_duration;
+            result.ttft_seconds = metrics.token_times.empty() ? 0.0 : metrics.token_times.front();
+            result.output_tokens = metrics.eval_count;
+            result.decode_seconds = metrics.eval_duration;
+            result.invalid_at_piece = 0;
+            result.valid_json = false;
+            result.schema_ok = false;
+
+            if (!result.ok) {
+                result.error = response;
+            } else if (validator.finish() != JsonStreamValidator::Status::Complete) {
+                result.invalid_at_piece = invalid_at > 0 ? invalid_at : pieces;
+                result.error = validator.error() + " at byte " + std::to_string(validator.error_offset());
+            } else {
+                std::string problem;
+                result.schema_ok = check_output(response, schema, result.valid_json, problem);
+                result.invalid_at_piece = result.valid_json ? 0 : pieces;
+                result.error = problem;
+            }
+            runs.push_back(result);
+        }
+    }
+    return runs;
+}
+
+bool StructuredOutputBench::check_output(const std::string& text, const json& schema, bool& parsed,
+                                         std::string& problem) {
+    json value = json::parse(text, nullptr, false);
+    parsed = !value.is_discarded();
+    if (!parsed) {
+        problem = "not valid JSON (rejected by the parser)";
+        return false;
+    }
+    return JsonStreamValidator::matches_schema(value, schema, problem);
+}
+
+void StructuredOutputBench::print(const std::vector<StructuredRun>& runs) {
+    std::map<std::pair<std::string, std::string>, ModeTotals> totals;
+    std::vector<std::string> model_order;
+    for (const auto& run : runs) {
+        if (std::find(model_order.begin(), model_order.end(), run.model_name) == model_order.end()) {
+            model_order.push_back(run.model_name);
+        }
+        if (!run.ok) {
+            continue;
+        }
+        ModeTotals& total = totals[{run.model_name, run.mode}];
+        total.runs++;
+        total.valid += run.valid_json ? 1 : 0;
+        total.schema_ok += run.schema_ok ? 1 : 0;
+        total.tokens += run.output_tokens;
+        total.decode_seconds += run.decode_seconds;
+        total.ttft_seconds += run.ttft_seconds;
+    }
+
+    std::cout << std::left << std::setw(20) << "Model"
+              << std::setw(8) << "Mode"
+              << std::setw(7) << "Runs"
+              << std::setw(8) << "Valid"
+              << std::setw(8) << "Schema"
+              << std::setw(10) << "ms/tok"
+              << std::setw(11) << "Overhead"
+              << std::setw(10) << "TTFT s"
+              << "TTFT change" << std::endl;
+    std::cout << std::string(94, '-') << std::endl;
+
+    for (const auto& model : model_order) {
+        const ModeTotals& base = totals[{model, modes[0]}];
+        for (const char* mode : modes) {
+            const ModeTotals& total = totals[{model, mode}];
+            std::stringstream overhead;
+            std::stringstream ttft_change;
+            if (mode != modes[0] && base.ms_per_token() > 0 && total.runs > 0) {
+                overhead << std::showpos << std::fixed << std::setprecision(1)
+                         << 100.0 * (total.ms_per_token() / base.ms_per_token() - 1.0) << "%";
+                ttft_change << std::showpos << std::fixed << std::setprecision(1)
+                            << 1000.0 * (total.mean_ttft() - base.mean_ttft()) << " ms";
+            } else {
+                overhead << "-";
+                ttft_change << "-";
+            }
+            std::cout << std::left << std::setw(20) << model
+                      << std::setw(8) << mode
+                      << std::setw(7) << total.runs
+                      << std::setw(8) << (std::to_string(total.valid) + "/" + std::to_string(total.runs))
+                      << std::setw(8) << (std::to_string(total.schema_ok) + "/" + std::to_string(total.runs))
+                      << std::setw(10) << std::fixed << std::setprecision(2) << total.ms_per_token()
+                      << std::setw(11) << overhead.str()
+                      << std::setw(10) << std::setprecision(3) << total.mean_ttft()
+                      << ttft_change.str() << std::defaultfloat << std::endl;
+        }
+    }
+
+    for (const auto& run : runs) {
+        if (!run.error.empty() && run.mode != modes[0]) {
+            std::cout << "  " << run.model_name << " / " << run.section << " / " << run.mode << ": " << run.error;
+            if (run.invalid_at_piece > 0) {
+                std::cout << " (piece " << run.invalid_at_piece << ")";
+            }
+            std::cout << std::endl;
+        }
+    }
+}
+
+json StructuredOutputBench::to_json(const std::vector<StructuredRun>& runs) {
+    json j = json::array();
+    for (const auto& run : runs) {
+        json entry = {
+            {"model", run.model_name},
+            {"section", run.section},
+            {"mode", run.mode},
+            {"ok", run.ok},
+            {"prompt_tokens", run.prompt_tokens},
+            {"prefill_s", run.prefill_seconds},
+            {"ttft_s", run.ttft_seconds},
+            {"output_tokens", run.output_tokens},
+            {"decode_s", run.decode_seconds},
+            {"ms_per_token", run.ms_per_token()},
+            {"valid_json", run.valid_json},
+            {"schema_ok", run.schema_ok}
+        };
+        if (run.invalid_at_piece > 0) {
+            entry["invalid_at_piece"] = run.invalid_at_piece;
+        }
+        if (!run.error.empty()) {
+            entry["error"] = run.error;
+        }
+        j.push_back(entry);
+    }
+    return j;
+}
@@ -3,91 +3,151 @@
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
-#include <unistd.h> // For geteuid()
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+#include <vector>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/swap.h>
+#include <unistd.h> // For geteuid() and sysconf()
 
 bool configure_swap(unsigned long swap_size_mb, int swappiness) {
-    // Check if we have root privileges (will need sudo otherwise)
-    bool is_root = (geteuid() == 0);
-    std::string sudo_prefix = is_root ? "" : "sudo ";
+    const std::string swap_file = "/swapfile";
     
     std::cout << "Configuring swap file (" << swap_size_mb << "MB) with swappiness " << swappiness << std::endl;
     
-    try {
-        // Check if swap already exists
-        std::string check_cmd = "free -m | grep Swap | awk '{print $2}'";
-        FILE* check_pipe = popen(check_cmd.c_str(), "r");
-        if (!check_pipe) return false;
-        
-        char buffer[128];
-        std::string existing_swap;
-        if (fgets(buffer, sizeof(buffer), check_pipe) != nullptr) {
-            existing_swap = buffer;
-            existing_swap.erase(existing_swap.find_last_not_of(" \n\r\t") + 1);
-        }
-        pclose(check_pipe);
+    if (geteuid() != 0) {
+        std::cerr << "Swap configuration writes to /proc/sys and needs root; re-run with sudo" << std::endl;
+        return false;
+    }
+    
+    // Check if swap already exists
+    unsigned long current_swap = get_swap_stats().swap_total_kb / 1024;
+    
+    if (current_swap >= swap_size_mb) {
+        std::cout << "Sufficient swap already exists (" << current_swap << "MB)" << std::endl;
+    } else {
+        // Create or resize swap file
+        std::cout << "Creating/modifying swap file..." << std::endl;
         
-        unsigned long current_swap = std::stoul(existing_swap);
+        // Release our swap file if it is already in use so it can be resized
+        disable_swap_file(swap_file);
         
-        if (current_swap >= swap_size_mb) {
-            std::cout << "Sufficient swap already exists (" << current_swap << "MB)" << std::endl;
-        } else {
-            // Create or resize swap file
-            std::cout << "Creating/modifying swap file..." << std::endl;
-            
-            // Disable existing swap if any
-            if (current_swap > 0) {
-                std::string cmd1 = sudo_prefix + "swapoff -a";
-                if (system(cmd1.c_str()) != 0) {
-                    std::cerr << "Failed to disable existing swap" << std::endl;
-                    return false;
-                }
-            }
-            
-            // Create swap file
-            std::string cmd2 = sudo_prefix + "fallocate -l " + std::to_string(swap_size_mb) + "M /swapfile";
-            if (system(cmd2.c_str()) != 0) {
-                std::cerr << "Failed to create swap file" << std::endl;
-                return false;
-            }
-            
-            // Set permissions
-            std::string cmd3 = sudo_prefix + "chmod 600 /swapfile";
-            if (system(cmd3.c_str()) != 0) {
-                std::cerr << "Failed to set swap file permissions" << std::endl;
-                return false;
-            }
-            
-            // Make swap
-            std::string cmd4 = sudo_prefix + "mkswap /swapfile";
-            if (system(cmd4.c_str()) != 0) {
-                std::cerr << "Failed to make swap file" << std::endl;
-                return false;
-            }
-            
-            // Enable swap
-            std::string cmd5 = sudo_prefix + "swapon /swapfile";
-            if (system(cmd5.c_str()) != 0) {
-                std::cerr << "Failed to enable swap file" << std::endl;
-                return false;
-            }
-            
-            std::cout << "Swap file created and enabled (" << swap_size_mb << "MB)" << std::endl;
+        if (!create_swap_file(swap_file, swap_size_mb)) {
+            std::cerr << "Failed to create swap file" << std::endl;
+            return false;
         }
         
-        // Set swappiness
-        std::string cmd6 = sudo_prefix + "sysctl -w vm.swappiness=" + std::to_string(swappiness);
-        if (system(cmd6.c_str()) != 0) {
-            std::cerr << "Failed to set swappiness" << std::endl;
+        if (!enable_swap_file(swap_file)) {
+            std::cerr << "Failed to enable swap file" << std::endl;
             return false;
         }
         
-        std::cout << "Swappiness set to " << swappiness << std::endl;
-        return true;
-        
-    } catch (const std::exception& e) {
-        std::cerr << "Error configuring swap: " << e.what() << std::endl;
+        std::cout << "Swap file created and enabled (" << swap_size_mb << "MB)" << std::endl;
+    }
+    
+    // Set swappiness
+    if (!write_system_value("/proc/sys/vm/swappiness", std::to_string(swappiness))) {
+        std::cerr << "Failed to set swappiness" << std::endl;
+        return false;
+    }
+    
+    std::cout << "Swappiness set to " << swappiness << std::endl;
+    return true;
+}
+
+std::string read_system_value(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return "";
+    }
+    
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string value = buffer.str();
+    value.erase(value.find_last_not_of(" \n\r\t") + 1);
+    return value;
+}
+
+bool write_system_value(const std::string& path, const std::string& value) {
+    // Write with a single write(2) so sysfs/procfs see the whole value at once
+    int fd = open(path.c_str(), O_WRONLY | O_TRUNC);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    std::string data = value + "\n";
+    ssize_t written = write(fd, data.data(), data.size());
+    int saved_errno = errno;
+    close(fd);
+    
+    if (written != static_cast<ssize_t>(data.size())) {
+        std::cerr << "Cannot write '" << value << "' to " << path << ": " 
+                  << std::strerror(saved_errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool create_swap_file(const std::string& path, unsigned long size_mb) {
+    const long page_size = sysconf(_SC_PAGESIZE);
+    const unsigned long long size_bytes = static_cast<unsigned long long>(size_mb) * 1024 * 1024;
+    const unsigned long long pages = size_bytes / page_size;
+    
+    if (pages < 10) {
+        std::cerr << "Swap file of " << size_mb << "MB is too small" << std::endl;
+        return false;
+    }
+    
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        std::cerr << "Cannot create " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    // Reserve the blocks up front; swapon rejects files with holes
+    int alloc_err = posix_fallocate(fd, 0, static_cast<off_t>(pages * page_size));
+    if (alloc_err != 0) {
+        std::cerr << "Cannot allocate " << size_mb << "MB for " << path << ": " 
+                  << std::strerror(alloc_err) << std::endl;
+        close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+    
+    // Equivalent of mkswap: a version 1 header in the first page,
+    // terminated by the SWAPSPACE2 signature in its last 10 bytes
+    std::vector<unsigned char> header(page_size, 0);
+    uint32_t version = 1;
+    uint32_t last_page = static_cast<uint32_t>(pages - 1);
+    uint32_t bad_pages = 0;
+    std::memcpy(&header[1024], &version, sizeof(version));
+    std::memcpy(&header[1028], &last_page, sizeof(last_page));
+    std::memcpy(&header[1032], &bad_pages, sizeof(bad_pages));
+    std::memcpy(&header[page_size - 10], "SWAPSPACE2", 10);
+    
+    bool ok = pwrite(fd, header.data(), header.size(), 0) == static_cast<ssize_t>(header.size()) 
+              && fsync(fd) == 0;
+    if (!ok) {
+        std::cerr << "Cannot write swap header to " << path << ": " << std::strerror(errno) << std::endl;
+    }
+    close(fd);
+    return ok;
+}
+
+bool enable_swap_file(const std::string& path) {
+    if (swapon(path.c_str(), 0) != 0) {
+        std::cerr << "swapon " << path << " failed: " << std::strerror(errno) << std::endl;
         return false;
     }
+    return true;
+}
+
+bool disable_swap_file(const std::string& path) {
+    return swapoff(path.c_str()) == 0;
 }
 
 std::pair<unsigned long, unsigned long> get_system_memory() {
@@ -102,8 +162,8 @@ std::pair<unsigned long, unsigned long> get_system_memory() {
             if (line.substr(0, 9) == "MemTotal:") {
                 std::stringstream ss(line.substr(9));
                 ss >> total_mem;
-            } else if (line.substr(0, 12) == "MemAvailable:") {
-                std::stringstream ss(line.substr(12));
+            } else if (line.substr(0, 13) == "MemAvailable:") {
+                std::stringstream ss(line.substr(13));
                 ss >> available_mem;
             }
         }
@@ -114,6 +174,68 @@ std::pair<unsigned long, unsigned long> get_system_memory() {
     return {total_mem / 1024, available_mem / 1024};
 }
 
+SwapStats get_swap_stats() {
+    SwapStats stats;
+    
+    std::ifstream vmstat("/proc/vmstat");
+    if (vmstat.is_open()) {
+        std::string key;
+        unsigned long value;
+        while (vmstat >> key >> value) {
+            if (key == "pswpin") {
+                stats.pages_swapped_in = value;
+            } else if (key == "pswpout") {
+                stats.pages_swapped_out = value;
+            }
+        }
+        vmstat.close();
+    }
+    
+    std::ifstream meminfo("/proc/meminfo");
+    if (meminfo.is_open()) {
+        std::string line;
+        while (std::getline(meminfo, line)) {
+            if (line.substr(0, 10) == "SwapTotal:") {
+                std::stringstream ss(line.substr(10));
+                ss >> stats.swap_total_kb;
+            } else if (line.substr(0, 9) == "SwapFree:") {
+                std::stringstream ss(line.substr(9));
+                ss >> stats.swap_free_kb;
+            }
+        }
+        meminfo.close();
+    }
+    
+    return stats;
+}
+
+SwapActivity swap_activity_between(const SwapStats& before, const SwapStats& after) {
+    SwapActivity activity;
+    
+    // Counters only grow, but guard against a reset between snapshots
+    if (after.pages_swapped_in >= before.pages_swapped_in) {
+        activity.pages_in = after.pages_swapped_in - before.pages_swapped_in;
+    }
+    if (after.pages_swapped_out >= before.pages_swapped_out) {
+        activity.pages_out = after.pages_swapped_out - before.pages_swapped_out;
+    }
+    
+    long used_before = static_cast<long>(before.swap_total_kb) - static_cast<long>(before.swap_free_kb);
+    long used_after = static_cast<long>(after.swap_total_kb) - static_cast<long>(after.swap_free_kb);
+    activity.swap_used_delta_kb = used_after - used_before;
+    
+    if (before.swap_free_kb > after.swap_free_kb) {
+        activity.peak_swap_growth_kb = before.swap_free_kb - after.swap_free_kb;
+    }
+    
+    return activity;
+}
+
+unsigned long pages_to_kb(unsigned long pages) {
+    static const unsigned long page_kb = static_cast<unsigned long>(sysconf(_SC_PAGESIZE)) / 1024;
+    return pages * page_kb;
+}
+
 unsigned long get_ollama_memory_usage() {
     unsigned long total_memory = 0;
     
@@ -130,6 +252,44 @@ unsigned long get_ollama_memory_usage() {
     return total_memory;
 }
 
+std::vector<int> find_process_ids(const std::string& name) {
+    std::vector<int> pids;
+    
+    DIR* proc = opendir("/proc");
+    if (!proc) {
+        return pids;
+    }
+    
+    struct dirent* entry;
+    while ((entry = readdir(proc)) != nullptr) {
+        if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+            continue;
+        }
+        
+        std::ifstream comm_file(std::string("/proc/") + entry->d_name + "/comm");
+        std::string comm;
+        if (comm_file.is_open() && std::getline(comm_file, comm) && comm == name) {
+            pids.push_back(std::atoi(entry->d_name));
+        }
+    }
+    closedir(proc);
+    
+    return pids;
+}
+
+bool make_directories(const std::string& dir) {
+    for (size_t pos = 1; pos <= dir.size(); pos++) {
+        if (pos == dir.size() || dir[pos] == '/') {
+            std::string prefix = dir.substr(0, pos);
+            if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+                std::cerr << "Error: Cannot create " << prefix << ": " << std::strerror(errno) << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 std::string format_memory(unsigned long memory_kb) {
     if (memory_kb > 1024*1024) {
         return std::to_string(memory_kb / (1024*1024)) + " GB";
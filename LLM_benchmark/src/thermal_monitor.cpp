@@ -0,0 +1,193 @@
+#include "thermal_monitor.h"
+#include "system_utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <glob.h>
+
+namespace {
+
+std::vector<std::string> glob_paths(const std::string& pattern) {
+    std::vector<std::string> paths;
+    glob_t matches;
+    if (glob(pattern.c_str(), 0, nullptr, &matches) == 0) {
+        for (size_t i = 0; i < matches.gl_pathc; ++i) {
+            paths.push_back(matches.gl_pathv[i]);
+        }
+    }
+    globfree(&matches);
+    return paths;
+}
+
+// Parse a whole sysfs value; zones can return text or an error instead of a number
+bool parse_long(const std::string& text, long long& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return errno == 0 && end != text.c_str() && *end == '\0';
+}
+
+} // namespace
+
+ThermalMonitor::ThermalMonitor(const std::string& root, int interval_ms, double ratio)
+    : should_run(false), sysfs_root(root == "/" ? "" : root), sample_interval_ms(interval_ms),
+      throttle_ratio(ratio), start_time(std::chrono::steady_clock::now()), throttle_events(0) {
+    discover();
+}
+
+ThermalMonitor::~ThermalMonitor() {
+    stop();
+}
+
+void ThermalMonitor::discover() {
+    zone_paths = glob_paths(sysfs_root + "/sys/class/thermal/thermal_zone*/temp");
+
+    // The policy limit rather than cpuinfo_max_freq, which is the single-core turbo
+    // frequency that all cores under sustained load never reach
+    for (const auto& cpufreq : glob_paths(sysfs_root + "/sys/devices/system/cpu/cpu[0-9]*/cpufreq")) {
+        long long max_khz = 0;
+        if (!parse_long(read_system_value(cpufreq + "/scaling_max_freq"), max_khz) || max_khz <= 0) {
+            continue;
+        }
+        cpu_paths.push_back({cpufreq + "/scaling_cur_freq", static_cast<unsigned long>(max_khz)});
+    }
+
+    throttle_paths = glob_paths(sysfs_root + "/sys/devices/system/cpu/cpu[0-9]*/thermal_throttle/*_throttle_count");
+    throttle_events = read_throttle_count();
+}
+
+unsigned long long ThermalMonitor::read_throttle_count() const {
+    unsigned long long total = 0;
+    for (const auto& path : throttle_paths) {
+        long long count = 0;
+        if (parse_long(read_system_value(path), count) && count > 0) {
+            total += static_cast<unsigned long long>(count);
+        }
+    }
+    return total;
+}
+
+bool ThermalMonitor::available() const {
+    return !zone_paths.empty() || !cpu_paths.empty();
+}
+
+ThermalSample ThermalMonitor::take_sample(bool boundary) {
+    ThermalSample sample{0.0, 0.0, 0.0, 0.0, false, boundary};
+    sample.time_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    // Zones report millidegrees Celsius
+    for (const auto& path : zone_paths) {
+        long long millidegrees = 0;
+        if (parse_long(read_system_value(path), millidegrees)) {
+            sample.max_temp_c = std::max(sample.max_temp_c, millidegrees / 1000.0);
+        }
+    }
+
+    int cpus = 0;
+    double freq_sum_khz = 0.0;
+    for (const auto& [cur_path, max_khz] : cpu_paths) {
+        long long cur_khz = 0;
+        if (!parse_long(read_system_value(cur_path), cur_khz) || cur_khz < 0 || max_khz == 0) {
+            continue;
+        }
+        freq_sum_khz += cur_khz;
+        sample.freq_ratio = std::max(sample.freq_ratio, static_cast<double>(cur_khz) / max_khz);
+        cpus++;
+    }
+
+    // A boundary sample sees the CPUs idling between requests, so only the
+    // kernel's throttle counters count there, not the frequency
+    if (cpus > 0) {
+        sample.mean_freq_mhz = freq_sum_khz / cpus / 1000.0;
+        sample.throttled = !boundary && sample.freq_ratio < throttle_ratio;
+    } else {
+        sample.freq_ratio = 1.0;
+    }
+
+    if (!throttle_paths.empty()) {
+        unsigned long long count = read_throttle_count();
+        std::lock_guard<std::mutex> lock(mtx);
+        if (count > throttle_events) {
+            sample.throttled = true;
+            throttle_events = count;
+        }
+    }
+
+    return sample;
+}
+
+void ThermalMonitor::monitor_thermal() {
+    while (should_run) {
+        ThermalSample sample = take_sample(false);
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            samples.push_back(sample);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(sample_interval_ms));
+    }
+}
+
+void ThermalMonitor::start() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!should_run) {
+        should_run = true;
+        samples.clear();
+        throttle_events = read_throttle_count();
+        start_time = std::chrono::steady_clock::now();
+        monitor_thread = std::thread(&ThermalMonitor::monitor_thermal, this);
+    }
+}
+
+void ThermalMonitor::stop() {
+    should_run = false;
+
+    if (monitor_thread.joinable()) {
+        monitor_thread.join();
+    }
+}
+
+double ThermalMonitor::sample_now() {
+    ThermalSample sample = take_sample(true);
+    std::lock_guard<std::mutex> lock(mtx);
+    // Keep the timeline ordered when racing the monitor thread
+    auto pos = std::upper_bound(samples.begin(), samples.end(), sample.time_s,
+                                [](double t, const ThermalSample& s) { return t < s.time_s; });
+    samples.insert(pos, sample);
+    return sample.time_s;
+}
+
+ThermalSummary ThermalMonitor::summarize(double from_s, double to_s) {
+    ThermalSummary summary;
+    double freq_sum = 0.0;
+    int running_samples = 0;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& sample : samples) {
+        if (sample.time_s < from_s || sample.time_s > to_s) {
+            continue;
+        }
+        summary.samples++;
+        if (sample.throttled) {
+            summary.throttled_samples++;
+        }
+        summary.max_temp_c = std::max(summary.max_temp_c, sample.max_temp_c);
+        if (!sample.boundary) {
+            summary.min_freq_ratio = std::min(summary.min_freq_ratio, sample.freq_ratio);
+            freq_sum += sample.mean_freq_mhz;
+            running_samples++;
+        }
+    }
+
+    if (running_samples > 0) {
+        summary.mean_freq_mhz = freq_sum / running_samples;
+    }
+    return summary;
+}
+
+std::vector<ThermalSample> ThermalMonitor::get_samples() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return samples;
+}
@@ -0,0 +1,573 @@
+#include "tokenizer.h"
+#include <iostream>
+#include <queue>
+#include <algorithm>
+#include <iterator>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+const std::string SPACE_MARKER = "\xE2\x96\x81"; // U+2581 LOWER ONE EIGHTH BLOCK
+
+constexpr int TOKEN_TYPE_CONTROL = 3;
+constexpr int TOKEN_TYPE_BYTE = 6;
+
+size_t utf8_length(unsigned char lead) {
+    if (lead < 0x80) return 1;
+    if ((lead >> 5) == 0x6) return 2;
+    if ((lead >> 4) == 0xE) return 3;
+    if ((lead >> 3) == 0x1E) return 4;
+    return 1; // Stray continuation byte
+}
+
+std::string utf8_encode(uint32_t cp) {
+    std::string out;
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    return out;
+}
+
+// Code point at text[pos] (U+FFFD for malformed sequences); length receives its byte count
+uint32_t utf8_decode(const std::string& text, size_t pos, size_t& length) {
+    unsigned char lead = static_cast<unsigned char>(text[pos]);
+    length = std::min(utf8_length(lead), text.size() - pos);
+    if (length == 1) {
+        return lead < 0x80 ? lead : 0xFFFD;
+    }
+    uint32_t cp = lead & (0x7F >> length);
+    for (size_t k = 1; k < length; ++k) {
+        cp = (cp << 6) | (static_cast<unsigned char>(text[pos + k]) & 0x3F);
+    }
+    return cp;
+}
+
+// GPT-2's printable stand-in for each byte, so byte-level tokens are valid UTF-8
+uint32_t byte_to_codepoint(unsigned char byte) {
+    static uint32_t table[256];
+    static bool ready = [] {
+        uint32_t next = 256;
+        for (int b = 0; b < 256; ++b) {
+            bool printable = (b >= 33 && b <= 126) || (b >= 161 && b <= 172) || (b >= 174);
+            table[b] = printable ? b : next++;
+        }
+        return true;
+    }();
+    (void)ready;
+    return table[byte];
+}
+
+enum CharClass { LETTER, DIGIT, SPACE, OTHER };
+
+// \p{L}, \p{N} and \s of the pre-split patterns; exact for ASCII, by block otherwise
+CharClass classify(uint32_t cp) {
+    if (cp < 0x80) {
+        if ((cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z')) return LETTER;
+        if (cp >= '0' && cp <= '9') return DIGIT;
+        if (cp == ' ' || (cp >= '\t' && cp <= '\r')) return SPACE;
+        return OTHER;
+    }
+    if (cp == 0x85 || cp == 0xA0 || cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200A) ||
+        cp == 0x2028 || cp == 0x2029 || cp == 0x202F || cp == 0x205F || cp == 0x3000) {
+        return SPACE;
+    }
+    if ((cp >= 0x0660 && cp <= 0x0669) || (cp >= 0x06F0 && cp <= 0x06F9) || (cp >= 0x0966 && cp <= 0x096F) ||
+        (cp >= 0xFF10 && cp <= 0xFF19) || cp == 0xB2 || cp == 0xB3 || cp == 0xB9 || (cp >= 0xBC && cp <= 0xBE)) {
+        return DIGIT;
+    }
+    if ((cp >= 0xA1 && cp <= 0xBF) || cp == 0xD7 || cp == 0xF7 || (cp >= 0x2010 && cp <= 0x2027) ||
+        (cp >= 0x2030 && cp <= 0x205E) || (cp >= 0x20A0 && cp <= 0x20CF) || (cp >= 0x2190 && cp <= 0x2BFF) ||
+        (cp >= 0x3001 && cp <= 0x3003) || (cp >= 0x3008 && cp <= 0x301F) || (cp >= 0xFE30 && cp <= 0xFE4F) ||
+        (cp >= 0xFF01 && cp <= 0xFF0F) || (cp >= 0xFF1A && cp <= 0xFF20) || (cp >= 0x1F000 && cp <= 0x1FAFF) ||
+        cp == 0xFFFD) {
+        return OTHER;
+    }
+    return LETTER;
+}
+
+struct Symbol {
+    int prev;
+    int next;
+    size_t start;
+    size_t length;
+};
+
+struct Bigram {
+    int left;
+    int right;
+    float score;
+    size_t length;
+
+    // Highest score first, leftmost first on ties
+    bool operator<(const Bigram& other) const {
+        return score < other.score || (score == other.score && left > other.left);
+    }
+};
+
+uint64_t pair_key(int left, int right) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(left)) << 32) | static_cast<uint32_t>(right);
+}
+
+} // namespace
+
+Tokenizer::Tokenizer()
+    : model(Model::SPM), bos_id(1), eos_id(2), eot_id(-1), unk_id(0), add_bos(true),
+      add_space_prefix(true), llama3_split(false) {
+    std::fill(std::begin(byte_tokens), std::end(byte_tokens), -1);
+}
+
+bool Tokenizer::load(const GgufFile& file) {
+    std::string name = file.get_string("tokenizer.ggml.model");
+    if (name == "llama") {
+        model = Model::SPM;
+    } else if (name == "gpt2") {
+        model = Model::BPE;
+    } else {
+        std::cerr << "Error: Tokenizer model '" << name << "' is not supported (expected 'llama' or 'gpt2')" << std::endl;
+        return false;
+    }
+
+    const json& metadata = file.get_metadata();
+    auto tokens = metadata.find("tokenizer.ggml.tokens");
+    if (tokens == metadata.end() || !tokens->is_array() || tokens->empty()) {
+        std::cerr << "Error: " << file.get_path() << " has no tokenizer vocabulary" << std::endl;
+        return false;
+    }
+
+    pieces = tokens->get<std::vector<std::string>>();
+    scores.assign(pieces.size(), 0.0f);
+    types.assign(pieces.size(), 1);
+
+    auto score_values = metadata.find("tokenizer.ggml.scores");
+    if (score_values != metadata.end() && score_values->size() == pieces.size()) {
+        scores = score_values->get<std::vector<float>>();
+    }
+    auto type_values = metadata.find("tokenizer.ggml.token_type");
+    if (type_values != metadata.end() && type_values->size() == pieces.size()) {
+        types = type_values->get<std::vector<int>>();
+    }
+
+    // pieces is not resized from here on, so the views stay valid
+    piece_ids.clear();
+    piece_ids.reserve(pieces.size());
+    std::fill(std::begin(byte_tokens), std::end(byte_tokens), -1);
+    for (size_t i = 0; i < pieces.size(); ++i) {
+        if (model == Model::SPM && types[i] == TOKEN_TYPE_BYTE) {
+            unsigned int byte = 0;
+            if (std::sscanf(pieces[i].c_str(), "<0x%02X>", &byte) == 1 && byte < 256) {
+                byte_tokens[byte] = static_cast<int>(i);
+            }
+            continue;
+        }
+        piece_ids.emplace(pieces[i], static_cast<int>(i));
+    }
+
+    if (model == Model::BPE) {
+        char_bytes.clear();
+        for (int b = 0; b < 256; ++b) {
+            uint32_t cp = byte_to_codepoint(static_cast<unsigned char>(b));
+            char_bytes[cp] = static_cast<unsigned char>(b);
+            auto it = piece_ids.find(utf8_encode(cp));
+            byte_tokens[b] = it != piece_ids.end() ? it->second : -1;
+        }
+        if (!load_merges(metadata)) {
+            std::cerr << "Error: " << file.get_path() << " has no BPE merges" << std::endl;
+            return false;
+        }
+        std::string pre = file.get_string("tokenizer.ggml.pre", "default");
+        llama3_split = pre == "llama-bpe" || pre == "llama3" || pre == "smaug-bpe";
+    }
+
+    bos_id = static_cast<int>(file.get_int("tokenizer.ggml.bos_token_id", 1));
+    eos_id = static_cast<int>(file.get_int("tokenizer.ggml.eos_token_id", 2));
+    eot_id = static_cast<int>(file.get_int("tokenizer.ggml.eot_token_id", -1));
+    unk_id = static_cast<int>(file.get_int("tokenizer.ggml.unknown_token_id", 0));
+    auto bos_flag = metadata.find("tokenizer.ggml.add_bos_token");
+    bool default_bos = model == Model::SPM;
+    add_bos = bos_flag != metadata.end() && bos_flag->is_boolean() ? bos_flag->get<bool>() : default_bos;
+    auto prefix_flag = metadata.find("tokenizer.ggml.add_space_prefix");
+    bool default_prefix = model == Model::SPM;
+    add_space_prefix = prefix_flag != metadata.end() && prefix_flag->is_boolean() ? prefix_flag->get<bool>() : default_prefix;
+
+    return true;
+}
+
+bool Tokenizer::load_merges(const json& metadata) {
+    auto values = metadata.find("tokenizer.ggml.merges");
+    if (values == metadata.end() || !values->is_array()) {
+        return false;
+    }
+
+    merges.clear();
+    merges.reserve(values->size());
+    int rank = 0;
+    for (const auto& value : *values) {
+        const std::string& merge = value.get_ref<const std::string&>();
+        // Pieces never contain a plain space (it is mapped to U+0120), so the first one separates them
+        size_t split = merge.find(' ', 1);
+        if (split == std::string::npos) {
+            rank++;
+            continue;
+        }
+        auto left = piece_ids.find(std::string_view(merge).substr(0, split));
+        auto right = piece_ids.find(std::string_view(merge).substr(split + 1));
+        auto merged = piece_ids.find(merge.substr(0, split) + merge.substr(split + 1));
+        if (left != piece_ids.end() && right != piece_ids.end() && merged != piece_ids.end()) {
+            merges.emplace(pair_key(left->second, right->second), std::make_pair(rank, merged->second));
+        }
+        rank++;
+    }
+    return !merges.empty();
+}
+
+std::vector<int> Tokenizer::encode(const std::string& input, bool with_bos) const {
+    std::vector<int> ids;
+    if (with_bos && add_bos) {
+        ids.push_back(bos_id);
+    }
+    if (input.empty()) {
+        return ids;
+    }
+
+    if (model == Model::BPE) {
+        encode_bpe(input, ids);
+    } else {
+        encode_spm(input, ids);
+    }
+    return ids;
+}
+
+size_t Tokenizer::count(const std::string& text) const {
+    return encode(text, false).size();
+}
+
+void Tokenizer::encode_spm(const std::string& input, std::vector<int>& ids) const {
+    std::string text;
+    text.reserve(input.size() * 2);
+    if (add_space_prefix) {
+        text += SPACE_MARKER;
+    }
+    for (char c : input) {
+        if (c == ' ') {
+            text += SPACE_MARKER;
+        } else {
+            text += c;
+        }
+    }
+    const std::string_view view(text);
+
+    std::vector<Symbol> symbols;
+    symbols.reserve(text.size());
+    for (size_t pos = 0; pos < text.size();) {
+        size_t length = std::min(utf8_length(static_cast<unsigned char>(text[pos])), text.size() - pos);
+        int index = static_cast<int>(symbols.size());
+        symbols.push_back({index - 1, index + 1, pos, length});
+        pos += length;
+    }
+    symbols.back().next = -1;
+
+    std::priority_queue<Bigram> queue;
+    auto try_add = [&](int left, int right) {
+        if (left < 0 || right < 0) {
+            return;
+        }
+        size_t length = symbols[left].length + symbols[right].length;
+        auto it = piece_ids.find(view.substr(symbols[left].start, length));
+        if (it != piece_ids.end()) {
+            queue.push({left, right, scores[it->second], length});
+        }
+    };
+
+    for (size_t i = 1; i < symbols.size(); ++i) {
+        try_add(static_cast<int>(i) - 1, static_cast<int>(i));
+    }
+
+    while (!queue.empty()) {
+        Bigram bigram = queue.top();
+        queue.pop();
+
+        Symbol& left = symbols[bigram.left];
+        Symbol& right = symbols[bigram.right];
+        // Skip pairs invalidated by an earlier merge
+        if (left.length == 0 || right.length == 0 || left.length + right.length != bigram.length) {
+            continue;
+        }
+
+        left.length += right.length;
+        right.length = 0;
+        left.next = right.next;
+        if (right.next >= 0) {
+            symbols[right.next].prev = bigram.left;
+        }
+
+        try_add(left.prev, bigram.left);
+        try_add(bigram.left, left.next);
+    }
+
+    for (int i = 0; i >= 0; i = symbols[i].next) {
+        const std::string_view piece = view.substr(symbols[i].start, symbols[i].length);
+        auto it = piece_ids.find(piece);
+        if (it != piece_ids.end()) {
+            ids.push_back(it->second);
+            continue;
+        }
+        for (unsigned char byte : piece) {
+            ids.push_back(byte_tokens[byte] >= 0 ? byte_tokens[byte] : unk_id);
+        }
+    }
+}
+
+std::vector<std::pair<size_t, size_t>> Tokenizer::split_words(const std::string& text) const {
+    // Decode once; offsets has a sentinel at the end
+    std::vector<uint32_t> cps;
+    std::vector<size_t> offsets;
+    std::vector<CharClass> classes;
+    cps.reserve(text.size());
+    offsets.reserve(text.size() + 1);
+    classes.reserve(text.size());
+    for (size_t pos = 0; pos < text.size();) {
+        size_t length;
+        uint32_t cp = utf8_decode(text, pos, length);
+        cps.push_back(cp);
+        offsets.push_back(pos);
+        classes.push_back(classify(cp));
+        pos += length;
+    }
+    const size_t n = cps.size();
+    offsets.push_back(text.size());
+
+    auto lower = [](uint32_t cp) { return cp >= 'A' && cp <= 'Z' ? cp + 32 : cp; };
+    auto is_newline = [&](size_t k) { return cps[k] == '\n' || cps[k] == '\r'; };
+
+    std::vector<std::pair<size_t, size_t>> words;
+    size_t i = 0;
+    auto emit = [&](size_t end) {
+        words.emplace_back(offsets[i], offsets[end] - offsets[i]);
+        i = end;
+    };
+
+    while (i < n) {
+        // 's 't 're 've 'm 'll 'd (case-insensitive in the Llama 3 pattern)
+        if (cps[i] == '\'' && i + 1 < n) {
+            auto at = [&](size_t k) { return k < n ? (llama3_split ? lower(cps[k]) : cps[k]) : 0; };
+            uint32_t a = at(i + 1), b = at(i + 2);
+            if ((a == 'r' && b == 'e') || (a == 'v' && b == 'e') || (a == 'l' && b == 'l')) {
+                emit(i + 3);
+                continue;
+            }
+            if (a == 's' || a == 't' || a == 'm' || a == 'd') {
+                emit(i + 2);
+                continue;
+            }
+        }
+
+        // Letters with one leading space (GPT-2) or one leading non-letter, non-digit, non-newline (Llama 3)
+        size_t j = i;
+        if (i + 1 < n && classes[i + 1] == LETTER &&
+            (llama3_split ? (classes[i] == OTHER || (classes[i] == SPACE && !is_newline(i))) : cps[i] == ' ')) {
+            j = i + 1;
+        }
+        if (classes[j] == LETTER) {
+            while (j < n && classes[j] == LETTER) {
+                j++;
+            }
+            emit(j);
+            continue;
+        }
+
+        // Digits: one leading space and any run (GPT-2), or runs of at most three (Llama 3)
+        if (llama3_split) {
+            if (classes[i] == DIGIT) {
+                j = i;
+                while (j < n && j < i + 3 && classes[j] == DIGIT) {
+                    j++;
+                }
+                emit(j);
+                continue;
+            }
+        } else {
+            j = cps[i] == ' ' && i + 1 < n && classes[i + 1] == DIGIT ? i + 1 : i;
+            if (classes[j] == DIGIT) {
+                while (j < n && classes[j] == DIGIT) {
+                    j++;
+                }
+                emit(j);
+                continue;
+            }
+        }
+
+        // Punctuation and symbols with one leading space (Llama 3 also takes trailing newlines)
+        j = cps[i] == ' ' && i + 1 < n && classes[i + 1] == OTHER ? i + 1 : i;
+        if (classes[j] == OTHER) {
+            while (j < n && classes[j] == OTHER) {
+                j++;
+            }
+            while (llama3_split && j < n && is_newline(j)) {
+                j++;
+            }
+            emit(j);
+            continue;
+        }
+
+        // Whitespace: up to the last newline (Llama 3), else all of it but the space before the next word
+        size_t end = i;
+        while (end < n && classes[end] == SPACE) {
+            end++;
+        }
+        if (llama3_split) {
+            size_t last_newline = end;
+            for (size_t k = i; k < end; ++k) {
+                if (is_newline(k)) {
+                    last_newline = k;
+                }
+            }
+            if (last_newline < end) {
+                emit(last_newline + 1);
+                continue;
+            }
+        }
+        if (end < n && end - i > 1) {
+            end--;
+        }
+        emit(std::max(end, i + 1));
+    }
+    return words;
+}
+
+void Tokenizer::merge_word(const std::string& text, size_t start, size_t length, std::vector<int>& out) const {
+    std::vector<int> symbols;
+    symbols.reserve(length);
+    for (size_t k = 0; k < length; ++k) {
+        int id = byte_tokens[static_cast<unsigned char>(text[start + k])];
+        symbols.push_back(id >= 0 ? id : unk_id);
+    }
+
+    // Words are short, so a rescan per merge beats maintaining a heap
+    while (symbols.size() > 1) {
+        int best_rank = INT_MAX;
+        int best_id = -1;
+        size_t best = 0;
+        for (size_t k = 0; k + 1 < symbols.size(); ++k) {
+            auto it = merges.find(pair_key(symbols[k], symbols[k + 1]));
+            if (it != merges.end() && it->second.first < best_rank) {
+                best_rank = it->second.first;
+                best_id = it->second.second;
+                best = k;
+            }
+        }
+        if (best_id < 0) {
+            break;
+        }
+        symbols[best] = best_id;
+        symbols.erase(symbols.begin() + best + 1);
+    }
+    out.insert(out.end(), symbols.begin(), symbols.end());
+}
+
+void Tokenizer::encode_bpe(const std::string& input, std::vector<int>& ids) const {
+    // Repeated words (most of them, in running text) are merged once
+    std::unordered_map<std::string_view, std::vector<int>> cache;
+    const std::string_view view(input);
+    std::vector<int> word_ids;
+
+    for (const auto& [start, length] : split_words(input)) {
+        const std::string_view word = view.substr(start, length);
+        auto cached = cache.find(word);
+        if (cached != cache.end()) {
+            ids.insert(ids.end(), cached->second.begin(), cached->second.end());
+            continue;
+        }
+
+        word_ids.clear();
+        bool whole = false;
+        if (llama3_split) {
+            // Llama 3 skips merging when the whole word is a token
+            std::string mapped;
+            for (unsigned char byte : word) {
+                mapped += utf8_encode(byte_to_codepoint(byte));
+            }
+            auto it = piece_ids.find(mapped);
+            if (it != piece_ids.end()) {
+                word_ids.push_back(it->second);
+                whole = true;
+            }
+        }
+        if (!whole) {
+            merge_word(input, start, length, word_ids);
+        }
+        ids.insert(ids.end(), word_ids.begin(), word_ids.end());
+        cache.emplace(word, word_ids);
+    }
+}
+
+std::string Tokenizer::decode(int token) const {
+    if (token < 0 || token >= static_cast<int>(pieces.size()) || types[token] == TOKEN_TYPE_CONTROL) {
+        return "";
+    }
+    const std::string& piece = pieces[token];
+
+    if (model == Model::BPE) {
+        std::string text;
+        for (size_t pos = 0; pos < piece.size();) {
+            size_t length;
+            uint32_t cp = utf8_decode(piece, pos, length);
+            auto it = char_bytes.find(cp);
+            if (it != char_bytes.end()) {
+                text += static_cast<char>(it->second);
+            } else {
+                text.append(piece, pos, length);
+            }
+            pos += length;
+        }
+        return text;
+    }
+
+    if (types[token] == TOKEN_TYPE_BYTE) {
+        return std::string(1, static_cast<char>(std::strtol(piece.c_str() + 3, nullptr, 16)));
+    }
+
+    std::string text;
+    for (size_t pos = 0; pos < piece.size();) {
+        if (piece.compare(pos, SPACE_MARKER.size(), SPACE_MARKER) == 0) {
+            text += ' ';
+            pos += SPACE_MARKER.size();
+        } else {
+            text += piece[pos++];
+        }
+    }
+    return text;
+}
+
+bool Tokenizer::is_end(int token) const {
+    return token == eos_id || (eot_id >= 0 && token == eot_id);
+}
+
+std::string Tokenizer::kind() const {
+    return model == Model::BPE ? "bpe" : "spm";
+}
+
+int Tokenizer::vocab_size() const {
+    return static_cast<int>(pieces.size());
+}
+
+int Tokenizer::bos() const {
+    return bos_id;
+}
+
+int Tokenizer::eos() const {
+    return eos_id;
+}
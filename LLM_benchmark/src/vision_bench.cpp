@@ -0,0 +1,281 @@
+#include "vision_bench.h"
+#include "memory_monitor.h"
+#include "system_utils.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <dirent.h>
+
+namespace {
+
+const int vision_seed = 42;
+
+/**
+ * @brief Lower-case extension of a file name, without the dot
+ */
+std::string extension(const std::string& name) {
+    size_t dot = name.find_last_of('.');
+    std::string ext = dot == std::string::npos ? "" : name.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext;
+}
+
+} // namespace
+
+long VisionPoint::pixels() const {
+    return static_cast<long>(width) * height;
+}
+
+double VisionPoint::decode_rate() const {
+    return decode_seconds > 0 ? output_tokens / decode_seconds : 0.0;
+}
+
+VisionBench::VisionBench(const std::string& directory, const std::vector<int>& sweep_sizes, int num_predict,
+                         int threads, const std::string& cache_dir)
+    : image_dir(directory),
+      max_tokens(std::max(1, num_predict)),
+      session(std::random_device{}()),
+      pipeline(threads, cache_dir),
+      prepared(false) {
+    for (int size : sweep_sizes) {
+        if (size > 0) {
+            sizes.push_back(size);
+        }
+    }
+}
+
+std::vector<int> VisionBench::default_sizes() {
+    return {224, 448, 672, 896};
+}
+
+const std::string& VisionBench::prompt() {
+    static const std::string text = "Describe this image in two sentences.";
+    return text;
+}
+
+void VisionBench::prepare_payloads() {
+    prepared = true;
+    std::vector<std::string> names;
+    if (!image_dir.empty()) {
+        DIR* dir = opendir(image_dir.c_str());
+        if (!dir) {
+            std::cerr << "Error: Could not open image directory " << image_dir << std::endl;
+        } else {
+            while (struct dirent* entry = readdir(dir)) {
+                std::string ext = extension(entry->d_name);
+                if (ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "ppm") {
+                    names.push_back(entry->d_name);
+                }
+            }
+            closedir(dir);
+            std::sort(names.begin(), names.end());
+            if (names.empty()) {
+                std::cerr << "Warning: no PNG, JPEG or PPM images in " << image_dir << std::endl;
+            }
+        }
+    }
+
+    // Every file as it is, then every size of the files a decoder can read (or of the pattern)
+    std::vector<ImageJob> jobs;
+    std::vector<ImageJob> scalable;
+    for (const auto& name : names) {
+        std::string path = image_dir + "/" + name;
+        jobs.push_back({name, path, 0});
+        if (pipeline.can_decode(path)) {
+            scalable.push_back({name, path, 0});
+        }
+    }
+    if (scalable.empty()) {
+        scalable.push_back({"pattern", "", 0});
+    }
+    for (int size : sizes) {
+        for (const auto& source : scalable) {
+            jobs.push_back({source.name, source.path, size});
+        }
+    }
+
+    for (auto& payload : pipeline.prepare(jobs)) {
+        if (payload.ok) {
+            payloads.push_back(std::move(payload));
+        } else {
+            std::cerr << "Warning: skipping " << payload.name << ": " << payload.error << std::endl;
+        }
+    }
+}
+
+VisionPoint VisionBench::measure(OllamaAPI& api, const std::string& model, const ImagePayload& payload,
+                                 int text_tokens, double text_prefill) {
+    json options = {
+        {"num_predict", max_tokens},
+        {"seed", vision_seed},
+        {"temperature", 0}
+    };
+    std::string tagged = "[" + std::to_string(session++) + "] " + prompt();
+
+    MemoryMonitor memory_monitor("ollama", 50);
+    memory_monitor.start();
+    GenerationMetrics metrics;
+    std::string response = api.generate_with_images(model, tagged, {payload.base64}, &metrics, &options);
+    memory_monitor.stop();
+
+    VisionPoint point;
+    point.model_name = model;
+    point.image = payload.name;
+    point.native = payload.native;
+    point.width = payload.width;
+    point.height = payload.height;
+    point.payload_bytes = payload.encoded_bytes;
+    point.ok = response.rfind("Error:", 0) != 0;
+    point.prompt_tokens = metrics.prompt_eval_count;
+    point.image_tokens = std::max(0, metrics.prompt_eval_count - text_tokens);
+    point.prefill_seconds = metrics.prompt_eval_duration;
+    point.vision_seconds = std::max(0.0, metrics.prompt_eval_duration - text_prefill);
+    point.ttft_seconds = metrics.token_times.empty() ? 0.0 : metrics.token_times.front();
+    point.output_tokens = metrics.eval_count;
+    point.decode_seconds = metrics.eval_duration;
+    point.peak_memory = memory_monitor.get_peak_memory();
+    if (!point.ok) {
+        point.error = response;
+    }
+    return point;
+}
+
+std::vector<VisionPoint> VisionBench::run(OllamaAPI& api, const std::string& model) {
+    std::vector<VisionPoint> points;
+    if (!prepared) {
+        prepare_payloads();
+    }
+
+    // Load the model and its vision projector before anything is timed
+    json warmup_options = {{"num_predict", 1}};
+    std::string response = api.generate_with_images(model, "Hello", {base64_encode(encode_png(test_pattern(64, 64)))},
+                                                    nullptr, &warmup_options);
+    if (response.rfind("Error:", 0) == 0) {
+        std::cerr << "Error: vision benchmark could not run " << model << ": " << response << std::endl;
+        return points;
+    }
+
+    // The same prompt without an image: what prompt eval costs for the text alone
+    json options = {
+        {"num_predict", max_tokens},
+        {"seed", vision_seed},
+        {"temperature", 0}
+    };
+    GenerationMetrics text_metrics;
+    response = api.generate_with_images(model, "[" + std::to_string(session++) + "] " + prompt(), {},
+                                        &text_metrics, &options);
+    if (response.rfind("Error:", 0) == 0) {
+        std::cerr << "Error: vision benchmark could not run " << model << ": " << response << std::endl;
+        return points;
+    }
+
+    for (const auto& payload : payloads) {
+        points.push_back(measure(api, model, payload, text_metrics.prompt_eval_count,
+                                 text_metrics.prompt_eval_duration));
+    }
+    return points;
+}
+
+const PreprocessStats& VisionBench::preprocess_stats() const {
+    return pipeline.stats();
+}
+
+void VisionBench::print(const std::vector<VisionPoint>& points) {
+    std::cout << std::left << std::setw(20) << "Model"
+              << std::setw(18) << "Image"
+              << std::setw(12) << "Size"
+              << std::setw(9) << "Img tok"
+              << std::setw(10) << "Vision s"
+              << std::setw(11) << "Prefill s"
+              << std::setw(9) << "TTFT s"
+              << std::setw(12) << "Decode t/s"
+              << "Peak RSS" << std::endl;
+    std::cout << std::string(111, '-') << std::endl;
+
+    std::vector<std::string> model_order;
+    for (const auto& point : points) {
+        if (std::find(model_order.begin(), model_order.end(), point.model_name) == model_order.end()) {
+            model_order.push_back(point.model_name);
+        }
+        if (!point.ok) {
+            continue;
+        }
+        std::string name = point.image.size() > 16 ? point.image.substr(0, 13) + "..." : point.image;
+        std::cout << std::left << std::setw(20) << point.model_name
+                  << std::setw(18) << (point.native ? name : name + "*")
+                  << std::setw(12) << (std::to_string(point.width) + "x" + std::to_string(point.height))
+                  << std::setw(9) << point.image_tokens
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(10) << point.vision_seconds
+                  << std::setw(11) << point.prefill_seconds
+                  << std::setw(9) << point.ttft_seconds
+                  << std::setprecision(2) << std::setw(12) << point.decode_rate()
+                  << format_memory(point.peak_memory) << std::defaultfloat << std::endl;
+    }
+    std::cout << "* scaled for the resolution sweep" << std::endl;
+
+    // How vision time grows with pixels over the sweep
+    for (const auto& model : model_order) {
+        const VisionPoint* smallest = nullptr;
+        const VisionPoint* largest = nullptr;
+        bool any_tokens = false;
+        for (const auto& point : points) {
+            if (point.model_name != model || !point.ok) {
+                continue;
+            }
+            any_tokens = any_tokens || point.image_tokens > 0;
+            if (point.native) {
+                continue;
+            }
+            if (!smallest || point.pixels() < smallest->pixels()) smallest = &point;
+            if (!largest || point.pixels() > largest->pixels()) largest = &point;
+        }
+        if (!any_tokens) {
+            std::cout << "  " << model << ": images added no prompt tokens (not a vision model?)" << std::endl;
+        } else if (smallest && largest && largest->pixels() > smallest->pixels() && smallest->vision_seconds > 0) {
+            std::cout << "  " << model << ": " << std::fixed << std::setprecision(1)
+                      << static_cast<double>(largest->pixels()) / smallest->pixels() << "x the pixels took "
+                      << largest->vision_seconds / smallest->vision_seconds << "x the vision time and "
+                      << (smallest->image_tokens > 0 ? static_cast<double>(largest->image_tokens) / smallest->image_tokens : 0.0)
+                      << "x the image tokens" << std::defaultfloat << std::endl;
+        }
+    }
+
+    for (const auto& point : points) {
+        if (!point.ok) {
+            std::cout << "  " << point.model_name << " / " << point.image << " " << point.width << "x"
+                      << point.height << ": " << point.error << std::endl;
+        }
+    }
+}
+
+json VisionBench::to_json(const std::vector<VisionPoint>& points) {
+    json j = json::array();
+    for (const auto& point : points) {
+        json entry = {
+            {"model", point.model_name},
+            {"image", point.image},
+            {"native", point.native},
+            {"width", point.width},
+            {"height", point.height},
+            {"payload_bytes", point.payload_bytes},
+            {"ok", point.ok},
+            {"prompt_tokens", point.prompt_tokens},
+            {"image_tokens", point.image_tokens},
+            {"prefill_s", point.prefill_seconds},
+            {"vision_s", point.vision_seconds},
+            {"ttft_s", point.ttft_seconds},
+            {"output_tokens", point.output_tokens},
+            {"decode_s", point.decode_seconds},
+            {"decode_tokens_per_second", point.decode_rate()},
+            {"peak_memory_kb", point.peak_memory}
+        };
+        if (!point.error.empty()) {
+            entry["error"] = point.error;
+        }
+        j.push_back(entry);
+    }
+    return j;
+}
@@ -0,0 +1,77 @@
+// PowercapSource against a fixture powercap tree: only top-level zones are
+// summed, and a counter that wrapped is unwound with max_energy_range_uj.
+#include "power_source.h"
+#include "system_utils.h"
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << std::endl;
+        failures++;
+    }
+}
+
+void write_fixture(const std::string& path, const std::string& value) {
+    make_directories(path.substr(0, path.rfind('/')));
+    std::ofstream(path) << value << "\n";
+}
+
+bool near(double value, double expected) {
+    return std::fabs(value - expected) < 1e-9;
+}
+
+} // namespace
+
+int main() {
+    char dir[] = "/tmp/powercap_fixture_XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::cerr << "Cannot create the fixture directory" << std::endl;
+        return 1;
+    }
+    const std::string root = dir;
+
+    // Package zone close to the end of its range, a subzone and an MMIO
+    // duplicate that must be skipped
+    write_fixture(root + "/intel-rapl:0/energy_uj", "999000");
+    write_fixture(root + "/intel-rapl:0/max_energy_range_uj", "1000000");
+    write_fixture(root + "/intel-rapl:0:0/energy_uj", "5000");
+    write_fixture(root + "/intel-rapl:0:0/max_energy_range_uj", "1000000");
+    write_fixture(root + "/intel-rapl-mmio:0/energy_uj", "999000");
+    write_fixture(root + "/intel-rapl-mmio:0/max_energy_range_uj", "1000000");
+
+    PowercapSource source(root);
+    check(source.available(), "fixture zone not found");
+    check(source.description().find("1 zone(s)") != std::string::npos, "subzone or MMIO zone counted");
+
+    EnergyMark start = source.mark();
+    write_fixture(root + "/intel-rapl:0/energy_uj", "999600");
+    write_fixture(root + "/intel-rapl:0:0/energy_uj", "9000");
+    EnergyMark middle = source.mark();
+    check(near(source.energy_between(start, middle), 600e-6), "plain increase");
+
+    // 400 uJ to the end of the range, then 1500 uJ after the wrap
+    write_fixture(root + "/intel-rapl:0/energy_uj", "1500");
+    EnergyMark end = source.mark();
+    check(near(source.energy_between(middle, end), 1900e-6), "wraparound not unwound");
+    check(near(source.energy_between(start, end), 2500e-6), "wraparound over the whole interval");
+
+    // Mismatched snapshots are reported as unavailable
+    EnergyMark empty{end.time, {}};
+    check(source.energy_between(empty, end) < 0, "mismatched snapshot accepted");
+
+    std::string cleanup = "rm -rf " + root;
+    if (std::system(cleanup.c_str()) != 0) {
+        std::cerr << "Warning: could not remove " << root << std::endl;
+    }
+
+    std::cout << (failures == 0 ? "power_source_test: OK" : "power_source_test: FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+// Outputs nlohmann::json rejects must count as invalid runs instead of
+// throwing out of the benchmark. The streaming validator rejects lone
+// surrogates and invalid UTF-8 too; 1e999 is valid JSON grammar that only
+// the parser refuses.
+#include "json_stream_validator.h"
+#include "structured_output_bench.h"
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+int main() {
+    const json schema = StructuredOutputBench::default_schema();
+    using Status = JsonStreamValidator::Status;
+    const std::vector<std::pair<std::string, Status>> inputs = {
+        {R"({"summary": "\ud800", "key_points": ["a"], "confidence": "high"})", Status::Invalid},   // Lone surrogate
+        {R"({"summary": "\udc00\ud800", "key_points": ["a"], "confidence": "high"})", Status::Invalid}, // Reversed pair
+        {R"({"summary": "s", "key_points": ["a"], "confidence": 1e999})", Status::Complete},         // Out-of-range number
+        {"{\"summary\": \"\xff\xfe\", \"key_points\": [\"a\"], \"confidence\": \"high\"}", Status::Invalid}, // Invalid UTF-8
+        {"{\"summary\": \"\xed\xa0\x80\", \"key_points\": [\"a\"], \"confidence\": \"high\"}", Status::Invalid}, // Encoded surrogate
+        {"{\"summary\": \"\xc0\xaf\", \"key_points\": [\"a\"], \"confidence\": \"high\"}", Status::Invalid}  // Overlong '/'
+    };
+
+    int failures = 0;
+    for (const auto& [input, expected] : inputs) {
+        JsonStreamValidator validator;
+        validator.feed(input);
+        Status status = validator.finish();
+
+        if (status != expected) {
+            std::cerr << "FAIL: validator " << (expected == Status::Complete ? "rejected " : "accepted ")
+                      << input << std::endl;
+            failures++;
+        }
+
+        bool parsed = true;
+        std::string problem;
+        try {
+            bool schema_ok = StructuredOutputBench::check_output(input, schema, parsed, problem);
+            if (schema_ok || parsed || problem.empty()) {
+                std::cerr << "FAIL: " << input << " counted as valid" << std::endl;
+                failures++;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "FAIL: check_output threw: " << e.what() << std::endl;
+            failures++;
+        }
+    }
+
+    // Paired surrogates and multi-byte UTF-8 up to U+10FFFF are accepted by both
+    const std::vector<std::string> good = {
+        R"({"summary": "s", "key_points": ["a"], "confidence": "high"})",
+        R"({"summary": "\ud83d\ude00", "key_points": ["a"], "confidence": "high"})",
+        "{\"summary\": \"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 \xf4\x8f\xbf\xbf\", \"key_points\": [\"a\"], \"confidence\": \"high\"}"
+    };
+    for (const auto& input : good) {
+        JsonStreamValidator validator;
+        validator.feed(input);
+        if (validator.finish() != Status::Complete) {
+            std::cerr << "FAIL: validator rejected " << input << ": " << validator.error() << std::endl;
+            failures++;
+        }
+
+        bool parsed = false;
+        std::string problem;
+        if (!StructuredOutputBench::check_output(input, schema, parsed, problem) || !parsed) {
+            std::cerr << "FAIL: valid output rejected: " << problem << std::endl;
+            failures++;
+        }
+    }
+
+    std::cout << (failures == 0 ? "structured_output_test: OK" : "structured_output_test: FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+// SystemStateGuard against a fixture /proc and /sys tree: every value it
+// changes is written back on restore(), on destruction and on SIGTERM, and
+// a dry run leaves the files alone.
+#include "memory_experiment.h"
+#include "system_utils.h"
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const SWAPPINESS = "/proc/sys/vm/swappiness";
+const char* const THP = "/sys/kernel/mm/transparent_hugepage/enabled";
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << std::endl;
+        failures++;
+    }
+}
+
+void write_fixture(const std::string& path, const std::string& value) {
+    make_directories(path.substr(0, path.rfind('/')));
+    std::ofstream(path) << value << "\n";
+}
+
+} // namespace
+
+int main() {
+    char dir[] = "/tmp/guard_fixture_XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::cerr << "Cannot create the fixture directory" << std::endl;
+        return 1;
+    }
+    const std::string root = dir;
+    write_fixture(root + SWAPPINESS, "60");
+    write_fixture(root + THP, "always [madvise] never");
+
+    // Destructor restores; the THP file gets the bracketed mode back
+    {
+        SystemStateGuard guard(root);
+        check(guard.apply({10, 0, false, "never"}), "fixture configuration not applied");
+        check(read_system_value(root + SWAPPINESS) == "10", "swappiness not written");
+        check(read_system_value(root + THP) == "never", "THP mode not written");
+
+        check(guard.apply({100, 0, true, "always"}), "second configuration not applied");
+        check(!guard.set_thp_mode("sometimes"), "unsupported THP mode accepted");
+        check(read_system_value(root + SWAPPINESS) == "100", "second swappiness not written");
+    }
+    check(read_system_value(root + SWAPPINESS) == "60", "swappiness not restored by the destructor");
+    check(read_system_value(root + THP) == "madvise", "THP mode not restored by the destructor");
+    // Real sysfs lists every mode again on read; the fixture file only keeps the last write
+    write_fixture(root + THP, "always [madvise] never");
+
+    // Explicit restore, then a second change is still recorded and restored
+    {
+        SystemStateGuard guard(root);
+        guard.set_swappiness(1);
+        guard.restore();
+        check(read_system_value(root + SWAPPINESS) == "60", "swappiness not restored by restore()");
+        guard.set_swappiness(5);
+    }
+    check(read_system_value(root + SWAPPINESS) == "60", "change after restore() not restored");
+
+    // Dry run writes nothing
+    {
+        SystemStateGuard guard(root, true);
+        check(guard.apply({10, 0, false, "never"}), "dry-run configuration rejected");
+        check(read_system_value(root + SWAPPINESS) == "60", "dry run wrote swappiness");
+    }
+
+    // The signal handler restores before the process dies
+    pid_t child = fork();
+    if (child == 0) {
+        SystemStateGuard guard(root);
+        guard.apply({10, 0, false, "never"});
+        raise(SIGTERM);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    check(WIFSIGNALED(status) && WTERMSIG(status) == SIGTERM, "child did not die from SIGTERM");
+    check(read_system_value(root + SWAPPINESS) == "60", "swappiness not restored on SIGTERM");
+    check(read_system_value(root + THP) == "madvise", "THP mode not restored on SIGTERM");
+
+    std::string cleanup = "rm -rf " + root;
+    if (std::system(cleanup.c_str()) != 0) {
+        std::cerr << "Warning: could not remove " << root << std::endl;
+    }
+
+    std::cout << (failures == 0 ? "system_state_guard_test: OK" : "system_state_guard_test: FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
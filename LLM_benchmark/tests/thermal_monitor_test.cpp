@@ -0,0 +1,103 @@
+// ThermalMonitor against a fixture sysfs tree: zones that do not hold a
+// number are skipped, frequency is judged against scaling_max_freq only in
+// samples taken while a request runs, and throttle counters flag any sample.
+#include "thermal_monitor.h"
+#include "system_utils.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << std::endl;
+        failures++;
+    }
+}
+
+void write_fixture(const std::string& path, const std::string& value) {
+    make_directories(path.substr(0, path.rfind('/')));
+    std::ofstream(path) << value << "\n";
+}
+
+const ThermalSample* sample_at(const std::vector<ThermalSample>& samples, double time_s) {
+    for (const auto& sample : samples) {
+        if (sample.time_s == time_s) {
+            return &sample;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+int main() {
+    char dir[] = "/tmp/thermal_fixture_XXXXXX";
+    if (!mkdtemp(dir)) {
+        std::cerr << "Cannot create the fixture directory" << std::endl;
+        return 1;
+    }
+    const std::string root = dir;
+    const std::string cpu = root + "/sys/devices/system/cpu/cpu";
+
+    write_fixture(root + "/sys/class/thermal/thermal_zone0/temp", "45000");
+    write_fixture(root + "/sys/class/thermal/thermal_zone1/temp", "N/A");
+    for (int i = 0; i < 2; ++i) {
+        // cpuinfo_max_freq is the turbo frequency; the policy limit is lower
+        write_fixture(cpu + std::to_string(i) + "/cpufreq/cpuinfo_max_freq", "4000000");
+        write_fixture(cpu + std::to_string(i) + "/cpufreq/scaling_max_freq", "2000000");
+    }
+    write_fixture(cpu + "0/cpufreq/scaling_cur_freq", "1000000");
+    write_fixture(cpu + "1/cpufreq/scaling_cur_freq", "1900000");
+    write_fixture(cpu + "0/thermal_throttle/core_throttle_count", "3");
+
+    ThermalMonitor monitor(root, 10, 0.9);
+    check(monitor.available(), "fixture zones and CPUs found");
+
+    // Busiest CPU at 0.95 of scaling_max_freq: running, not throttled
+    monitor.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    double t0 = monitor.sample_now();
+    ThermalSummary busy = monitor.summarize(0.0, t0);
+    check(busy.samples > 1, "samples taken while running");
+    check(!busy.throttled(), "0.95 of scaling_max_freq counted as throttled");
+    check(busy.max_temp_c == 45.0, "non-numeric zone not skipped");
+    check(std::fabs(busy.mean_freq_mhz - 1450.0) < 1e-6, "mean frequency over both CPUs");
+    check(std::fabs(busy.min_freq_ratio - 0.95) < 1e-6, "ratio against scaling_max_freq");
+
+    // Both CPUs at 0.5: running samples are throttled, the boundary one is not
+    write_fixture(cpu + "1/cpufreq/scaling_cur_freq", "1000000");
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    double t1 = monitor.sample_now();
+    ThermalSummary slow = monitor.summarize(t0, t1);
+    check(slow.throttled(), "running samples at 0.5 not throttled");
+    check(std::fabs(slow.min_freq_ratio - 0.5) < 1e-6, "low ratio not reported");
+    monitor.stop();
+
+    const std::vector<ThermalSample> timeline = monitor.get_samples();
+    const ThermalSample* boundary = sample_at(timeline, t1);
+    check(boundary && boundary->boundary && !boundary->throttled, "idle boundary sample judged by frequency");
+
+    // A throttle event shows up even in a boundary sample
+    write_fixture(cpu + "0/thermal_throttle/core_throttle_count", "4");
+    double t2 = monitor.sample_now();
+    check(monitor.summarize(t2, t2).throttled(), "throttle counter increase missed");
+    double t3 = monitor.sample_now();
+    check(!monitor.summarize(t3, t3).throttled(), "unchanged throttle counter flagged");
+
+    std::string cleanup = "rm -rf " + root;
+    if (std::system(cleanup.c_str()) != 0) {
+        std::cerr << "Warning: could not remove " << root << std::endl;
+    }
+
+    std::cout << (failures == 0 ? "thermal_monitor_test: OK" : "thermal_monitor_test: FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
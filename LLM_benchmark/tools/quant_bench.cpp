@@ -0,0 +1,63 @@
+#include "quant_bench.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+void display_help(const char* program_name) {
+    std::cout << "Quantized Kernel Microbenchmark for LLM Benchmark" << std::endl;
+    std::cout << "Usage: " << program_name << " [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --help, -h             Show this help message" << std::endl;
+    std::cout << "  --shapes, -s LIST      Layer shapes as ROWSxCOLS (default: 2048x2048,5632x2048,4096x4096,11008x4096)" << std::endl;
+    std::cout << "  --min-time, -t SEC     Minimum timing window per kernel (default 0.1)" << std::endl;
+    std::cout << "  --output, -o FILE      Write results to JSON file" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Example:" << std::endl;
+    std::cout << "  " << program_name << " -s 4096x4096 -o quant_kernels.json" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    // Default values
+    std::vector<std::pair<int, int>> shapes = QuantKernelBench::default_shapes();
+    double min_time = 0.1;
+    std::string output_file = "";
+
+    // Parse command line arguments
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            display_help(argv[0]);
+            return 0;
+        } else if (arg == "--shapes" || arg == "-s") {
+            if (i + 1 < argc && !QuantKernelBench::parse_shapes(argv[++i], shapes)) {
+                std::cerr << "Error: Invalid shape list (cols must be a multiple of 256)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--min-time" || arg == "-t") {
+            if (i + 1 < argc) {
+                min_time = std::stod(argv[++i]);
+            }
+        } else if (arg == "--output" || arg == "-o") {
+            if (i + 1 < argc) {
+                output_file = argv[++i];
+            }
+        }
+    }
+
+    QuantKernelBench bench(shapes, min_time);
+    auto results = bench.run();
+    QuantKernelBench::print(results);
+
+    if (!output_file.empty()) {
+        std::ofstream out(output_file);
+        if (!out.is_open()) {
+            std::cerr << "Error: Could not open output file " << output_file << std::endl;
+            return 1;
+        }
+        out << std::setw(4) << QuantKernelBench::to_json(results) << std::endl;
+        std::cout << "\nJSON results saved to " << output_file << std::endl;
+    }
+
+    return 0;
+}